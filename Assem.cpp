@@ -28,22 +28,523 @@
 
 #include "Assembler.h"
 #include "Errors.h"
+#include "ImageCache.h"
+#include "Options.h"
+#include "Linker.h"
+#include "Pipeline.h"
+#include "ResultCache.h"
+#include "Scheduler.h"
+#include "ShardRunner.h"
+#include "SharedImage.h"
+#include "Stats.h"
+#include "Translator.h"
+
+// Report the statistics gathered while the program ran, as asked for with --stats.
+static void ReportStats( )
+{
+    if( Options::StatsFile().empty() ) {
+        Stats::Print( cerr );
+        return;
+    }
+    ofstream file( Options::StatsFile().c_str(), ios::out | ios::trunc );
+    Stats::WriteJson( file );
+    if( !file ) {
+        cerr << "Could not write the statistics to " << Options::StatsFile() << endl;
+    }
+}
+
+// Merge the coverage of the run into the file given with --coverage, and tell what it added.
+static void MergeCoverage( const Coverage &a_run )
+{
+    if( a_run.GetProgram() == 0 ) {
+        return;
+    }
+    static Coverage total;
+    vector<string> errors;      // Kept apart from the errors of the run.
+    vector<string> *previous = Errors::CaptureErrors( &errors );
+    int added = total.Update( Options::CoverageFile(), a_run );
+    if( added >= 0 ) {
+        cerr << "Coverage: " << added << " new, " << total.CountExecuted() << " instructions and "
+             << total.CountBranchDirections() << " branch directions in total" << endl;
+    }
+    Errors::CaptureErrors( previous );
+    for( size_t i = 0; i < errors.size(); i++ ) {
+        cerr << errors[i] << endl;
+    }
+}
+
+// Read the input log to be replayed, or save the one recorded, as asked for with --replay or --record.
+static bool ReplayLog( InputLog &a_log )
+{
+    Errors::InitErrorReporting();
+    if( !a_log.Read( Options::InputLogFile() ) ) {
+        Errors::DisplayErrors();
+        return false;
+    }
+    return true;
+}
+
+static void SaveLog( const InputLog &a_log )
+{
+    vector<string> errors;      // Kept apart from the errors of the run.
+    vector<string> *previous = Errors::CaptureErrors( &errors );
+    a_log.Write( Options::InputLogFile() );
+    Errors::CaptureErrors( previous );
+    for( size_t i = 0; i < errors.size(); i++ ) {
+        cerr << errors[i] << endl;
+    }
+}
+
+// Read a whole file. Returns false if it could not be opened.
+static bool ReadFile( const string &a_fileName, string &a_text )
+{
+    ifstream file( a_fileName.c_str(), ios::in | ios::binary );
+    a_text.assign( istreambuf_iterator<char>( file ), istreambuf_iterator<char>() );
+    return (bool)file;
+}
+
+// The result cache given with --result-cache, NULL if there is none.
+static ResultCache *OpenResultCache( )
+{
+    static unique_ptr<ResultCache> cache;
+    if( !Options::ResultCacheDirectory().empty() && cache == NULL ) {
+        cache.reset( new ResultCache( Options::ResultCacheDirectory(), Options::ResultCacheBytes() ) );
+    }
+    return cache.get();
+}
+
+// Find the runs of a batch that need not be done, given the key of each, empty for a run that is always done. Sets a_first[i]
+// to the earlier run with the same key as run i, or i if there is none, and a_found[i] if the result of run i is in a_cache.
+static void PlanRuns( ResultCache *a_cache, const vector<string> &a_keys, vector<size_t> &a_first, vector<ResultCache::Result> &a_results, vector<bool> &a_found )
+{
+    map<string, size_t> runs;
+    a_first.resize( a_keys.size() );
+    a_results.assign( a_keys.size(), ResultCache::Result() );
+    a_found.assign( a_keys.size(), false );
+    for( size_t i = 0; i < a_keys.size(); i++ ) {
+        a_first[i] = i;
+        if( a_keys[i].empty() ) {
+            continue;
+        }
+        pair<map<string, size_t>::iterator, bool> run = runs.insert( make_pair( a_keys[i], i ) );
+        if( !run.second ) {
+            a_first[i] = run.first->second;
+            STATS_ADD( CT_DuplicateRuns, 1 );
+        }
+        else if( a_cache != NULL ) {
+            a_found[i] = a_cache->Find( a_keys[i], a_results[i] );
+        }
+    }
+}
+
+// Run the images given with -b at once on the scheduler, then print the output and errors of each in order. The runs of an
+// image given more than once, under any name, share one copy of it and keep only the pages they write.
+static bool RunBatch( const vector<string> &a_imageFiles )
+{
+    size_t count = a_imageFiles.size();
+    vector<unique_ptr<emulator>> emulators( count );
+    vector<unique_ptr<SharedInstance>> instances( count );
+    vector<istringstream> inputs( count );
+    vector<ostringstream> outputs( count );
+    vector<vector<string>> errors( count );
+    vector<int> jobs( count, -1 );
+    Scheduler scheduler;
+
+    // Only the first run of each image on each input is done, and not even that one if its result is in the result cache.
+    ResultCache *cache = OpenResultCache();
+    vector<string> texts( count );
+    vector<string> hashes( count );
+    vector<string> keys( count );
+    for( size_t i = 0; i < count; i++ ) {
+        ReadFile( Options::InputFileFor( a_imageFiles[i] ), texts[i] );
+        hashes[i] = ResultCache::HashImage( a_imageFiles[i] );
+        keys[i] = ResultCache::KeyFor( hashes[i], texts[i] );
+    }
+    vector<size_t> first;
+    vector<ResultCache::Result> results;
+    vector<bool> found;
+    PlanRuns( cache, keys, first, results, found );
+
+    // The images that more than one run is done on.
+    map<string, int> runsOf;
+    for( size_t i = 0; i < count; i++ ) {
+        if( first[i] == i && !found[i] && !hashes[i].empty() ) {
+            runsOf[hashes[i]]++;
+        }
+    }
+    map<string, unique_ptr<SharedImage>> shared;
+    map<string, size_t> sharedBy;      // The run each shared image was loaded for.
+
+    for( size_t i = 0; i < count; i++ ) {
+        if( first[i] != i || found[i] ) {
+            continue;
+        }
+        if( runsOf[hashes[i]] > 1 ) {
+            // The image is loaded for its first run. The other runs share it, or the errors of loading it.
+            pair<map<string, size_t>::iterator, bool> loader = sharedBy.insert( make_pair( hashes[i], i ) );
+            if( loader.second ) {
+                unique_ptr<emulator> loaded( new emulator );
+                vector<string> *previous = Errors::CaptureErrors( &errors[i] );
+                if( ObjectImage::LoadFile( a_imageFiles[i], *loaded ) ) {
+                    shared[hashes[i]].reset( new SharedImage( *loaded ) );
+                }
+                Errors::CaptureErrors( previous );
+            }
+            const unique_ptr<SharedImage> &image = shared[hashes[i]];
+            if( !image ) {
+                errors[i] = errors[loader.first->second];
+                continue;
+            }
+            instances[i].reset( new SharedInstance( *image ) );
+            inputs[i].str( texts[i] );
+            jobs[i] = scheduler.Submit( *instances[i], &inputs[i], &outputs[i] );
+            continue;
+        }
+        emulators[i].reset( new emulator );
+        vector<string> *previous = Errors::CaptureErrors( &errors[i] );
+        bool loaded = ObjectImage::LoadFile( a_imageFiles[i], *emulators[i] );
+        Errors::CaptureErrors( previous );
+        if( !loaded ) {
+            continue;
+        }
+        inputs[i].str( texts[i] );
+        emulators[i]->setStreams( &inputs[i], &outputs[i] );
+        jobs[i] = scheduler.Submit( *emulators[i] );
+    }
+    scheduler.Run();
+
+    bool success = true;
+    for( size_t i = 0; i < count; i++ ) {
+        size_t run = first[i];
+        if( found[run] ) {
+            outputs[i].str( results[run].m_output );
+            errors[i] = results[run].m_errors;
+            if( !results[run].m_halted ) {
+                errors[i].push_back( "Error running the emulator" );
+            }
+        }
+        else if( run != i ) {
+            outputs[i].str( outputs[run].str() );
+            errors[i] = errors[run];
+        }
+        else if( jobs[i] >= 0 ) {
+            const Scheduler::Job &job = scheduler.GetJob( jobs[i] );
+            if( cache != NULL && ( job.m_outcome == Scheduler::JO_Halted || job.m_outcome == Scheduler::JO_OutOfSteps ) ) {
+                int accumulator = instances[i] ? instances[i]->GetAccumulator() : emulators[i]->accumulator();
+                ResultCache::Result result = { job.m_outcome == Scheduler::JO_Halted, job.m_steps, accumulator,
+                    outputs[i].str(), job.m_errors };
+                cache->Save( keys[i], result );
+            }
+            errors[i].insert( errors[i].end(), job.m_errors.begin(), job.m_errors.end() );
+            if( job.m_outcome != Scheduler::JO_Halted ) {
+                errors[i].push_back( "Error running the emulator" );
+            }
+        }
+        cout << a_imageFiles[i] << ":" << endl << outputs[i].str();
+        vector<string> *previous = Errors::CaptureErrors( &errors[i] );
+        Errors::DisplayErrors();
+        Errors::CaptureErrors( previous );
+        success = success && errors[i].empty();
+    }
+    return success;
+}
+
+// Run the image given with -s on each input file in worker processes, then print the output and errors of each in order.
+static bool RunShards( const string &a_imageFile, const vector<string> &a_inputFiles )
+{
+    static emulator loaded;
+    Errors::InitErrorReporting();
+    if( !ObjectImage::LoadFile( a_imageFile, loaded ) ) {
+        Errors::DisplayErrors();
+        return false;
+    }
+
+    // Only the first run on each input is done, and not even that one if its result is in the result cache.
+    ResultCache *cache = OpenResultCache();
+    string image = ResultCache::HashImage( a_imageFile );
+    vector<string> keys( a_inputFiles.size() );
+    for( size_t i = 0; i < a_inputFiles.size(); i++ ) {
+        string input;
+        if( ReadFile( a_inputFiles[i], input ) ) {
+            keys[i] = ResultCache::KeyFor( image, input );
+        }
+    }
+    vector<size_t> first;
+    vector<ResultCache::Result> results;
+    vector<bool> found;
+    PlanRuns( cache, keys, first, results, found );
+
+    vector<string> runFiles;
+    vector<int> shards( a_inputFiles.size(), -1 );
+    for( size_t i = 0; i < a_inputFiles.size(); i++ ) {
+        if( first[i] == i && !found[i] ) {
+            shards[i] = (int)runFiles.size();
+            runFiles.push_back( a_inputFiles[i] );
+        }
+    }
+    ShardRunner runner( loaded );
+    if( !runFiles.empty() && !runner.Run( runFiles ) ) {
+        cerr << "Could not start the worker processes" << endl;
+        return false;
+    }
+
+    bool success = true;
+    for( size_t i = 0; i < a_inputFiles.size(); i++ ) {
+        size_t run = first[i];
+        ShardRunner::Result result;
+        if( found[run] ) {
+            result.m_outcome = results[run].m_halted ? ShardRunner::SO_Halted : ShardRunner::SO_OutOfSteps;
+            result.m_steps = results[run].m_steps;
+            result.m_accumulator = results[run].m_accumulator;
+            result.m_output = results[run].m_output;
+            result.m_errors = results[run].m_errors;
+            result.m_truncated = false;
+        }
+        else {
+            result = runner.GetResult( shards[run] );
+        }
+        if( run == i && !found[i] && cache != NULL && !result.m_truncated
+            && ( result.m_outcome == ShardRunner::SO_Halted || result.m_outcome == ShardRunner::SO_OutOfSteps ) ) {
+            ResultCache::Result saved = { result.m_outcome == ShardRunner::SO_Halted, result.m_steps, result.m_accumulator,
+                result.m_output, result.m_errors };
+            cache->Save( keys[i], saved );
+        }
+        vector<string> errors = result.m_errors;
+        switch( result.m_outcome ) {
+            case ShardRunner::SO_Halted:
+            case ShardRunner::SO_NoInput:
+                break;
+            case ShardRunner::SO_Crashed:
+                errors.push_back( "The worker running the program crashed" );
+                break;
+            case ShardRunner::SO_TimedOut:
+                errors.push_back( "The worker running the program took too long and was stopped" );
+                break;
+            default:
+                errors.push_back( "Error running the emulator" );
+                break;
+        }
+        if( result.m_truncated ) {
+            errors.push_back( "The output was too long and was cut off" );
+        }
+        cout << a_inputFiles[i] << ":" << endl << result.m_output;
+        vector<string> *previous = Errors::CaptureErrors( &errors );
+        Errors::DisplayErrors();
+        Errors::CaptureErrors( previous );
+        success = success && errors.empty();
+    }
+    return success;
+}
+
+// The options that change what a source assembles to, which are part of its key in the image cache.
+static string ImageCacheOptions( )
+{
+    ostringstream options;
+    if( Options::Optimize() ) {
+        options << "-O ";
+    }
+    if( Options::Evaluate() ) {
+        options << "--evaluate=" << Options::EvaluateSteps() << ":" << Options::EvaluateSeconds();
+    }
+    return options.str();
+}
 
 int main( int argc, char *argv[] )
 {
-    Assembler assem( argc, argv );
+    Options::ParseCommandLine( argc, argv );
+
+    // The statistics are reported however the program ends.
+    if( Options::Stats() ) {
+        Stats::Enable();
+        atexit( ReportStats );
+    }
+
+    // Run a previously assembled program without assembling it again.
+    if( Options::RunImage() ) {
+        static emulator emul;
+        static Coverage coverage;
+        static InputLog log;
+        if( Options::Replay() && !ReplayLog( log ) ) {
+            return 1;
+        }
+        if( !Options::InputLogFile().empty() ) {
+            emul.setInputLog( &log, Options::Replay() );
+        }
+        Errors::InitErrorReporting();
+        if( ObjectImage::LoadFile( Options::ImageFile(), emul ) ) {
+            if( !Options::CoverageFile().empty() ) {
+                emul.setCoverage( &coverage );
+            }
+            if( !emul.runProgram() ) {
+                string error = "Error running the emulator";
+                Errors::RecordError( error );
+            }
+        }
+        if( !Options::CoverageFile().empty() ) {
+            MergeCoverage( coverage );
+        }
+        if( !Options::InputLogFile().empty() && !Options::Replay() ) {
+            SaveLog( log );
+        }
+        if( !Errors::Empty() ) {
+            Errors::DisplayErrors();
+            return 1;
+        }
+        return 0;
+    }
+
+    // Run many previously assembled programs at once.
+    if( Options::Batch() ) {
+        return RunBatch( Options::InputFiles() ) ? 0 : 1;
+    }
+
+    // Run one previously assembled program on many inputs.
+    if( Options::Shards() ) {
+        return RunShards( Options::ImageFile(), Options::InputFiles() ) ? 0 : 1;
+    }
+
+    // Assemble and run many programs, with the stages of many of them at once.
+    if( Options::Pipelined() ) {
+        Pipeline pipeline;
+        unique_ptr<ImageCache> cache;
+        if( !Options::ImageCacheDirectory().empty() ) {
+            cache.reset( new ImageCache( Options::ImageCacheDirectory(), Options::ImageCacheBytes() ) );
+            pipeline.UseImageCache( cache.get() );
+        }
+        return pipeline.Run( Options::InputFiles(), cout ) ? 0 : 1;
+    }
+
+    // Translate a previously assembled program into C++ to be compiled natively.
+    if( !Options::TranslateFile().empty() ) {
+        ObjectImage image;
+        Errors::InitErrorReporting();
+        if( image.Read( Options::ImageFile() ) ) {
+            if( image.IsRelocatable() ) {
+                string error = "Object image is a module, it must be linked before it can be translated";
+                Errors::RecordError( error );
+            }
+            else {
+                ofstream out( Options::TranslateFile().c_str(), ios::out | ios::trunc );
+                Translator( image ).Translate( Options::ImageFile(), out );
+                out.close();
+                if( out.fail() ) {
+                    string error = "Could not write the translation " + Options::TranslateFile();
+                    Errors::RecordError( error );
+                }
+            }
+        }
+        if( !Errors::Empty() ) {
+            Errors::DisplayErrors();
+            return 1;
+        }
+        return 0;
+    }
+
+    // Assemble each source file as a module to be linked later.
+    if( Options::Compile() ) {
+        vector<string> objectFiles;
+        for( size_t i = 0; i < Options::InputFiles().size(); i++ ) {
+            objectFiles.push_back( Options::ObjectFileFor( Options::InputFiles()[i] ) );
+        }
+        return Assembler::AssembleModules( Options::InputFiles(), objectFiles ) ? 0 : 1;
+    }
+
+    // Link modules into a program that can be run with -x.
+    if( Options::Link() ) {
+        Linker linker;
+        ObjectImage image;
+        Errors::InitErrorReporting();
+        bool success = true;
+        for( size_t i = 0; i < Options::InputFiles().size(); i++ ) {
+            success = linker.AddModule( Options::InputFiles()[i] ) && success;
+        }
+        if( success && linker.Link( image ) ) {
+            image.Write( Options::ImageFile() );
+        }
+        if( !Errors::Empty() ) {
+            Errors::DisplayErrors();
+            return 1;
+        }
+        return 0;
+    }
+
+    Assembler assem( Options::SourceFile() );
+
+    // A replayed run needs nobody at the console.
+    static InputLog log;
+    if( Options::Replay() ) {
+        if( !ReplayLog( log ) ) {
+            return 1;
+        }
+        assem.SetInteractive( false );
+    }
+    if( !Options::InputLogFile().empty() ) {
+        assem.SetInputLog( &log, Options::Replay() );
+    }
+
+    // Reuse the results of the previous run for the lines that did not change.
+    if( Options::Incremental() ) {
+        assem.UseCache( Options::CacheFile() );
+    }
+
+    // Load a program assembled before with the same options instead of assembling it again.
+    static unique_ptr<ImageCache> cache;
+    if( !Options::ImageCacheDirectory().empty() ) {
+        cache.reset( new ImageCache( Options::ImageCacheDirectory(), Options::ImageCacheBytes() ) );
+        assem.UseImageCache( cache.get(), ImageCacheOptions() );
+    }
 
     // Establish the location of the labels:
     assem.PassI( );
 
+    // Print the source with the coverage of its instructions instead of running it.
+    if( Options::Report() ) {
+        static Coverage coverage;
+        Errors::InitErrorReporting();
+        if( !coverage.Read( Options::CoverageFile() ) || coverage.GetProgram() == 0 ) {
+            string error = "No coverage has been recorded in " + Options::CoverageFile();
+            Errors::RecordError( error );
+            Errors::DisplayErrors();
+            return 1;
+        }
+        assem.ReportCoverage( coverage );
+        return Errors::Empty() ? 0 : 1;
+    }
+
     // Display the symbol table.
     assem.DisplaySymbolTable();
 
     // Output the symbol table and the translation.
     assem.PassII( );
 
+    // Make the translation execute fewer instructions.
+    if( Options::Optimize() ) {
+        assem.Optimize( );
+    }
+
+    // Do the work that does not depend on the input once, instead of in every run.
+    if( Options::Evaluate() ) {
+        assem.Evaluate( Options::EvaluateSteps(), Options::EvaluateSeconds() );
+    }
+    assem.CacheImage( );
+
+    // Save the translation so it can be run again without being assembled.
+    if( assem.WriteImage( Options::ImageFile() ) ) {
+        assem.WriteDebugInfo( Options::DebugFile() );
+    }
+
     // Run the emulator on the VC3600 program that was generated in Pass II.
+    static Coverage coverage;
+    if( !Options::CoverageFile().empty() ) {
+        assem.SetCoverage( &coverage );
+    }
     assem.RunEmulator();
+    if( !Options::CoverageFile().empty() ) {
+        MergeCoverage( coverage );
+    }
+    if( !Options::InputLogFile().empty() && !Options::Replay() ) {
+        SaveLog( log );
+    }
    
     // Terminate indicating all is well.  If there is an unrecoverable error, the 
     // program will terminate at the point that it occurred with an exit(1) call.
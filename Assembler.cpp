@@ -3,12 +3,16 @@
 //
 #include "stdafx.h"
 #include "Assembler.h"
+#include "ImageCache.h"
 #include "Errors.h"
+#include "Hash.h"
+#include "MappedFile.h"
+#include "Stats.h"
 
 
 /**/
 /*
-Assembler::Assembler( int argc, char *argv[] )
+Assembler::Assembler( const string &a_sourceFile )
 
 NAME
 
@@ -16,13 +20,12 @@ NAME
 
 SYNOPSIS
 
-    Assembler::Assembler( int argc, char *argv[] );
-    argc              --> total number of arguments received in the command line.
-    *argv[]           --> a pointer to the array of arguments passed through the command line.
+    Assembler::Assembler( const string &a_sourceFile );
+    a_sourceFile      --> name of the source file to be assembled.
 
 DESCRIPTION
 
-    Constructor for the assembler. Note: we are passing argc and argv to the file access constructor.
+    Constructor for the assembler. Note: we are passing the file name to the file access constructor.
 
 RETURNS
 
@@ -37,13 +40,522 @@ DATE
 
 */
 /**/
-Assembler::Assembler( int argc, char *argv[] )
-: m_facc( argc, argv )
+Assembler::Assembler( const string &a_sourceFile )
+: m_sourceFile( a_sourceFile ), m_facc( a_sourceFile ), m_sourceRead( false ), m_useCache( false ), m_imageCache( NULL ), m_cached( false ), m_module( false ), m_out( &cout ), m_interactive( true ), m_coverage( NULL )
 {
 
     // Nothing else to do here at this point.
 
-} /* Assembler::Assembler( int argc, char *argv[] ) */
+} /* Assembler::Assembler( const string &a_sourceFile ) */
+
+
+/**/
+/*
+Assembler::UseCache(const string &a_fileName)
+
+NAME
+
+    Assembler::UseCache - assemble incrementally using a cache file.
+
+SYNOPSIS
+
+    void Assembler::UseCache(const string &a_fileName);
+    a_fileName    --> name of the cache file.
+
+DESCRIPTION
+
+    Loads the results of the previous run from the cache file. The source is then read whole and
+    split into blocks, and the blocks whose text did not change are not split into lines or parsed
+    by Pass I. Pass II takes their translation and listing from the cache unless they moved or a
+    symbol they refer to did, in which case their lines are translated again without being parsed.
+    At the end of Pass II the cache file is replaced with the results of this run. This must be
+    called before the source is read.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Assembler::UseCache(const string &a_fileName)
+{
+     m_useCache = true;
+     m_cacheFile = a_fileName;
+     m_cache.Load(a_fileName);
+} /* void Assembler::UseCache(const string &a_fileName) */
+
+
+/**/
+/*
+Assembler::MakeModule()
+
+NAME
+
+    Assembler::MakeModule - assemble the source as a relocatable module.
+
+SYNOPSIS
+
+    void Assembler::MakeModule();
+
+DESCRIPTION
+
+    The source may then use "import <symbol>" to refer to a symbol defined in another module and
+    "export <symbol>" to let other modules refer to one of its labels. The object image records which
+    instructions refer to labels of the module and which refer to imported symbols, so the Linker can
+    place the module anywhere in memory and connect it to the other modules.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Assembler::MakeModule()
+{
+     m_module = true;
+} /* void Assembler::MakeModule() */
+
+
+/**/
+/*
+Assembler::SetOutput(ostream &a_out)
+
+NAME
+
+    Assembler::SetOutput - redirect the output of the assembler.
+
+SYNOPSIS
+
+    void Assembler::SetOutput(ostream &a_out);
+    a_out    --> the stream the listing and the errors are written to.
+
+DESCRIPTION
+
+    Writes the translation listing and the errors of Pass II to a_out instead of the console, and no longer
+    waits for the user to press Enter. Used when several sources are assembled at the same time.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Assembler::SetOutput(ostream &a_out)
+{
+     m_out = &a_out;
+     m_interactive = false;
+} /* void Assembler::SetOutput(ostream &a_out) */
+
+
+/**/
+/*
+Assembler::UseImageCache(ImageCache *a_cache, const string &a_options)
+
+NAME
+
+    Assembler::UseImageCache - assemble through an image cache.
+
+SYNOPSIS
+
+    void Assembler::UseImageCache(ImageCache *a_cache, const string &a_options);
+    a_cache      --> the image cache.
+    a_options    --> the options the source is assembled with that change its image or listing.
+
+DESCRIPTION
+
+    Pass I then looks the source up in the cache. If it is found, the object image, the debug
+    information and the listing are loaded from the cache, Pass II, Optimize and Evaluate only print
+    the listing as it was, and the lines of the source are not read or translated at all. Otherwise
+    the source is assembled as usual and the listing is kept, so CacheImage can save it all. Modules
+    are not cached.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Assembler::UseImageCache(ImageCache *a_cache, const string &a_options)
+{
+     m_imageCache = a_cache;
+     m_imageKey = ImageCache::KeyFor(m_sourceFile, a_options);
+     m_listing.assign(LS_Sections, "");
+} /* void Assembler::UseImageCache(ImageCache *a_cache, const string &a_options) */
+
+
+/**/
+/*
+Assembler::CacheImage()
+
+NAME
+
+    Assembler::CacheImage - save the results in the image cache.
+
+SYNOPSIS
+
+    void Assembler::CacheImage();
+
+DESCRIPTION
+
+    Saves the object image, the debug information and the listing in the image cache, to be found by
+    the next assembly of the same source. Nothing is saved if the cache is not in use, the results came
+    from it, there were errors or the source is a module. The cache only saves work, so failing to save
+    is not an error.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Assembler::CacheImage()
+{
+     if (m_imageCache == NULL || m_cached || m_module || !Errors::Empty())
+          return;
+     if (m_listing[LS_Symbols].empty()) {
+          ostringstream symbols;
+          m_symtab.DisplaySymbolTable(symbols);
+          m_listing[LS_Symbols] = symbols.str();
+     }
+     m_imageCache->Save(m_imageKey, m_image, m_debug, m_listing);
+} /* void Assembler::CacheImage() */
+
+
+/**/
+/*
+Assembler::DisplaySymbolTable()
+
+NAME
+
+    Assembler::DisplaySymbolTable - print the symbol table.
+
+SYNOPSIS
+
+    void Assembler::DisplaySymbolTable();
+
+DESCRIPTION
+
+    Prints the symbol table, or the one kept in the image cache if the image came from it, and waits
+    for the user to press Enter.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Assembler::DisplaySymbolTable()
+{
+     if (m_cached) {
+          cout << m_listing[LS_Symbols];
+     }
+     else {
+          ostringstream symbols;
+          m_symtab.DisplaySymbolTable(symbols);
+          WriteListing(cout, LS_Symbols, symbols.str());
+     }
+     // The rest of the output relies on the console being left justified, as printing the table leaves it.
+     cout << left << "Press Enter to continue...";
+     cin.ignore();
+} /* void Assembler::DisplaySymbolTable() */
+
+
+/**/
+/*
+Assembler::WriteListing(ostream &a_out, ListingSection a_section, const string &a_text)
+
+NAME
+
+    Assembler::WriteListing - print part of the listing.
+
+SYNOPSIS
+
+    void Assembler::WriteListing(ostream &a_out, ListingSection a_section, const string &a_text);
+    a_out        --> the stream it is printed to.
+    a_section    --> the section of the listing it belongs to.
+    a_text       --> the text.
+
+DESCRIPTION
+
+    Prints the text, and adds it to its section of the listing kept for the image cache, if the cache
+    is in use.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Assembler::WriteListing(ostream &a_out, ListingSection a_section, const string &a_text)
+{
+     a_out << a_text;
+     if (m_imageCache != NULL)
+          m_listing[a_section] += a_text;
+} /* void Assembler::WriteListing(ostream &a_out, ListingSection a_section, const string &a_text) */
+
+
+/**/
+/*
+ParallelFor(size_t a_count, const function<void(size_t)> &a_body)
+
+NAME
+
+    ParallelFor - run a function on separate threads.
+
+SYNOPSIS
+
+    static void ParallelFor(size_t a_count, const function<void(size_t)> &a_body);
+    a_count    --> the number of times the function is called.
+    a_body     --> the function. it is called once with each index from 0 to a_count - 1.
+
+DESCRIPTION
+
+    Calls a_body for every index and waits for all of the calls to finish. There are no more threads
+    than hardware threads, the calling thread being one of them, and each takes the next index until
+    none are left.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+static void ParallelFor(size_t a_count, const function<void(size_t)> &a_body)
+{
+     atomic<size_t> next(0);
+     auto work = [&next, a_count, &a_body]() {
+          for (size_t i = next++; i < a_count; i = next++)
+               a_body(i);
+     };
+     size_t count = min<size_t>(a_count, max<unsigned>(1, thread::hardware_concurrency()));
+     vector<thread> threads;
+     for (size_t i = 1; i < count; i++)
+          threads.push_back(thread(work));
+     work();
+     for (size_t i = 0; i < threads.size(); i++)
+          threads[i].join();
+} /* static void ParallelFor(size_t a_count, const function<void(size_t)> &a_body) */
+
+
+/**/
+/*
+Assembler::HashSource(const string &a_sourceFile)
+
+NAME
+
+    Assembler::HashSource - hash the contents of a source file.
+
+SYNOPSIS
+
+    static uint64_t Assembler::HashSource(const string &a_sourceFile);
+    a_sourceFile    --> name of the source file.
+
+DESCRIPTION
+
+    Computes a 64 bit hash of the bytes of the source file, seeded with the version of the object image
+    format so that modules written by an older assembler are never taken to be up to date.
+
+RETURNS
+
+    The hash of the source file, or 0 if it could not be read.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+uint64_t Assembler::HashSource(const string &a_sourceFile)
+{
+     MappedFile file;
+     if (!file.Open(a_sourceFile))
+          return 0;
+     uint32_t version = ObjectImage::VERSION;
+     return Hash::Fnv1a64(file.Data(), file.Size(), Hash::Fnv1a64(&version, sizeof(version)));
+} /* uint64_t Assembler::HashSource(const string &a_sourceFile) */
+
+
+/**/
+/*
+Assembler::AssembleModules(const vector<string> &a_sourceFiles, const vector<string> &a_objectFiles)
+
+NAME
+
+    Assembler::AssembleModules - assemble several modules.
+
+SYNOPSIS
+
+    static bool Assembler::AssembleModules(const vector<string> &a_sourceFiles, const vector<string> &a_objectFiles);
+    a_sourceFiles    --> names of the source files of the modules.
+    a_objectFiles    --> names of the object files the modules are saved as, in the same order.
+
+DESCRIPTION
+
+    Assembles each source file as a relocatable module. A module is skipped if its object file was
+    assembled from the same contents, so only the modules that changed are assembled again. The
+    modules are independent of each other, so they are assembled on separate threads, each with its
+    own listing and errors. The listings and the errors are printed in the order of the source files.
+
+RETURNS
+
+    'true' if every module is up to date or was assembled and saved without errors,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Assembler::AssembleModules(const vector<string> &a_sourceFiles, const vector<string> &a_objectFiles)
+{
+     vector<string> listings(a_sourceFiles.size());
+     vector<char> failed(a_sourceFiles.size(), 0);
+     atomic<size_t> next(0);
+
+     size_t workers = max<size_t>(1, min<size_t>(thread::hardware_concurrency(), a_sourceFiles.size()));
+     ParallelFor(workers, [&](size_t) {
+          for (size_t i = next++; i < a_sourceFiles.size(); i = next++) {
+               ostringstream out;
+               vector<string> errors;
+               vector<string> *previous = Errors::CaptureErrors(&errors);
+
+               // A module whose source did not change need not be assembled again.
+               uint64_t hash = HashSource(a_sourceFiles[i]);
+               ObjectImage existing;
+               if (hash != 0 && existing.Read(a_objectFiles[i]) && existing.IsRelocatable() && existing.GetSourceHash() == hash) {
+                    out << a_sourceFiles[i] << ": " << a_objectFiles[i] << " is up to date" << endl;
+               }
+               else {
+                    out << a_sourceFiles[i] << ":" << endl;
+                    Assembler assem(a_sourceFiles[i]);
+                    assem.MakeModule();
+                    assem.SetOutput(out);
+                    assem.PassI();
+                    assem.PassII();
+                    assem.m_image.SetSourceHash(hash);
+                    if (!Errors::Empty() || !assem.WriteImage(a_objectFiles[i]))
+                         failed[i] = 1;
+               }
+
+               Errors::CaptureErrors(previous);
+               listings[i] = out.str();
+          }
+     });
+
+     bool success = true;
+     for (size_t i = 0; i < listings.size(); i++) {
+          cout << listings[i];
+          success = success && !failed[i];
+     }
+     return success;
+} /* bool Assembler::AssembleModules(const vector<string> &a_sourceFiles, const vector<string> &a_objectFiles) */
+
+
+/**/
+/*
+Assembler::ReadSource()
+
+NAME
+
+    Assembler::ReadSource - read the source code.
+
+SYNOPSIS
+
+    void Assembler::ReadSource();
+
+DESCRIPTION
+
+    Reads all the lines of the source file into memory. Pass I calls this itself if it has not been
+    called, so it only needs to be called to read the source apart from the rest of Pass I, as the
+    Pipeline does on a thread of its own. With the translation cache the text is read whole instead,
+    and Pass I only splits the blocks that changed into lines.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Assembler::ReadSource()
+{
+     if (m_useCache)
+          m_facc.GetAllText(m_source);
+     else
+          m_facc.GetAllLines(m_lines);
+     m_sourceRead = true;
+} /* void Assembler::ReadSource() */
 
 
 /**/
@@ -52,16 +564,593 @@ Assembler::PassI()
 
 NAME
 
-    Assembler::PassI - first pass through the source code.
+    Assembler::PassI - first pass through the source code.
+
+SYNOPSIS
+
+    Assembler::PassI();
+
+DESCRIPTION
+
+    This function is the first pass for the Assembler. Pass I establishes the location of the 
+    labels and constructs a symbol table using the SymbolTable class.
+
+    The source code is read into memory and split at line boundaries into chunks, one per hardware
+    thread for large sources. Each chunk is scanned on its own thread for its labels and its size,
+    with locations counted from the start of the chunk until an org statement makes them absolute.
+    A prefix sum over the chunks then gives the location each chunk starts at, and the symbol tables
+    of the chunks are built and merged in parallel. Chunks after the end statement are ignored.
+
+    With the translation cache the chunks are the blocks of the source instead, matched with those
+    of the previous run, and there may be many more of them than threads. The labels of a block that
+    did not change are taken from the cache.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Assembler::PassI()
+{
+     // A source assembled before is not read at all.
+     if (m_imageCache != NULL && !m_module) {
+          vector<string> listing;
+          m_cached = m_imageCache->Find(m_imageKey, m_sourceFile, m_image, m_debug, listing) && listing.size() == LS_Sections;
+          if (m_cached) {
+               m_listing = listing;
+               return;
+          }
+     }
+
+     if (!m_sourceRead)
+          ReadSource();
+     STATS_TIMER(timer, PH_PassI);
+     if (m_useCache) {
+          // Each block is a chunk. Only the lines of the new blocks are split out of the text, by ScanChunk.
+          vector<TranslationCache::Span> spans;
+          m_cache.Match(m_source, spans);
+          m_chunks.assign(spans.size(), Chunk());
+          size_t line = 0;
+          for (size_t i = 0; i < spans.size(); i++) {
+               m_chunks[i].m_first = line;
+               line += spans[i].m_lines;
+               m_chunks[i].m_last = line;
+               m_chunks[i].m_offset = spans[i].m_offset;
+               m_chunks[i].m_size = spans[i].m_size;
+               m_chunks[i].m_cached = spans[i].m_block;
+          }
+          m_lines.assign(line, string());
+     }
+     else {
+          // Split the lines into chunks of about the same size.
+          size_t count = thread::hardware_concurrency();
+          count = max<size_t>(1, min<size_t>(count, m_lines.size() / MIN_CHUNK_LINES));
+          m_chunks.assign(count, Chunk());
+          for (size_t i = 0; i < count; i++) {
+               m_chunks[i].m_first = m_lines.size() * i / count;
+               m_chunks[i].m_last = m_lines.size() * (i + 1) / count;
+          }
+     }
+
+     // Scan the chunks for labels.
+     ParallelFor(m_chunks.size(), [this](size_t i) { ScanChunk(m_chunks[i]); });
+
+     // Establish where each chunk starts. Pass I stops at the end statement.
+     int loc = 0;
+     m_endLine = m_lines.size();
+     size_t used = m_chunks.size();
+     for (size_t i = 0; i < m_chunks.size(); i++) {
+          m_chunks[i].m_start = loc;
+          loc = m_chunks[i].m_absolute ? m_chunks[i].m_loc : loc + m_chunks[i].m_loc;
+
+          if (m_chunks[i].m_endLine != m_chunks[i].m_last && m_endLine == m_lines.size()) {
+               m_endLine = m_chunks[i].m_endLine;
+               used = i + 1;
+          }
+     }
+
+     // Record the labels of each group of chunks in the symbol table of its first chunk. There are no more
+     // groups than threads, so there are as many groups as chunks unless the chunks are blocks of the cache.
+     size_t groups = min<size_t>(used, max<unsigned>(1, thread::hardware_concurrency()));
+     ParallelFor(groups, [this, used, groups](size_t g) {
+          SymbolTable &symtab = m_chunks[used * g / groups].m_symtab;
+          for (size_t i = used * g / groups; i < used * (g + 1) / groups; i++) {
+               Chunk &chunk = m_chunks[i];
+               for (vector<ChunkLabel>::iterator it = chunk.m_labels.begin(); it != chunk.m_labels.end(); ++it)
+                    symtab.AddSymbol(it->m_label, it->m_relative ? chunk.m_start + it->m_loc : it->m_loc);
+          }
+     });
+
+     // Merge the tables pairwise until the first chunk holds all the symbols.
+     for (size_t step = 1; step < groups; step *= 2) {
+          ParallelFor((groups + step - 1) / (2 * step), [this, step, used, groups](size_t i) {
+               m_chunks[used * (2 * step * i) / groups].m_symtab.Merge(m_chunks[used * (2 * step * i + step) / groups].m_symtab);
+          });
+     }
+     m_symtab = m_chunks[0].m_symtab;
+} /* void Assembler::PassI() */
+
+
+/**/
+/*
+Assembler::ScanChunk(Chunk &a_chunk)
+
+NAME
+
+    Assembler::ScanChunk - first pass through a chunk of the source code.
+
+SYNOPSIS
+
+    void Assembler::ScanChunk(Chunk &a_chunk);
+    a_chunk    --> the chunk to be scanned.
+
+DESCRIPTION
+
+    Records the labels of the chunk and the location following it, counting locations from the start of
+    the chunk. Once an org statement is seen the locations are absolute. Scanning stops at an end statement.
+    The symbols named by import and export statements are recorded as well.
+    When the translation cache is in use, a block that did not change takes all of this from the
+    cache, and the lines of a new block are split out of the text and their results kept for Pass II.
+    This is called on a separate thread for each chunk, so it uses its own Instruction object.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Assembler::ScanChunk(Chunk &a_chunk)
+{
+     Instruction inst;      // Instruction object for this thread
+     TranslationCache::Entry scanned;   // Results of the line when the cache is not in use
+     int loc = 0;           // Tracks the location of the instructions to be generated.
+
+     a_chunk.m_absolute = false;
+     a_chunk.m_endLine = a_chunk.m_last;
+
+     // A block that did not change is not looked at.
+     if (a_chunk.m_cached != NULL) {
+          const TranslationCache::Block &block = *a_chunk.m_cached;
+          a_chunk.m_loc = block.m_loc;
+          a_chunk.m_absolute = block.m_absolute;
+          a_chunk.m_endLine = a_chunk.m_first + min(block.m_endLine, block.m_lines);
+          a_chunk.m_labels = block.m_labels;
+          a_chunk.m_exports = block.m_exports;
+          return;
+     }
+     if (m_useCache) {
+          SplitLines(a_chunk);
+          a_chunk.m_entries.assign(a_chunk.m_last - a_chunk.m_first, TranslationCache::Entry());
+     }
+
+     // Successively process each line of the chunk.
+     for (size_t i = a_chunk.m_first; i < a_chunk.m_last; i++) {
+          TranslationCache::Entry &entry = m_useCache ? a_chunk.m_entries[i - a_chunk.m_first] : scanned;
+          ParseLine(inst, m_lines[i], entry);
+
+          // If this is an end statement, there is nothing left to do in pass I.
+          // Pass II will determine if the end is the last statement.
+          if (entry.m_type == Instruction::ST_End) {
+               a_chunk.m_endLine = i;
+               STATS_ADD(CT_LinesPassI, i + 1 - a_chunk.m_first);
+               break;
+          }
+
+          // Labels can only be on machine language and assembler language
+          // instructions.  So, skip other instruction types.
+          if (entry.m_type != Instruction::ST_MachineLanguage && entry.m_type != Instruction::ST_AssemblerInstr)
+          {
+               continue;
+          }
+          // An imported symbol is recorded like a label so it is known in Pass II.
+          if (entry.m_import && !entry.m_linkSymbol.empty()) {
+               ChunkLabel label = { entry.m_linkSymbol, SymbolTable::importedSymbol, false };
+               a_chunk.m_labels.push_back(label);
+          }
+          if (entry.m_export && !entry.m_linkSymbol.empty())
+               a_chunk.m_exports.push_back(entry.m_linkSymbol);
+
+          // If the instruction has a label, record it and its location.
+          if (!entry.m_label.empty()) {
+               ChunkLabel label = { entry.m_label, loc, !a_chunk.m_absolute };
+               a_chunk.m_labels.push_back(label);
+          }
+
+          // Compute the location of the next instruction. Locations after an org statement
+          // no longer depend on where the chunk starts.
+          if (entry.m_origin) {
+               a_chunk.m_absolute = true;
+               loc = entry.m_size;
+          }
+          else {
+               loc += entry.m_size;
+          }
+     }
+     if (a_chunk.m_endLine == a_chunk.m_last)
+          STATS_ADD(CT_LinesPassI, a_chunk.m_last - a_chunk.m_first);
+     a_chunk.m_loc = loc;
+} /* void Assembler::ScanChunk(Chunk &a_chunk) */
+
+
+/**/
+/*
+Assembler::PassII()
+
+NAME
+
+    Assembler::PassII - second pass through the source code.
+
+SYNOPSIS
+
+    void Assembler::PassII();
+
+DESCRIPTION
+
+    Pass II does a second traversal of the source code. It uses the symbol table established in Pass I 
+    and starts translating the source code into code for the VC-3600 computer. Pass II does the most 
+    work in this project as it translates the instructions, it records any errors encountered, and stores 
+    the translated instruction in a vector of pairs for further use. Pass II also prints out the original 
+    statement and the translated code for every line of instruction in the source code with help from the 
+    TranslateInstruction function in the Instruction class and ListTranslation. At the end, if errors have been encountered, 
+    the function prints them out. Otherwise the translation is packed into an object image.
+
+    The chunks established in Pass I are translated on separate threads. Their listings, errors and
+    machine code are then put together in source order, so the output is the same as translating the
+    lines one after another. When the translation cache is in use, lines whose cached translation is
+    still good are not translated again, and the cache file is updated at the end.
+
+    When the source is assembled as a module, the image also records the instructions whose operand is
+    a label of the module, which the Linker relocates, and those whose operand is imported.
+
+RETURNS
+
+
+AUTHOR
+
+	Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Assembler::PassII()
+{
+     STATS_TIMER(timer, PH_PassII);
+     Errors::InitErrorReporting(); 
+
+     // The translation came from the image cache.
+     if (m_cached) {
+          *m_out << m_listing[LS_Translation];
+          STATS_STOP(timer);
+          if (m_interactive) {
+               cout << "Press Enter to continue...";
+               cin.ignore();
+          }
+          return;
+     }
+
+     // Translate the chunks up to the one holding the end statement.
+     size_t used = 0;
+     while (used < m_chunks.size() && m_chunks[used].m_first <= m_endLine)
+          used++;
+     ParallelFor(used, [this](size_t i) { TranslateChunk(m_chunks[i]); });
+
+     // Clearing the vector which will hold the (location, content) pair which will be fed into the emulator
+     m_machinecode.clear();
+     m_sourceLines.clear();
+     m_instructions.clear();
+     vector<int> relocations;
+     vector<pair<int, string>> imports;
+     vector<string> exports;
+
+     // Print the header for the translation table output, followed by the listings of the chunks.
+     STATS_TIMER(listingTimer, PH_Listing);
+     ostringstream heading;
+     heading << setw(12) << left << "Location" << setw(12) << left << "Contents" << "Original Statement" << endl;
+     WriteListing(*m_out, LS_Translation, heading.str());
+     for (size_t i = 0; i < used; i++)
+          WriteListing(*m_out, LS_Translation, m_chunks[i].m_listing);
+     STATS_STOP(listingTimer);
+
+     // Put the results of the chunks together in source order.
+     int origin = -1;     // Location of the first machine language instruction
+     int loc = 0;         // Location following the last line translated
+     for (size_t i = 0; i < used; i++) {
+          Chunk &chunk = m_chunks[i];
+          for (vector<string>::iterator it = chunk.m_errors.begin(); it != chunk.m_errors.end(); ++it)
+               Errors::RecordError(*it);
+          m_machinecode.insert(m_machinecode.end(), chunk.m_machinecode.begin(), chunk.m_machinecode.end());
+          m_sourceLines.insert(m_sourceLines.end(), chunk.m_sourceLines.begin(), chunk.m_sourceLines.end());
+          m_instructions.insert(m_instructions.end(), chunk.m_instructions.begin(), chunk.m_instructions.end());
+          relocations.insert(relocations.end(), chunk.m_relocations.begin(), chunk.m_relocations.end());
+          imports.insert(imports.end(), chunk.m_imports.begin(), chunk.m_imports.end());
+          exports.insert(exports.end(), chunk.m_exports.begin(), chunk.m_exports.end());
+
+          // Execution starts at the first instruction rather than at any constants before it.
+          if (origin == -1)
+               origin = chunk.m_origin;
+          loc = chunk.m_absolute ? chunk.m_loc : chunk.m_start + chunk.m_loc;
+     }
+
+     if (m_endLine == m_lines.size()) {
+          // Report error : since there are no more lines, we are missing an end statement
+          string error = "(location " + to_string(loc) + ") Missing end statement";
+          Errors::RecordError(error);
+     }
+     else if (m_endLine + 1 < m_lines.size()) {
+          string error = "(location " + to_string(loc) + ") Lines after end statement";
+          Errors::RecordError(error);
+     }
+
+     // Only modules may be linked to other modules, and only their own labels may be exported.
+     if (!m_module && (!imports.empty() || !exports.empty())) {
+          string error = "Import and export statements are only allowed in modules (assemble with -c)";
+          Errors::RecordError(error);
+     }
+     for (vector<string>::iterator it = exports.begin(); it != exports.end(); ++it) {
+          int symbolLoc = 0;
+          if (!m_symtab.LookupSymbol(*it, symbolLoc) || symbolLoc < 0) {
+               string error = "Exported symbol " + *it + " is not a label of the module";
+               Errors::RecordError(error);
+          }
+     }
+     SymbolTable::TakeLookups();
+
+     // Keep the results of the blocks up to the end statement for the next run, unless they had errors.
+     if (m_useCache) {
+          vector<TranslationCache::Block> blocks;
+          for (size_t i = 0; i < used; i++) {
+               Chunk &chunk = m_chunks[i];
+               if (!chunk.m_errors.empty())
+                    continue;
+               if (chunk.m_reused) {
+                    blocks.push_back(*chunk.m_cached);
+                    blocks.back().m_offset = chunk.m_offset;
+                    continue;
+               }
+               TranslationCache::Block block;
+               block.m_offset = chunk.m_offset;
+               block.m_size = chunk.m_size;
+               block.m_lines = chunk.m_last - chunk.m_first;
+               block.m_loc = chunk.m_loc;
+               block.m_absolute = chunk.m_absolute;
+               block.m_endLine = chunk.m_endLine - chunk.m_first;
+               block.m_labels.swap(chunk.m_labels);
+               block.m_exports.swap(chunk.m_exports);
+               block.m_start = chunk.m_start;
+               block.m_symbols.swap(chunk.m_symbols);
+               block.m_listing.swap(chunk.m_listing);
+               block.m_machinecode.swap(chunk.m_machinecode);
+               for (size_t j = 0; j < chunk.m_sourceLines.size(); j++)
+                    block.m_sourceLines.push_back(chunk.m_sourceLines[j] - static_cast<int>(chunk.m_first));
+               block.m_instructions.swap(chunk.m_instructions);
+               block.m_origin = chunk.m_origin;
+               block.m_relocations.swap(chunk.m_relocations);
+               block.m_imports.swap(chunk.m_imports);
+               TranslationCache::EncodeEntries(chunk.m_entries, block.m_entries);
+               blocks.push_back(block);
+          }
+          m_cache.Replace(m_source, blocks);
+          if (!m_cache.Save(m_cacheFile)) {
+               string error = "Could not save the translation cache " + m_cacheFile;
+               Errors::RecordError(error);
+          }
+     }
+
+     if (!Errors::Empty()) {
+          Errors::DisplayErrors(*m_out);
+     }
+     else {
+          // Imported symbols have no location in this image.
+          map<string, int> symbols;
+          for (map<string, int>::const_iterator it = m_symtab.GetSymbols().begin(); it != m_symtab.GetSymbols().end(); ++it) {
+               if (it->second != SymbolTable::importedSymbol)
+                    symbols.insert(*it);
+          }
+          m_image.Build(origin == -1 ? 0 : origin, loc, m_machinecode, symbols);
+          vector<pair<int, int>> sourceLines;
+          for (size_t i = 0; i < m_machinecode.size(); i++)
+               sourceLines.push_back(pair<int, int>(m_machinecode[i].first, m_sourceLines[i]));
+          m_debug.Build(m_sourceFile, sourceLines, symbols, loc);
+          if (m_module)
+               m_image.SetLinkage(relocations, imports, exports);
+     }
+
+     STATS_STOP(timer);
+     if (m_interactive) {
+          cout << "Press Enter to continue...";
+          cin.ignore();
+     }
+} /* void Assembler::PassII() */
+
+
+/**/
+/*
+Assembler::Optimize()
+
+NAME
+
+    Assembler::Optimize - optimize the translation.
+
+SYNOPSIS
+
+    void Assembler::Optimize();
+
+DESCRIPTION
+
+    Runs the Optimizer on the machine code of Pass II, prints what it changed and rebuilds the object
+    image and the debug information from the optimized code. Nothing is done if there were errors.
+    Modules are left alone, since the Linker relies on the locations recorded in them.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Assembler::Optimize()
+{
+     if (m_cached) {
+          *m_out << m_listing[LS_Optimization];
+          return;
+     }
+     if (!Errors::Empty())
+          return;
+     if (m_module) {
+          *m_out << "Modules are not optimized" << endl;
+          return;
+     }
+
+     Optimizer optimizer(m_machinecode, m_instructions, m_image.GetOrigin(), m_image.GetEnd(), m_image.GetSymbols());
+     optimizer.Run();
+     ostringstream report;
+     optimizer.Report(report);
+     WriteListing(*m_out, LS_Optimization, report.str());
+
+     // The words keep their source lines, except the removed ones.
+     vector<pair<int, int>> sourceLines;
+     for (size_t i = 0; i < m_machinecode.size(); i++) {
+          if (!optimizer.IsRemoved(m_machinecode[i].first))
+               sourceLines.push_back(pair<int, int>(optimizer.Remap(m_machinecode[i].first), m_sourceLines[i]));
+     }
+
+     m_machinecode = optimizer.GetMachineCode();
+     map<string, int> symbols = optimizer.GetSymbols();
+     m_image.Build(optimizer.GetOrigin(), optimizer.GetEnd(), m_machinecode, symbols);
+     m_debug.Build(m_sourceFile, sourceLines, symbols, optimizer.GetEnd());
+
+     // The words no longer follow the source, so they are not matched with its lines and kinds any more.
+     m_sourceLines.clear();
+     m_instructions.clear();
+} /* void Assembler::Optimize() */
+
+
+/**/
+/*
+Assembler::Evaluate(int a_maxSteps, double a_maxSeconds)
+
+NAME
+
+    Assembler::Evaluate - run the start of the program at assembly time.
+
+SYNOPSIS
+
+    void Assembler::Evaluate(int a_maxSteps, double a_maxSeconds);
+    a_maxSteps      --> the most steps to run.
+    a_maxSeconds    --> the most time to run for.
+
+DESCRIPTION
+
+    Loads the image into an emulator of its own and runs it up to the first instruction that reads,
+    writes, halts or would overflow, within the bounds given. The memory, origin, accumulator and step
+    count it stops with replace those of the image, so every run of the program starts from there
+    instead of doing the same work again. The locations of the words do not change, so the debug
+    information stays as it is. Nothing is done if there were errors or the source is a module.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Assembler::Evaluate(int a_maxSteps, double a_maxSeconds)
+{
+     if (m_cached) {
+          *m_out << m_listing[LS_Evaluation];
+          return;
+     }
+     if (!Errors::Empty() || m_module)
+          return;
+
+     // The emulator is too big for the stack, and each call needs its own.
+     unique_ptr<emulator> run(new emulator);
+     emulator &prefix = *run;
+     if (!m_image.Load(prefix))
+          return;
+     int steps = prefix.runPrefix(a_maxSteps, a_maxSeconds);
+     if (steps <= 0) {
+          WriteListing(*m_out, LS_Evaluation, "\nPartial evaluation: nothing could be run before the first input\n\n");
+          return;
+     }
+
+     // Every word that is not zero goes into the image, including the ones the run stored.
+     int end = m_image.GetEnd();
+     m_machinecode.clear();
+     for (int loc = 0; loc < emulator::MEMSZ; loc++) {
+          if (prefix.memory()[loc] != 0) {
+               m_machinecode.push_back(pair<int, int>(loc, prefix.memory()[loc]));
+               end = max(end, loc + 1);
+          }
+     }
+     map<string, int> symbols = m_image.GetSymbols();
+     m_image.Build(prefix.origin(), end, m_machinecode, symbols);
+     m_image.SetStartState(prefix.accumulator(), prefix.startSteps());
+     m_sourceLines.clear();
+     m_instructions.clear();
+
+     ostringstream report;
+     report << endl << "Partial evaluation: ran " << steps << " steps; the program now starts at location "
+          << prefix.origin() << " with " << prefix.accumulator() << " in the accumulator" << endl << endl;
+     WriteListing(*m_out, LS_Evaluation, report.str());
+} /* void Assembler::Evaluate(int a_maxSteps, double a_maxSeconds) */
+
+
+/**/
+/*
+Assembler::TranslateChunk(Chunk &a_chunk)
+
+NAME
+
+    Assembler::TranslateChunk - second pass through a chunk of the source code.
 
 SYNOPSIS
 
-    Assembler::PassI();
+    void Assembler::TranslateChunk(Chunk &a_chunk);
+    a_chunk    --> the chunk to be translated.
 
 DESCRIPTION
 
-    This function is the first pass for the Assembler. Pass I establishes the location of the 
-    labels and constructs a symbol table using the SymbolTable class.
+    Translates the lines of the chunk up to and including the end statement, starting at the location
+    established for the chunk in Pass I. The listing, the errors and the machine code are kept with the
+    chunk so PassII can put them together in source order. This is called on a separate thread for each
+    chunk, so it uses its own Instruction object and captures its errors. For a module, the instructions
+    referring to labels and to imported symbols are collected as well.
+
+    With the translation cache, a block whose results are still good takes them from the cache. A block
+    that did not change but moved is translated from the results of its lines kept in the cache, and
+    only lines whose operand moved are translated again. The operands of the block are recorded with
+    their locations, so the next run can tell whether the results are still good.
 
 RETURNS
 
@@ -76,73 +1165,141 @@ DATE
 
 */
 /**/
-void Assembler::PassI()
+void Assembler::TranslateChunk(Chunk &a_chunk)
 {
-     int loc = 0;        // Tracks the location of the instructions to be generated.
+     Instruction inst;           // Instruction object for this thread
+     ostringstream listing;      // Listing of the chunk
+     int loc = a_chunk.m_start;  // Tracks the location of the instructions to be generated.
+     size_t last = min(a_chunk.m_last, m_endLine + 1);
+
+     a_chunk.m_reused = false;
+     a_chunk.m_symbols.clear();
+     if (ReuseChunk(a_chunk))
+          return;
 
-     // Successively process each line of source code.
-     for (; ; ) {
-          // Read the next line from the source file.
-          string buff;
-          if (!m_facc.GetNextLine(buff)) {
+     // A block that moved has only its labels from Pass I. Its lines are not parsed again unless the
+     // results kept for them cannot be read.
+     if (a_chunk.m_cached != NULL) {
+          SplitLines(a_chunk);
+          if (!TranslationCache::DecodeEntries(a_chunk.m_cached->m_entries, a_chunk.m_entries)
+               || a_chunk.m_entries.size() != a_chunk.m_last - a_chunk.m_first) {
+               a_chunk.m_entries.assign(a_chunk.m_last - a_chunk.m_first, TranslationCache::Entry());
+               for (size_t i = a_chunk.m_first; i < a_chunk.m_last; i++)
+                    ParseLine(inst, m_lines[i], a_chunk.m_entries[i - a_chunk.m_first]);
+          }
+     }
 
-               // If there are no more lines, we are missing an end statement.
-               // We will let this error be reported by Pass II.
-               return;
+     a_chunk.m_origin = -1;
+     a_chunk.m_machinecode.clear();
+     a_chunk.m_sourceLines.clear();
+     a_chunk.m_instructions.clear();
+     a_chunk.m_errors.clear();
+     a_chunk.m_relocations.clear();
+     a_chunk.m_imports.clear();
+     vector<string> *previous = Errors::CaptureErrors(&a_chunk.m_errors);
+
+     // Successively process each line of the chunk.
+     for (size_t i = a_chunk.m_first; i < last; i++) {
+          Instruction::Translation translation;
+          string operand;             // The symbol the line refers to, if any.
+
+          // A cached translation is still good if the operand has not moved.
+          TranslationCache::Entry *cached = m_useCache ? &a_chunk.m_entries[i - a_chunk.m_first] : NULL;
+          int operandLoc = 0;
+          if (cached != NULL && cached->m_translated
+               && (cached->m_operand.empty() || (m_symtab.LookupSymbol(cached->m_operand, operandLoc) && operandLoc == cached->m_operandLoc))) {
+               translation.m_status = cached->m_status;
+               translation.m_loc = loc;
+               translation.m_word = cached->m_word;
+               translation.m_unknown = cached->m_unknown;
+               operand = cached->m_operand;
+          }
+          else {
+               size_t errors = a_chunk.m_errors.size();
+               translation = inst.TranslateInstruction(m_lines[i], loc, m_symtab);
+               operand = inst.GetOperand();
+
+               // Record the translation for the next run unless it produced errors.
+               if (m_useCache) {
+                    TranslationCache::Entry &entry = *cached;
+                    entry.m_translated = (a_chunk.m_errors.size() == errors);
+                    entry.m_operand = inst.GetOperand();
+                    entry.m_operandLoc = 0;
+                    m_symtab.LookupSymbol(entry.m_operand, entry.m_operandLoc);
+                    entry.m_status = translation.m_status;
+                    entry.m_word = translation.m_word;
+                    entry.m_unknown = translation.m_unknown;
+               }
           }
-          // Parse the line and get the instruction type.
-          Instruction::InstructionType st = m_inst.ParseInstruction(buff);
+          ListTranslation(listing, translation, m_lines[i]);
 
-          // If this is an end statement, there is nothing left to do in pass I.
-          // Pass II will determine if the end is the last statement.
-          if (st == Instruction::ST_End) return;
+          // Record where the operand was, or that it is not a symbol.
+          int symbolLoc = 0;
+          if (m_useCache && !operand.empty() && a_chunk.m_symbols.find(operand) == a_chunk.m_symbols.end())
+               a_chunk.m_symbols[operand] = m_symtab.LookupSymbol(operand, symbolLoc) ? symbolLoc : TranslationCache::NOT_A_SYMBOL;
 
-          // Labels can only be on machine language and assembler language
-          // instructions.  So, skip other instruction types.
-          if (st != Instruction::ST_MachineLanguage && st != Instruction::ST_AssemblerInstr)
-          {
-               continue;
+          // Only instructions and constants are placed in the emulator's memory
+          if (translation.m_status == Instruction::TS_Instruction || translation.m_status == Instruction::TS_Constant) {
+               a_chunk.m_machinecode.push_back(pair<int, int>(translation.m_loc, translation.m_word));
+               a_chunk.m_sourceLines.push_back(static_cast<int>(i));
+               a_chunk.m_instructions.push_back(translation.m_status == Instruction::TS_Instruction);
+
+               if (a_chunk.m_origin == -1 && translation.m_status == Instruction::TS_Instruction)
+                    a_chunk.m_origin = translation.m_loc;
           }
-          // If the instruction has a label, record it and its location in the
-          // symbol table.
-          if (m_inst.isLabel()) {
 
-               m_symtab.AddSymbol(m_inst.GetLabel(), loc);
+          // The Linker needs to know which operands are locations in the module and which are imported.
+          if (m_module && translation.m_status == Instruction::TS_Instruction && translation.m_unknown == 0
+               && !operand.empty() && m_symtab.LookupSymbol(operand, symbolLoc)) {
+               if (symbolLoc == SymbolTable::importedSymbol)
+                    a_chunk.m_imports.push_back(pair<int, string>(translation.m_loc, operand));
+               else
+                    a_chunk.m_relocations.push_back(translation.m_loc);
           }
+
           // Compute the location of the next instruction.
-          loc = m_inst.LocationNextInstruction(loc);
+          if (m_useCache)
+               loc = cached->m_origin ? cached->m_size : loc + cached->m_size;
+          else
+               loc = inst.LocationNextInstruction(loc);
      }
-} /* void Assembler::PassI() */
+
+     STATS_ADD(CT_LinesPassII, last - a_chunk.m_first);
+     SymbolTable::TakeLookups();
+     Errors::CaptureErrors(previous);
+     a_chunk.m_listing = listing.str();
+} /* void Assembler::TranslateChunk(Chunk &a_chunk) */
 
 
 /**/
 /*
-Assembler::PassII()
+Assembler::ReuseChunk(Chunk &a_chunk)
 
 NAME
 
-    Assembler::PassII - second pass through the source code.
+    Assembler::ReuseChunk - take the results of Pass II for a chunk from the translation cache.
 
 SYNOPSIS
 
-    void Assembler::PassII();
+    bool Assembler::ReuseChunk(Chunk &a_chunk);
+    a_chunk    --> the chunk to be translated.
 
 DESCRIPTION
 
-    Pass II does a second traversal of the source code. It uses the symbol table established in Pass I 
-    and starts translating the source code into code for the VC-3600 computer. Pass II does the most 
-    work in this project as it translates the instructions, it records any errors encountered, and stores 
-    the translated instruction in a vector of pairs for further use. Pass II also prints out the original 
-    statement and the translated code for every line of instruction in the source code with help from the 
-    TranslateInstruction function in the Instruction class. At the end, if errors have been encountered, 
-    the function prints them out.
+    The results kept for a block are still good if its text did not change, it starts at the same
+    location and each of its operands has the same location as it had, or is still not a symbol. The
+    listing, the machine code and what the Linker needs are then copied from the cache, and the lines
+    of the block are not split, parsed or translated. Blocks with errors are never kept, so there are
+    no errors to copy.
 
 RETURNS
 
+    'true' if the results were taken from the cache,
+    'false' if the chunk has to be translated.
 
 AUTHOR
 
-	Abish Jha
+    Abish Jha
 
 DATE
 
@@ -150,59 +1307,278 @@ DATE
 
 */
 /**/
-void Assembler::PassII()
+bool Assembler::ReuseChunk(Chunk &a_chunk)
 {
-     m_facc.rewind(); // Resets the flags for the open file so it can be read again from the top
-     int loc = 0;        // Tracks the location of the instructions to be generated.
-     bool is_end = false; // Flag to indicate if the code has hit the end statement
-     Errors::InitErrorReporting(); 
+     const TranslationCache::Block *block = a_chunk.m_cached;
+     if (block == NULL || block->m_start != a_chunk.m_start)
+          return false;
+     for (map<string, int>::const_iterator it = block->m_symbols.begin(); it != block->m_symbols.end(); ++it) {
+          int symbolLoc = 0;
+          if ((m_symtab.LookupSymbol(it->first, symbolLoc) ? symbolLoc : TranslationCache::NOT_A_SYMBOL) != it->second)
+               return false;
+     }
+     SymbolTable::TakeLookups();
+
+     a_chunk.m_listing = block->m_listing;
+     a_chunk.m_errors.clear();
+     a_chunk.m_machinecode = block->m_machinecode;
+     a_chunk.m_sourceLines.resize(block->m_sourceLines.size());
+     for (size_t i = 0; i < block->m_sourceLines.size(); i++)
+          a_chunk.m_sourceLines[i] = static_cast<int>(a_chunk.m_first) + block->m_sourceLines[i];
+     a_chunk.m_instructions = block->m_instructions;
+     a_chunk.m_origin = block->m_origin;
+     a_chunk.m_relocations = block->m_relocations;
+     a_chunk.m_imports = block->m_imports;
+     a_chunk.m_reused = true;
+     STATS_ADD(CT_CachedBlocks, 1);
+     return true;
+} /* bool Assembler::ReuseChunk(Chunk &a_chunk) */
 
-     // Clearing the vector which will hold the (location, content) pair which will be fed into the emulator
-     m_machinecode.clear();
 
-     // Print the header for the translation table output . The rest is printed by the Instruction class
-     cout << setw(12) << left << "Location" << setw(12) << left << "Contents" << "Original Statement" << endl;
+/**/
+/*
+Assembler::SplitLines(const Chunk &a_chunk)
 
-     // Successively process each line of source code.
-     for (; ; ) {
-          // Read the next line from the source file.
-          string buff;
-          if (!m_facc.GetNextLine(buff)) {
+NAME
 
-               // Returned as was expected with no lines after code
-               if (is_end == true) 
-                    break;
+    Assembler::SplitLines - split the text of a block into its lines.
 
-               // Report error : since there are no more lines, we are missing an end statement
-               string error = "(location " + to_string(loc) + ") Missing end statement";
-               Errors::RecordError(error);
-               break;
-          }
+SYNOPSIS
 
-          if (is_end == true) {
-               string error = "(location " + to_string(loc) + ") Lines after end statement";
-               Errors::RecordError(error);
-               break;
-          }
+    void Assembler::SplitLines(const Chunk &a_chunk);
+    a_chunk    --> the block.
 
-          pair<int, string>  translation = m_inst.TranslateInstruction(buff, loc);
+DESCRIPTION
 
-          // Set the is_end flag to true to indicate the apperance of end statement
-          if (translation == pair<int, string>(0, "end") )
-               is_end = true;
-          // Do not push the pair onto the vector if there is no valid machine code
-          else if (translation != pair<int, string>(0, "n/a"))
-               m_machinecode.push_back(translation);
+    Copies the lines of the block from the text of the source into the lines of the assembler. Only
+    blocks that are parsed or translated need their lines. The lines of different blocks are different
+    elements, so blocks may be split on separate threads.
 
-          // Compute the location of the next instruction.
-          loc = m_inst.LocationNextInstruction(loc);
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Assembler::SplitLines(const Chunk &a_chunk)
+{
+     const char *text = m_source.data() + a_chunk.m_offset;
+     const char *end = text + a_chunk.m_size;
+     for (size_t i = a_chunk.m_first; i < a_chunk.m_last; i++) {
+          const char *newline = static_cast<const char *>(memchr(text, '\n', end - text));
+          if (newline == NULL)
+               newline = end;
+          m_lines[i].assign(text, newline);
+          text = newline == end ? end : newline + 1;
+     }
+     STATS_ADD(CT_LinesRead, a_chunk.m_last - a_chunk.m_first);
+} /* void Assembler::SplitLines(const Chunk &a_chunk) */
+
+
+/**/
+/*
+Assembler::ParseLine(Instruction &a_inst, string &a_line, TranslationCache::Entry &a_entry)
+
+NAME
+
+    Assembler::ParseLine - parse a line for Pass I.
+
+SYNOPSIS
+
+    static void Assembler::ParseLine(Instruction &a_inst, string &a_line, TranslationCache::Entry &a_entry);
+    a_inst     --> the Instruction object of the thread.
+    a_line     --> the line.
+    a_entry    --> what Pass I makes of the line is put in this. It is not translated yet.
+
+DESCRIPTION
+
+    Parses the line and records its type, its size, its label and the symbol it imports or exports.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Assembler::ParseLine(Instruction &a_inst, string &a_line, TranslationCache::Entry &a_entry)
+{
+     a_entry.m_type = a_inst.ParseInstruction(a_line);
+     a_entry.m_origin = a_inst.IsOrigin();
+     a_entry.m_size = a_inst.LocationNextInstruction(0);
+     a_entry.m_label = a_inst.GetLabel();
+     a_entry.m_import = a_inst.IsImport();
+     a_entry.m_export = a_inst.IsExport();
+     a_entry.m_linkSymbol = a_inst.GetLinkSymbol();
+     a_entry.m_translated = false;
+} /* void Assembler::ParseLine(Instruction &a_inst, string &a_line, TranslationCache::Entry &a_entry) */
+
+
+/**/
+/*
+Assembler::ListTranslation(ostream &a_out, const Instruction::Translation &a_trans, const string &a_buff)
+
+NAME
+
+    Assembler::ListTranslation - print a line of the translation listing.
+
+SYNOPSIS
+
+    static void Assembler::ListTranslation(ostream &a_out, const Instruction::Translation &a_trans, const string &a_buff);
+    a_out      --> the stream the listing is written to.
+    a_trans    --> the translation of the line.
+    a_buff     --> the original statement.
+
+DESCRIPTION
+
+    Prints the location, the contents and the original statement of a line of source code. The contents are
+    the six digit machine word, with the digits that could not be translated shown as '?'. Assembler
+    instructions that place nothing in memory show only their location, while comments and the end
+    statement show neither. This is the only place machine words are turned into text.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Assembler::ListTranslation(ostream &a_out, const Instruction::Translation &a_trans, const string &a_buff)
+{
+     if (a_trans.m_status == Instruction::TS_Comment || a_trans.m_status == Instruction::TS_End) {
+          a_out << setw(24) << " " << a_buff << endl;
+          return;
+     }
+     if (a_trans.m_status == Instruction::TS_Directive) {
+          a_out << setw(12) << left << a_trans.m_loc << setw(12) << left << "" << a_buff << endl;
+          return;
+     }
+
+     // Six digits with leading zeros, and a sign for negative constants.
+     char contents[8];
+     char *digits = contents;
+     int value = a_trans.m_word;
+     if (value < 0) {
+          *digits++ = '-';
+          value = -value;
      }
+     for (int i = 5; i >= 0; i--, value /= 10)
+          digits[i] = (i >= 6 - a_trans.m_unknown) ? '?' : char('0' + value % 10);
+     digits[6] = '\0';
+
+     a_out << setw(12) << left << a_trans.m_loc << setw(12) << left << contents << a_buff << endl;
+} /* void Assembler::ListTranslation(ostream &a_out, const Instruction::Translation &a_trans, const string &a_buff) */
+
+
+/**/
+/*
+Assembler::WriteImage(const string &a_fileName)
+
+NAME
+
+    Assembler::WriteImage - save the translation as an object image.
+
+SYNOPSIS
+
+    bool Assembler::WriteImage(const string &a_fileName);
+    a_fileName    --> name of the object image file.
+
+DESCRIPTION
+
+    Write the object image built in Pass II to a file so the program can later be run without being
+    assembled again. Nothing is written if errors were encountered during the translation.
+
+RETURNS
+
+    'true' if the image was written,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Assembler::WriteImage(const string &a_fileName)
+{
      if (!Errors::Empty())
-          Errors::DisplayErrors();
+          return false;
 
-     cout << "Press Enter to continue...";
-     cin.ignore();
-} /* void Assembler::PassII() */
+     if (!m_image.Write(a_fileName)) {
+          Errors::DisplayErrors(*m_out);
+          return false;
+     }
+     return true;
+} /* bool Assembler::WriteImage(const string &a_fileName) */
+
+
+/**/
+/*
+Assembler::WriteDebugInfo(const string &a_fileName)
+
+NAME
+
+    Assembler::WriteDebugInfo - save the debug information.
+
+SYNOPSIS
+
+    bool Assembler::WriteDebugInfo(const string &a_fileName);
+    a_fileName    --> name of the debug information file.
+
+DESCRIPTION
+
+    Save the table from the locations of the image to the source lines and labels built by Pass II,
+    for tools that run or trace the image. Nothing is saved if there were errors.
+
+RETURNS
+
+    'true' if the debug information was saved,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Assembler::WriteDebugInfo(const string &a_fileName)
+{
+     if (!Errors::Empty())
+          return false;
+
+     if (!m_debug.Write(a_fileName)) {
+          Errors::DisplayErrors(*m_out);
+          return false;
+     }
+     return true;
+} /* bool Assembler::WriteDebugInfo(const string &a_fileName) */
 
 
 /**/
@@ -220,7 +1596,7 @@ SYNOPSIS
 DESCRIPTION
 
     Run the emulator on the translated code from Pass II. If errors have been encountered, emulation is halted. 
-    If not, the function loads all the translated instruction into the emulator's memory and then runs the emulator. 
+    If not, the function loads the object image into the emulator's memory and then runs the emulator. 
     This function also  detects errors encountered during emulation and reports them after.
 
 RETURNS
@@ -245,17 +1621,18 @@ void Assembler::RunEmulator()
      }
 
      // Insert the machine code into the emulator class and report errors.
-     for (vector<pair<int, string>>::iterator it = m_machinecode.begin(); it != m_machinecode.end(); ++it) {
-          bool insertion_check = m_emul.insertMemory(it->first, stoi(it->second));
-          if (insertion_check == false) {
-               string error = "Error inserting the command " + to_string(it->first) + " " + it->second + " into the emulator memory";
-               Errors::RecordError(error);
-          }
+     bool loaded = m_image.Load(m_emul);
+     if (!loaded) {
+          string error = "Error inserting the object image into the emulator memory";
+          Errors::RecordError(error);
      }
 
+     // The coverage is tied to the program once it is in memory.
+     if (loaded)
+          m_emul.setCoverage(m_coverage);
+
      // Run program and report error if encountered any.
-     bool run_check = m_emul.runProgram();
-     if (run_check == false) {
+     if (loaded && !m_emul.runProgram()) {
           string error = "Error running the emulator";
           Errors::RecordError(error);
      }
@@ -264,7 +1641,109 @@ void Assembler::RunEmulator()
      if (!Errors::Empty())
           Errors::DisplayErrors();
 
-     cout << "Press Enter to continue...\n";
-     cin.ignore();
+     if (m_interactive) {
+          cout << "Press Enter to continue...\n";
+          cin.ignore();
+     }
 } /* void Assembler::RunEmulator() */
 
+
+
+/**/
+/*
+Assembler::ReportCoverage(const Coverage &a_coverage)
+
+NAME
+
+    Assembler::ReportCoverage - print the coverage of the source.
+
+SYNOPSIS
+
+    void Assembler::ReportCoverage(const Coverage &a_coverage);
+    a_coverage    --> the coverage recorded by runs of the program assembled from the source.
+
+DESCRIPTION
+
+    Translates the source again and prints each line after its location and its coverage: whether the
+    instruction was executed, and for a conditional branch whether it was taken (T) and not taken (N),
+    with '.' for a direction never seen. Instructions never executed are marked with "###" so they stand
+    out. Ends with a count of the instructions and branch directions covered.
+
+    The coverage is only reported if it was recorded for the program the source assembles to. Blocks
+    taken from the translation cache are split into lines first, since Pass II did not need them.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Assembler::ReportCoverage(const Coverage &a_coverage)
+{
+     Instruction inst;
+     vector<string> errors;          // The errors were reported when the program was assembled.
+     vector<string> *previous = Errors::CaptureErrors(&errors);
+     vector<int> memory(emulator::MEMSZ, 0);
+     vector<Instruction::Translation> translations;
+     int origin = -1;
+     int loc = 0;
+
+     for (size_t i = 0; i < m_chunks.size(); i++) {
+          if (m_chunks[i].m_reused)
+               SplitLines(m_chunks[i]);
+     }
+
+     // Translate the lines, rebuilding the memory the program starts with.
+     for (size_t i = 0; i < m_lines.size() && i <= m_endLine; i++) {
+          translations.push_back(inst.TranslateInstruction(m_lines[i], loc, m_symtab));
+          const Instruction::Translation &translation = translations.back();
+          if ((translation.m_status == Instruction::TS_Instruction || translation.m_status == Instruction::TS_Constant)
+               && translation.m_loc >= 0 && translation.m_loc < emulator::MEMSZ) {
+               memory[translation.m_loc] = translation.m_word;
+               if (origin == -1 && translation.m_status == Instruction::TS_Instruction)
+                    origin = translation.m_loc;
+          }
+          loc = inst.LocationNextInstruction(loc);
+     }
+     Errors::CaptureErrors(previous);
+
+     if (a_coverage.GetProgram() != Coverage::HashProgram(memory.data(), origin == -1 ? 0 : origin)) {
+          string error = "The coverage was not recorded for this program";
+          Errors::RecordError(error);
+          Errors::DisplayErrors(*m_out);
+          return;
+     }
+
+     int instructions = 0, executed = 0, branches = 0, directions = 0;
+     *m_out << setw(12) << left << "Location" << setw(12) << left << "Coverage" << "Original Statement" << endl;
+     for (size_t i = 0; i < translations.size(); i++) {
+          const Instruction::Translation &translation = translations[i];
+          if (translation.m_status != Instruction::TS_Instruction || translation.m_loc < 0 || translation.m_loc >= emulator::MEMSZ) {
+               *m_out << setw(24) << " " << m_lines[i] << endl;
+               continue;
+          }
+
+          // The conditional branches are bm, bz and bp.
+          int opcode = translation.m_word / 10000;
+          string marks = a_coverage.IsExecuted(translation.m_loc) ? "yes" : "###";
+          instructions++;
+          executed += a_coverage.IsExecuted(translation.m_loc);
+          if (opcode >= 10 && opcode <= 12) {
+               marks += " ";
+               marks += a_coverage.IsTaken(translation.m_loc) ? 'T' : '.';
+               marks += a_coverage.IsNotTaken(translation.m_loc) ? 'N' : '.';
+               branches++;
+               directions += a_coverage.IsTaken(translation.m_loc) + a_coverage.IsNotTaken(translation.m_loc);
+          }
+          *m_out << setw(12) << left << translation.m_loc << setw(12) << left << marks << m_lines[i] << endl;
+     }
+     *m_out << endl << "Executed " << executed << " of " << instructions << " instructions, "
+          << directions << " of " << 2 * branches << " branch directions" << endl;
+} /* void Assembler::ReportCoverage(const Coverage &a_coverage) */
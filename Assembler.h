@@ -28,12 +28,23 @@ DATE
 #include "Instruction.h"
 #include "FileAccess.h"
 #include "Emulator.h"
+#include "ObjectImage.h"
+#include "TranslationCache.h"
+#include "Coverage.h"
+#include "DebugInfo.h"
+#include "InputLog.h"
+#include "Optimizer.h"
+
+class ImageCache;
 
 
 class Assembler {
 
 public:
-    Assembler( int argc, char *argv[] );
+    Assembler( const string &a_sourceFile );
+
+    // Read the source code into memory. Pass I does it if it has not been done.
+    void ReadSource( );
 
     // Pass I - establish the locations of the symbols
     void PassI( );
@@ -41,20 +52,167 @@ public:
     // Pass II - generate a translation
     void PassII( );
 
+    // Keep the results of each block of lines in a cache file, and reuse them for blocks that did not change.
+    // Must be called before the source is read.
+    void UseCache( const string &a_fileName );
+
+    // Load the image, debug information and listing from a_cache if the source was assembled before with a_options, instead of doing Pass I and Pass II.
+    void UseImageCache( ImageCache *a_cache, const string &a_options );
+
+    // Save the image, debug information and listing in the image cache, unless they came from it or there were errors.
+    void CacheImage( );
+
+    // Assemble the source as a relocatable module that may import and export symbols.
+    void MakeModule( );
+
+    // Write the listing and the errors to a_out instead of the console, without waiting for Enter.
+    void SetOutput( ostream &a_out );
+
+    // Assemble each source file as a module and save it as the object file of the same index.
+    static bool AssembleModules( const vector<string> &a_sourceFiles, const vector<string> &a_objectFiles );
+
     // Display the symbols in the symbol table.
-    void DisplaySymbolTable() { m_symtab.DisplaySymbolTable(); }
+    void DisplaySymbolTable( );
     
+    // To access the object image built by Pass II.
+    const ObjectImage &GetImage( ) const { return m_image; }
+
+    // Save the translation as an object image.
+    bool WriteImage( const string &a_fileName );
+
+    // Optimize the translation of Pass II and print what was changed.
+    void Optimize( );
+
+    // Run the part of the program before its first input at assembly time, making the state it leaves the start of the image.
+    void Evaluate( int a_maxSteps, double a_maxSeconds );
+
+    // To access the table from the locations to the source lines and labels, built by Pass II.
+    const DebugInfo &GetDebugInfo( ) const { return m_debug; }
+
+    // Save the table from the locations to the source lines and labels next to the image.
+    bool WriteDebugInfo( const string &a_fileName );
+
     // Run emulator on the translation.
     void RunEmulator();
 
+    // Record the coverage of the run of the emulator in a_coverage.
+    void SetCoverage( Coverage *a_coverage ) { m_coverage = a_coverage; }
+
+    // Record the values read by the program in a_log, or with a_replay, read them from a_log.
+    void SetInputLog( InputLog *a_log, bool a_replay ) { m_emul.setInputLog( a_log, a_replay ); }
+
+    // Choose whether the user is asked to press Enter between steps.
+    void SetInteractive( bool a_interactive ) { m_interactive = a_interactive; }
+
+    // Print the source with the coverage of each instruction. Pass I must have been done.
+    void ReportCoverage( const Coverage &a_coverage );
+
 private:
 
+    // Sources shorter than this many lines per thread are not split any further.
+    const static size_t MIN_CHUNK_LINES = 4096;
+
+    // The sections of the listing that are kept in the image cache.
+    enum ListingSection {
+        LS_Symbols,         // The symbol table.
+        LS_Translation,     // The translation of Pass II.
+        LS_Optimization,    // What the optimizer changed.
+        LS_Evaluation,      // What partial evaluation did.
+        LS_Sections         // Number of sections.
+    };
+
+    // A label found in Pass I. Its location is relative to the start of the chunk until an org is seen.
+    typedef TranslationCache::Label ChunkLabel;
+
+    // A run of consecutive source lines handled by one thread in Pass I and Pass II. With the translation
+    // cache, each chunk is a block of the cache instead.
+    struct Chunk {
+        size_t m_first;             // Index of the first line of the chunk.
+        size_t m_last;              // Index following the last line of the chunk.
+        size_t m_endLine;           // Index of the end statement, or m_last if the chunk has none.
+
+        // Established by Pass I.
+        int m_start;                // Location of the first line of the chunk.
+        int m_loc;                  // Location following the chunk. Relative to m_start unless m_absolute.
+        bool m_absolute;            // == true if an org statement in the chunk made m_loc absolute.
+        vector<ChunkLabel> m_labels;          // Labels in the order they were found. Imports are included.
+        vector<string> m_exports;             // Symbols exported by the chunk.
+        SymbolTable m_symtab;                 // Symbols of the chunk, merged into the assembler's table.
+
+        // Established by Pass II.
+        string m_listing;                     // Translation listing of the chunk.
+        vector<string> m_errors;              // Errors found in the chunk, in source order.
+        vector<pair<int, int>> m_machinecode; // (location, contents) pairs translated in the chunk.
+        vector<int> m_sourceLines;            // Index of the source line of each word of m_machinecode.
+        vector<bool> m_instructions;          // == true for the words of m_machinecode that are instructions.
+        int m_origin;                         // Location of the first instruction in the chunk, -1 if none.
+        vector<int> m_relocations;            // Locations of the instructions referring to a label of the module.
+        vector<pair<int, string>> m_imports;  // Locations of the instructions referring to an imported symbol.
+
+        // With the translation cache.
+        size_t m_offset;                      // Offset of the block in the source.
+        size_t m_size;                        // Size of the block in bytes.
+        const TranslationCache::Block *m_cached;    // The results of the previous run for the same text, NULL if it is new.
+        bool m_reused;                        // == true if Pass II took its results from m_cached.
+        vector<TranslationCache::Entry> m_entries;  // Results of each line, when they were needed.
+        map<string, int> m_symbols;           // The operands Pass II looked up, and their locations.
+    };
+
+    // Pass I on one chunk - find the labels and the size of the chunk
+    void ScanChunk( Chunk &a_chunk );
+
+    // Pass II on one chunk - translate the chunk
+    void TranslateChunk( Chunk &a_chunk );
+
+    // Take the results of Pass II for a chunk from the translation cache if they are still good.
+    bool ReuseChunk( Chunk &a_chunk );
+
+    // Split the text of a block into its lines.
+    void SplitLines( const Chunk &a_chunk );
+
+    // Parse a line for Pass I.
+    static void ParseLine( Instruction &a_inst, string &a_line, TranslationCache::Entry &a_entry );
+
+    // Print a line of the translation listing.
+    static void ListTranslation( ostream &a_out, const Instruction::Translation &a_trans, const string &a_buff );
+
+    // Print a section of the listing, and keep it for the image cache if it is in use.
+    void WriteListing( ostream &a_out, ListingSection a_section, const string &a_text );
+
+    // Hash of the contents of a source file, used to tell if its module is up to date.
+    static uint64_t HashSource( const string &a_sourceFile );
+
+    string m_sourceFile;      // Name of the source file
     FileAccess m_facc;	      // File Access object
     SymbolTable m_symtab;     // Symbol table object
-    Instruction m_inst;	    // Instruction object
     emulator m_emul;        // Emulator object
 
-    // Vector to store the machine code
-    vector<pair<int, string>> m_machinecode;
+    vector<string> m_lines;   // The lines of the source code. With the translation cache only those of the blocks that are assembled.
+    string m_source;          // The text of the source code, read whole when the translation cache is in use
+    bool m_sourceRead;        // == true once the lines have been read
+    vector<Chunk> m_chunks;   // The chunks the lines are split into
+    size_t m_endLine;         // Index of the end statement, or the number of lines if there is none
+
+    bool m_useCache;                              // == true if the translation cache is in use
+    string m_cacheFile;                           // The file the cache is kept in
+    TranslationCache m_cache;                     // Results of the previous run
+
+    // Vector to store the (location, contents) pairs of the machine code
+    vector<pair<int, int>> m_machinecode;
+    vector<int> m_sourceLines;      // Index of the source line of each word of m_machinecode
+    vector<bool> m_instructions;    // == true for the words of m_machinecode that are instructions
+
+    ObjectImage m_image;    // Object image built from the machine code
+    DebugInfo m_debug;      // Source lines and labels of the locations of the image
+
+    ImageCache *m_imageCache;     // The image cache, NULL if it is not in use
+    string m_imageKey;            // Key of the source in the image cache
+    bool m_cached;                // == true if the image was loaded from the image cache
+    vector<string> m_listing;     // The sections of the listing, kept for the image cache
+
+    bool m_module;          // == true if the source is assembled as a relocatable module
+    ostream *m_out;         // Where the listing and the errors are written
+    bool m_interactive;     // == true if the user is asked to press Enter between steps
+    Coverage *m_coverage;   // Where the coverage of the run is recorded, NULL if it is not
 };
 
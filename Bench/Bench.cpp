@@ -0,0 +1,573 @@
+ /**/
+ /*
+ Bench
+
+ NAME
+
+     Bench - benchmarks of the assembler and the emulator.
+
+ DESCRIPTION
+
+     Bench - measures the speed of the parts of the assembler and the emulator on a fixed
+     corpus of VC-3600 programs kept in Bench/corpus:
+
+         assembler/parse          ParseInstruction, in thousands of lines per second.
+         assembler/translate      TranslateInstruction, in thousands of lines per second.
+         assembler/symtab-add     SymbolTable::AddSymbol, in millions of symbols per second.
+         assembler/symtab-lookup  SymbolTable::LookupSymbol, in millions of lookups per second.
+         assembler/pass/<file>    PassI and PassII together, in thousands of lines per second.
+         assembler/pass/generated-<n>  the same on generated programs of n instructions.
+         emulator/<op>/<engine>   each opcode on its own, in millions of instructions per second.
+         emulator/<file>/<engine> each program of the corpus, in millions of instructions per second.
+         scheduler/channels       many programs fed through channels on one thread, in thousands of values read per second.
+
+     It is built from the sources of the assembler without Assem.cpp, with the top level
+     directory on the include path, and run from the top level directory:
+
+         Bench [-w <warmup>] [-r <reps>] [-f <filter>] [-c <CorpusDir>] [-j <ResultFile>] [-b <BaselineFile>]
+
+     -j saves the results as JSON and -b compares them with the results saved by an earlier run.
+
+ AUTHOR
+
+     Abish Jha
+
+ DATE
+
+     12/05/2017
+
+ */
+ /**/
+
+#include "stdafx.h"
+
+#include "Benchmark.h"
+#include "Assembler.h"
+#include "Errors.h"
+#include "Channel.h"
+#include "ProgramGenerator.h"
+#include "Scheduler.h"
+
+// The programs of the corpus. They halt on their own, except for sample.txt which reads until it
+// runs out of steps.
+static const char *CORPUS[] = { "sample.txt", "countdown.txt", "arith.txt", "sum.txt", "branches.txt", "table.txt" };
+
+// The ways the emulator can run a program. Each is measured on every program. runProgram takes the
+// fast loop for programs that passed verification, and runChecked always takes the general one.
+static const pair<const char *, bool (emulator::*)()> ENGINES[] = {
+     pair<const char *, bool (emulator::*)()>("interpreter", &emulator::runProgram),
+     pair<const char *, bool (emulator::*)()>("checked", &emulator::runChecked)
+};
+
+// Sizes of the generated programs the assembler is measured on, and the file they are written to.
+static const int GENERATED_SIZES[] = { 10000, 100000 };
+static const char *GENERATED_FILE = "bench_generated.tmp";
+
+// Programs fed through channels at once, the values each reads, and the characters of output after which
+// a write waits for it to be taken.
+static const int CHANNEL_PROGRAMS = 1000;
+static const int CHANNEL_VALUES = 20;
+static const int CHANNEL_CAPACITY = 16;
+
+// A stream buffer that throws away everything written to it, so the output of write does not
+// dominate the measurements.
+class NullBuffer : public streambuf {
+protected:
+     int overflow(int a_c) { return a_c; }
+     streamsize xsputn(const char *, streamsize a_n) { return a_n; }
+};
+
+// Lines of every program of the corpus, and the symbol table of each program.
+struct CorpusProgram {
+     string m_fileName;
+     vector<string> m_lines;
+     SymbolTable m_symtab;
+     ObjectImage m_image;
+};
+
+
+/**/
+/*
+LoadCorpus(const string &a_dir, vector<CorpusProgram> &a_programs)
+
+NAME
+
+    LoadCorpus - read and assemble the programs of the corpus.
+
+SYNOPSIS
+
+    static bool LoadCorpus(const string &a_dir, vector<CorpusProgram> &a_programs);
+    a_dir         --> the directory holding the corpus.
+    a_programs    --> the programs read.
+
+DESCRIPTION
+
+    Reads the lines of each program, builds its symbol table and assembles it so the emulator
+    benchmarks can load its image.
+
+RETURNS
+
+    'true' if every program was read and assembled without errors,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+static bool LoadCorpus(const string &a_dir, vector<CorpusProgram> &a_programs)
+{
+     NullBuffer null;
+     ostream listing(&null);
+
+     for (size_t i = 0; i < sizeof(CORPUS) / sizeof(CORPUS[0]); i++) {
+          CorpusProgram program;
+          program.m_fileName = a_dir + "/" + CORPUS[i];
+
+          ifstream file(program.m_fileName.c_str());
+          string line;
+          while (getline(file, line))
+               program.m_lines.push_back(line);
+          if (program.m_lines.empty()) {
+               cerr << program.m_fileName << " could not be read" << endl;
+               return false;
+          }
+
+          Assembler assem(program.m_fileName);
+          assem.SetOutput(listing);
+          assem.PassI();
+          assem.PassII();
+          if (!Errors::Empty()) {
+               cerr << program.m_fileName << " has errors" << endl;
+               return false;
+          }
+          program.m_image = assem.GetImage();
+
+          // The same symbol table the assembler built, for translating lines on their own.
+          Instruction inst;
+          int loc = 0;
+          for (size_t j = 0; j < program.m_lines.size(); j++) {
+               if (inst.ParseInstruction(program.m_lines[j]) == Instruction::ST_End)
+                    break;
+               if (inst.isLabel())
+                    program.m_symtab.AddSymbol(inst.GetLabel(), loc);
+               loc = inst.LocationNextInstruction(loc);
+          }
+          a_programs.push_back(program);
+     }
+     return true;
+} /* static bool LoadCorpus(const string &a_dir, vector<CorpusProgram> &a_programs) */
+
+
+/**/
+/*
+BenchAssembler(Benchmark &a_bench, const vector<CorpusProgram> &a_programs)
+
+NAME
+
+    BenchAssembler - benchmarks of the assembler.
+
+SYNOPSIS
+
+    static void BenchAssembler(Benchmark &a_bench, const vector<CorpusProgram> &a_programs);
+    a_bench       --> the benchmark harness.
+    a_programs    --> the programs of the corpus.
+
+DESCRIPTION
+
+    Measures parsing and translating the lines of the corpus, adding and looking up symbols, and
+    assembling each program of the corpus and some generated programs with PassI and PassII.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+static void BenchAssembler(Benchmark &a_bench, const vector<CorpusProgram> &a_programs)
+{
+     a_bench.Run("assembler/parse", "klines/s", 1e3, [&](double &a_seconds) {
+          Instruction inst;
+          double lines = 0;
+          double start = Benchmark::Now();
+          for (size_t i = 0; i < a_programs.size(); i++) {
+               for (size_t j = 0; j < a_programs[i].m_lines.size(); j++) {
+                    string line = a_programs[i].m_lines[j];
+                    inst.ParseInstruction(line);
+               }
+               lines += a_programs[i].m_lines.size();
+          }
+          a_seconds += Benchmark::Now() - start;
+          return lines;
+     });
+
+     a_bench.Run("assembler/translate", "klines/s", 1e3, [&](double &a_seconds) {
+          Instruction inst;
+          double lines = 0;
+          double start = Benchmark::Now();
+          for (size_t i = 0; i < a_programs.size(); i++) {
+               int loc = 0;
+               for (size_t j = 0; j < a_programs[i].m_lines.size(); j++) {
+                    string line = a_programs[i].m_lines[j];
+                    inst.TranslateInstruction(line, loc, a_programs[i].m_symtab);
+                    loc = inst.LocationNextInstruction(loc);
+               }
+               lines += a_programs[i].m_lines.size();
+          }
+          a_seconds += Benchmark::Now() - start;
+          return lines;
+     });
+
+     // Symbols named like the labels of generated programs.
+     vector<string> symbols;
+     for (int i = 0; i < 10000; i++)
+          symbols.push_back("L" + to_string(i * 7919 % 10000));
+
+     a_bench.Run("assembler/symtab-add", "Msym/s", 1e6, [&](double &a_seconds) {
+          SymbolTable symtab;
+          double start = Benchmark::Now();
+          for (size_t i = 0; i < symbols.size(); i++)
+               symtab.AddSymbol(symbols[i], (int)i);
+          a_seconds += Benchmark::Now() - start;
+          return (double)symbols.size();
+     });
+
+     SymbolTable full;
+     for (size_t i = 0; i < symbols.size(); i++)
+          full.AddSymbol(symbols[i], (int)i);
+     a_bench.Run("assembler/symtab-lookup", "Mlook/s", 1e6, [&](double &a_seconds) {
+          int loc = 0;
+          double start = Benchmark::Now();
+          for (size_t i = 0; i < symbols.size(); i++)
+               full.LookupSymbol(symbols[symbols.size() - 1 - i], loc);
+          a_seconds += Benchmark::Now() - start;
+          return (double)symbols.size();
+     });
+
+     NullBuffer null;
+     ostream listing(&null);
+     for (size_t i = 0; i < a_programs.size(); i++) {
+          const CorpusProgram &program = a_programs[i];
+          string name = program.m_fileName.substr(program.m_fileName.find_last_of("/\\") + 1);
+          a_bench.Run("assembler/pass/" + name, "klines/s", 1e3, [&](double &a_seconds) {
+               double start = Benchmark::Now();
+               Assembler assem(program.m_fileName);
+               assem.SetOutput(listing);
+               assem.PassI();
+               assem.PassII();
+               a_seconds += Benchmark::Now() - start;
+               return (double)program.m_lines.size();
+          });
+     }
+
+     // Generated programs show how the assembler scales. The seed is fixed so every run measures the same program.
+     for (size_t i = 0; i < sizeof(GENERATED_SIZES) / sizeof(GENERATED_SIZES[0]); i++) {
+          ProgramGenerator::Shape shape = ProgramGenerator::DefaultShape();
+          shape.m_lines = GENERATED_SIZES[i];
+          shape.m_labels = GENERATED_SIZES[i] / 10;
+          ostringstream source;
+          ProgramGenerator(1).Generate(shape, source);
+          string text = source.str();
+          ofstream file(GENERATED_FILE, ios::out | ios::trunc);
+          file << text;
+          file.close();
+          double lines = (double)count(text.begin(), text.end(), '\n') + 1;
+
+          a_bench.Run("assembler/pass/generated-" + to_string(GENERATED_SIZES[i]), "klines/s", 1e3, [&](double &a_seconds) {
+               double start = Benchmark::Now();
+               Assembler assem(GENERATED_FILE);
+               assem.SetOutput(listing);
+               assem.PassI();
+               assem.PassII();
+               a_seconds += Benchmark::Now() - start;
+               return lines;
+          });
+          remove(GENERATED_FILE);
+     }
+} /* static void BenchAssembler(Benchmark &a_bench, const vector<CorpusProgram> &a_programs) */
+
+
+/**/
+/*
+RunEmulator(Benchmark &a_bench, const string &a_name, const emulator &a_loaded)
+
+NAME
+
+    RunEmulator - measure every engine on a loaded program.
+
+SYNOPSIS
+
+    static void RunEmulator(Benchmark &a_bench, const string &a_name, const emulator &a_loaded);
+    a_bench     --> the benchmark harness.
+    a_name      --> the name of the program, used in the names of the benchmarks.
+    a_loaded    --> an emulator with the program in its memory.
+
+DESCRIPTION
+
+    Each run starts from the snapshot of a_loaded, copied once and reset before every run, so it
+    executes the same instructions. Only the run itself
+    is timed. Every engine is measured, and the interpreter once more with coverage recorded. The output of the program is thrown away and read is given an endless supply of numbers.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+static void RunEmulator(Benchmark &a_bench, const string &a_name, const emulator &a_loaded)
+{
+     static emulator work;
+     NullBuffer null;
+     string numbers;
+     for (int i = 0; i < emulator::MEMSZ; i++)
+          numbers += "7\n";
+
+     for (size_t e = 0; e < sizeof(ENGINES) / sizeof(ENGINES[0]); e++) {
+          bool (emulator::*engine)() = ENGINES[e].second;
+          work = a_loaded;
+          a_bench.Run("emulator/" + a_name + "/" + ENGINES[e].first, "MIPS", 1e6, [&](double &a_seconds) {
+               work.reset();
+               istringstream input(numbers);
+               streambuf *out = cout.rdbuf(&null);
+               streambuf *in = cin.rdbuf(input.rdbuf());
+
+               double start = Benchmark::Now();
+               (work.*engine)();
+               a_seconds += Benchmark::Now() - start;
+
+               cout.rdbuf(out);
+               cin.rdbuf(in);
+               return (double)work.stepCount();
+          });
+     }
+
+     // The interpreter again with coverage recorded, which is meant to be cheap enough to leave on.
+     // As in a batch of runs, the coverage is tied to the program once and each run records into it.
+     static Coverage coverage;
+     static emulator covered;
+     covered = a_loaded;
+     covered.setCoverage(&coverage);
+     work = covered;
+     a_bench.Run("emulator/" + a_name + "/interpreter+coverage", "MIPS", 1e6, [&](double &a_seconds) {
+          work.reset();
+          istringstream input(numbers);
+          streambuf *out = cout.rdbuf(&null);
+          streambuf *in = cin.rdbuf(input.rdbuf());
+
+          double start = Benchmark::Now();
+          work.runProgram();
+          a_seconds += Benchmark::Now() - start;
+
+          cout.rdbuf(out);
+          cin.rdbuf(in);
+          return (double)work.stepCount();
+     });
+} /* static void RunEmulator(Benchmark &a_bench, const string &a_name, const emulator &a_loaded) */
+
+
+/**/
+/*
+BenchEmulator(Benchmark &a_bench, const vector<CorpusProgram> &a_programs)
+
+NAME
+
+    BenchEmulator - benchmarks of the emulator.
+
+SYNOPSIS
+
+    static void BenchEmulator(Benchmark &a_bench, const vector<CorpusProgram> &a_programs);
+    a_bench       --> the benchmark harness.
+    a_programs    --> the programs of the corpus.
+
+DESCRIPTION
+
+    Measures each opcode on its own with a program made of 9000 copies of the instruction followed by
+    a halt, then each program of the corpus. The operands are chosen so nothing overflows: the word at
+    9999 holds 1, and the branches go to the next instruction whether they are taken or not.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+static void BenchEmulator(Benchmark &a_bench, const vector<CorpusProgram> &a_programs)
+{
+     static const char *names[] = { "add", "sub", "mult", "div", "load", "store", "read", "write", "b", "bm", "bz", "bp" };
+     const int count = 9000;
+     const int data = emulator::MEMSZ - 1;
+
+     for (int op = 1; op <= 12; op++) {
+          static emulator loaded;
+          loaded = emulator();
+          vector<int> words;
+          for (int i = 0; i < count; i++)
+               words.push_back(op * 10000 + (op >= 9 ? i + 1 : data));
+          words.push_back(130000);
+          loaded.insertBlock(0, &words[0], (int)words.size());
+          loaded.insertMemory(data, 1);
+          loaded.setOrigin(0);
+          loaded.verify();
+          loaded.snapshot();
+          RunEmulator(a_bench, names[op - 1], loaded);
+     }
+
+     for (size_t i = 0; i < a_programs.size(); i++) {
+          static emulator loaded;
+          loaded = emulator();
+          a_programs[i].m_image.Load(loaded);
+          string name = a_programs[i].m_fileName.substr(a_programs[i].m_fileName.find_last_of("/\\") + 1);
+          RunEmulator(a_bench, name, loaded);
+     }
+} /* static void BenchEmulator(Benchmark &a_bench, const vector<CorpusProgram> &a_programs) */
+
+
+/**/
+/*
+BenchChannels(Benchmark &a_bench, const vector<CorpusProgram> &a_programs)
+
+NAME
+
+    BenchChannels - benchmark of programs fed through channels.
+
+SYNOPSIS
+
+    static void BenchChannels(Benchmark &a_bench, const vector<CorpusProgram> &a_programs);
+    a_bench       --> the benchmark harness.
+    a_programs    --> the programs of the corpus.
+
+DESCRIPTION
+
+    Runs CHANNEL_PROGRAMS copies of sample.txt, which writes back each value it reads until one is
+    not positive, on a scheduler with one thread. Each is fed through a channel of its own, one value
+    at a time, and its output is taken only when it fills the channel, so every program blocks many
+    times on input and on output. After each Run the blocked programs are fed, and Run is called again
+    until every program has read CHANNEL_VALUES values and halted. Only the runs and the feeding are
+    timed.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+static void BenchChannels(Benchmark &a_bench, const vector<CorpusProgram> &a_programs)
+{
+     const CorpusProgram *sample = NULL;
+     for (size_t i = 0; i < a_programs.size(); i++) {
+          if (a_programs[i].m_fileName.find("sample.txt") != string::npos)
+               sample = &a_programs[i];
+     }
+     if (sample == NULL)
+          return;
+
+     a_bench.Run("scheduler/channels", "kreads/s", 1e3, [&](double &a_seconds) {
+          vector<unique_ptr<emulator>> emulators(CHANNEL_PROGRAMS);
+          vector<unique_ptr<Channel>> channels(CHANNEL_PROGRAMS);
+          vector<int> fed(CHANNEL_PROGRAMS, 0);
+          Scheduler scheduler(1);
+          for (int i = 0; i < CHANNEL_PROGRAMS; i++) {
+               emulators[i].reset(new emulator);
+               sample->m_image.Load(*emulators[i]);
+               channels[i].reset(new Channel(CHANNEL_CAPACITY));
+               emulators[i]->setChannel(channels[i].get());
+               scheduler.Submit(*emulators[i]);
+          }
+
+          double start = Benchmark::Now();
+          for (bool blocked = true; blocked; ) {
+               scheduler.Run();
+               blocked = false;
+               for (int i = 0; i < CHANNEL_PROGRAMS; i++) {
+                    if (scheduler.GetJob(i).m_outcome != Scheduler::JO_Blocked)
+                         continue;
+                    blocked = true;
+                    if (emulators[i]->waitingFor() == emulator::W_Input)
+                         channels[i]->Push(++fed[i] < CHANNEL_VALUES ? "7" : "0");
+                    else
+                         channels[i]->TakeOutput();
+               }
+          }
+          a_seconds += Benchmark::Now() - start;
+          return (double)CHANNEL_PROGRAMS * CHANNEL_VALUES;
+     });
+} /* static void BenchChannels(Benchmark &a_bench, const vector<CorpusProgram> &a_programs) */
+
+
+int main( int argc, char *argv[] )
+{
+    int warmup = 3;
+    int reps = 10;
+    string filter, corpus = "Bench/corpus", resultFile, baselineFile;
+
+    for( int i = 1; i < argc; i++ ) {
+        string arg = argv[i];
+        if( i + 1 >= argc || arg.size() != 2 || arg[0] != '-' ) {
+            cerr << "Usage: Bench [-w <warmup>] [-r <reps>] [-f <filter>] [-c <CorpusDir>] [-j <ResultFile>] [-b <BaselineFile>]" << endl;
+            return 1;
+        }
+        string value = argv[++i];
+        switch( arg[1] ) {
+        case 'w': warmup = atoi( value.c_str() ); break;
+        case 'r': reps = max( 1, atoi( value.c_str() ) ); break;
+        case 'f': filter = value; break;
+        case 'c': corpus = value; break;
+        case 'j': resultFile = value; break;
+        case 'b': baselineFile = value; break;
+        }
+    }
+
+    Errors::InitErrorReporting();
+    vector<CorpusProgram> programs;
+    if( !LoadCorpus( corpus, programs ) ) {
+        return 1;
+    }
+
+    Benchmark bench( warmup, reps );
+    bench.SetFilter( filter );
+    BenchAssembler( bench, programs );
+    BenchEmulator( bench, programs );
+    BenchChannels( bench, programs );
+
+    if( !resultFile.empty() && !bench.WriteJson( resultFile ) ) {
+        cerr << "Could not write " << resultFile << endl;
+        return 1;
+    }
+    if( !baselineFile.empty() && !bench.CompareBaseline( baselineFile ) ) {
+        return 1;
+    }
+    return 0;
+}
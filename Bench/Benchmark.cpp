@@ -0,0 +1,293 @@
+//
+//      Implementation of the Benchmark class.
+//
+#include "stdafx.h"
+#include "Benchmark.h"
+
+const double Benchmark::MIN_REP_SECONDS = 0.05;
+
+
+/**/
+/*
+Benchmark::Run(const string &a_name, const string &a_unit, double a_scale, const Body &a_body)
+
+NAME
+
+    Benchmark::Run - measure a function.
+
+SYNOPSIS
+
+    void Benchmark::Run(const string &a_name, const string &a_unit, double a_scale, const Body &a_body);
+    a_name     --> name of the benchmark.
+    a_unit     --> unit the rates are reported in.
+    a_scale    --> the units of work per second are divided by this, e.g. 1e6 for millions.
+    a_body     --> the function to be measured.
+
+DESCRIPTION
+
+    Runs the function for the warmup rounds without measuring it, then for each repetition calls it
+    until at least MIN_REP_SECONDS were measured and records the rate of that repetition. The summary
+    of the rates is printed and kept with the results. Benchmarks that do not match the filter are skipped.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Benchmark::Run(const string &a_name, const string &a_unit, double a_scale, const Body &a_body)
+{
+     if (a_name.find(m_filter) == string::npos)
+          return;
+
+     double seconds = 0;
+     for (int i = 0; i < m_warmup; i++)
+          a_body(seconds);
+
+     vector<double> rates;
+     for (int i = 0; i < m_reps; i++) {
+          double units = 0;
+          seconds = 0;
+          while (seconds < MIN_REP_SECONDS)
+               units += a_body(seconds);
+          rates.push_back(units / seconds / a_scale);
+     }
+
+     Result result = { a_name, a_unit, m_reps, 0, 0, 0, 0 };
+     for (size_t i = 0; i < rates.size(); i++)
+          result.m_mean += rates[i] / rates.size();
+     for (size_t i = 0; i < rates.size() && rates.size() > 1; i++)
+          result.m_stddev += (rates[i] - result.m_mean) * (rates[i] - result.m_mean) / (rates.size() - 1);
+     result.m_stddev = sqrt(result.m_stddev);
+
+     double half = rates.size() > 1 ? TValue(m_reps - 1) * result.m_stddev / sqrt((double)rates.size()) : 0;
+     result.m_ciLow = result.m_mean - half;
+     result.m_ciHigh = result.m_mean + half;
+     m_results.push_back(result);
+
+     cout << setw(44) << left << a_name << setw(14) << right << fixed << setprecision(3) << result.m_mean
+          << " " << setw(8) << left << a_unit << " +/- " << setprecision(3) << half
+          << " (sd " << result.m_stddev << ", n=" << m_reps << ")" << endl;
+} /* void Benchmark::Run(const string &a_name, const string &a_unit, double a_scale, const Body &a_body) */
+
+
+/**/
+/*
+Benchmark::Now()
+
+NAME
+
+    Benchmark::Now - the current time.
+
+SYNOPSIS
+
+    static double Benchmark::Now();
+
+DESCRIPTION
+
+    Reads a steady clock, so the difference of two readings is the time that passed between them.
+
+RETURNS
+
+    The current time in seconds.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+double Benchmark::Now()
+{
+     return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+} /* double Benchmark::Now() */
+
+
+/**/
+/*
+Benchmark::WriteJson(const string &a_fileName)
+
+NAME
+
+    Benchmark::WriteJson - save the results as JSON.
+
+SYNOPSIS
+
+    bool Benchmark::WriteJson(const string &a_fileName) const;
+    a_fileName    --> name of the file the results are written to.
+
+DESCRIPTION
+
+    Writes the results as a JSON object holding an array of benchmarks. Each benchmark is written on a
+    line of its own, which is what CompareBaseline relies on when it reads the file back.
+
+RETURNS
+
+    'true' if the file was written,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Benchmark::WriteJson(const string &a_fileName) const
+{
+     ofstream file(a_fileName.c_str(), ios::out | ios::trunc);
+     file << "{\n  \"benchmarks\": [\n" << setprecision(9);
+     for (size_t i = 0; i < m_results.size(); i++) {
+          const Result &result = m_results[i];
+          file << "    {\"name\": \"" << result.m_name << "\", \"unit\": \"" << result.m_unit << "\", \"reps\": " << result.m_reps
+               << ", \"mean\": " << result.m_mean << ", \"stddev\": " << result.m_stddev
+               << ", \"ci95_low\": " << result.m_ciLow << ", \"ci95_high\": " << result.m_ciHigh << "}"
+               << (i + 1 < m_results.size() ? ",\n" : "\n");
+     }
+     file << "  ]\n}\n";
+     file.close();
+     return !file.fail();
+} /* bool Benchmark::WriteJson(const string &a_fileName) const */
+
+
+/**/
+/*
+Benchmark::CompareBaseline(const string &a_fileName)
+
+NAME
+
+    Benchmark::CompareBaseline - compare the results with an earlier run.
+
+SYNOPSIS
+
+    bool Benchmark::CompareBaseline(const string &a_fileName) const;
+    a_fileName    --> name of a file written by WriteJson.
+
+DESCRIPTION
+
+    Prints the change of the mean rate of every benchmark that is also in the baseline. A change is
+    only called faster or slower when the 95% confidence intervals of the two runs do not overlap;
+    otherwise it is within the noise of the measurements.
+
+RETURNS
+
+    'true' if the baseline was read,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Benchmark::CompareBaseline(const string &a_fileName) const
+{
+     ifstream file(a_fileName.c_str());
+     if (!file) {
+          cerr << "Baseline " << a_fileName << " could not be opened" << endl;
+          return false;
+     }
+
+     // Each benchmark is on a line of its own, so the fields can be picked out of the line.
+     map<string, Result> baseline;
+     string line;
+     while (getline(file, line)) {
+          size_t name = line.find("\"name\": \"");
+          if (name == string::npos)
+               continue;
+          Result result = {};
+          name += 9;
+          result.m_name = line.substr(name, line.find('"', name) - name);
+
+          const char *fields[] = { "\"mean\": ", "\"ci95_low\": ", "\"ci95_high\": " };
+          double *values[] = { &result.m_mean, &result.m_ciLow, &result.m_ciHigh };
+          for (int i = 0; i < 3; i++) {
+               size_t pos = line.find(fields[i]);
+               if (pos != string::npos)
+                    *values[i] = atof(line.c_str() + pos + strlen(fields[i]));
+          }
+          baseline[result.m_name] = result;
+     }
+
+     cout << endl << "Compared with " << a_fileName << ":" << endl;
+     for (size_t i = 0; i < m_results.size(); i++) {
+          map<string, Result>::const_iterator it = baseline.find(m_results[i].m_name);
+          if (it == baseline.end() || it->second.m_mean == 0)
+               continue;
+
+          double change = (m_results[i].m_mean / it->second.m_mean - 1) * 100;
+          const char *verdict = "within noise";
+          if (m_results[i].m_ciLow > it->second.m_ciHigh)
+               verdict = "faster";
+          else if (m_results[i].m_ciHigh < it->second.m_ciLow)
+               verdict = "slower";
+          cout << setw(44) << left << m_results[i].m_name << setw(9) << right << showpos << fixed << setprecision(1)
+               << change << noshowpos << "%  " << verdict << endl;
+     }
+     return true;
+} /* bool Benchmark::CompareBaseline(const string &a_fileName) const */
+
+
+/**/
+/*
+Benchmark::TValue(int a_df)
+
+NAME
+
+    Benchmark::TValue - critical value of Student's t distribution.
+
+SYNOPSIS
+
+    static double Benchmark::TValue(int a_df);
+    a_df    --> degrees of freedom, one less than the number of repetitions.
+
+DESCRIPTION
+
+    Looks up the critical value for a two sided 95% confidence interval. Beyond 30 degrees of freedom
+    the normal distribution is close enough.
+
+RETURNS
+
+    The critical value.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+double Benchmark::TValue(int a_df)
+{
+     static const double table[] = {
+          12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+          2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+          2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+     };
+     if (a_df < 1)
+          return 0;
+     if (a_df <= 30)
+          return table[a_df - 1];
+     return 1.960;
+} /* double Benchmark::TValue(int a_df) */
@@ -0,0 +1,89 @@
+#pragma once
+
+/**/
+/*
+Benchmark Class
+
+NAME
+
+     Benchmark - measure and report the speed of parts of the assembler and emulator.
+
+DESCRIPTION
+
+     Benchmark class - runs a measured function through a number of warmup rounds and then
+     a number of repetitions, each lasting at least MIN_REP_SECONDS. Every repetition gives
+     a rate in units of work per second; the mean, standard deviation and 95% confidence
+     interval of the rates are reported. The results can be saved as JSON and compared with
+     the results of an earlier run, which is how performance changes are judged.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+
+class Benchmark {
+
+public:
+
+    // A repetition runs the measured function until at least this much time was measured.
+    const static double MIN_REP_SECONDS;
+
+    // The summary of the repetitions of one benchmark.
+    struct Result {
+        string m_name;          // Name of the benchmark, such as "emulator/add/interpreter".
+        string m_unit;          // Unit of the rates, such as "lines/s" or "MIPS".
+        int m_reps;             // Number of repetitions measured.
+        double m_mean;          // Mean rate.
+        double m_stddev;        // Standard deviation of the rates.
+        double m_ciLow;         // Lower end of the 95% confidence interval of the mean.
+        double m_ciHigh;        // Upper end of the 95% confidence interval of the mean.
+    };
+
+    // The measured function. It adds the seconds spent on the work to a_seconds, leaving out any
+    // setup, and returns the number of units of work done.
+    typedef function<double(double &a_seconds)> Body;
+
+    Benchmark( int a_warmup, int a_reps ) : m_warmup( a_warmup ), m_reps( a_reps ) { };
+    ~Benchmark( ) { };
+
+    // Only run the benchmarks whose names contain a_filter.
+    void SetFilter( const string &a_filter ) {
+
+        m_filter = a_filter;
+    };
+
+    // Measure a function. The rates are the units of work per second divided by a_scale.
+    void Run( const string &a_name, const string &a_unit, double a_scale, const Body &a_body );
+
+    // The current time in seconds, for timing the work done by a Body.
+    static double Now( );
+
+    // Save the results as JSON.
+    bool WriteJson( const string &a_fileName ) const;
+
+    // Compare the results with a file written by WriteJson and print the differences.
+    bool CompareBaseline( const string &a_fileName ) const;
+
+    // To access the results.
+    inline const vector<Result> &GetResults( ) const {
+
+        return m_results;
+    };
+
+private:
+
+    // Student's t value for a two sided 95% interval with a_df degrees of freedom.
+    static double TValue( int a_df );
+
+    int m_warmup;               // Number of rounds run before measuring.
+    int m_reps;                 // Number of repetitions measured.
+    string m_filter;            // Only benchmarks whose names contain this are run.
+    vector<Result> m_results;   // The results in the order the benchmarks were run.
+};
@@ -0,0 +1,126 @@
+//
+//      Implementation of the Channel class.
+//
+#include "stdafx.h"
+#include "Channel.h"
+
+
+/**/
+/*
+Channel::Push(const string &a_text)
+
+NAME
+
+    Channel::Push - give the program values to read.
+
+SYNOPSIS
+
+    void Channel::Push(const string &a_text);
+    a_text    --> the values, separated by white space.
+
+DESCRIPTION
+
+    Splits the text at white space, as reading the console does, and queues each piece as a value
+    for read. A piece that is not a number is queued too, since read reports it to the program.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Channel::Push(const string &a_text)
+{
+     istringstream values(a_text);
+     string value;
+     while (values >> value)
+          m_input.push_back(value);
+} /* void Channel::Push(const string &a_text) */
+
+
+/**/
+/*
+Channel::Next(string &a_value)
+
+NAME
+
+    Channel::Next - take the next value.
+
+SYNOPSIS
+
+    bool Channel::Next(string &a_value);
+    a_value    --> set to the value.
+
+DESCRIPTION
+
+    Takes the oldest value that has not been read.
+
+RETURNS
+
+    'true' if there was a value,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Channel::Next(string &a_value)
+{
+     if (m_input.empty())
+          return false;
+     a_value = m_input.front();
+     m_input.pop_front();
+     return true;
+} /* bool Channel::Next(string &a_value) */
+
+
+/**/
+/*
+Channel::TakeOutput()
+
+NAME
+
+    Channel::TakeOutput - take the output written so far.
+
+SYNOPSIS
+
+    string Channel::TakeOutput();
+
+DESCRIPTION
+
+    Returns the output and empties it, so a program waiting for the output to be taken can go on.
+
+RETURNS
+
+    The output written since it was last taken.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+string Channel::TakeOutput()
+{
+     string output = m_output.str();
+     m_output.str("");
+     m_output.clear();
+     return output;
+} /* string Channel::TakeOutput() */
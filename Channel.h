@@ -0,0 +1,82 @@
+#pragma once
+
+/**/
+/*
+Channel Class
+
+NAME
+
+     Channel - the input and output of a program run without a console.
+
+DESCRIPTION
+
+     Channel class - holds the values given to a program that have not been read yet and the
+     output it wrote that has not been taken yet. An emulator whose program is fed through a
+     channel does not block: when read finds no value waiting, or write finds the output full,
+     runSlice returns and says what the program is waiting for, and the next call resumes it at
+     the same instruction. One thread can then drive any number of programs, giving each values
+     and taking its output as they become available, from queues, sockets or anything else.
+
+     The capacity is the number of characters of output after which a write waits for it to be
+     taken. The prompts and messages the emulator writes along with a read or an overflow do not
+     wait, so the output can go over it by a little.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+
+class Channel {
+
+public:
+
+    const static int DEFAULT_CAPACITY = 4096;   // Characters of output a write waits for unless asked otherwise.
+
+    Channel( int a_capacity = DEFAULT_CAPACITY ) : m_closed( false ), m_capacity( a_capacity ) { };
+    ~Channel( ) { };
+
+    // Give the program values to read, separated by white space as they would be typed.
+    void Push( const string &a_text );
+
+    // No more values will be given. A read with none left is then an error, as at the end of the console input.
+    inline void Close( ) {
+
+        m_closed = true;
+    };
+
+    // Take the output written so far.
+    string TakeOutput( );
+
+    // Used by the emulator: check for a value, take the next one, check if the output is full and write it.
+    inline bool HasInput( ) const {
+
+        return !m_input.empty();
+    };
+    inline bool Closed( ) const {
+
+        return m_closed;
+    };
+    bool Next( string &a_value );
+    inline bool Full( ) {
+
+        return m_output.tellp() >= m_capacity;
+    };
+    inline ostream &Output( ) {
+
+        return m_output;
+    };
+
+private:
+
+    deque<string> m_input;          // Values given and not read yet.
+    bool m_closed;                  // == true once no more values will be given.
+    int m_capacity;                 // Characters of output after which a write waits.
+    ostringstream m_output;         // Output written and not taken yet.
+};
@@ -0,0 +1,458 @@
+//
+//      Implementation of the Coverage class.
+//
+#include "stdafx.h"
+#include "Coverage.h"
+#include "DiskCache.h"
+#include "Errors.h"
+#include "Hash.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+// The number of bits set in a word.
+static int CountBits(uint64_t a_word)
+{
+     int count = 0;
+     for (; a_word != 0; a_word &= a_word - 1)
+          count++;
+     return count;
+}
+
+
+/**/
+/*
+Coverage::Clear()
+
+NAME
+
+    Coverage::Clear - forget all the coverage.
+
+SYNOPSIS
+
+    void Coverage::Clear();
+
+DESCRIPTION
+
+    Clears every bit and the program the coverage belongs to.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Coverage::Clear()
+{
+     m_program = 0;
+     memset(m_executed, 0, sizeof(m_executed));
+     memset(m_taken, 0, sizeof(m_taken));
+     memset(m_notTaken, 0, sizeof(m_notTaken));
+} /* void Coverage::Clear() */
+
+
+/**/
+/*
+Coverage::HashProgram(const int *a_memory, int a_origin)
+
+NAME
+
+    Coverage::HashProgram - compute the hash of a program.
+
+SYNOPSIS
+
+    static uint64_t Coverage::HashProgram(const int *a_memory, int a_origin);
+    a_memory    --> the memory of the emulator before the program runs.
+    a_origin    --> the location the program starts at.
+
+DESCRIPTION
+
+    Hashes the origin and the whole memory. The result is never 0, which stands for no program.
+
+RETURNS
+
+    The hash of the program.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+uint64_t Coverage::HashProgram(const int *a_memory, int a_origin)
+{
+     uint64_t hash = Hash::Fnv1a64(&a_origin, sizeof(a_origin));
+     hash = Hash::Fnv1a64(a_memory, emulator::MEMSZ * sizeof(int), hash);
+     return hash == 0 ? 1 : hash;
+} /* uint64_t Coverage::HashProgram(const int *a_memory, int a_origin) */
+
+
+/**/
+/*
+Coverage::SetProgram(const int *a_memory, int a_origin)
+
+NAME
+
+    Coverage::SetProgram - tie the coverage to a program.
+
+SYNOPSIS
+
+    void Coverage::SetProgram(const int *a_memory, int a_origin);
+    a_memory    --> the memory of the emulator before the program runs.
+    a_origin    --> the location the program starts at.
+
+DESCRIPTION
+
+    Records the hash of the program the coverage belongs to. If the coverage belonged to another program
+    it is cleared first.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Coverage::SetProgram(const int *a_memory, int a_origin)
+{
+     uint64_t hash = HashProgram(a_memory, a_origin);
+     if (hash != m_program) {
+          Clear();
+          m_program = hash;
+     }
+} /* void Coverage::SetProgram(const int *a_memory, int a_origin) */
+
+
+/**/
+/*
+Coverage::Merge(const Coverage &a_other)
+
+NAME
+
+    Coverage::Merge - add the coverage of another run.
+
+SYNOPSIS
+
+    int Coverage::Merge(const Coverage &a_other);
+    a_other    --> the coverage of another run of the same program.
+
+DESCRIPTION
+
+    Sets every bit that is set in a_other. Empty coverage takes on the program of a_other; coverage of
+    a different program is reported as an error and not merged.
+
+RETURNS
+
+    The number of bits that were not set before, or -1 if the programs differ.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+int Coverage::Merge(const Coverage &a_other)
+{
+     if (m_program == 0)
+          m_program = a_other.m_program;
+     else if (a_other.m_program != 0 && a_other.m_program != m_program) {
+          string error = "The coverage belongs to a different program";
+          Errors::RecordError(error);
+          return -1;
+     }
+
+     int added = 0;
+     for (int i = 0; i < WORDS; i++) {
+          added += CountBits(a_other.m_executed[i] & ~m_executed[i]) + CountBits(a_other.m_taken[i] & ~m_taken[i])
+               + CountBits(a_other.m_notTaken[i] & ~m_notTaken[i]);
+          m_executed[i] |= a_other.m_executed[i];
+          m_taken[i] |= a_other.m_taken[i];
+          m_notTaken[i] |= a_other.m_notTaken[i];
+     }
+     return added;
+} /* int Coverage::Merge(const Coverage &a_other) */
+
+
+/**/
+/*
+Coverage::CountExecuted()
+
+NAME
+
+    Coverage::CountExecuted - count the instructions executed.
+
+SYNOPSIS
+
+    int Coverage::CountExecuted() const;
+
+DESCRIPTION
+
+    Counts the locations whose instruction was executed at least once.
+
+RETURNS
+
+    The number of locations.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+int Coverage::CountExecuted() const
+{
+     int count = 0;
+     for (int i = 0; i < WORDS; i++)
+          count += CountBits(m_executed[i]);
+     return count;
+} /* int Coverage::CountExecuted() const */
+
+
+/**/
+/*
+Coverage::CountBranchDirections()
+
+NAME
+
+    Coverage::CountBranchDirections - count the branch directions taken.
+
+SYNOPSIS
+
+    int Coverage::CountBranchDirections() const;
+
+DESCRIPTION
+
+    Counts the directions seen of every conditional branch, so a branch that went both ways counts twice.
+
+RETURNS
+
+    The number of branch directions.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+int Coverage::CountBranchDirections() const
+{
+     int count = 0;
+     for (int i = 0; i < WORDS; i++)
+          count += CountBits(m_taken[i]) + CountBits(m_notTaken[i]);
+     return count;
+} /* int Coverage::CountBranchDirections() const */
+
+
+/**/
+/*
+Coverage::Read(const string &a_fileName)
+
+NAME
+
+    Coverage::Read - read the coverage from a file.
+
+SYNOPSIS
+
+    bool Coverage::Read(const string &a_fileName);
+    a_fileName    --> name of the coverage file.
+
+DESCRIPTION
+
+    Replaces the coverage with the coverage saved in the file. A file that does not exist yet gives
+    empty coverage, so the first run of a batch can start the file.
+
+RETURNS
+
+    'true' if the file was read or does not exist,
+    'false' if it is not a coverage file of this version.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Coverage::Read(const string &a_fileName)
+{
+     Clear();
+     ifstream file(a_fileName.c_str(), ios::in | ios::binary);
+     if (!file)
+          return true;
+
+     uint32_t header[3];
+     if (!file.read(reinterpret_cast<char *>(header), sizeof(header)) || header[0] != MAGIC || header[1] != VERSION
+          || header[2] != (uint32_t)emulator::MEMSZ || !file.read(reinterpret_cast<char *>(&m_program), sizeof(m_program))
+          || !file.read(reinterpret_cast<char *>(m_executed), sizeof(m_executed))
+          || !file.read(reinterpret_cast<char *>(m_taken), sizeof(m_taken))
+          || !file.read(reinterpret_cast<char *>(m_notTaken), sizeof(m_notTaken))) {
+          Clear();
+          string error = a_fileName + " is not a coverage file";
+          Errors::RecordError(error);
+          return false;
+     }
+     return true;
+} /* bool Coverage::Read(const string &a_fileName) */
+
+
+/**/
+/*
+Coverage::Write(const string &a_fileName)
+
+NAME
+
+    Coverage::Write - save the coverage to a file.
+
+SYNOPSIS
+
+    bool Coverage::Write(const string &a_fileName) const;
+    a_fileName    --> name of the coverage file.
+
+DESCRIPTION
+
+    Writes the header and the three bitmaps under a name of their own, then renames that file to
+    a_fileName, so a reader sees either the previous contents or the new ones, never a mix.
+
+RETURNS
+
+    'true' if the coverage was saved,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Coverage::Write(const string &a_fileName) const
+{
+     uint32_t header[3] = { MAGIC, VERSION, (uint32_t)emulator::MEMSZ };
+
+     bool written = DiskCache::WriteAndRename(a_fileName, [&](const string &a_path) {
+          ofstream file(a_path.c_str(), ios::out | ios::binary | ios::trunc);
+          file.write(reinterpret_cast<const char *>(header), sizeof(header));
+          file.write(reinterpret_cast<const char *>(&m_program), sizeof(m_program));
+          file.write(reinterpret_cast<const char *>(m_executed), sizeof(m_executed));
+          file.write(reinterpret_cast<const char *>(m_taken), sizeof(m_taken));
+          file.write(reinterpret_cast<const char *>(m_notTaken), sizeof(m_notTaken));
+          file.close();
+          return !file.fail();
+     });
+     if (!written) {
+          string error = "Could not write the coverage file " + a_fileName;
+          Errors::RecordError(error);
+          return false;
+     }
+     return true;
+} /* bool Coverage::Write(const string &a_fileName) const */
+
+
+/**/
+/*
+Coverage::Update(const string &a_fileName, const Coverage &a_run)
+
+NAME
+
+    Coverage::Update - merge the coverage of a run into a file.
+
+SYNOPSIS
+
+    int Coverage::Update(const string &a_fileName, const Coverage &a_run);
+    a_fileName    --> name of the coverage file.
+    a_run         --> the coverage of the run.
+
+DESCRIPTION
+
+    Takes an exclusive advisory lock on a_fileName.lock, then reads the file into this coverage,
+    merges a_run into it and writes it back. Runs sharing the file take turns, so none of them reads
+    the file while another is between reading and writing it, and no coverage is lost. The lock is
+    taken on a file of its own because Write replaces the coverage file with another. It is let go
+    when the lock file is closed, which the system also does for a process that dies.
+
+RETURNS
+
+    The number of bits a_run added to the file, or -1 if the file could not be locked, read or
+    written, or belongs to a different program.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+int Coverage::Update(const string &a_fileName, const Coverage &a_run)
+{
+     string lockName = a_fileName + ".lock";
+#ifdef _WIN32
+     HANDLE lock = CreateFileA(lockName.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+          NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+     OVERLAPPED whole = {};
+     bool locked = lock != INVALID_HANDLE_VALUE && LockFileEx(lock, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &whole);
+#else
+     int lock = open(lockName.c_str(), O_RDWR | O_CREAT, 0666);
+     bool locked = lock >= 0 && flock(lock, LOCK_EX) == 0;
+#endif
+
+     int added = -1;
+     if (!locked) {
+          string error = "Could not lock the coverage file " + a_fileName;
+          Errors::RecordError(error);
+     }
+     else if (Read(a_fileName)) {
+          added = Merge(a_run);
+          if (added >= 0 && !Write(a_fileName))
+               added = -1;
+     }
+
+#ifdef _WIN32
+     if (lock != INVALID_HANDLE_VALUE)
+          CloseHandle(lock);
+#else
+     if (lock >= 0)
+          close(lock);
+#endif
+     return added;
+} /* int Coverage::Update(const string &a_fileName, const Coverage &a_run) */
@@ -0,0 +1,117 @@
+#pragma once
+
+/**/
+/*
+Coverage Class
+
+NAME
+
+     Coverage - which instructions and branch directions a program has executed.
+
+DESCRIPTION
+
+     Coverage class - one bit per location of memory for the instructions executed, and for
+     the conditional branches (bm, bz, bp) one bit for each direction taken. The emulator sets
+     the bits as it runs, which costs a shift and an or per instruction. Coverage of many runs
+     of the same program is merged by or-ing the bits, so a file can collect the coverage of a
+     whole batch of runs and each run can tell whether it reached anything new.
+
+     The coverage is tied to the program by a hash of its memory when it started, so coverage
+     of different programs is never merged. Runs that share a file update it under a lock on a
+     file of its own, so none of them loses what another added.
+
+     File layout, all fields are little-endian:
+
+         header      magic "VCCV", version, memory size, 64 bit program hash.
+         bitmaps     executed, branch taken, branch not taken; each (memory size + 63) / 64 words of 64 bits.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+
+#include "Emulator.h"
+
+class Coverage {
+
+public:
+
+    const static uint32_t MAGIC = 0x56434356;   // "VCCV" read as a little-endian word.
+    const static uint32_t VERSION = 1;          // Current version of the file format.
+
+    Coverage( ) { Clear(); };
+    ~Coverage( ) { };
+
+    // Forget all the coverage and the program.
+    void Clear( );
+
+    // Tie the coverage to the program in memory. Coverage of another program is cleared first.
+    void SetProgram( const int *a_memory, int a_origin );
+
+    // The hash that tells programs apart: of the whole memory before the program runs, and its origin.
+    static uint64_t HashProgram( const int *a_memory, int a_origin );
+
+    // Record that the instruction at a location was executed.
+    inline void MarkExecuted( int a_loc ) {
+
+        m_executed[a_loc >> 6] |= (uint64_t)1 << (a_loc & 63);
+    };
+    // Record the direction a conditional branch at a location went.
+    inline void MarkBranch( int a_loc, bool a_taken ) {
+
+        (a_taken ? m_taken : m_notTaken)[a_loc >> 6] |= (uint64_t)1 << (a_loc & 63);
+    };
+
+    // To check what was covered.
+    inline bool IsExecuted( int a_loc ) const {
+
+        return (m_executed[a_loc >> 6] >> (a_loc & 63)) & 1;
+    };
+    inline bool IsTaken( int a_loc ) const {
+
+        return (m_taken[a_loc >> 6] >> (a_loc & 63)) & 1;
+    };
+    inline bool IsNotTaken( int a_loc ) const {
+
+        return (m_notTaken[a_loc >> 6] >> (a_loc & 63)) & 1;
+    };
+
+    // Add the coverage of another run of the same program. Returns the number of bits it added.
+    int Merge( const Coverage &a_other );
+
+    // Count the instructions executed and the branch directions taken.
+    int CountExecuted( ) const;
+    int CountBranchDirections( ) const;
+
+    // Read the coverage from a file. A file that does not exist gives empty coverage.
+    bool Read( const string &a_fileName );
+
+    // Save the coverage to a file.
+    bool Write( const string &a_fileName ) const;
+
+    // Read a file, merge the coverage of a run into it and save it, while holding a lock on the file.
+    int Update( const string &a_fileName, const Coverage &a_run );
+
+    // To access the hash of the program the coverage belongs to, 0 if none.
+    inline uint64_t GetProgram( ) const {
+
+        return m_program;
+    };
+
+private:
+
+    // Number of 64 bit words in each bitmap.
+    const static int WORDS = (emulator::MEMSZ + 63) / 64;
+
+    uint64_t m_program;             // Hash of the program the coverage belongs to, 0 if none.
+    uint64_t m_executed[WORDS];     // Bit per location: an instruction there was executed.
+    uint64_t m_taken[WORDS];        // Bit per location: a conditional branch there was taken.
+    uint64_t m_notTaken[WORDS];     // Bit per location: a conditional branch there was not taken.
+};
@@ -0,0 +1,387 @@
+//
+//      Implementation of the DebugInfo class.
+//
+#include "stdafx.h"
+#include "DebugInfo.h"
+#include "Errors.h"
+#include "Hash.h"
+
+
+/**/
+/*
+DebugInfo::DebugInfo()
+
+NAME
+
+    DebugInfo::DebugInfo - constructor for the DebugInfo class.
+
+SYNOPSIS
+
+    DebugInfo::DebugInfo();
+
+DESCRIPTION
+
+    Starts with empty tables and no source file.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+DebugInfo::DebugInfo()
+{
+     m_builtStrings.assign(4, '\0');
+     UseBuiltTables();
+} /* DebugInfo::DebugInfo() */
+
+
+/**/
+/*
+DebugInfo::UseBuiltTables()
+
+NAME
+
+    DebugInfo::UseBuiltTables - use the tables built in memory.
+
+SYNOPSIS
+
+    void DebugInfo::UseBuiltTables();
+
+DESCRIPTION
+
+    Points the tables in use at the vectors filled by Build.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void DebugInfo::UseBuiltTables()
+{
+     m_lines = m_builtLines.data();
+     m_lineCount = m_builtLines.size();
+     m_symbols = m_builtSymbols.data();
+     m_symbolCount = m_builtSymbols.size();
+     m_strings = m_builtStrings.data();
+     m_stringSize = m_builtStrings.size();
+} /* void DebugInfo::UseBuiltTables() */
+
+
+/**/
+/*
+DebugInfo::Build(const string &a_sourceFile, const vector<pair<int, int>> &a_lines, const map<string, int> &a_symbols, int a_end)
+
+NAME
+
+    DebugInfo::Build - build the tables of an assembled program.
+
+SYNOPSIS
+
+    void DebugInfo::Build(const string &a_sourceFile, const vector<pair<int, int>> &a_lines, const map<string, int> &a_symbols, int a_end);
+    a_sourceFile    --> name of the source file.
+    a_lines         --> (location, line index) of each word placed in memory, in source order.
+    a_symbols       --> the labels and their locations.
+    a_end           --> location following the program.
+
+DESCRIPTION
+
+    Sorts the lines by location. When several lines placed a word at the same location (after an org
+    going backwards), the last one is kept, as its word is the one left in memory. The label ranges
+    end at the next label with a greater location, or at a_end.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void DebugInfo::Build(const string &a_sourceFile, const vector<pair<int, int>> &a_lines, const map<string, int> &a_symbols, int a_end)
+{
+     m_file.Close();
+
+     // Stable sorting keeps the lines of a location in source order, so the last one is the one kept.
+     vector<pair<int, int>> lines(a_lines);
+     stable_sort(lines.begin(), lines.end(), [](const pair<int, int> &a_x, const pair<int, int> &a_y) { return a_x.first < a_y.first; });
+     m_builtLines.clear();
+     for (size_t i = 0; i < lines.size(); i++) {
+          LineEntry entry = { static_cast<uint32_t>(lines[i].first), static_cast<uint32_t>(lines[i].second + 1) };
+          if (!m_builtLines.empty() && m_builtLines.back().m_loc == entry.m_loc)
+               m_builtLines.back() = entry;
+          else
+               m_builtLines.push_back(entry);
+     }
+
+     // The string table starts with the source file; the names follow.
+     m_builtStrings.assign(a_sourceFile.begin(), a_sourceFile.end());
+     m_builtStrings.push_back('\0');
+
+     vector<pair<int, string>> symbols;
+     for (map<string, int>::const_iterator it = a_symbols.begin(); it != a_symbols.end(); ++it) {
+          if (it->second >= 0)
+               symbols.push_back(pair<int, string>(it->second, it->first));
+     }
+     sort(symbols.begin(), symbols.end());
+     m_builtSymbols.clear();
+     for (size_t i = 0; i < symbols.size(); i++) {
+          size_t next = i + 1;
+          while (next < symbols.size() && symbols[next].first == symbols[i].first)
+               next++;
+          int end = next < symbols.size() ? symbols[next].first : max(a_end, symbols[i].first + 1);
+
+          SymbolRange range = { static_cast<uint32_t>(symbols[i].first), static_cast<uint32_t>(end), static_cast<uint32_t>(m_builtStrings.size()) };
+          m_builtSymbols.push_back(range);
+          m_builtStrings.insert(m_builtStrings.end(), symbols[i].second.begin(), symbols[i].second.end());
+          m_builtStrings.push_back('\0');
+     }
+     while (m_builtStrings.size() % 4 != 0)
+          m_builtStrings.push_back('\0');
+
+     UseBuiltTables();
+} /* void DebugInfo::Build(const string &a_sourceFile, const vector<pair<int, int>> &a_lines, const map<string, int> &a_symbols, int a_end) */
+
+
+/**/
+/*
+DebugInfo::Write(const string &a_fileName)
+
+NAME
+
+    DebugInfo::Write - save the tables to a file.
+
+SYNOPSIS
+
+    bool DebugInfo::Write(const string &a_fileName) const;
+    a_fileName    --> name of the debug information file.
+
+DESCRIPTION
+
+    Writes the header, the line table, the symbol ranges and the string table, replacing the previous
+    contents of the file.
+
+RETURNS
+
+    'true' if the file was written,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool DebugInfo::Write(const string &a_fileName) const
+{
+     size_t lineBytes = m_lineCount * sizeof(LineEntry);
+     size_t symbolBytes = m_symbolCount * sizeof(SymbolRange);
+
+     Header header;
+     header.m_magic = MAGIC;
+     header.m_version = VERSION;
+     header.m_lines = static_cast<uint32_t>(m_lineCount);
+     header.m_symbols = static_cast<uint32_t>(m_symbolCount);
+     header.m_stringSize = static_cast<uint32_t>(m_stringSize);
+     header.m_checksum = Hash::Fnv1a32(m_lines, lineBytes);
+     header.m_checksum = Hash::Fnv1a32(m_symbols, symbolBytes, header.m_checksum);
+     header.m_checksum = Hash::Fnv1a32(m_strings, m_stringSize, header.m_checksum);
+
+     ofstream file(a_fileName.c_str(), ios::out | ios::binary | ios::trunc);
+     file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+     file.write(reinterpret_cast<const char *>(m_lines), lineBytes);
+     file.write(reinterpret_cast<const char *>(m_symbols), symbolBytes);
+     file.write(m_strings, m_stringSize);
+     file.close();
+     if (!file) {
+          string error = "Could not write the debug information " + a_fileName;
+          Errors::RecordError(error);
+          return false;
+     }
+     return true;
+} /* bool DebugInfo::Write(const string &a_fileName) const */
+
+
+/**/
+/*
+DebugInfo::Open(const string &a_fileName)
+
+NAME
+
+    DebugInfo::Open - use the tables of a file.
+
+SYNOPSIS
+
+    bool DebugInfo::Open(const string &a_fileName);
+    a_fileName    --> name of the debug information file.
+
+DESCRIPTION
+
+    Maps the file into memory and checks its header, sizes and checksum, so the lookups can then use
+    the tables in place. The tables are left empty if the file is not valid.
+
+RETURNS
+
+    'true' if the file is valid debug information,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool DebugInfo::Open(const string &a_fileName)
+{
+     m_builtLines.clear();
+     m_builtSymbols.clear();
+     m_builtStrings.assign(4, '\0');
+     UseBuiltTables();
+
+     if (!m_file.Open(a_fileName)) {
+          string error = "Could not open the debug information " + a_fileName;
+          Errors::RecordError(error);
+          return false;
+     }
+
+     // The sizes are checked in 64 bits so damaged counts cannot overflow.
+     Header header;
+     const unsigned char *data = m_file.Data();
+     uint64_t size = m_file.Size();
+     bool valid = size >= sizeof(header);
+     if (valid) {
+          memcpy(&header, data, sizeof(header));
+          uint64_t expected = sizeof(header) + (uint64_t)header.m_lines * sizeof(LineEntry)
+               + (uint64_t)header.m_symbols * sizeof(SymbolRange) + header.m_stringSize;
+          valid = header.m_magic == MAGIC && header.m_version == VERSION && expected == size && header.m_stringSize > 0
+               && Hash::Fnv1a32(data + sizeof(header), size - sizeof(header)) == header.m_checksum
+               && data[size - 1] == '\0';
+     }
+     if (!valid) {
+          m_file.Close();
+          string error = a_fileName + " is not valid debug information";
+          Errors::RecordError(error);
+          return false;
+     }
+
+     m_lines = reinterpret_cast<const LineEntry *>(data + sizeof(header));
+     m_lineCount = header.m_lines;
+     m_symbols = reinterpret_cast<const SymbolRange *>(m_lines + m_lineCount);
+     m_symbolCount = header.m_symbols;
+     m_strings = reinterpret_cast<const char *>(m_symbols + m_symbolCount);
+     m_stringSize = header.m_stringSize;
+     return true;
+} /* bool DebugInfo::Open(const string &a_fileName) */
+
+
+/**/
+/*
+DebugInfo::LineFor(int a_loc)
+
+NAME
+
+    DebugInfo::LineFor - find the source line of a location.
+
+SYNOPSIS
+
+    int DebugInfo::LineFor(int a_loc) const;
+    a_loc    --> the location.
+
+DESCRIPTION
+
+    Binary search of the line table.
+
+RETURNS
+
+    The number of the source line, counting from 1, or 0 if no word of the source was placed at a_loc.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+int DebugInfo::LineFor(int a_loc) const
+{
+     const LineEntry *end = m_lines + m_lineCount;
+     const LineEntry *it = lower_bound(m_lines, end, a_loc, [](const LineEntry &a_entry, int a_loc) { return (int)a_entry.m_loc < a_loc; });
+     if (it == end || (int)it->m_loc != a_loc)
+          return 0;
+     return it->m_line;
+} /* int DebugInfo::LineFor(int a_loc) const */
+
+
+/**/
+/*
+DebugInfo::SymbolFor(int a_loc, int &a_offset)
+
+NAME
+
+    DebugInfo::SymbolFor - find the label covering a location.
+
+SYNOPSIS
+
+    const char *DebugInfo::SymbolFor(int a_loc, int &a_offset) const;
+    a_loc       --> the location.
+    a_offset    --> set to the distance of a_loc from the label.
+
+DESCRIPTION
+
+    Binary search of the symbol ranges for the last label at or before a_loc. When several labels share
+    a location the one latest in alphabetical order is returned.
+
+RETURNS
+
+    The name of the label, or NULL if no label covers a_loc.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+const char *DebugInfo::SymbolFor(int a_loc, int &a_offset) const
+{
+     const SymbolRange *it = upper_bound(m_symbols, m_symbols + m_symbolCount, a_loc, [](int a_loc, const SymbolRange &a_range) { return a_loc < (int)a_range.m_start; });
+     if (it == m_symbols || a_loc >= (int)(it - 1)->m_end || (it - 1)->m_name >= m_stringSize)
+          return NULL;
+     --it;
+     a_offset = a_loc - it->m_start;
+     return m_strings + it->m_name;
+} /* const char *DebugInfo::SymbolFor(int a_loc, int &a_offset) const */
@@ -0,0 +1,133 @@
+#pragma once
+
+/**/
+/*
+DebugInfo Class
+
+NAME
+
+     DebugInfo - table from the locations of a program to its source lines and labels.
+
+DESCRIPTION
+
+     DebugInfo class - the debug information the assembler saves next to the object image, so
+     tools that run or trace a program can tell which source line and which label a location
+     belongs to without assembling the source again. The tables are sorted by location and
+     have a fixed size per entry, so a file is used in place by mapping it into memory and
+     a location is looked up by binary search.
+
+     Only the words placed in memory (instructions and constants) have a line. Each label
+     covers the locations from its own up to the next label, or up to the end of the program.
+
+     File layout, all fields are 32 bit little-endian words:
+
+         header      magic "VCDB", version, line count, symbol count, string table size in bytes,
+                     FNV-1a checksum of the rest of the file.
+         lines       location, line number (counting from 1); sorted by location.
+         symbols     first location, location following the last, offset of the name in the
+                     string table; sorted by first location.
+         strings     the name of the source file followed by the names of the symbols, each
+                     ending with a zero byte, padded to a multiple of four bytes.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+
+#include "MappedFile.h"
+
+class DebugInfo {
+
+public:
+
+    const static uint32_t MAGIC = 0x42444356;   // "VCDB" read as a little-endian word.
+    const static uint32_t VERSION = 1;          // Current version of the file format.
+
+    // The source line of a location.
+    struct LineEntry {
+        uint32_t m_loc;         // The location.
+        uint32_t m_line;        // Number of the source line, counting from 1.
+    };
+
+    // The locations covered by a label.
+    struct SymbolRange {
+        uint32_t m_start;       // Location of the label.
+        uint32_t m_end;         // Location following the last one covered.
+        uint32_t m_name;        // Offset of the name in the string table.
+    };
+
+    DebugInfo( );
+    ~DebugInfo( ) { };
+
+    // Build the tables from the (location, line index) pairs of the words placed in memory and the labels.
+    void Build( const string &a_sourceFile, const vector<pair<int, int>> &a_lines, const map<string, int> &a_symbols, int a_end );
+
+    // Save the tables to a file.
+    bool Write( const string &a_fileName ) const;
+
+    // Map a file of debug information into memory and use its tables.
+    bool Open( const string &a_fileName );
+
+    // The source line of a location, 0 if no word of the source was placed there.
+    int LineFor( int a_loc ) const;
+
+    // The label covering a location, NULL if none. a_offset is set to the distance from the label.
+    const char *SymbolFor( int a_loc, int &a_offset ) const;
+
+    // The name of the source file.
+    inline const char *SourceFile( ) const {
+
+        return m_strings;
+    };
+
+    // To access the tables.
+    inline size_t LineCount( ) const {
+
+        return m_lineCount;
+    };
+    inline size_t SymbolCount( ) const {
+
+        return m_symbolCount;
+    };
+
+private:
+
+    struct Header {
+        uint32_t m_magic;           // Identifies the file.
+        uint32_t m_version;         // Version of the file format.
+        uint32_t m_lines;           // Number of line entries.
+        uint32_t m_symbols;         // Number of symbol ranges.
+        uint32_t m_stringSize;      // Size of the string table in bytes, a multiple of four.
+        uint32_t m_checksum;        // FNV-1a checksum of everything after the header.
+    };
+
+    // The object owns the mapping so it may not be copied.
+    DebugInfo( const DebugInfo & );
+    DebugInfo &operator=( const DebugInfo & );
+
+    // Make the tables point into the built vectors.
+    void UseBuiltTables( );
+
+    // The tables built by Build. Empty when a file is mapped.
+    vector<LineEntry> m_builtLines;
+    vector<SymbolRange> m_builtSymbols;
+    vector<char> m_builtStrings;
+
+    // The mapped file, if the tables were read from one.
+    MappedFile m_file;
+
+    // The tables in use, either the built vectors or the mapped file.
+    const LineEntry *m_lines;
+    size_t m_lineCount;
+    const SymbolRange *m_symbols;
+    size_t m_symbolCount;
+    const char *m_strings;
+    size_t m_stringSize;
+};
@@ -0,0 +1,379 @@
+//
+//      Implementation of the DiskCache class.
+//
+#include "stdafx.h"
+#include "DiskCache.h"
+#include "Stats.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#include <sys/utime.h>
+#else
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+// Files left behind by a writer that died are deleted once they are this many seconds old.
+static const int64_t STALE_SECONDS = 600;
+
+// A file in the directory of the cache.
+struct CacheFile {
+     string m_name;          // Its name, without the directory.
+     uint64_t m_size;        // Its size in bytes.
+     int64_t m_modified;     // When it was last modified, in seconds.
+};
+
+// List the files in a directory, and tell the time in the same seconds as their times.
+static void ListFiles(const string &a_directory, vector<CacheFile> &a_files, int64_t &a_now)
+{
+     a_files.clear();
+#ifdef _WIN32
+     const int64_t EPOCH = 116444736000000000ll;     // 1970 in 100 nanoseconds since 1601.
+     FILETIME now;
+     GetSystemTimeAsFileTime(&now);
+     a_now = ((int64_t)now.dwHighDateTime << 32 | now.dwLowDateTime) / 10000000 - EPOCH / 10000000;
+
+     WIN32_FIND_DATAA data;
+     HANDLE find = FindFirstFileA((a_directory + "\\*").c_str(), &data);
+     if (find == INVALID_HANDLE_VALUE)
+          return;
+     do {
+          if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+               continue;
+          CacheFile file;
+          file.m_name = data.cFileName;
+          file.m_size = (uint64_t)data.nFileSizeHigh << 32 | data.nFileSizeLow;
+          file.m_modified = ((int64_t)data.ftLastWriteTime.dwHighDateTime << 32 | data.ftLastWriteTime.dwLowDateTime) / 10000000 - EPOCH / 10000000;
+          a_files.push_back(file);
+     } while (FindNextFileA(find, &data));
+     FindClose(find);
+#else
+     a_now = (int64_t)time(NULL);
+
+     DIR *dir = opendir(a_directory.c_str());
+     if (dir == NULL)
+          return;
+     struct dirent *entry;
+     while ((entry = readdir(dir)) != NULL) {
+          struct stat st;
+          string name = entry->d_name;
+          if (stat((a_directory + "/" + name).c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+               continue;
+          CacheFile file;
+          file.m_name = name;
+          file.m_size = (uint64_t)st.st_size;
+          file.m_modified = (int64_t)st.st_mtime;
+          a_files.push_back(file);
+     }
+     closedir(dir);
+#endif
+}
+
+
+
+/**/
+/*
+DiskCache::DiskCache(const string &a_directory, size_t a_maxBytes, const string &a_mainExtension, Stats::Counter a_evictions)
+
+NAME
+
+    DiskCache::DiskCache - open the directory of a cache.
+
+SYNOPSIS
+
+    DiskCache::DiskCache(const string &a_directory, size_t a_maxBytes, const string &a_mainExtension, Stats::Counter a_evictions);
+    a_directory        --> the directory the entries are kept in. It is made when the first one is written.
+    a_maxBytes         --> the size the files of the cache may take.
+    a_mainExtension    --> the extension of the main file of an entry, with the dot.
+    a_evictions        --> the counter the entries evicted are added to.
+
+DESCRIPTION
+
+    Nothing is read until an entry is looked up.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+DiskCache::DiskCache(const string &a_directory, size_t a_maxBytes, const string &a_mainExtension, Stats::Counter a_evictions)
+     : m_directory(a_directory), m_maxBytes(a_maxBytes), m_mainExtension(a_mainExtension), m_evictions(a_evictions)
+{
+} /* DiskCache::DiskCache(const string &a_directory, size_t a_maxBytes, const string &a_mainExtension, Stats::Counter a_evictions) */
+
+
+/**/
+/*
+DiskCache::PathFor(const string &a_key, const char *a_extension) const
+
+NAME
+
+    DiskCache::PathFor - the name of a file of an entry.
+
+SYNOPSIS
+
+    string DiskCache::PathFor(const string &a_key, const char *a_extension) const;
+    a_key          --> the key of the entry.
+    a_extension    --> the extension of the file, with the dot.
+
+DESCRIPTION
+
+RETURNS
+
+    The name of the file, in the directory of the cache.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+string DiskCache::PathFor(const string &a_key, const char *a_extension) const
+{
+     return m_directory + "/" + a_key + a_extension;
+} /* string DiskCache::PathFor(const string &a_key, const char *a_extension) const */
+
+
+/**/
+/*
+DiskCache::WriteAtomically(const string &a_path, const function<bool(const string &)> &a_write)
+
+NAME
+
+    DiskCache::WriteAtomically - write a file so no one sees it half written.
+
+SYNOPSIS
+
+    bool DiskCache::WriteAtomically(const string &a_path, const function<bool(const string &)> &a_write);
+    a_path     --> the name of the file.
+    a_write    --> writes the contents to the file it is given the name of.
+
+DESCRIPTION
+
+    Makes the directory if there is none, then writes the file with WriteAndRename.
+
+RETURNS
+
+    'true' if the file was written,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool DiskCache::WriteAtomically(const string &a_path, const function<bool(const string &)> &a_write)
+{
+#ifdef _WIN32
+     _mkdir(m_directory.c_str());
+#else
+     mkdir(m_directory.c_str(), 0777);
+#endif
+     return WriteAndRename(a_path, a_write);
+} /* bool DiskCache::WriteAtomically(const string &a_path, const function<bool(const string &)> &a_write) */
+
+
+/**/
+/*
+DiskCache::WriteAndRename(const string &a_path, const function<bool(const string &)> &a_write)
+
+NAME
+
+    DiskCache::WriteAndRename - write a file under a name of its own and rename it into place.
+
+SYNOPSIS
+
+    static bool DiskCache::WriteAndRename(const string &a_path, const function<bool(const string &)> &a_write);
+    a_path     --> the name of the file.
+    a_write    --> writes the contents to the file it is given the name of.
+
+DESCRIPTION
+
+    Writes the file under a name made of the name, the process and a count, so no two writers share
+    it, then renames it to a_path, which replaces a file already there in one step. The directory of
+    a_path must exist.
+
+RETURNS
+
+    'true' if the file was written,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool DiskCache::WriteAndRename(const string &a_path, const function<bool(const string &)> &a_write)
+{
+     static atomic<unsigned> count(0);
+#ifdef _WIN32
+     string temp = a_path + "." + to_string(_getpid()) + "." + to_string(count++) + ".tmp";
+#else
+     string temp = a_path + "." + to_string(getpid()) + "." + to_string(count++) + ".tmp";
+#endif
+
+     if (!a_write(temp)) {
+          remove(temp.c_str());
+          return false;
+     }
+#ifdef _WIN32
+     bool renamed = MoveFileExA(temp.c_str(), a_path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+     bool renamed = rename(temp.c_str(), a_path.c_str()) == 0;
+#endif
+     if (!renamed)
+          remove(temp.c_str());
+     return renamed;
+} /* bool DiskCache::WriteAndRename(const string &a_path, const function<bool(const string &)> &a_write) */
+
+
+/**/
+/*
+DiskCache::Touch(const string &a_key)
+
+NAME
+
+    DiskCache::Touch - mark an entry as used.
+
+SYNOPSIS
+
+    void DiskCache::Touch(const string &a_key);
+    a_key    --> the key of the entry.
+
+DESCRIPTION
+
+    Sets the time the main file of the entry was last modified to now, so the entry is the last to
+    be evicted.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void DiskCache::Touch(const string &a_key)
+{
+#ifdef _WIN32
+     _utime(PathFor(a_key, m_mainExtension.c_str()).c_str(), NULL);
+#else
+     utime(PathFor(a_key, m_mainExtension.c_str()).c_str(), NULL);
+#endif
+} /* void DiskCache::Touch(const string &a_key) */
+
+
+/**/
+/*
+DiskCache::Evict()
+
+NAME
+
+    DiskCache::Evict - delete the entries used least recently.
+
+SYNOPSIS
+
+    void DiskCache::Evict();
+
+DESCRIPTION
+
+    Adds up the sizes of the files of each entry in the directory. If they take more than the size
+    allowed, the entries are deleted in the order they were last used, entries without a main file
+    first, until the rest fit. The main file of an entry is deleted first, so that it is no longer
+    found while its other files go. Files being written by a process that died long ago are deleted
+    too. The entries deleted are counted.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void DiskCache::Evict()
+{
+     vector<CacheFile> files;
+     int64_t now;
+     ListFiles(m_directory, files, now);
+
+     // The entries: the time each was last used, -1 if it has no main file, its size and its files.
+     map<string, pair<int64_t, uint64_t>> entries;
+     map<string, vector<string>> names;
+     uint64_t total = 0;
+     for (size_t i = 0; i < files.size(); i++) {
+          const string &name = files[i].m_name;
+          if (name.size() > 4 && name.compare(name.size() - 4, 4, ".tmp") == 0) {
+               if (now - files[i].m_modified > STALE_SECONDS)
+                    remove((m_directory + "/" + name).c_str());
+               continue;
+          }
+          if (name.size() < 66 || name.find_first_not_of("0123456789abcdef") != 64 || name[64] != '.'
+               || name.find('.', 65) != string::npos)
+               continue;
+          string key = name.substr(0, 64);
+
+          if (entries.find(key) == entries.end())
+               entries[key] = make_pair((int64_t)-1, (uint64_t)0);
+          if (name.compare(64, string::npos, m_mainExtension) == 0) {
+               entries[key].first = files[i].m_modified;
+               names[key].insert(names[key].begin(), name);
+          }
+          else {
+               names[key].push_back(name);
+          }
+          entries[key].second += files[i].m_size;
+          total += files[i].m_size;
+     }
+     if (total <= m_maxBytes)
+          return;
+
+     vector<pair<int64_t, string>> order;
+     for (map<string, pair<int64_t, uint64_t>>::iterator it = entries.begin(); it != entries.end(); ++it)
+          order.push_back(make_pair(it->second.first, it->first));
+     sort(order.begin(), order.end());
+     for (size_t i = 0; i < order.size() && total > m_maxBytes; i++) {
+          const vector<string> &entryFiles = names[order[i].second];
+          for (size_t j = 0; j < entryFiles.size(); j++)
+               remove((m_directory + "/" + entryFiles[j]).c_str());
+          total -= entries[order[i].second].second;
+#if VC_STATS
+          Stats::Add(m_evictions, 1);
+#endif
+     }
+} /* void DiskCache::Evict() */
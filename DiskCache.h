@@ -0,0 +1,67 @@
+#pragma once
+
+/**/
+/*
+DiskCache Class
+
+NAME
+
+     DiskCache - a directory of cache entries, each a few files named after its key.
+
+DESCRIPTION
+
+     DiskCache class - keeps the files of the entries of a cache in a directory, each named by the
+     key of its entry, 64 hexadecimal digits, and an extension. One extension is the main file of
+     an entry: an entry is only there if its main file is, and the time the main file was last
+     modified is the time the entry was last used.
+
+     Each file is written under a name of its own and renamed into place, so a process reading an
+     entry never sees a file half written, and any number of processes may share the directory.
+     A cache that saves the main file last is seen either whole or not at all.
+
+     When the files take more than the size allowed, the entries used least recently are deleted
+     until they fit, the main file first.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+#include "Stats.h"
+
+class DiskCache {
+
+public:
+
+    // The entries evicted are counted in a_evictions.
+    DiskCache( const string &a_directory, size_t a_maxBytes, const string &a_mainExtension, Stats::Counter a_evictions );
+    ~DiskCache( ) { };
+
+    // The name of a file of an entry. The extension includes the dot.
+    string PathFor( const string &a_key, const char *a_extension ) const;
+
+    // Write a file with a_write under a name of its own, then rename it to a_path. Makes the directory if there is none.
+    bool WriteAtomically( const string &a_path, const function<bool( const string & )> &a_write );
+
+    // The same for a file outside any cache: write it under a name of its own, then rename it to a_path.
+    static bool WriteAndRename( const string &a_path, const function<bool( const string & )> &a_write );
+
+    // Mark an entry as used now.
+    void Touch( const string &a_key );
+
+    // Delete the entries used least recently until the cache fits.
+    void Evict( );
+
+private:
+
+    string m_directory;         // The directory the entries are kept in.
+    size_t m_maxBytes;          // The size the files of the cache may take.
+    string m_mainExtension;     // The extension of the main file of an entry.
+    Stats::Counter m_evictions; // The counter of the entries evicted.
+};
@@ -3,7 +3,12 @@
 //
 #include "stdafx.h"
 #include "Emulator.h"
+#include "Channel.h"
 #include "Errors.h"
+#include "Stats.h"
+#include "Coverage.h"
+#include "InputLog.h"
+#include "Verifier.h"
 
 /**/
 /*
@@ -42,7 +47,10 @@ DATE
 bool emulator::insertMemory(int a_location, int a_contents)
 {
      if (a_location < MEMSZ && a_location >= 0) {
+          touch(a_location);
           m_memory[a_location] = a_contents;
+          m_verified = false;
+          m_decodedValid = false;
      }
      else {
           string error = "Location out of bounds error";
@@ -59,26 +67,789 @@ bool emulator::insertMemory(int a_location, int a_contents)
 } /* bool emulator::insertMemory(int a_location, int a_contents) */
 
 
+/**/
+/*
+emulator::insertBlock(int a_location, const int *a_contents, int a_count)
+
+NAME
+
+    emulator::insertBlock - insert a block of words into emulator memory.
+
+SYNOPSIS
+
+    bool emulator::insertBlock(int a_location, const int *a_contents, int a_count);
+    a_location     --> location of the first word of the block.
+    a_contents     --> the words to be recorded.
+    a_count        --> the number of words in the block. the block must end before location 10,000.
+
+DESCRIPTION
+
+    Copy a block of consecutive words into the memory of the emulator in one step. This is how object images
+    are loaded. Like insertMemory, the first block inserted establishes the origin of the program unless
+    setOrigin is called.
+
+RETURNS
+
+    'true' if the block was successfully inserted into memory of the emulator,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool emulator::insertBlock(int a_location, const int *a_contents, int a_count)
+{
+     if (a_location < 0 || a_count < 0 || a_count > MEMSZ - a_location) {
+          string error = "Location out of bounds error";
+          Errors::RecordError(error);
+          return false;
+     }
+     for (int i = 0; i < a_count; i++)
+          touch(a_location + i);
+     memcpy(&m_memory[a_location], a_contents, a_count * sizeof(int));
+     m_verified = false;
+     m_decodedValid = false;
+
+     if (m_firstInst) {
+          m_org = a_location;
+          m_firstInst = false;
+     }
+
+     return true;
+} /* bool emulator::insertBlock(int a_location, const int *a_contents, int a_count) */
+
+
+/**/
+/*
+emulator::setOrigin(int a_location)
+
+NAME
+
+    emulator::setOrigin - set the location of the first instruction.
+
+SYNOPSIS
+
+    bool emulator::setOrigin(int a_location);
+    a_location     --> location where emulation starts. location should be less than 10,000.
+
+DESCRIPTION
+
+    Set the location where runProgram starts executing. This overrides the origin established by the
+    first word inserted into memory.
+
+RETURNS
+
+    'true' if the location is within the memory of the emulator,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool emulator::setOrigin(int a_location)
+{
+     if (a_location < 0 || a_location >= MEMSZ) {
+          string error = "Location out of bounds error";
+          Errors::RecordError(error);
+          return false;
+     }
+     m_org = a_location;
+     m_firstInst = false;
+     m_verified = false;
+     m_decodedValid = false;
+     return true;
+} /* bool emulator::setOrigin(int a_location) */
+
+
+/**/
+/*
+emulator::setCoverage(Coverage *a_coverage)
+
+NAME
+
+    emulator::setCoverage - record the coverage of the runs.
+
+SYNOPSIS
+
+    void emulator::setCoverage(Coverage *a_coverage);
+    a_coverage     --> where the coverage is recorded, or NULL to stop recording it.
+
+DESCRIPTION
+
+    Ties a_coverage to the program in memory and records the coverage of every following run in it. It
+    is to be called once the program is loaded. Tying the coverage to the program means hashing the
+    whole memory, so it is done here once rather than at the start of every run; copies of the emulator
+    record into the same coverage without hashing again.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void emulator::setCoverage(Coverage *a_coverage)
+{
+     m_coverage = a_coverage;
+     if (m_coverage != NULL)
+          m_coverage->SetProgram(m_memory, m_org);
+} /* void emulator::setCoverage(Coverage *a_coverage) */
+
+
+/**/
+/*
+emulator::setChannel(Channel *a_channel)
+
+NAME
+
+    emulator::setChannel - feed the program through a channel.
+
+SYNOPSIS
+
+    void emulator::setChannel(Channel *a_channel);
+    a_channel    --> the channel, or NULL for the console.
+
+DESCRIPTION
+
+    The program reads its values from the channel and writes its output into it from then on. When
+    the channel has no value for a read, or its output is full, runSlice returns instead of waiting.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void emulator::setChannel(Channel *a_channel)
+{
+     m_channel = a_channel;
+     m_in = &cin;
+     m_out = m_channel != NULL ? &m_channel->Output() : &cout;
+} /* void emulator::setChannel(Channel *a_channel) */
+
+
+/**/
+/*
+emulator::channelReady() const
+
+NAME
+
+    emulator::channelReady - check if a program waiting for its channel can go on.
+
+SYNOPSIS
+
+    bool emulator::channelReady() const;
+
+DESCRIPTION
+
+    A program waiting for input can go on once the channel has a value or is closed, and one
+    waiting for room for its output once the output has been taken. A program that is not waiting
+    can always go on.
+
+RETURNS
+
+    'true' if runSlice would resume the program past what it waits for,
+    'false' if it would return again at once.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool emulator::channelReady() const
+{
+     switch (m_waiting) {
+     case W_Input:
+          return m_channel->HasInput() || m_channel->Closed();
+     case W_Output:
+          return !m_channel->Full();
+     default:
+          return true;
+     }
+} /* bool emulator::channelReady() const */
+
+
 /**/
 /*
 emulator::runProgram()
 
 NAME
 
-    emulator::runProgram - run the emulator.
+    emulator::runProgram - run the emulator.
+
+SYNOPSIS
+
+    bool emulator::runProgram();
+
+DESCRIPTION
+
+    Run the emulator on the code stored in the emulator's memory. Instruction is parsed one line 
+    at a time into op-code and operand and the respective function is called for the op-code.
+    The loop is chosen by runLoop.
+
+RETURNS
+
+    'true' if the emulator was successfully run,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool emulator::runProgram()
+{
+     STATS_TIMER(timer, PH_Emulation);
+
+     m_endSteps = MEMSZ;
+     m_waiting = W_Nothing;
+     return runLoop();
+} /* bool emulator::runProgram() */
+
+
+/**/
+/*
+emulator::runSlice(int a_steps)
+
+NAME
+
+    emulator::runSlice - run the program for a number of steps.
+
+SYNOPSIS
+
+    bool emulator::runSlice(int a_steps);
+    a_steps    --> the most steps to take before returning.
+
+DESCRIPTION
+
+    Runs the program like runProgram, but returns after a_steps steps if it is still running. The
+    location and the steps taken so far then become the origin and the start of the next run, as
+    with runPrefix, so calling runSlice again resumes the program where it left off. A verified
+    program stays verified, since every word it can reach from there it could reach before.
+
+    A program fed through a channel also returns when it reads with no value waiting in the channel,
+    or writes with its output full, and waitingFor says which. It is resumed at that instruction
+    once the channel has what it needs. Such a program should only be run with runSlice.
+
+RETURNS
+
+    'true' if the program is done, having halted, been stopped by an error or run out of steps,
+    'false' if it is to be resumed, having used up a_steps or waiting for its channel.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool emulator::runSlice(int a_steps)
+{
+     m_endSteps = m_startSteps + min(max(a_steps, 1), MEMSZ - m_startSteps);
+     m_waiting = W_Nothing;
+     runLoop();
+
+     // The read or write that waits was not taken, so it is the first step of the next slice.
+     if (m_waiting != W_Nothing)
+          m_kill = false;
+     else if (m_kill || m_steps >= MEMSZ)
+          return true;
+
+     m_org = m_loc;
+     m_startSteps = m_steps;
+     return false;
+} /* bool emulator::runSlice(int a_steps) */
+
+
+/**/
+/*
+emulator::runLoop()
+
+NAME
+
+    emulator::runLoop - run the program on the loop that suits it.
+
+SYNOPSIS
+
+    bool emulator::runLoop();
+
+DESCRIPTION
+
+    Runs the program from the origin until it stops or m_endSteps steps have been taken. A program
+    that passed verify runs on a loop of its own, and any other program verify decoded runs on the
+    decoded words, which are patched as it stores. Each loop is compiled once with and once without
+    recording coverage.
+
+RETURNS
+
+    'true' if the program halted or was stopped by an error,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool emulator::runLoop()
+{
+     // Without coverage the loops have no trace of it, so leaving coverage off costs nothing.
+     bool coverage = m_coverage != NULL;
+     if (m_verified)
+          return coverage ? runDecoded<false, true>() : runDecoded<false, false>();
+     if (m_decodedValid)
+          return coverage ? runDecoded<true, true>() : runDecoded<true, false>();
+     return coverage ? run<true>() : run<false>();
+} /* bool emulator::runLoop() */
+
+
+/**/
+/*
+emulator::runChecked()
+
+NAME
+
+    emulator::runChecked - run the emulator on the general loop.
+
+SYNOPSIS
+
+    bool emulator::runChecked();
+
+DESCRIPTION
+
+    Runs the program like runProgram, but on the loop for programs that were not verified, so the two
+    loops can be compared.
+
+RETURNS
+
+    'true' if the emulator was successfully run,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool emulator::runChecked()
+{
+     STATS_TIMER(timer, PH_Emulation);
+
+     m_endSteps = MEMSZ;
+     m_waiting = W_Nothing;
+     if (m_coverage != NULL)
+          return run<true>();
+     return run<false>();
+} /* bool emulator::runChecked() */
+
+
+/**/
+/*
+emulator::snapshot()
+
+NAME
+
+    emulator::snapshot - remember the memory and state to reset to.
+
+SYNOPSIS
+
+    void emulator::snapshot();
+
+DESCRIPTION
+
+    Makes the memory, the origin, the accumulator, the steps already taken and the verification the
+    ones reset goes back to. The memory is not copied: every word written from now on has its old
+    contents saved the first time, in a log and a bitmap, so the cost of a reset depends on the words
+    a run wrote rather than on the size of the memory. The bitmap is only made by the first snapshot,
+    so an emulator that is never reset is no bigger than its memory. ObjectImage takes a snapshot of
+    every program it loads.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void emulator::snapshot()
+{
+     if (m_dirty.empty())
+          m_dirty.assign(MEMSZ, 0);
+     for (size_t i = 0; i < m_undo.size(); i++)
+          m_dirty[m_undo[i].m_loc] = 0;
+     m_undo.clear();
+
+     m_snapshot.m_org = m_org;
+     m_snapshot.m_accumulator = m_accumulator;
+     m_snapshot.m_startSteps = m_startSteps;
+     m_snapshot.m_firstInst = m_firstInst;
+     m_snapshot.m_verified = m_verified;
+     m_snapshot.m_decodedValid = m_decodedValid;
+} /* void emulator::snapshot() */
+
+
+/**/
+/*
+emulator::reset()
+
+NAME
+
+    emulator::reset - go back to the snapshot.
+
+SYNOPSIS
+
+    void emulator::reset();
+
+DESCRIPTION
+
+    Restores the words written since the last snapshot, newest first, and the state it remembered,
+    so the program can be run again from the start as if it had just been loaded. The decoded words
+    of the restored words are decoded again, so a program verify decoded need not be verified again.
+    If no snapshot was taken, nothing was logged, and the memory is cleared as it was when the
+    emulator was made.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void emulator::reset()
+{
+     if (m_dirty.empty())
+          memset(m_memory, 0, MEMSZ * sizeof(int));
+     STATS_ADD(CT_ResetWords, m_undo.size());
+     bool decoded = m_snapshot.m_verified || m_snapshot.m_decodedValid;
+     for (int i = (int)m_undo.size() - 1; i >= 0; i--) {
+          int loc = m_undo[i].m_loc;
+          m_memory[loc] = m_undo[i].m_word;
+          m_dirty[loc] = 0;
+          if (decoded)
+               m_decoded[loc] = decode(m_memory[loc]);
+     }
+     m_undo.clear();
+
+     m_org = m_snapshot.m_org;
+     m_accumulator = m_snapshot.m_accumulator;
+     m_startSteps = m_snapshot.m_startSteps;
+     m_firstInst = m_snapshot.m_firstInst;
+     m_verified = m_snapshot.m_verified;
+     m_decodedValid = m_snapshot.m_decodedValid;
+     m_kill = false;
+     m_steps = 0;
+     m_waiting = W_Nothing;
+} /* void emulator::reset() */
+
+
+/**/
+/*
+emulator::restoreWords(int a_location, const int *a_words, int a_count)
+
+NAME
+
+    emulator::restoreWords - write back words of an earlier run.
+
+SYNOPSIS
+
+    void emulator::restoreWords(int a_location, const int *a_words, int a_count);
+    a_location    --> location of the first word.
+    a_words       --> the words.
+    a_count       --> number of words.
+
+DESCRIPTION
+
+    Writes words the program itself wrote in an earlier run of the same image, as SharedInstance does
+    before resuming it. Unlike insertBlock this keeps the verification, since a verified program
+    never writes the words it executes, and decodes the words again. The words are logged like any
+    other write, so reset takes them back out.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void emulator::restoreWords(int a_location, const int *a_words, int a_count)
+{
+     bool decoded = m_verified || m_decodedValid;
+     for (int i = 0; i < a_count; i++) {
+          int loc = a_location + i;
+          touch(loc);
+          m_memory[loc] = a_words[i];
+          if (decoded)
+               m_decoded[loc] = decode(a_words[i]);
+     }
+} /* void emulator::restoreWords(int a_location, const int *a_words, int a_count) */
+
+
+/**/
+/*
+emulator::verify()
+
+NAME
+
+    emulator::verify - check the program for the fast loop.
+
+SYNOPSIS
+
+    bool emulator::verify();
+
+DESCRIPTION
+
+    Decodes every word of memory once for runDecoded, into a table the first verify makes, then
+    checks the program with the Verifier, which proves from the origin that the words the program
+    can execute are valid and never change. A program that fails is still run on the decoded words,
+    patching them as it stores into them. Changing the memory or the origin through insertMemory,
+    insertBlock, setOrigin or runPrefix undoes both. ObjectImage verifies every program it loads.
+
+RETURNS
+
+    'true' if the program passed,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool emulator::verify()
+{
+     m_decoded.resize(MEMSZ + 1);
+     for (int loc = 0; loc < MEMSZ; loc++)
+          m_decoded[loc] = decode(m_memory[loc]);
+     // Running past the end of memory takes the case for an invalid opcode.
+     m_decoded[MEMSZ].m_opcode = INVALID_OPCODE;
+     m_decoded[MEMSZ].m_operand = 0;
+     m_decodedValid = true;
+
+     Verifier verifier(m_memory, m_org);
+     m_verified = verifier.Run();
+     return m_verified;
+} /* bool emulator::verify() */
+
+
+/**/
+/*
+emulator::run()
+
+NAME
+
+    emulator::run - the loop of the emulator.
+
+SYNOPSIS
+
+    template <bool COVERAGE> bool emulator::run();
+    COVERAGE    --> true to record the coverage of the run in m_coverage.
+
+DESCRIPTION
+
+    Executes the program from the origin until it halts or has taken a step for every word of memory.
+    With COVERAGE set, the location of every instruction executed is marked, and for bm, bz and bp the
+    direction the branch goes.
+
+RETURNS
+
+    'true' if the program halted,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+template <bool COVERAGE> bool emulator::run()
+{
+     // Moving the program pointer to point to the origin location
+     m_loc = m_org;
+     for (int i = m_startSteps; i < m_endSteps; i++) {
+          m_opcode = m_memory[m_loc] / 10000;
+          m_operand = m_memory[m_loc] % 10000;
+
+          // Opcode 0 means the line is either declaring storage or a constant or something along the lines 
+          // which has already been processed during instruction parsing
+          if (m_opcode == 0) {
+               m_loc++;
+               continue;
+          }
+          if (COVERAGE)
+               m_coverage->MarkExecuted(m_loc);
+
+          switch (m_opcode) {
+          case 1:
+               add();
+               break;
+          case 2:
+               sub();
+               break;
+          case 3:
+               mult();
+               break;
+          case 4:
+               div();
+               break;
+          case 5:
+               load();
+               break;
+          case 6:
+               store();
+               break;
+          case 7:
+               m_steps = i;
+               read();
+               break;
+          case 8:
+               write();
+               break;
+          case 9:
+               b();
+               break;
+          case 10:
+               if (COVERAGE)
+                    m_coverage->MarkBranch(m_loc, m_accumulator < 0);
+               bm();
+               break;
+          case 11:
+               if (COVERAGE)
+                    m_coverage->MarkBranch(m_loc, m_accumulator == 0);
+               bz();
+               break;
+          case 12:
+               if (COVERAGE)
+                    m_coverage->MarkBranch(m_loc, m_accumulator > 0);
+               bp();
+               break;
+          case 13:
+               halt();
+               break;
+          default:
+               invalid(i);
+               break;
+          }
+
+          if (m_kill) {
+               m_steps = m_waiting == W_Nothing ? i + 1 : i;
+               STATS_ADD(CT_Instructions, m_steps - m_startSteps);
+               return true;
+          }
+     }
+     // Reaching this point in the program means there is a missing halt statement, or the slice is over
+     m_steps = m_endSteps;
+     STATS_ADD(CT_Instructions, m_steps - m_startSteps);
+     return false;
+} /* template <bool COVERAGE> bool emulator::run() */
+
+
+/**/
+/*
+emulator::runDecoded()
+
+NAME
+
+    emulator::runDecoded - run a program on its decoded words.
 
 SYNOPSIS
 
-    bool emulator::runProgram();
+    template <bool PATCHING, bool COVERAGE> bool emulator::runDecoded();
+    PATCHING    --> true if the program may change the words it executes.
+    COVERAGE    --> true to record the coverage of the run in m_coverage.
 
 DESCRIPTION
 
-    Run the emulator on the code stored in the emulator's memory. Instruction is parsed one line 
-    at a time into op-code and operand and the respective function is called for the op-code.
+    Executes the program like run, from the words verify decoded. The location and the accumulator
+    are kept in local variables, and only handed to the members for read, which works on them.
+
+    Without PATCHING the program passed verification, so it cannot change the words it executes and
+    they all have valid opcodes. Nothing is decoded during the run, and m_decoded is left out of date
+    for the data the program stores into.
+
+    With PATCHING the program may change its code, as array code does by adding to the operand of an
+    instruction and storing it back. Every word stored or read is patched: if it kept its opcode only
+    its decoded operand is changed, otherwise it is decoded again. Invalid opcodes, and running past
+    the end of memory, stop the program as in run. --stats counts the patches as operand_patches and
+    the words decoded again as redecodes.
+
+    With COVERAGE the instructions executed and the directions of bm, bz and bp are marked as run
+    marks them, so recording coverage keeps a program on the fast loop.
 
 RETURNS
 
-    'true' if the emulator was successfully run,
+    'true' if the program halted,
     'false' otherwise.
 
 AUTHOR
@@ -91,21 +862,307 @@ DATE
 
 */
 /**/
-bool emulator::runProgram()
+template <bool PATCHING, bool COVERAGE> bool emulator::runDecoded()
 {
-     // Moving the program pointer to point to the origin location
+     int loc = m_org;
+     int acc = m_accumulator;
+     int result = 0;
+     int patches[3] = { 0, 0, 0 };
+     int i = m_startSteps;
+     const Decoded *decoded = m_decoded.data();
+     for (; i < m_endSteps; i++) {
+          int operand = decoded[loc].m_operand;
+          int opcode = decoded[loc].m_opcode;
+          // The invalid word past the end of memory has no place in the coverage.
+          if (COVERAGE && opcode != 0 && loc < MEMSZ)
+               m_coverage->MarkExecuted(loc);
+          switch (opcode) {
+          case 0:
+               loc++;
+               break;
+          case 1:
+               if (StaticAssembler::Arithmetic(1, acc, m_memory[operand], result)) {
+                    acc = result;
+                    loc++;
+               }
+               else {
+                    *m_out << "Overflow in the accumulator when executing command\n";
+               }
+               break;
+          case 2:
+               if (StaticAssembler::Arithmetic(2, acc, m_memory[operand], result)) {
+                    acc = result;
+                    loc++;
+               }
+               else {
+                    *m_out << "Overflow in the accumulator when executing command\n";
+               }
+               break;
+          case 3:
+               if (StaticAssembler::Arithmetic(3, acc, m_memory[operand], result)) {
+                    acc = result;
+                    loc++;
+               }
+               else {
+                    *m_out << "Overflow in the accumulator when executing command\n";
+               }
+               break;
+          case 4:
+               if (StaticAssembler::Arithmetic(4, acc, m_memory[operand], result)) {
+                    acc = result;
+                    loc++;
+               }
+               else {
+                    *m_out << "Overflow in the accumulator when executing command\n";
+               }
+               break;
+          case 5:
+               acc = m_memory[operand];
+               loc++;
+               break;
+          case 6:
+               touch(operand);
+               m_memory[operand] = acc;
+               if (PATCHING)
+                    patches[patch(operand)]++;
+               loc++;
+               break;
+          case 7:
+               m_loc = loc;
+               m_operand = operand;
+               m_steps = i;
+               read();
+               if (PATCHING)
+                    patches[patch(operand)]++;
+               loc = m_loc;
+               if (m_kill) {
+                    if (m_waiting == W_Nothing)
+                         i++;
+                    goto stopped;
+               }
+               break;
+          case 8:
+               if (m_channel != NULL && m_channel->Full()) {
+                    m_waiting = W_Output;
+                    m_kill = true;
+                    goto stopped;
+               }
+               *m_out << m_memory[operand] << endl;
+               STATS_ADD(CT_Writes, 1);
+               loc++;
+               break;
+          case 9:
+               loc = operand;
+               break;
+          case 10:
+               if (COVERAGE)
+                    m_coverage->MarkBranch(loc, acc < 0);
+               loc = acc < 0 ? operand : loc + 1;
+               break;
+          case 11:
+               if (COVERAGE)
+                    m_coverage->MarkBranch(loc, acc == 0);
+               loc = acc == 0 ? operand : loc + 1;
+               break;
+          case 12:
+               if (COVERAGE)
+                    m_coverage->MarkBranch(loc, acc > 0);
+               loc = acc > 0 ? operand : loc + 1;
+               break;
+          case 13:
+               m_kill = true;
+               i++;
+               goto stopped;
+          default:
+               // Only a program that was not verified gets here.
+               m_loc = loc;
+               invalid(i);
+               i++;
+               goto stopped;
+          }
+     }
+
+stopped:
+     m_loc = loc;
+     m_accumulator = acc;
+     m_steps = i;
+     STATS_ADD(CT_Instructions, m_steps - m_startSteps);
+     if (PATCHING) {
+          STATS_ADD(CT_OperandPatches, patches[1]);
+          STATS_ADD(CT_Redecodes, patches[2]);
+     }
+     else {
+          // Only the words the program executes are still known to be decoded.
+          m_decodedValid = false;
+          STATS_ADD(CT_VerifiedInstructions, m_steps - m_startSteps);
+     }
+     return m_kill;
+} /* template <bool PATCHING, bool COVERAGE> bool emulator::runDecoded() */
+
+
+/**/
+/*
+emulator::patch(int a_loc)
+
+NAME
+
+    emulator::patch - bring a decoded word up to date.
+
+SYNOPSIS
+
+    int emulator::patch(int a_loc);
+    a_loc    --> the location that was stored into.
+
+DESCRIPTION
+
+    Called by runDecoded after the program stored into a word. A word whose value still has the
+    opcode it was decoded with, which is what array code does to its instructions, only needs its
+    operand changed. Any other word is decoded again.
+
+RETURNS
+
+    1 if the operand of an instruction changed,
+    2 if the word was decoded again with a different opcode,
+    0 otherwise, as for data or a value that did not change.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+int emulator::patch(int a_loc)
+{
+     Decoded &decoded = m_decoded[a_loc];
+     int base = decoded.m_opcode * 10000;
+     int word = m_memory[a_loc];
+
+     if (decoded.m_opcode != INVALID_OPCODE && word >= base && word - base < 10000) {
+          int operand = word - base;
+          if (operand == decoded.m_operand)
+               return 0;
+          decoded.m_operand = int16_t(operand);
+          return decoded.m_opcode != 0 ? 1 : 0;
+     }
+
+     int opcode = decoded.m_opcode;
+     decoded = decode(word);
+     return decoded.m_opcode != opcode ? 2 : 0;
+} /* int emulator::patch(int a_loc) */
+
+
+/**/
+/*
+emulator::decode(int a_word)
+
+NAME
+
+    emulator::decode - split a word into opcode and operand.
+
+SYNOPSIS
+
+    static emulator::Decoded emulator::decode(int a_word);
+    a_word    --> the contents of a word of memory.
+
+DESCRIPTION
+
+    Splits a word the way run does. An opcode other than 0 to 13 is decoded as INVALID_OPCODE.
+
+RETURNS
+
+    The decoded word.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+emulator::Decoded emulator::decode(int a_word)
+{
+     Decoded decoded;
+     decoded.m_opcode = int16_t(a_word / 10000);
+     decoded.m_operand = int16_t(a_word % 10000);
+     if (decoded.m_opcode < 0 || decoded.m_opcode >= INVALID_OPCODE) {
+          decoded.m_opcode = INVALID_OPCODE;
+          decoded.m_operand = 0;
+     }
+     return decoded;
+} /* emulator::Decoded emulator::decode(int a_word) */
+
+
+/**/
+/*
+emulator::runPrefix(int a_maxSteps, double a_maxSeconds)
+
+NAME
+
+    emulator::runPrefix - run the part of the program that does not depend on its input.
+
+SYNOPSIS
+
+    int emulator::runPrefix(int a_maxSteps, double a_maxSeconds);
+    a_maxSteps      --> the most steps to take.
+    a_maxSeconds    --> the most time to take.
+
+DESCRIPTION
+
+    Runs the program from the origin like runProgram, but stops before the first instruction that reads,
+    writes or halts, or that would overflow the accumulator or divide by zero, since those depend on the
+    input or show something to the user. It also stops after a_maxSteps steps, after a_maxSeconds
+    seconds, or when the steps taken reach the limit of the emulator. The location it stopped at becomes
+    the origin, and the steps taken are added to the start state, so running the program from there
+    does exactly what running it from the beginning would have done.
+
+RETURNS
+
+    The number of steps taken, or -1 if the program ran past the end of memory.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+int emulator::runPrefix(int a_maxSteps, double a_maxSeconds)
+{
+     chrono::steady_clock::time_point start = chrono::steady_clock::now();
+     int limit = m_startSteps + min(a_maxSteps, MEMSZ - m_startSteps);
+     int steps = m_startSteps;
+
+     // The prefix may store into the code and moves the origin.
+     m_verified = false;
+     m_decodedValid = false;
      m_loc = m_org;
-     for (int i = 0; i < MEMSZ; i++) {
+     for (; steps < limit; steps++) {
+          // Looking at the clock every step would cost more than the steps.
+          if ((steps & 255) == 0 && chrono::duration<double>(chrono::steady_clock::now() - start).count() > a_maxSeconds)
+               break;
+          if (m_loc >= MEMSZ)
+               return -1;
+
           m_opcode = m_memory[m_loc] / 10000;
           m_operand = m_memory[m_loc] % 10000;
-
-          // Opcode 0 means the line is either declaring storage or a constant or something along the lines 
-          // which has already been processed during instruction parsing
           if (m_opcode == 0) {
                m_loc++;
                continue;
           }
+          if (overflows())
+               break;
 
+          bool done = false;
           switch (m_opcode) {
           case 1:
                add();
@@ -125,12 +1182,6 @@ bool emulator::runProgram()
           case 6:
                store();
                break;
-          case 7:
-               read();
-               break;
-          case 8:
-               write();
-               break;
           case 9:
                b();
                break;
@@ -143,18 +1194,61 @@ bool emulator::runProgram()
           case 12:
                bp();
                break;
-          case 13:
-               halt();
+          default:
+               done = true;
                break;
           }
-
-          if (m_kill) {
-               return true;
-          }
+          if (done)
+               break;
      }
-     // Reaching this point in the program means there is a missing halt statement
-     return false;
-} /* bool emulator::runProgram() */
+     if (m_loc >= MEMSZ)
+          return -1;
+
+     int taken = steps - m_startSteps;
+     m_org = m_loc;
+     m_startSteps = steps;
+     STATS_ADD(CT_Instructions, taken);
+     return taken;
+} /* int emulator::runPrefix(int a_maxSteps, double a_maxSeconds) */
+
+
+/**/
+/*
+emulator::overflows()
+
+NAME
+
+    emulator::overflows - check if an arithmetic instruction would fail.
+
+SYNOPSIS
+
+    bool emulator::overflows() const;
+
+DESCRIPTION
+
+    Checks the instruction in m_opcode and m_operand with the same StaticAssembler::Arithmetic that add,
+    sub, mult and div use, so it can be left unexecuted instead of printing the overflow message.
+
+RETURNS
+
+    'true' if the instruction would overflow the accumulator or divide by zero,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool emulator::overflows() const
+{
+     int result = 0;
+     return m_opcode >= 1 && m_opcode <= 4 && !StaticAssembler::Arithmetic(m_opcode, m_accumulator, m_memory[m_operand], result);
+} /* bool emulator::overflows() const */
 
 
 /**/
@@ -188,12 +1282,12 @@ DATE
 /**/
 void emulator::add()
 {
-     int sum = m_accumulator + m_memory[m_operand];
-     if (sum > 999999) {
-          cout << "Overflow in the accumulator when executing command\n";
+     int sum = 0;
+     if (!StaticAssembler::Arithmetic(1, m_accumulator, m_memory[m_operand], sum)) {
+          *m_out << "Overflow in the accumulator when executing command\n";
           return;
      }
-     
+
      m_accumulator = sum;
      m_loc++;
 } /* void emulator::add() */
@@ -230,9 +1324,9 @@ DATE
 /**/
 void emulator::sub()
 {
-     int diff = m_accumulator - m_memory[m_operand];
-     if (diff < -999999) {
-          cout << "Overflow in the accumulator when executing command\n";
+     int diff = 0;
+     if (!StaticAssembler::Arithmetic(2, m_accumulator, m_memory[m_operand], diff)) {
+          *m_out << "Overflow in the accumulator when executing command\n";
           return;
      }
 
@@ -272,9 +1366,9 @@ DATE
 /**/
 void emulator::mult()
 {
-     int multi = m_accumulator * m_memory[m_operand];
-     if (multi > 999999 || multi < -999999) {
-          cout << "Overflow in the accumulator when executing command\n";
+     int multi = 0;
+     if (!StaticAssembler::Arithmetic(3, m_accumulator, m_memory[m_operand], multi)) {
+          *m_out << "Overflow in the accumulator when executing command\n";
           return;
      }
 
@@ -297,7 +1391,8 @@ SYNOPSIS
 
 DESCRIPTION
 
-    Divide the number present in the accumulator with the number at the specified address.
+    Divide the number present in the accumulator with the number at the specified address. Dividing by
+    zero overflows the accumulator.
 
 RETURNS
 
@@ -314,9 +1409,9 @@ DATE
 /**/
 void emulator::div()
 {
-     int divi = m_accumulator / m_memory[m_operand];
-     if (divi > 999999 || divi < -999999) {
-          cout << "Overflow in the accumulator when executing command\n";
+     int divi = 0;
+     if (!StaticAssembler::Arithmetic(4, m_accumulator, m_memory[m_operand], divi)) {
+          *m_out << "Overflow in the accumulator when executing command\n";
           return;
      }
 
@@ -392,6 +1487,7 @@ DATE
 /**/
 void emulator::store()
 {
+     touch(m_operand);
      m_memory[m_operand] = m_accumulator;
      m_loc++;
 } /* void emulator::store() */
@@ -411,7 +1507,11 @@ SYNOPSIS
 
 DESCRIPTION
 
-    Read a line from the console and place the first 6 digits in the specified address.
+    Read a line from the console and place the first 6 digits in the specified address. With an input log
+    the value is recorded in the log along with the step at which it was read, or in replay mode taken from
+    the log instead of the console. Running out of input stops the program with an error.
+    A program fed through a channel takes its value from the channel, and if none is waiting there
+    yet, stops without taking the step so that runSlice returns and can resume it.
 
 RETURNS
 
@@ -429,8 +1529,39 @@ DATE
 void emulator::read()
 {
      string input;
-     cout << "? ";
-     cin >> input;
+
+     // A program fed through a channel waits for a value instead of blocking, before it prompts for it.
+     if (m_channel != NULL && !m_replay && !m_channel->HasInput() && !m_channel->Closed()) {
+          m_waiting = W_Input;
+          m_kill = true;
+          return;
+     }
+     *m_out << "? ";
+
+     // A replayed value was checked when it was recorded.
+     int value = 0;
+     if (m_replay) {
+          if (!m_inputLog->Next(m_steps, value)) {
+               m_kill = true;
+               return;
+          }
+          if (value == InputLog::INVALID) {
+               *m_out << "Input is not all digits\n";
+               return;
+          }
+          touch(m_operand);
+          m_memory[m_operand] = value;
+          m_loc++;
+          STATS_ADD(CT_Reads, 1);
+          return;
+     }
+
+     if (m_channel != NULL ? !m_channel->Next(input) : !(*m_in >> input)) {
+          string error = "No input left to read (step " + to_string(m_steps) + ")";
+          Errors::RecordError(error);
+          m_kill = true;
+          return;
+     }
 
      char sign = 'z';
      if (input[0] == '-' || input[0] == '+') {
@@ -442,17 +1573,27 @@ void emulator::read()
      if(input.size() > 6)
           input = input.substr(0, 6);
 
+     // A sign alone is not a number either.
+     bool digits = !input.empty();
      for (int i = 0; i < input.size(); i++) {
-          if (!isdigit(input[i])) {
-               cout << "Input is not all digits\n";
-               return;
-          }
+          if (!isdigit(input[i]))
+               digits = false;
+     }
+     if (!digits) {
+          *m_out << "Input is not all digits\n";
+          if (m_inputLog != NULL)
+               m_inputLog->Record(m_steps, InputLog::INVALID);
+          return;
      }
 
+     touch(m_operand);
      m_memory[m_operand] = stoi(input);
      if (sign == '-')
           m_memory[m_operand] *= -1;
+     if (m_inputLog != NULL)
+          m_inputLog->Record(m_steps, m_memory[m_operand]);
      m_loc++;
+     STATS_ADD(CT_Reads, 1);
 } /* void emulator::read() */
 
 
@@ -470,7 +1611,9 @@ SYNOPSIS
 
 DESCRIPTION
 
-    Write the contents of the specified address to the console.
+    Write the contents of the specified address to the console. A program fed through a channel
+    whose output is full stops without taking the step, so that runSlice returns and can resume it
+    once the output has been taken.
 
 RETURNS
 
@@ -487,8 +1630,14 @@ DATE
 /**/
 void emulator::write()
 {
-     cout << m_memory[m_operand] << endl;
+     if (m_channel != NULL && m_channel->Full()) {
+          m_waiting = W_Output;
+          m_kill = true;
+          return;
+     }
+     *m_out << m_memory[m_operand] << endl;
      m_loc++;
+     STATS_ADD(CT_Writes, 1);
 } /* void emulator::write() */
 
 
@@ -641,6 +1790,47 @@ void emulator::bp()
 } /* void emulator::bp() */
 
 
+/**/
+/*
+emulator::invalid(int a_step)
+
+NAME
+
+    emulator::invalid - stop at an invalid opcode.
+
+SYNOPSIS
+
+    void emulator::invalid(int a_step);
+    a_step    --> the step being taken.
+
+DESCRIPTION
+
+    A word whose opcode is not 0 to 13 cannot be executed. Such a word used to be stepped on until
+    the steps ran out; now the program stops with an error saying where. runDecoded also comes here
+    when the program runs past the end of memory.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void emulator::invalid(int a_step)
+{
+     string error = m_loc >= MEMSZ ? "The program ran past the end of memory" : "Invalid opcode at location " + to_string(m_loc);
+     error += " (step " + to_string(a_step) + ")";
+     Errors::RecordError(error);
+     m_kill = true;
+} /* void emulator::invalid(int a_step) */
+
+
 /**/
 /*
 emulator::halt()
@@ -25,27 +25,185 @@ DATE
 /**/
 
 
+#include "StaticAssembler.h"
+
+class Channel;
+class Coverage;
+class InputLog;
+
 class emulator {
 
 public:
 
-    const static int MEMSZ = 10000;	// The size of the memory of the VC3600.
+    const static int MEMSZ = StaticAssembler::MEMSZ;	// The size of the memory of the VC3600.
+
+    // What a program fed through a channel is waiting for when runSlice returns.
+    enum Waiting {
+        W_Nothing,      // It is not waiting.
+        W_Input,        // A read found no value in the channel.
+        W_Output        // A write found the output of the channel full.
+    };
+
     emulator() {
 
         memset( m_memory, 0, MEMSZ * sizeof(int) );
         m_accumulator = 0;
         m_org = 0; 
+        m_loc = 0;
+        m_opcode = 0;
+        m_operand = 0;
         m_firstInst = true;
         m_kill = false;
+        m_steps = 0;
+        m_startSteps = 0;
+        m_coverage = NULL;
+        m_inputLog = NULL;
+        m_replay = false;
+        m_verified = false;
+        m_decodedValid = false;
+        m_endSteps = MEMSZ;
+        m_in = &cin;
+        m_out = &cout;
+        m_channel = NULL;
+        m_waiting = W_Nothing;
 
+        // Until a snapshot is taken, reset goes back to this, and no words are logged.
+        m_snapshot.m_org = 0;
+        m_snapshot.m_accumulator = 0;
+        m_snapshot.m_startSteps = 0;
+        m_snapshot.m_firstInst = true;
+        m_snapshot.m_verified = false;
+        m_snapshot.m_decodedValid = false;
     }
 
     // Records instructions and data into VC3600 memory.
     bool insertMemory( int a_location, int a_contents );
+
+    // Records a block of consecutive words into VC3600 memory.
+    bool insertBlock( int a_location, const int *a_contents, int a_count );
+
+    // Sets the location of the first instruction to be executed.
+    bool setOrigin( int a_location );
     
+    // Sets the accumulator and the number of steps already taken when the program starts.
+    void setStartState( int a_accumulator, int a_steps ) {
+
+        m_accumulator = a_accumulator;
+        m_startSteps = a_steps;
+    }
+
     // Runs the VC3600 program recorded in memory.
     bool runProgram( );
 
+    // Make the memory and state now the ones reset goes back to, usually once the program is loaded.
+    void snapshot( );
+
+    // Go back to the memory and state of the last snapshot, restoring only the words written since.
+    void reset( );
+
+    // The number of words written since the last snapshot or reset.
+    int dirtyCount( ) const {
+
+        return (int)m_undo.size();
+    }
+
+    // The location of a word written since the last snapshot or reset, from 0 to dirtyCount() - 1.
+    int dirtyLocation( int a_index ) const {
+
+        return m_undo[a_index].m_loc;
+    }
+
+    // Write back words that the program wrote in an earlier run, keeping its verification.
+    void restoreWords( int a_location, const int *a_words, int a_count );
+
+    // Pick up a program saved from an earlier run where it left off, keeping its verification.
+    void setResumeState( int a_location, int a_accumulator, int a_steps ) {
+
+        m_org = a_location;
+        m_accumulator = a_accumulator;
+        m_startSteps = a_steps;
+        m_kill = false;
+    }
+
+    // Runs the program for at most a_steps steps, or until it waits for its channel, so that it can be
+    // resumed by calling this again.
+    bool runSlice( int a_steps );
+
+    // Checks and decodes the program now in memory, so runProgram can use the fast loops.
+    bool verify( );
+
+    // Runs the program on the general loop even if it was verified.
+    bool runChecked( );
+
+    // Runs the program until it would read, write, halt or overflow, and makes that the start of the program.
+    int runPrefix( int a_maxSteps, double a_maxSeconds );
+
+    // To access the state of the emulator.
+    const int *memory( ) const {
+
+        return m_memory;
+    }
+    int origin( ) const {
+
+        return m_org;
+    }
+    int accumulator( ) const {
+
+        return m_accumulator;
+    }
+    int startSteps( ) const {
+
+        return m_startSteps;
+    }
+
+    // Check if the program passed verify since it was last changed.
+    bool verified( ) const {
+
+        return m_verified;
+    }
+
+    // What the program was waiting for when runSlice last returned.
+    Waiting waitingFor( ) const {
+
+        return m_waiting;
+    }
+
+    // Check if the channel now has what the program was waiting for, so runSlice can go on.
+    bool channelReady( ) const;
+
+    // Check if the last run halted or was stopped by an error.
+    bool halted( ) const {
+
+        return m_kill;
+    }
+
+    // The number of words stepped through by the last run, including skipped data words.
+    int stepCount( ) const {
+
+        return m_steps;
+    }
+
+    // Record the coverage of the following runs in a_coverage, or stop recording it if NULL.
+    void setCoverage( Coverage *a_coverage );
+
+    // Record the values read in a_log, or with a_replay, read the values from a_log instead of the console.
+    void setInputLog( InputLog *a_log, bool a_replay ) {
+
+        m_inputLog = a_log;
+        m_replay = a_replay;
+    }
+
+    // Read the values and write the output of the program through these streams instead of the console.
+    void setStreams( istream *a_in, ostream *a_out ) {
+
+        m_in = a_in;
+        m_out = a_out;
+    }
+
+    // Read the values and write the output of the program through a_channel, waiting instead of blocking,
+    // or through the console again if NULL.
+    void setChannel( Channel *a_channel );
+
 private:
 
     int m_memory[MEMSZ];           // The memory of the VC3600.
@@ -59,6 +217,77 @@ private:
     int m_operand;                 // Store the operand for the current statement
 
     bool m_kill;                   // Kill switch to be switched on by the halt or other statement where required
+    int m_steps;                   // Number of steps taken by the last run, or the step being taken by read
+    int m_startSteps;              // Number of steps already taken when the program starts
+    Coverage *m_coverage;          // Where the coverage of a run is recorded, NULL if it is not
+    InputLog *m_inputLog;          // Where the values read are recorded or replayed from, NULL if nowhere
+    bool m_replay;                 // == true if the values are replayed from m_inputLog
+    int m_endSteps;                // The step the run stops at if it has not halted: MEMSZ, or the end of a slice
+    istream *m_in;                 // Where the values read come from
+    ostream *m_out;                // Where the output of the program goes
+    Channel *m_channel;            // The channel the program is fed through, NULL if there is none
+    Waiting m_waiting;             // What the program is waiting for, W_Nothing if it is not
+
+    // A word decoded once, for the fast loops. Opcodes that are not valid are decoded as INVALID_OPCODE.
+    struct Decoded {
+        int16_t m_opcode;
+        int16_t m_operand;
+    };
+    const static int INVALID_OPCODE = 14;
+
+    bool m_verified;               // == true if the program passed verify, so it cannot change its code
+    bool m_decodedValid;           // == true if m_decoded holds the words of memory, decoded by verify
+    vector<Decoded> m_decoded;     // The words of memory decoded, and an invalid word past the end of memory. Empty until the first verify
+
+    // A word written since the snapshot, and what it held then.
+    struct Undo {
+        int m_loc;
+        int m_word;
+    };
+    // Both are empty until the first snapshot, so an emulator that is never reset does not carry them.
+    vector<uint8_t> m_dirty;       // != 0 for the words written since the snapshot
+    vector<Undo> m_undo;           // The words written since the snapshot, in the order they were first written
+
+    // The state of the snapshot, besides the memory.
+    struct Snapshot {
+        int m_org;
+        int m_accumulator;
+        int m_startSteps;
+        bool m_firstInst;
+        bool m_verified;
+        bool m_decodedValid;
+    };
+    Snapshot m_snapshot;
+
+    // Remember the contents of a word before it is first written after the snapshot.
+    inline void touch( int a_loc ) {
+
+        if( !m_dirty.empty( ) && m_dirty[a_loc] == 0 ) {
+            m_dirty[a_loc] = 1;
+            Undo undo = { a_loc, m_memory[a_loc] };
+            m_undo.push_back( undo );
+        }
+    }
+
+    // Run the program on the loop that suits it, until it stops or reaches m_endSteps.
+    bool runLoop();
+
+    // The loop of runProgram, compiled once with and once without recording coverage.
+    template <bool COVERAGE> bool run();
+
+    // The loop of runProgram on the decoded words. With PATCHING the program may change its code,
+    // so every store and read keeps m_decoded up to date. With COVERAGE the run is recorded as in run.
+    template <bool PATCHING, bool COVERAGE> bool runDecoded();
+
+    // Bring the decoded word at a location up to date after it was written.
+    // Returns 1 if only the operand of an instruction changed, 2 if an instruction was decoded again, 0 otherwise.
+    int patch( int a_loc );
+
+    // Decode a word.
+    static Decoded decode( int a_word );
+
+    // Check if the arithmetic instruction about to be executed would overflow or divide by zero.
+    bool overflows() const;
 
     // Functions for the thirteen possible operations in a VC-3600 computer
     void add();
@@ -74,6 +303,9 @@ private:
     void bz();
     void bp();
     void halt();
+
+    // Stops the program at a word that has no valid opcode.
+    void invalid( int a_step );
 };
 
 #endif
@@ -7,6 +7,15 @@
 //since this is a static vector, this needs to be included here to work
 static vector<string> m_ErrorMsgs;
 
+// Where errors of the current thread are collected when they are not kept in m_ErrorMsgs.
+static thread_local vector<string> *m_CaptureMsgs = NULL;
+
+// The error list of the current thread.
+static inline vector<string> &ErrorList()
+{
+     return (m_CaptureMsgs != NULL) ? *m_CaptureMsgs : m_ErrorMsgs;
+}
+
 /**/
 /*
 Errors::InitErrorReporting()
@@ -21,7 +30,8 @@ SYNOPSIS
 
 DESCRIPTION
 
-    Initialize the class for error reporting. This is done by clearing the vector that stores all the errors.
+    Initialize the class for error reporting. This is done by clearing the vector that stores all the errors,
+    or the vector errors are being captured in.
 
 RETURNS
 
@@ -38,7 +48,7 @@ DATE
 /**/
 void Errors::InitErrorReporting()
 {
-     m_ErrorMsgs.clear();
+     ErrorList().clear();
 } /* void Errors::InitErrorReporting() */
 
 
@@ -58,6 +68,7 @@ SYNOPSIS
 DESCRIPTION
 
     This function records errors into a vector so they can be used to keep a log of the errors.
+    If the calling thread is capturing errors they go into its own vector instead.
 
 RETURNS
 
@@ -74,13 +85,13 @@ DATE
 /**/
 void Errors::RecordError(string & a_emsg)
 {
-     m_ErrorMsgs.push_back(a_emsg);
+     ErrorList().push_back(a_emsg);
 } /* void Errors::RecordError(string & a_emsg) */
 
 
 /**/
 /*
-Errors::DisplayErrors()
+Errors::DisplayErrors(ostream &a_out)
 
 NAME
 
@@ -88,7 +99,8 @@ NAME
 
 SYNOPSIS
 
-    void Errors::DisplayErrors();
+    void Errors::DisplayErrors(ostream &a_out);
+    a_out         --> the stream the errors are written to. defaults to the console.
 
 DESCRIPTION
 
@@ -107,13 +119,14 @@ DATE
 
 */
 /**/
-void Errors::DisplayErrors()
+void Errors::DisplayErrors(ostream &a_out)
 {
      int count = 0;
-     for (vector<string>::iterator it = m_ErrorMsgs.begin(); it != m_ErrorMsgs.end(); ++it) {
-          cout << "!ERROR " << setw(2) << count++ << "! " << *it << endl;
+     vector<string> &errors = ErrorList();
+     for (vector<string>::iterator it = errors.begin(); it != errors.end(); ++it) {
+          a_out << "!ERROR " << setw(2) << count++ << "! " << *it << endl;
      }
-} /* void Errors::DisplayErrors() */
+} /* void Errors::DisplayErrors(ostream &a_out) */
 
 
 /**/
@@ -150,5 +163,46 @@ DATE
 /**/
 bool Errors::Empty()
 {
-     return (m_ErrorMsgs.size() == 0) ? true : false;
+     return (ErrorList().size() == 0) ? true : false;
 } /* bool Errors::Empty() */
+
+
+/**/
+/*
+Errors::CaptureErrors(vector<string> *a_errors)
+
+NAME
+
+    Errors::CaptureErrors - collect the errors of the calling thread.
+
+SYNOPSIS
+
+    vector<string> *Errors::CaptureErrors(vector<string> *a_errors);
+    a_errors      --> the vector the errors are collected in, or NULL to stop collecting.
+
+DESCRIPTION
+
+    Threads that work on separate parts of a job cannot share the error list, since the errors would be
+    recorded out of order and at the same time. While capturing, all the functions of this class work on
+    a_errors for the calling thread. The caller records them in order once all the threads are done.
+
+RETURNS
+
+    The vector errors were captured in before the call, or NULL, so that it can be restored.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+vector<string> *Errors::CaptureErrors(vector<string> *a_errors)
+{
+     vector<string> *previous = m_CaptureMsgs;
+     m_CaptureMsgs = a_errors;
+     return previous;
+} /* vector<string> *Errors::CaptureErrors(vector<string> *a_errors) */
@@ -40,11 +40,14 @@ public:
     static void RecordError( string &a_emsg );
 
     // Displays the collected error message.
-    static void DisplayErrors( );
+    static void DisplayErrors( ostream &a_out = cout );
 
     // Check if the error list is empty.
     static bool Empty();
 
+    // Collect the errors of the calling thread in a_errors. NULL uses the shared list again. Returns the previous list.
+    static vector<string> *CaptureErrors( vector<string> *a_errors );
+
 private:
 
 
@@ -3,11 +3,12 @@
 //
 #include "stdafx.h"
 #include "FileAccess.h"
+#include "Stats.h"
 
 
 /**/
 /*
-FileAccess::FileAccess( int argc, char *argv[] )
+FileAccess::FileAccess( const string &a_fileName )
 
 NAME
 
@@ -15,13 +16,12 @@ NAME
 
 SYNOPSIS
 
-    FileAccess::FileAccess( int argc, char *argv[] );
-    argc    --> total number of arguments pass through the terminal. should be two.
-    *argv[] --> array of arguments passed from the terminal. second argument in the array is supposed to be the file name for the source file.
+    FileAccess::FileAccess( const string &a_fileName );
+    a_fileName --> name of the source file. this is the file name given on the command line.
 
 DESCRIPTION
 
-    Initialize the class by opening the file passed as a command line argument. Report errors if file does not exist or could not be opened.
+    Initialize the class by opening the source file. Report errors if file does not exist or could not be opened.
 
 RETURNS
 
@@ -36,15 +36,10 @@ DATE
 
 */
 /**/
-FileAccess::FileAccess( int argc, char *argv[] )
+FileAccess::FileAccess( const string &a_fileName )
 {
-    // Check that there is exactly one run time parameter.
-    if( argc != 2 ) {
-        cerr << "Usage: Assem <FileName>" << endl;
-        exit( 1 );
-    }
     // Open the file.
-    m_sfile.open( argv[1], ios::in );
+    m_sfile.open( a_fileName.c_str(), ios::in );
 
     // If the open failed, report the error and terminate.
     if( ! m_sfile ) {
@@ -52,7 +47,7 @@ FileAccess::FileAccess( int argc, char *argv[] )
             << endl;
         exit( 1 ); 
     }
-} /* FileAccess::FileAccess( int argc, char *argv[] ) */
+} /* FileAccess::FileAccess( const string &a_fileName ) */
 
 
 /**/
@@ -138,6 +133,92 @@ bool FileAccess::GetNextLine( string &a_buff )
 } /* bool FileAccess::GetNextLine( string &a_buff ) */
 
 
+/**/
+/*
+FileAccess::GetAllLines( vector<string> &a_lines )
+
+NAME
+
+    FileAccess::GetAllLines - read the whole source code.
+
+SYNOPSIS
+
+    void FileAccess::GetAllLines( vector<string> &a_lines );
+    a_lines    --> the vector the lines of the file are stored in.
+
+DESCRIPTION
+
+    Rewind the file and read every line into a_lines, giving the same lines that repeated calls to
+    GetNextLine would. Having all the lines in memory lets the assembler split them between threads.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void FileAccess::GetAllLines( vector<string> &a_lines )
+{
+    STATS_TIMER( timer, PH_ReadFile );
+    rewind( );
+    a_lines.clear( );
+
+    string buff;
+    while( GetNextLine( buff ) ) {
+        a_lines.push_back( buff );
+    }
+    STATS_ADD( CT_LinesRead, a_lines.size() );
+} /* void FileAccess::GetAllLines( vector<string> &a_lines ) */
+
+
+/**/
+/*
+FileAccess::GetAllText( string &a_text )
+
+NAME
+
+    FileAccess::GetAllText - read the whole text of the source code.
+
+SYNOPSIS
+
+    void FileAccess::GetAllText( string &a_text );
+    a_text    --> the text of the file is stored here.
+
+DESCRIPTION
+
+    Rewind the file and read all of it into a_text, with the line endings GetNextLine sees. The lines
+    are then the text up to each new line, and the text after the last one, even if it is empty.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void FileAccess::GetAllText( string &a_text )
+{
+    STATS_TIMER( timer, PH_ReadFile );
+    rewind( );
+    ostringstream text;
+    text << m_sfile.rdbuf( );
+    a_text = text.str( );
+} /* void FileAccess::GetAllText( string &a_text ) */
+
+
 /**/
 /*
 FileAccess::rewind( )
@@ -174,4 +255,4 @@ void FileAccess::rewind( )
     m_sfile.clear();
     m_sfile.seekg( 0, ios::beg );
 } /* void FileAccess::rewind( ) */
-    
\ No newline at end of file
+    
@@ -12,7 +12,7 @@ NAME
 DESCRIPTION
 
      FileAccess class - class to open and read the source code file.
-     Source code file is provided as a command line argument.
+     Source code file is named on the command line.
 
 AUTHOR
 
@@ -35,7 +35,7 @@ class FileAccess {
 public:
 
     // Opens the file.
-    FileAccess( int argc, char *argv[] );
+    FileAccess( const string &a_fileName );
 
     // Closes the file.
     ~FileAccess( );
@@ -43,6 +43,12 @@ public:
     // Get the next line from the source file.
     bool GetNextLine( string &a_buff );
 
+    // Read all the lines of the source file.
+    void GetAllLines( vector<string> &a_lines );
+
+    // Read the whole text of the source file.
+    void GetAllText( string &a_text );
+
     // Put the file pointer back to the beginning of the file.
     void rewind( );
 
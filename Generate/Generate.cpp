@@ -0,0 +1,81 @@
+ /**/
+ /*
+ Generate
+
+ NAME
+
+     Generate - write synthetic VC-3600 programs.
+
+ DESCRIPTION
+
+     Generate - writes a valid VC-3600 program of the requested size and shape with the
+     ProgramGenerator class, for scale and stress testing of the assembler and the emulator.
+     The same seed and options always give the same program.
+
+         Generate [-s <seed>] [-n <instructions>] [-l <labels>] [-f <forward ratio>] [-d <loop depth>]
+                  [-D <data density>] [-i <i/o frequency>] [-m] [-o <FileName>]
+
+     -m sets aside storage up to the last word of memory. Without -o the program is written to the
+     standard output. It is built from ProgramGenerator.cpp with the top level directory on the
+     include path.
+
+ AUTHOR
+
+     Abish Jha
+
+ DATE
+
+     12/05/2017
+
+ */
+ /**/
+
+#include "stdafx.h"
+
+#include "ProgramGenerator.h"
+
+int main( int argc, char *argv[] )
+{
+    uint32_t seed = 1;
+    string fileName;
+    ProgramGenerator::Shape shape = ProgramGenerator::DefaultShape();
+
+    for( int i = 1; i < argc; i++ ) {
+        string arg = argv[i];
+        if( arg == "-m" ) {
+            shape.m_fillMemory = true;
+            continue;
+        }
+        if( i + 1 >= argc || arg.size() != 2 || arg[0] != '-' || string( "snlfdDio" ).find( arg[1] ) == string::npos ) {
+            cerr << "Usage: Generate [-s <seed>] [-n <instructions>] [-l <labels>] [-f <forward ratio>] [-d <loop depth>]" << endl;
+            cerr << "                [-D <data density>] [-i <i/o frequency>] [-m] [-o <FileName>]" << endl;
+            return 1;
+        }
+        const char *value = argv[++i];
+        switch( arg[1] ) {
+        case 's': seed = (uint32_t)strtoul( value, NULL, 10 ); break;
+        case 'n': shape.m_lines = max( 0, atoi( value ) ); break;
+        case 'l': shape.m_labels = max( 0, atoi( value ) ); break;
+        case 'f': shape.m_forwardRatio = atof( value ); break;
+        case 'd': shape.m_loopDepth = max( 0, atoi( value ) ); break;
+        case 'D': shape.m_dataDensity = atof( value ); break;
+        case 'i': shape.m_ioFrequency = atof( value ); break;
+        case 'o': fileName = value; break;
+        }
+    }
+
+    ProgramGenerator generator( seed );
+    if( fileName.empty() ) {
+        generator.Generate( shape, cout );
+        return 0;
+    }
+
+    ofstream file( fileName.c_str(), ios::out | ios::trunc );
+    generator.Generate( shape, file );
+    file.close();
+    if( file.fail() ) {
+        cerr << "Could not write " << fileName << endl;
+        return 1;
+    }
+    return 0;
+}
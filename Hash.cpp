@@ -0,0 +1,203 @@
+//
+//      Implementation of the Hash class.
+//
+#include "stdafx.h"
+#include "Hash.h"
+
+
+/**/
+/*
+Hash::Fnv1a32(const void *a_data, size_t a_size, uint32_t a_seed)
+
+NAME
+
+    Hash::Fnv1a32 - 32 bit FNV-1a hash.
+
+SYNOPSIS
+
+    uint32_t Hash::Fnv1a32(const void *a_data, size_t a_size, uint32_t a_seed);
+    a_data    --> the memory to be hashed.
+    a_size    --> the number of bytes to be hashed.
+    a_seed    --> the starting value of the hash. defaults to the FNV offset basis.
+
+DESCRIPTION
+
+    Compute the 32 bit Fowler-Noll-Vo (FNV-1a) hash of a block of memory. This is used as the
+    checksum of the object image files.
+
+RETURNS
+
+    The 32 bit hash of the data.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+uint32_t Hash::Fnv1a32(const void *a_data, size_t a_size, uint32_t a_seed)
+{
+     const unsigned char *data = static_cast<const unsigned char *>(a_data);
+     uint32_t hash = a_seed;
+     for (size_t i = 0; i < a_size; i++) {
+          hash ^= data[i];
+          hash *= 16777619u;
+     }
+     return hash;
+} /* uint32_t Hash::Fnv1a32(const void *a_data, size_t a_size, uint32_t a_seed) */
+
+
+/**/
+/*
+Hash::Fnv1a64(const void *a_data, size_t a_size, uint64_t a_seed)
+
+NAME
+
+    Hash::Fnv1a64 - 64 bit FNV-1a hash.
+
+SYNOPSIS
+
+    uint64_t Hash::Fnv1a64(const void *a_data, size_t a_size, uint64_t a_seed);
+    a_data    --> the memory to be hashed.
+    a_size    --> the number of bytes to be hashed.
+    a_seed    --> the starting value of the hash. defaults to the FNV offset basis.
+
+DESCRIPTION
+
+    Compute the 64 bit Fowler-Noll-Vo (FNV-1a) hash of a block of memory.
+
+RETURNS
+
+    The 64 bit hash of the data.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+uint64_t Hash::Fnv1a64(const void *a_data, size_t a_size, uint64_t a_seed)
+{
+     const unsigned char *data = static_cast<const unsigned char *>(a_data);
+     uint64_t hash = a_seed;
+     for (size_t i = 0; i < a_size; i++) {
+          hash ^= data[i];
+          hash *= 1099511628211ull;
+     }
+     return hash;
+} /* uint64_t Hash::Fnv1a64(const void *a_data, size_t a_size, uint64_t a_seed) */
+
+
+/**/
+/*
+Hash::Sha256(const void *a_data, size_t a_size)
+
+NAME
+
+    Hash::Sha256 - SHA-256 hash.
+
+SYNOPSIS
+
+    string Hash::Sha256(const void *a_data, size_t a_size);
+    a_data    --> the memory to be hashed.
+    a_size    --> the number of bytes to be hashed.
+
+DESCRIPTION
+
+    Compute the SHA-256 hash of a block of memory, as in FIPS 180-4. Unlike the FNV hashes, it is
+    strong enough that two different sources are taken to never have the same hash, so it can be
+    used to key the image cache without comparing the sources.
+
+RETURNS
+
+    The hash, as 64 lower case hexadecimal digits.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+string Hash::Sha256(const void *a_data, size_t a_size)
+{
+     static const uint32_t ROUND[64] = {
+          0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+          0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+          0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+          0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+          0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+          0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+          0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+          0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+     };
+     uint32_t state[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+     // The message is padded with a one bit, zeros and its length in bits to a multiple of 64 bytes.
+     const unsigned char *data = static_cast<const unsigned char *>(a_data);
+     size_t blocks = (a_size + 8) / 64 + 1;
+     unsigned char tail[128] = { 0 };
+     size_t whole = a_size / 64;
+     size_t rest = a_size % 64;
+     memcpy(tail, data + whole * 64, rest);
+     tail[rest] = 0x80;
+     uint64_t bits = static_cast<uint64_t>(a_size) * 8;
+     for (int i = 0; i < 8; i++)
+          tail[(blocks - whole) * 64 - 1 - i] = static_cast<unsigned char>(bits >> (8 * i));
+
+     for (size_t block = 0; block < blocks; block++) {
+          const unsigned char *chunk = block < whole ? data + block * 64 : tail + (block - whole) * 64;
+          uint32_t w[64];
+          for (int i = 0; i < 16; i++)
+               w[i] = (uint32_t)chunk[4 * i] << 24 | (uint32_t)chunk[4 * i + 1] << 16 | (uint32_t)chunk[4 * i + 2] << 8 | chunk[4 * i + 3];
+          for (int i = 16; i < 64; i++) {
+               uint32_t s0 = (w[i - 15] >> 7 | w[i - 15] << 25) ^ (w[i - 15] >> 18 | w[i - 15] << 14) ^ (w[i - 15] >> 3);
+               uint32_t s1 = (w[i - 2] >> 17 | w[i - 2] << 15) ^ (w[i - 2] >> 19 | w[i - 2] << 13) ^ (w[i - 2] >> 10);
+               w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+          }
+
+          uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+          uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+          for (int i = 0; i < 64; i++) {
+               uint32_t s1 = (e >> 6 | e << 26) ^ (e >> 11 | e << 21) ^ (e >> 25 | e << 7);
+               uint32_t t1 = h + s1 + ((e & f) ^ (~e & g)) + ROUND[i] + w[i];
+               uint32_t s0 = (a >> 2 | a << 30) ^ (a >> 13 | a << 19) ^ (a >> 22 | a << 10);
+               uint32_t t2 = s0 + ((a & b) ^ (a & c) ^ (b & c));
+               h = g;
+               g = f;
+               f = e;
+               e = d + t1;
+               d = c;
+               c = b;
+               b = a;
+               a = t1 + t2;
+          }
+          state[0] += a;
+          state[1] += b;
+          state[2] += c;
+          state[3] += d;
+          state[4] += e;
+          state[5] += f;
+          state[6] += g;
+          state[7] += h;
+     }
+
+     static const char DIGITS[] = "0123456789abcdef";
+     string digest;
+     for (int i = 0; i < 8; i++) {
+          for (int shift = 28; shift >= 0; shift -= 4)
+               digest += DIGITS[(state[i] >> shift) & 0xf];
+     }
+     return digest;
+} /* string Hash::Sha256(const void *a_data, size_t a_size) */
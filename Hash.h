@@ -0,0 +1,45 @@
+#pragma once
+
+/**/
+/*
+Hash Class
+
+NAME
+
+     Hash - hash and checksum functions.
+
+DESCRIPTION
+
+     Hash class - small collection of hash functions used to checksum object images
+     and to key cached data.
+     Note: all members are static so we can access them anywhere.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+
+class Hash {
+
+public:
+
+    // 32 bit FNV-1a hash of a block of memory. Pass a previous result as a_seed to continue a hash.
+    static uint32_t Fnv1a32( const void *a_data, size_t a_size, uint32_t a_seed = 2166136261u );
+
+    // 64 bit FNV-1a hash of a block of memory. Pass a previous result as a_seed to continue a hash.
+    static uint64_t Fnv1a64( const void *a_data, size_t a_size, uint64_t a_seed = 14695981039346656037ull );
+
+    // SHA-256 of a block of memory, as 64 hexadecimal digits.
+    static string Sha256( const void *a_data, size_t a_size );
+
+private:
+
+
+};
@@ -0,0 +1,240 @@
+//
+//      Implementation of the ImageCache class.
+//
+#include "stdafx.h"
+#include "ImageCache.h"
+#include "DebugInfo.h"
+#include "Emulator.h"
+#include "Errors.h"
+#include "Hash.h"
+#include "MappedFile.h"
+#include "ObjectImage.h"
+#include "Stats.h"
+#include "TranslationCache.h"
+
+/**/
+/*
+ImageCache::ImageCache(const string &a_directory, size_t a_maxBytes)
+
+NAME
+
+    ImageCache::ImageCache - open an image cache.
+
+SYNOPSIS
+
+    ImageCache::ImageCache(const string &a_directory, size_t a_maxBytes);
+    a_directory    --> the directory the entries are kept in. It is made when the first one is saved.
+    a_maxBytes     --> the size the files of the cache may take.
+
+DESCRIPTION
+
+    Nothing is read until an entry is looked up.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+ImageCache::ImageCache(const string &a_directory, size_t a_maxBytes)
+     : m_files(a_directory, a_maxBytes, ".vco", Stats::CT_ImageCacheEvictions)
+{
+} /* ImageCache::ImageCache(const string &a_directory, size_t a_maxBytes) */
+
+
+/**/
+/*
+ImageCache::KeyFor(const string &a_sourceFile, const string &a_options)
+
+NAME
+
+    ImageCache::KeyFor - the key of a source file.
+
+SYNOPSIS
+
+    static string ImageCache::KeyFor(const string &a_sourceFile, const string &a_options);
+    a_sourceFile    --> the source file.
+    a_options       --> the options it is assembled with that change what it assembles to.
+
+DESCRIPTION
+
+    Hashes the versions of the cache, of the object image and debug information formats and of the
+    translation of a line, then the options, then the bytes of the source, with SHA-256. Any change
+    to the assembler that changes its output must change one of the versions.
+
+RETURNS
+
+    The key, as 64 hexadecimal digits, or an empty string if the source could not be read or is empty.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+string ImageCache::KeyFor(const string &a_sourceFile, const string &a_options)
+{
+     MappedFile file;
+     if (!file.Open(a_sourceFile))
+          return "";
+
+     ostringstream text;
+     text << "VC3600 image cache " << VERSION << " " << ObjectImage::VERSION << " " << DebugInfo::VERSION << " "
+          << TranslationCache::VERSION << "\n" << a_options << "\n";
+     text.write(reinterpret_cast<const char *>(file.Data()), file.Size());
+     string bytes = text.str();
+     return Hash::Sha256(bytes.data(), bytes.size());
+} /* string ImageCache::KeyFor(const string &a_sourceFile, const string &a_options) */
+
+
+/**/
+/*
+ImageCache::Find(const string &a_key, const string &a_sourceFile, ObjectImage &a_image, DebugInfo &a_debug, vector<string> &a_listing)
+
+NAME
+
+    ImageCache::Find - look up an entry.
+
+SYNOPSIS
+
+    bool ImageCache::Find(const string &a_key, const string &a_sourceFile, ObjectImage &a_image, DebugInfo &a_debug, vector<string> &a_listing);
+    a_key           --> the key from KeyFor.
+    a_sourceFile    --> the source file being assembled.
+    a_image         --> the image is read into this.
+    a_debug         --> the debug information is opened in this.
+    a_listing       --> the sections of the listing are put in this.
+
+DESCRIPTION
+
+    Reads the files of the entry. An entry that is missing a file, or whose files do not check out,
+    is not found, and no error is recorded. The same source may have been saved under another name,
+    in which case the debug information is rebuilt from the cached one with the name of this one,
+    so it names the file that was assembled. The image file is touched so the entry is the last to
+    be evicted.
+
+RETURNS
+
+    'true' if the entry was found,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool ImageCache::Find(const string &a_key, const string &a_sourceFile, ObjectImage &a_image, DebugInfo &a_debug, vector<string> &a_listing)
+{
+     if (a_key.empty())
+          return false;
+
+     // The listing is the number of bytes of each section on a line of its own, followed by the section.
+     a_listing.clear();
+     ifstream listing(m_files.PathFor(a_key, ".lst").c_str(), ios::in | ios::binary);
+     size_t size;
+     while (listing >> size && listing.get() == '\n') {
+          string section(size, '\0');
+          if (size > 0 && !listing.read(&section[0], size))
+               break;
+          a_listing.push_back(section);
+     }
+     bool found = listing.eof() && !a_listing.empty();
+
+     vector<string> errors;      // A bad entry is only a miss.
+     vector<string> *previous = Errors::CaptureErrors(&errors);
+     found = found && a_image.Read(m_files.PathFor(a_key, ".vco")) && a_debug.Open(m_files.PathFor(a_key, ".vcd"));
+     Errors::CaptureErrors(previous);
+     if (!found) {
+          STATS_ADD(CT_ImageCacheMisses, 1);
+          return false;
+     }
+
+     if (a_sourceFile != a_debug.SourceFile()) {
+          vector<pair<int, int>> lines;
+          for (int loc = 0; loc < emulator::MEMSZ; loc++) {
+               int line = a_debug.LineFor(loc);
+               if (line > 0)
+                    lines.push_back(pair<int, int>(loc, line - 1));
+          }
+          a_debug.Build(a_sourceFile, lines, a_image.GetSymbols(), a_image.GetEnd());
+     }
+
+     m_files.Touch(a_key);
+     STATS_ADD(CT_ImageCacheHits, 1);
+     return true;
+} /* bool ImageCache::Find(const string &a_key, const string &a_sourceFile, ObjectImage &a_image, DebugInfo &a_debug, vector<string> &a_listing) */
+
+
+/**/
+/*
+ImageCache::Save(const string &a_key, const ObjectImage &a_image, const DebugInfo &a_debug, const vector<string> &a_listing)
+
+NAME
+
+    ImageCache::Save - save an entry.
+
+SYNOPSIS
+
+    bool ImageCache::Save(const string &a_key, const ObjectImage &a_image, const DebugInfo &a_debug, const vector<string> &a_listing);
+    a_key        --> the key from KeyFor.
+    a_image      --> the object image.
+    a_debug      --> its debug information.
+    a_listing    --> the sections of its listing.
+
+DESCRIPTION
+
+    Writes the files of the entry, the image last, each under a name of its own and then renamed
+    over any file of the same entry saved by another process. Then evicts entries if the cache is too big. The cache only saves work, so nothing it
+    fails to do is recorded as an error.
+
+RETURNS
+
+    'true' if the entry was saved,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool ImageCache::Save(const string &a_key, const ObjectImage &a_image, const DebugInfo &a_debug, const vector<string> &a_listing)
+{
+     if (a_key.empty())
+          return false;
+     vector<string> errors;      // Kept apart from the errors of the assembly.
+     vector<string> *previous = Errors::CaptureErrors(&errors);
+     bool saved = m_files.WriteAtomically(m_files.PathFor(a_key, ".vcd"), [&a_debug](const string &a_path) { return a_debug.Write(a_path); })
+          && m_files.WriteAtomically(m_files.PathFor(a_key, ".lst"), [&a_listing](const string &a_path) {
+               ofstream file(a_path.c_str(), ios::out | ios::binary | ios::trunc);
+               for (size_t i = 0; i < a_listing.size(); i++)
+                    file << a_listing[i].size() << '\n' << a_listing[i];
+               file.close();
+               return !file.fail();
+          })
+          && m_files.WriteAtomically(m_files.PathFor(a_key, ".vco"), [&a_image](const string &a_path) { return a_image.Write(a_path); });
+     Errors::CaptureErrors(previous);
+
+     if (saved)
+          m_files.Evict();
+     return saved;
+} /* bool ImageCache::Save(const string &a_key, const ObjectImage &a_image, const DebugInfo &a_debug, const vector<string> &a_listing) */
@@ -0,0 +1,63 @@
+#pragma once
+
+/**/
+/*
+ImageCache Class
+
+NAME
+
+     ImageCache - a directory of assembled programs, kept by the hash of their source.
+
+DESCRIPTION
+
+     ImageCache class - keeps the object image, the debug information and the listing of the
+     programs assembled, in a directory, under the SHA-256 of the versions of the file formats,
+     the options that change the translation and the bytes of the source. A source that was
+     assembled before with the same options is then loaded from the cache without Pass I or
+     Pass II being done at all, and its listing is printed as it was.
+
+     The files are kept by a DiskCache, with the image as the main file of an entry, which is
+     written last, so a process looking up the entry sees either all of it or no image. Any number
+     of processes may share the directory. When the files of the cache take more than the size
+     allowed, the entries used least recently are deleted until they fit. An entry is used when it
+     is saved or found.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+#include "DiskCache.h"
+
+class ObjectImage;
+class DebugInfo;
+
+class ImageCache {
+
+public:
+
+    const static uint32_t VERSION = 1;              // Changes whenever what is kept in an entry changes.
+    const static int DEFAULT_MEGABYTES = 64;        // Size allowed unless asked otherwise.
+
+    ImageCache( const string &a_directory, size_t a_maxBytes = DEFAULT_MEGABYTES * (size_t)1048576 );
+    ~ImageCache( ) { };
+
+    // The key of a source file assembled with the options given. Empty if the file cannot be read.
+    static string KeyFor( const string &a_sourceFile, const string &a_options );
+
+    // Find an entry. The debug information is rebuilt for a_sourceFile, which may be a copy of the source it was saved for.
+    bool Find( const string &a_key, const string &a_sourceFile, ObjectImage &a_image, DebugInfo &a_debug, vector<string> &a_listing );
+
+    // Save an entry, then delete the entries used least recently if the cache is too big.
+    bool Save( const string &a_key, const ObjectImage &a_image, const DebugInfo &a_debug, const vector<string> &a_listing );
+
+private:
+
+    DiskCache m_files;          // The files of the entries, the image being the main one.
+};
@@ -0,0 +1,240 @@
+//
+//      Implementation of the InputLog class.
+//
+#include "stdafx.h"
+#include "InputLog.h"
+#include "Errors.h"
+
+
+/**/
+/*
+InputLog::Clear()
+
+NAME
+
+    InputLog::Clear - forget all the values.
+
+SYNOPSIS
+
+    void InputLog::Clear();
+
+DESCRIPTION
+
+    Empties the log, so it can record another run.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void InputLog::Clear()
+{
+     m_entries.clear();
+     m_next = 0;
+} /* void InputLog::Clear() */
+
+
+/**/
+/*
+InputLog::Record(int a_step, int a_value)
+
+NAME
+
+    InputLog::Record - record a value.
+
+SYNOPSIS
+
+    void InputLog::Record(int a_step, int a_value);
+    a_step     --> the step of the run at which the value was read.
+    a_value    --> the value, or INVALID if the input was not a number.
+
+DESCRIPTION
+
+    Adds the value at the end of the log.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void InputLog::Record(int a_step, int a_value)
+{
+     Entry entry = { static_cast<uint32_t>(a_step), a_value };
+     m_entries.push_back(entry);
+} /* void InputLog::Record(int a_step, int a_value) */
+
+
+/**/
+/*
+InputLog::Next(int a_step, int &a_value)
+
+NAME
+
+    InputLog::Next - replay the next value.
+
+SYNOPSIS
+
+    bool InputLog::Next(int a_step, int &a_value);
+    a_step     --> the step of the run at which the program reads.
+    a_value    --> set to the value read.
+
+DESCRIPTION
+
+    Gives the next value of the log. A value recorded at another step means the program or its memory
+    is not the one that was recorded, and the run would go its own way, so it is reported as an error.
+
+RETURNS
+
+    'true' if the value was recorded at a_step,
+    'false' if the log has no more values or does not match the run.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool InputLog::Next(int a_step, int &a_value)
+{
+     if (m_next >= m_entries.size()) {
+          string error = "The input log has no more values (step " + to_string(a_step) + ")";
+          Errors::RecordError(error);
+          return false;
+     }
+     if (m_entries[m_next].m_step != static_cast<uint32_t>(a_step)) {
+          string error = "The input log does not match the run: the value was read at step "
+               + to_string(m_entries[m_next].m_step) + ", not at step " + to_string(a_step);
+          Errors::RecordError(error);
+          return false;
+     }
+     a_value = m_entries[m_next++].m_value;
+     return true;
+} /* bool InputLog::Next(int a_step, int &a_value) */
+
+
+/**/
+/*
+InputLog::Read(const string &a_fileName)
+
+NAME
+
+    InputLog::Read - read the log from a file.
+
+SYNOPSIS
+
+    bool InputLog::Read(const string &a_fileName);
+    a_fileName    --> name of the log file.
+
+DESCRIPTION
+
+    Replaces the values with the ones saved in the file and rewinds the log.
+
+RETURNS
+
+    'true' if the log was read,
+    'false' if the file could not be read or is not an input log.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool InputLog::Read(const string &a_fileName)
+{
+     Clear();
+     ifstream file(a_fileName.c_str(), ios::in | ios::binary);
+
+     uint32_t header[3];
+     if (!file || !file.read(reinterpret_cast<char *>(header), sizeof(header)) || header[0] != MAGIC || header[1] != VERSION) {
+          string error = a_fileName + " is not an input log";
+          Errors::RecordError(error);
+          return false;
+     }
+
+     // Read the entries one at a time, so a damaged count runs into the end of the file rather than allocating a huge log.
+     for (uint32_t i = 0; i < header[2]; i++) {
+          Entry entry;
+          if (!file.read(reinterpret_cast<char *>(&entry), sizeof(entry))) {
+               Clear();
+               string error = a_fileName + " is not an input log";
+               Errors::RecordError(error);
+               return false;
+          }
+          m_entries.push_back(entry);
+     }
+     return true;
+} /* bool InputLog::Read(const string &a_fileName) */
+
+
+/**/
+/*
+InputLog::Write(const string &a_fileName)
+
+NAME
+
+    InputLog::Write - save the log to a file.
+
+SYNOPSIS
+
+    bool InputLog::Write(const string &a_fileName) const;
+    a_fileName    --> name of the log file.
+
+DESCRIPTION
+
+    Writes the header and the values, replacing the previous contents of the file.
+
+RETURNS
+
+    'true' if the log was saved,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool InputLog::Write(const string &a_fileName) const
+{
+     uint32_t header[3] = { MAGIC, VERSION, static_cast<uint32_t>(m_entries.size()) };
+
+     ofstream file(a_fileName.c_str(), ios::out | ios::binary | ios::trunc);
+     file.write(reinterpret_cast<const char *>(header), sizeof(header));
+     file.write(reinterpret_cast<const char *>(m_entries.data()), m_entries.size() * sizeof(Entry));
+     file.close();
+     if (!file) {
+          string error = "Could not write the input log " + a_fileName;
+          Errors::RecordError(error);
+          return false;
+     }
+     return true;
+} /* bool InputLog::Write(const string &a_fileName) const */
@@ -0,0 +1,85 @@
+#pragma once
+
+/**/
+/*
+InputLog Class
+
+NAME
+
+     InputLog - the values a program read, so a run can be replayed.
+
+DESCRIPTION
+
+     InputLog class - while a program runs, the emulator can record in the log every value
+     read gives it, together with the step of the run at which it was read. Replaying the log
+     later gives the program the same values at the same steps without reading the console,
+     so the run is repeated exactly and needs nobody to type anything. Input that was not a
+     number is recorded too, since the program reacts to it.
+
+     File layout, all fields are little-endian 32 bit words:
+
+         header      magic "VCIL", version, number of entries.
+         entries     step, value; INVALID as the value for input that was not a number.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+
+class InputLog {
+
+public:
+
+    const static uint32_t MAGIC = 0x4C494356;   // "VCIL" read as a little-endian word.
+    const static uint32_t VERSION = 1;          // Current version of the file format.
+
+    const static int32_t INVALID = INT32_MIN;   // Value recorded for input that was not a number.
+
+    // A value given to read.
+    struct Entry {
+        uint32_t m_step;        // The step of the run at which it was read.
+        int32_t m_value;        // The value, or INVALID.
+    };
+
+    InputLog( ) : m_next( 0 ) { };
+    ~InputLog( ) { };
+
+    // Forget all the values.
+    void Clear( );
+
+    // Record a value read at a step.
+    void Record( int a_step, int a_value );
+
+    // Replay the next value, which must have been read at a_step. Records an error if there is none.
+    bool Next( int a_step, int &a_value );
+
+    // Start replaying from the first value again.
+    inline void Rewind( ) {
+
+        m_next = 0;
+    };
+
+    // To access the number of values.
+    inline size_t Size( ) const {
+
+        return m_entries.size();
+    };
+
+    // Read the log from a file.
+    bool Read( const string &a_fileName );
+
+    // Save the log to a file.
+    bool Write( const string &a_fileName ) const;
+
+private:
+
+    vector<Entry> m_entries;    // The values in the order they were read.
+    size_t m_next;              // Index of the next value to replay.
+};
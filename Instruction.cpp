@@ -2,6 +2,7 @@
 #include "Instruction.h"
 #include "Errors.h"
 #include "SymTab.h"
+#include "StaticAssembler.h"
 
 
 /**/
@@ -75,6 +76,10 @@ Instruction::InstructionType Instruction::ParseInstruction(string & a_buff)
      else if (to_lower(m_parsed_inst[0]) == "end")
           m_type = InstructionType(3); //end instruction
 
+     // Linkage statements of a module
+     else if (to_lower(m_parsed_inst[0]) == "import" || m_parsed_inst[0] == "export")
+          m_type = InstructionType(1); //assembler instruction
+
      // The instruction has only two fields : opcode and operand
      else if (m_parsed_inst.size() == 2)
           m_type = InstructionType(0); //assembly language instruction
@@ -94,34 +99,32 @@ Instruction::InstructionType Instruction::ParseInstruction(string & a_buff)
 
 /**/
 /*
-Instruction::TranslateInstruction(string & a_buff, int a_loc)
+Instruction::TranslateInstruction(string & a_buff, int a_loc, const SymbolTable &a_symtab)
 
 NAME
 
-    Instruction::TranslateInstruction - initializer for the FileAccess class.
+    Instruction::TranslateInstruction - translate an instruction into machine code.
 
 SYNOPSIS
 
-    pair<int, string> Instruction::TranslateInstruction(string & a_buff, int a_loc);
-    a_buff    --> this argument is the line from the source code that is to be translated.
-    a_loc     --> the location of the instruction for the VC-3600 translated code.
+    Instruction::Translation Instruction::TranslateInstruction(string & a_buff, int a_loc, const SymbolTable &a_symtab);
+    a_buff      --> this argument is the line from the source code that is to be translated.
+    a_loc       --> the location of the instruction for the VC-3600 translated code.
+    a_symtab    --> the symbol table the operands are looked up in.
 
 DESCRIPTION
 
     This function translates instructions in the source code and generates the equivalent machine code for the
     VC-3600 compiler. Function also extensively deals with errors encountered in the source code and reports them 
-    as necessary. 
+    as necessary. The machine word is built as an integer; formatting it for the listing is left to the caller.
 
 RETURNS
 
-    a pair with the first element of type int, and the second element of type string.
-        the first element is the location of the instruction being translated, and
-        the second element is the six digit op-code + operand combo for the emulator.
-    
-    Special Case:
-    returns first -> 0, and second -> "end" in a pair to indicate end statement for the code.
-    returns first -> 0, and second -> "n/a" in a pair to indicate instructions not meant for the emulator 
-        i.e. which should not be stored in the memory to be passed to the emulator to emulate, e.g. declaring storage or constant.
+    a variable of datatype 'Instruction::Translation' holding
+        the status of the translation, which tells whether the line produced a word for the emulator's memory,
+        the location of the instruction being translated,
+        the six digit op-code + operand combo (or the constant) for the emulator, and
+        the number of trailing digits of the word that could not be translated because of errors.
 
 AUTHOR
 
@@ -133,10 +136,11 @@ DATE
 
 */
 /**/
-pair<int, string> Instruction::TranslateInstruction(string & a_buff, int a_loc)
+Instruction::Translation Instruction::TranslateInstruction(string & a_buff, int a_loc, const SymbolTable &a_symtab)
 {
      // Parse the line and get the instruction type.
      Instruction::InstructionType st = ParseInstruction(a_buff);
+     Translation translation = { TS_Comment, a_loc, 0, 0 };
 
      // If the instruction has more that three words, it must be an error
      if (m_parsed_inst.size() > 3) {
@@ -146,50 +150,40 @@ pair<int, string> Instruction::TranslateInstruction(string & a_buff, int a_loc)
 
      // For InstructionType(0) -- assembly language instruction which returns the machine code equivalent
      if (st == InstructionType(0)) {
-          string assem_code = ""; // To store the assembly language code for the given instruction
-          int loc = 0; // To store the location
+          translation.m_status = TS_Instruction;
           switch (m_parsed_inst.size()) {
           case (1):
                m_OpCode = to_lower(m_parsed_inst[0]);
                // Check to see if the word has an OpCode
                if (opcode(m_OpCode) != -1){
                     if(m_OpCode == "halt")
-                         assem_code = "130000";
+                         translation.m_word = 130000;
                     // Halt is the only OpCode which goes without an operand. Either its "halt" or its an error
                     else {
                          string error = "(location " + to_string(a_loc) + ") Missing operand";
                          Errors::RecordError(error);
-                         assem_code = to_string(opcode(m_OpCode)) + "????";
-                         pad(assem_code, 6);
+                         translation.m_word = opcode(m_OpCode) * 10000;
+                         translation.m_unknown = 4;
                     }
                }
                // Report an error otherwise
                else {
                     string error = "(location " + to_string(a_loc) + ") Bad Operation Command";
                     Errors::RecordError(error);
-                    assem_code = "??????";
+                    translation.m_unknown = 6;
                }
                break;
           case(2):
                m_OpCode = m_parsed_inst[0];
                m_Operand = m_parsed_inst[1];
                if (opcode(m_OpCode) != -1) {
-                    assem_code = to_string(opcode(m_OpCode));
-                    pad(assem_code, 2);
-
-                    if (SymbolTable::LookupSymbol(m_Operand, loc)) {
-                         assem_code += pad(to_string(loc), 4);
-                    }
-                    else {
-                         string error = "(location " + to_string(a_loc) + ") Undefined Operand/Label";
-                         Errors::RecordError(error);
-                         assem_code += "????";
-                    }
+                    translation.m_word = opcode(m_OpCode) * 10000;
+                    translation.m_unknown = TranslateOperand(a_loc, translation.m_word, a_symtab);
                }
                else {
                     string error = "(location " + to_string(a_loc) + ") Bad Operation Command";
                     Errors::RecordError(error);
-                    assem_code = "??????";
+                    translation.m_unknown = 6;
                }
                break;
           case(3):
@@ -198,48 +192,106 @@ pair<int, string> Instruction::TranslateInstruction(string & a_buff, int a_loc)
                m_Operand = m_parsed_inst[2];
 
                if (opcode(m_OpCode) != -1) {
-                    assem_code = to_string(opcode(m_OpCode));
-                    pad(assem_code, 2);
-
-                    if (SymbolTable::LookupSymbol(m_Operand, loc)) {
-                         assem_code += pad(to_string(loc), 4);
-                    }
-                    else {
-                         string error = "(location " + to_string(a_loc) + ") Undefined Operand/Label";
-                         Errors::RecordError(error);
-                         assem_code += "????";
-                    }
+                    translation.m_word = opcode(m_OpCode) * 10000;
+                    translation.m_unknown = TranslateOperand(a_loc, translation.m_word, a_symtab);
                }
                else {
                     string error = "(location " + to_string(a_loc) + ") Bad Operation Command";
                     Errors::RecordError(error);
-                    assem_code = "??????";
+                    translation.m_unknown = 6;
                }
                break;
           default:
-               assem_code = "??????";
+               translation.m_unknown = 6;
                break;
           }
-          cout << setw(12) << left << a_loc << setw(12) << left << assem_code << a_buff << endl;
-          return pair<int, string>(a_loc, assem_code);
+          return translation;
      }
      
-     
-     if (st == InstructionType(1) && m_parsed_inst.size() >= 3 && (m_parsed_inst[1] == "dc" || m_parsed_inst[1] == "DC"))
-          cout << setw(12) << left << a_loc << setw(12) << left << pad(m_parsed_inst[2], 6) << a_buff << endl;
+     // For InstructionType(1) -- define constant, which is loaded into memory along with the instructions
+     if (st == InstructionType(1) && m_parsed_inst.size() >= 3 && (m_parsed_inst[1] == "dc" || m_parsed_inst[1] == "DC")) {
+          translation.m_status = TS_Constant;
+          const string &constant = m_parsed_inst[2];
+          StaticAssembler::Text text = { constant.data(), static_cast<int>(constant.size()) };
+          if (!StaticAssembler::ParseConstant(text, translation.m_word)) {
+               string error = "(location " + to_string(a_loc) + ") Constant is not a number of at most six digits";
+               Errors::RecordError(error);
+               translation.m_unknown = 6;
+          }
+     }
+     // For InstructionType(1) -- linkage statement, which names exactly one symbol
+     else if (st == InstructionType(1) && (IsImport() || IsExport())) {
+          translation.m_status = TS_Directive;
+          if (m_parsed_inst.size() != 2) {
+               string error = "(location " + to_string(a_loc) + ") " + m_parsed_inst[0] + " takes exactly one symbol";
+               Errors::RecordError(error);
+          }
+     }
      // For InstructionType(1) -- assembler instruction
      else if (st == InstructionType(1))
-          cout << setw(12) << left << a_loc << setw(12) << left << "" << a_buff << endl;
-     // For InstructionType(2) -- comment or blank line and InstructionType(3) -- end
-     else
-          cout << setw(24) << " " << a_buff << endl;
-
+          translation.m_status = TS_Directive;
      // To indicate the end statement
-     if (st == InstructionType(3))
-          return pair<int, string>(0, "end");
+     else if (st == InstructionType(3))
+          translation.m_status = TS_End;
+
+     return translation;
+} /* Instruction::Translation Instruction::TranslateInstruction(string & a_buff, int a_loc, const SymbolTable &a_symtab) */
+
+
+/**/
+/*
+Instruction::TranslateOperand(int a_loc, int &a_word, const SymbolTable &a_symtab)
+
+NAME
+
+    Instruction::TranslateOperand - translate the operand of an instruction.
+
+SYNOPSIS
+
+    int Instruction::TranslateOperand(int a_loc, int &a_word, const SymbolTable &a_symtab);
+    a_loc       --> the location of the instruction being translated. used in error messages.
+    a_word      --> the machine word of the instruction. the location of the operand is added to it.
+    a_symtab    --> the symbol table the operand is looked up in.
+
+DESCRIPTION
+
+    Looks up the operand of the instruction in the symbol table and adds its location to the machine word.
+    Undefined and multiply defined labels are reported as errors. An imported symbol leaves the operand
+    field zero for the Linker to fill in.
+
+RETURNS
+
+    0 if the operand was translated,
+    4, the number of digits of the operand field, otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
 
-     return pair<int, string>(0, "n/a");
-} /* pair<int, string> Instruction::TranslateInstruction(string & a_buff, int a_loc) */
+    12/05/2017
+
+*/
+/**/
+int Instruction::TranslateOperand(int a_loc, int &a_word, const SymbolTable &a_symtab)
+{
+     int loc = 0;
+     if (!a_symtab.LookupSymbol(m_Operand, loc)) {
+          string error = "(location " + to_string(a_loc) + ") Undefined Operand/Label";
+          Errors::RecordError(error);
+          return 4;
+     }
+     if (loc == SymbolTable::importedSymbol)
+          return 0;
+     if (loc < 0) {
+          string error = "(location " + to_string(a_loc) + ") Multiply defined Operand/Label";
+          Errors::RecordError(error);
+          return 4;
+     }
+     a_word += loc;
+     return 0;
+} /* int Instruction::TranslateOperand(int a_loc, int &a_word, const SymbolTable &a_symtab) */
 
 
 /**/
@@ -275,18 +327,17 @@ DATE
 /**/
 int Instruction::LocationNextInstruction(int a_loc)
 {
-     // Donot increment location for blank line, comment or end instruction
-     if (m_type == InstructionType(2) || m_type == InstructionType(3))
+     // Donot increment location for blank line, comment, end or linkage instruction
+     if (m_type == InstructionType(2) || m_type == InstructionType(3) || IsImport() || IsExport())
           return a_loc;
 
      // Check if the current statement is an origin statement
      else if (m_type == InstructionType(1)) {
-          stringstream ss(m_instruction);
-          string one, two, three;
-          ss >> one >> two >> three;
+          string two = m_parsed_inst.size() > 1 ? m_parsed_inst[1] : "";
+          string three = m_parsed_inst.size() > 2 ? m_parsed_inst[2] : "";
 
           //returns the origin location stated in the statement
-          if (one == "org" || one == "ORG") 
+          if (IsOrigin()) 
                return stoi(two);
           //sets apart storage specified in the statement if it is a define storage statement
           else if (two == "ds" || two == "DS")
@@ -371,57 +422,7 @@ DATE
 /**/
 int Instruction::opcode(string &a_buff)
 {
-     // Codes to indicate the respective opcode for instructions.
-     map<string, int> OpCode{
-          { "add", 1 },{ "sub", 2 },{ "mult", 3 },{ "div", 4 },{ "load", 5 },
-          { "store", 6 },{ "read", 7 },{ "write", 8 },{ "b", 9 },{ "bm", 10 },
-          { "bz", 11 },{ "bp", 12 },{ "halt", 13 }
-     };
-
-     if (OpCode[a_buff] <= 13 && OpCode[a_buff] >= 1)
-          return OpCode[a_buff];
-
-     return -1;
+     // The table is shared with the assembler that runs at compile time.
+     StaticAssembler::Text name = { a_buff.data(), static_cast<int>(a_buff.size()) };
+     return StaticAssembler::Opcode(name, false);
 } /* int Instruction::opcode(string &a_buff) */
-
-
-/**/
-/*
-Instruction::pad(string &a_buff, int a_size)
-
-NAME
-
-    Instruction::pad - pad the input string to the a_size.
-
-SYNOPSIS
-
-    string Instruction::pad(string &a_buff, int a_size);
-    a_buff    --> the string to be padded.
-    a_size    --> the size to which to grow the string to.
-
-DESCRIPTION
-
-    This function pads a string by adding 0's at the beginning until the desired size is met.
-
-RETURNS
-
-    a padded copy of the string passed in as argument.
-
-AUTHOR
-
-    Abish Jha
-
-DATE
-
-    12/05/2017
-
-*/
-/**/
-string Instruction::pad(string &a_buff, int a_size)
-{
-     if (a_buff.size() == a_size) return a_buff;
-
-     for (int i = a_buff.size(); i < a_size; i++)
-          a_buff.insert(0, "0");
-     return a_buff;
-} /* string Instruction::pad(string &a_buff, int a_size) */
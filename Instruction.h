@@ -24,6 +24,8 @@ DATE
 /**/
 
 
+class SymbolTable;
+
 class Instruction {
 
 public:
@@ -39,11 +41,28 @@ public:
           ST_End                    // end instruction.
      };
 
+     // Codes to indicate what the translation of an instruction produced.
+     enum TranslationStatus {
+          TS_Instruction,     // A machine language instruction to be placed in memory.
+          TS_Constant,        // A constant to be placed in memory.
+          TS_Directive,       // An assembler instruction that places nothing in memory (org, ds).
+          TS_Comment,         // Comment or blank line.
+          TS_End              // end instruction.
+     };
+
+     // The result of translating an instruction.
+     struct Translation {
+          TranslationStatus m_status;   // What the translation produced.
+          int m_loc;                    // The location of the instruction.
+          int m_word;                   // The machine word or constant.
+          int m_unknown;                // Number of trailing digits of the word that could not be translated.
+     };
+
      // Parse the Instruction.
      InstructionType ParseInstruction(string &a_buff);
 
      // Translate the Instruction.
-     pair<int, string> TranslateInstruction(string &a_buff, int a_loc);
+     Translation TranslateInstruction(string &a_buff, int a_loc, const SymbolTable &a_symtab);
 
      // Compute the location of the next instruction.
      int LocationNextInstruction(int a_loc);
@@ -53,6 +72,32 @@ public:
 
           return m_Label;
      };
+     // To access the operand of the last instruction translated
+     inline string &GetOperand() {
+
+          return m_Operand;
+     };
+     // To determine if the instruction sets the origin.
+     inline bool IsOrigin() {
+
+          // The op code was converted to lower case by ParseInstruction.
+          return m_type == ST_AssemblerInstr && m_parsed_inst[0] == "org";
+     };
+     // To determine if the instruction imports a symbol from another module.
+     inline bool IsImport() {
+
+          return m_type == ST_AssemblerInstr && m_parsed_inst[0] == "import";
+     };
+     // To determine if the instruction exports a symbol to other modules.
+     inline bool IsExport() {
+
+          return m_type == ST_AssemblerInstr && m_parsed_inst[0] == "export";
+     };
+     // To access the symbol named by an import or export statement.
+     inline string GetLinkSymbol() {
+
+          return m_parsed_inst.size() > 1 ? m_parsed_inst[1] : "";
+     };
      // To determine if a label is blank.
      inline bool isLabel() {
 
@@ -67,8 +112,8 @@ private:
      // Check for and return the opeartion code of the given string. Returns -1 if it does not.
      int opcode(string &a_buff);
 
-     // Pad a string to a_size digits by adding 0s in the beginning
-     string pad(string &a_buff, int a_size);
+     // Look up the operand and add its location to the machine word. Returns the number of digits left unknown.
+     int TranslateOperand(int a_loc, int &a_word, const SymbolTable &a_symtab);
 
      // The elemements of a instruction
      string m_Label;        // The label.
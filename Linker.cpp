@@ -0,0 +1,175 @@
+//
+//      Implementation of the Linker class.
+//
+#include "stdafx.h"
+#include "Linker.h"
+#include "SymTab.h"
+#include "Emulator.h"
+#include "Errors.h"
+
+
+/**/
+/*
+Linker::AddModule(const string &a_fileName)
+
+NAME
+
+    Linker::AddModule - read a module to be linked.
+
+SYNOPSIS
+
+    bool Linker::AddModule(const string &a_fileName);
+    a_fileName    --> name of the object file of the module.
+
+DESCRIPTION
+
+    Reads the object image of a module assembled with -c. Images that were not assembled as modules
+    are refused, since nothing tells the Linker how to move them.
+
+RETURNS
+
+    'true' if the module was read,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Linker::AddModule(const string &a_fileName)
+{
+     ObjectImage module;
+     if (!module.Read(a_fileName))
+          return false;
+     if (!module.IsRelocatable()) {
+          string error = a_fileName + " is not a module (assemble it with -c)";
+          Errors::RecordError(error);
+          return false;
+     }
+     m_names.push_back(a_fileName);
+     m_modules.push_back(module);
+     return true;
+} /* bool Linker::AddModule(const string &a_fileName) */
+
+
+/**/
+/*
+Linker::Link(ObjectImage &a_image)
+
+NAME
+
+    Linker::Link - link the modules into a program.
+
+SYNOPSIS
+
+    bool Linker::Link(ObjectImage &a_image);
+    a_image    --> the image the linked program is built in.
+
+DESCRIPTION
+
+    Each module is placed at the location following the previous one. The exported symbols of all the
+    modules are collected into one symbol table, with their locations moved by the location of their
+    module. The words of each module are then copied, adding the location of the module to the operand
+    of every relocated instruction and the location of the symbol to the operand of every instruction
+    referring to an imported symbol. Symbols exported by more than one module, imports that no module
+    exports, and programs that do not fit in the memory of the VC3600 are reported as errors.
+
+    The linked image keeps the exported symbols as its symbol table.
+
+RETURNS
+
+    'true' if the program was linked,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Linker::Link(ObjectImage &a_image)
+{
+     bool success = true;
+
+     // Place the modules one after another.
+     vector<int> bases;
+     int end = 0;
+     for (size_t i = 0; i < m_modules.size(); i++) {
+          bases.push_back(end);
+          end += m_modules[i].GetEnd();
+     }
+     if (m_modules.empty() || end > emulator::MEMSZ) {
+          string error = m_modules.empty() ? "No modules to link" : "The linked program needs " + to_string(end) + " words of memory";
+          Errors::RecordError(error);
+          return false;
+     }
+
+     // Collect the exported symbols at their final locations.
+     SymbolTable exports;
+     for (size_t i = 0; i < m_modules.size(); i++) {
+          const vector<string> &names = m_modules[i].GetExports();
+          for (vector<string>::const_iterator it = names.begin(); it != names.end(); ++it) {
+               map<string, int>::const_iterator symbol = m_modules[i].GetSymbols().find(*it);
+               if (symbol == m_modules[i].GetSymbols().end()) {
+                    string error = m_names[i] + ": exported symbol " + *it + " is not defined";
+                    Errors::RecordError(error);
+                    success = false;
+                    continue;
+               }
+               string name = *it;
+               exports.AddSymbol(name, bases[i] + symbol->second);
+          }
+     }
+     for (map<string, int>::const_iterator it = exports.GetSymbols().begin(); it != exports.GetSymbols().end(); ++it) {
+          if (it->second == SymbolTable::multiplyDefinedSymbol) {
+               string error = "Symbol " + it->first + " is exported by more than one module";
+               Errors::RecordError(error);
+               success = false;
+          }
+     }
+
+     // Copy the words of each module to their final locations and fix up their operands.
+     vector<pair<int, int>> words;
+     for (size_t i = 0; i < m_modules.size(); i++) {
+          map<int, int> module;
+          const vector<ObjectImage::Segment> &segments = m_modules[i].GetSegments();
+          for (vector<ObjectImage::Segment>::const_iterator it = segments.begin(); it != segments.end(); ++it) {
+               for (int j = 0; it->m_type == ObjectImage::SEG_Words && j < it->m_count; j++)
+                    module[it->m_location + j] = it->m_words[j];
+          }
+
+          const vector<int> &relocations = m_modules[i].GetRelocations();
+          for (vector<int>::const_iterator it = relocations.begin(); it != relocations.end(); ++it)
+               module[*it] += bases[i];
+
+          const vector<pair<int, string>> &imports = m_modules[i].GetImports();
+          for (vector<pair<int, string>>::const_iterator it = imports.begin(); it != imports.end(); ++it) {
+               int loc = 0;
+               if (!exports.LookupSymbol(it->second, loc)) {
+                    string error = m_names[i] + ": (location " + to_string(it->first) + ") Unresolved symbol " + it->second;
+                    Errors::RecordError(error);
+                    success = false;
+                    continue;
+               }
+               if (loc >= 0)
+                    module[it->first] += loc;
+          }
+
+          for (map<int, int>::iterator it = module.begin(); it != module.end(); ++it)
+               words.push_back(pair<int, int>(bases[i] + it->first, it->second));
+     }
+
+     if (success)
+          a_image.Build(m_modules[0].GetOrigin(), end, words, exports.GetSymbols());
+     SymbolTable::TakeLookups();
+     return success;
+} /* bool Linker::Link(ObjectImage &a_image) */
@@ -0,0 +1,51 @@
+#pragma once
+
+/**/
+/*
+Linker Class
+
+NAME
+
+     Linker - combine separately assembled modules into one program.
+
+DESCRIPTION
+
+     Linker class - reads the relocatable object images of the modules assembled with -c,
+     places them one after another in memory in the order they were given, relocates the
+     instructions that refer to labels of their own module and fills in the operands of
+     the instructions that refer to symbols exported by another module. The result is an
+     ordinary object image that can be run with -x. Execution starts at the first
+     instruction of the first module.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+
+#include "ObjectImage.h"
+
+class Linker {
+
+public:
+
+    Linker( ) { };
+    ~Linker( ) { };
+
+    // Read a module to be linked. Modules are placed in memory in the order they are added.
+    bool AddModule( const string &a_fileName );
+
+    // Link the modules into an image that can be run. Errors are recorded with the Errors class.
+    bool Link( ObjectImage &a_image );
+
+private:
+
+    vector<string> m_names;             // The file names of the modules, for error messages.
+    vector<ObjectImage> m_modules;      // The modules in the order they were added.
+};
@@ -0,0 +1,216 @@
+//
+//      Implementation of the MappedFile class.
+//
+#include "stdafx.h"
+#include "MappedFile.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+/**/
+/*
+MappedFile::MappedFile()
+
+NAME
+
+    MappedFile::MappedFile - constructor for the MappedFile class.
+
+SYNOPSIS
+
+    MappedFile::MappedFile();
+
+DESCRIPTION
+
+    Constructs an object with no file mapped.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+MappedFile::MappedFile()
+: m_data( NULL ), m_size( 0 )
+{
+#ifdef _WIN32
+     m_file = INVALID_HANDLE_VALUE;
+     m_mapping = NULL;
+#endif
+} /* MappedFile::MappedFile() */
+
+
+/**/
+/*
+MappedFile::~MappedFile()
+
+NAME
+
+    MappedFile::~MappedFile - destroyer for the MappedFile class.
+
+SYNOPSIS
+
+    MappedFile::~MappedFile();
+
+DESCRIPTION
+
+    Releases the mapping when the object goes out-of-scope.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+MappedFile::~MappedFile()
+{
+     Close();
+} /* MappedFile::~MappedFile() */
+
+
+/**/
+/*
+MappedFile::Open(const string &a_fileName)
+
+NAME
+
+    MappedFile::Open - map a file into memory.
+
+SYNOPSIS
+
+    bool MappedFile::Open(const string &a_fileName);
+    a_fileName    --> name of the file to be mapped.
+
+DESCRIPTION
+
+    Maps the whole file read-only into the address space of the process. Any previous mapping
+    held by the object is released first. Empty files are not mapped.
+
+RETURNS
+
+    'true' if the file was mapped,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool MappedFile::Open(const string &a_fileName)
+{
+     Close();
+
+#ifdef _WIN32
+     m_file = CreateFileA(a_fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+     if (m_file == INVALID_HANDLE_VALUE)
+          return false;
+
+     LARGE_INTEGER size;
+     if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+          Close();
+          return false;
+     }
+     m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+     if (m_mapping == NULL) {
+          Close();
+          return false;
+     }
+     m_data = static_cast<const unsigned char *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+     if (m_data == NULL) {
+          Close();
+          return false;
+     }
+     m_size = static_cast<size_t>(size.QuadPart);
+#else
+     int fd = open(a_fileName.c_str(), O_RDONLY);
+     if (fd < 0)
+          return false;
+
+     struct stat st;
+     if (fstat(fd, &st) != 0 || st.st_size == 0) {
+          close(fd);
+          return false;
+     }
+     void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+     // The mapping stays valid after the descriptor is closed.
+     close(fd);
+     if (data == MAP_FAILED)
+          return false;
+
+     m_data = static_cast<const unsigned char *>(data);
+     m_size = static_cast<size_t>(st.st_size);
+#endif
+     return true;
+} /* bool MappedFile::Open(const string &a_fileName) */
+
+
+/**/
+/*
+MappedFile::Close()
+
+NAME
+
+    MappedFile::Close - unmap the file.
+
+SYNOPSIS
+
+    void MappedFile::Close();
+
+DESCRIPTION
+
+    Releases the mapping and the handles held by the object. Does nothing if no file is mapped.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void MappedFile::Close()
+{
+#ifdef _WIN32
+     if (m_data != NULL)
+          UnmapViewOfFile(m_data);
+     if (m_mapping != NULL)
+          CloseHandle(m_mapping);
+     if (m_file != INVALID_HANDLE_VALUE)
+          CloseHandle(m_file);
+     m_mapping = NULL;
+     m_file = INVALID_HANDLE_VALUE;
+#else
+     if (m_data != NULL)
+          munmap(const_cast<unsigned char *>(m_data), m_size);
+#endif
+     m_data = NULL;
+     m_size = 0;
+} /* void MappedFile::Close() */
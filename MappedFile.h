@@ -0,0 +1,68 @@
+#pragma once
+
+/**/
+/*
+MappedFile Class
+
+NAME
+
+     MappedFile - read-only memory mapping of a file.
+
+DESCRIPTION
+
+     MappedFile class - maps a whole file into memory for reading so binary files such as
+     the object images can be used in place without being copied into buffers first.
+     The mapping is released when the object goes out of scope.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+
+class MappedFile {
+
+public:
+
+    MappedFile( );
+
+    // Unmaps the file.
+    ~MappedFile( );
+
+    // Map the file into memory.
+    bool Open( const string &a_fileName );
+
+    // Unmap the file.
+    void Close( );
+
+    // To access the mapped bytes.
+    inline const unsigned char *Data( ) const {
+
+        return m_data;
+    };
+    // To access the size of the mapping in bytes.
+    inline size_t Size( ) const {
+
+        return m_size;
+    };
+
+private:
+
+    // The object owns the mapping so it may not be copied.
+    MappedFile( const MappedFile & );
+    MappedFile &operator=( const MappedFile & );
+
+    const unsigned char *m_data;    // Start of the mapped file.
+    size_t m_size;                  // Size of the mapped file.
+
+#ifdef _WIN32
+    HANDLE m_file;                  // Handle of the open file.
+    HANDLE m_mapping;               // Handle of the file mapping.
+#endif
+};
@@ -0,0 +1,593 @@
+//
+//      Implementation of the ObjectImage class.
+//
+#include "stdafx.h"
+#include "ObjectImage.h"
+#include "MappedFile.h"
+#include "Emulator.h"
+#include "Errors.h"
+#include "Hash.h"
+#include "Stats.h"
+
+// The header at the start of every image file.
+struct ImageHeader {
+     uint32_t m_magic;          // Always ObjectImage::MAGIC.
+     uint32_t m_version;        // Version of the file format.
+     int32_t m_origin;          // Location of the first instruction to be executed.
+     int32_t m_end;             // Location following the last word of the program.
+     uint32_t m_segments;       // Number of segments.
+     uint32_t m_symbols;        // Number of symbols.
+     uint32_t m_payloadSize;    // Number of bytes following the header.
+     uint32_t m_checksum;       // FNV-1a hash of the bytes following the header.
+};
+
+// Append a name to the payload as its length followed by its bytes padded to a word boundary.
+static void AppendName(vector<uint32_t> &a_payload, const string &a_name)
+{
+     a_payload.push_back(static_cast<uint32_t>(a_name.size()));
+     size_t start = a_payload.size();
+     a_payload.resize(start + (a_name.size() + 3) / 4, 0);
+     if (!a_name.empty())
+          memcpy(&a_payload[start], a_name.data(), a_name.size());
+}
+
+// Check the bounds of a name written by AppendName and extract it if a_name is not NULL.
+static bool ReadName(const uint32_t *a_payload, size_t a_size, size_t &a_pos, string *a_name)
+{
+     if (a_size - a_pos < 1 || (a_size - a_pos - 1) < ((size_t)a_payload[a_pos] + 3) / 4)
+          return false;
+     if (a_name != NULL)
+          a_name->assign(reinterpret_cast<const char *>(a_payload + a_pos + 1), a_payload[a_pos]);
+     a_pos += 1 + ((size_t)a_payload[a_pos] + 3) / 4;
+     return true;
+}
+
+
+/**/
+/*
+ObjectImage::Build(int a_origin, int a_end, const vector<pair<int, int>> &a_words, const map<string, int> &a_symbols)
+
+NAME
+
+    ObjectImage::Build - build the image from the translated program.
+
+SYNOPSIS
+
+    void ObjectImage::Build(int a_origin, int a_end, const vector<pair<int, int>> &a_words, const map<string, int> &a_symbols);
+    a_origin     --> location of the first instruction to be executed.
+    a_end        --> location following the last word of the program.
+    a_words      --> the (location, contents) pairs produced by Pass II.
+    a_symbols    --> the symbol table of the program.
+
+DESCRIPTION
+
+    Sorts the translated words by location and groups runs of consecutive locations into word segments.
+    The gaps between the runs, and the space up to the end of the program, were set aside by ds statements
+    and are recorded as storage segments holding only their length. If a location was translated more than
+    once the last translation wins, as it would if the words were inserted into memory one at a time.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void ObjectImage::Build(int a_origin, int a_end, const vector<pair<int, int>> &a_words, const map<string, int> &a_symbols)
+{
+     m_origin = a_origin;
+     m_end = a_end;
+     m_symbols = a_symbols;
+     m_segments.clear();
+     m_relocatable = false;
+     m_relocations.clear();
+     m_imports.clear();
+     m_exports.clear();
+     m_accumulator = 0;
+     m_steps = 0;
+
+     // Order the words by location. Later translations of the same location replace earlier ones.
+     map<int, int> words;
+     for (vector<pair<int, int>>::const_iterator it = a_words.begin(); it != a_words.end(); ++it)
+          words[it->first] = it->second;
+
+     int next = -1;     // Location following the current word segment.
+     for (map<int, int>::iterator it = words.begin(); it != words.end(); ++it) {
+          if (it->first != next) {
+               // Record the storage set aside between the previous segment and this one.
+               if (next != -1) {
+                    Segment storage = { SEG_Storage, next, it->first - next, vector<int>() };
+                    m_segments.push_back(storage);
+               }
+               Segment segment = { SEG_Words, it->first, 0, vector<int>() };
+               m_segments.push_back(segment);
+          }
+          m_segments.back().m_words.push_back(it->second);
+          m_segments.back().m_count++;
+          next = it->first + 1;
+     }
+
+     // Storage at the end of the program.
+     if (next != -1 && a_end > next) {
+          Segment storage = { SEG_Storage, next, a_end - next, vector<int>() };
+          m_segments.push_back(storage);
+     }
+} /* void ObjectImage::Build(int a_origin, int a_end, const vector<pair<int, int>> &a_words, const map<string, int> &a_symbols) */
+
+
+/**/
+/*
+ObjectImage::SetLinkage(const vector<int> &a_relocations, const vector<pair<int, string>> &a_imports, const vector<string> &a_exports)
+
+NAME
+
+    ObjectImage::SetLinkage - make the image a relocatable module.
+
+SYNOPSIS
+
+    void ObjectImage::SetLinkage(const vector<int> &a_relocations, const vector<pair<int, string>> &a_imports, const vector<string> &a_exports);
+    a_relocations    --> locations of the words whose operand is a location inside the module.
+    a_imports        --> locations of the words whose operand is an imported symbol, with the symbol.
+    a_exports        --> the symbols of the module that other modules may import.
+
+DESCRIPTION
+
+    Marks the image as a module and records what the Linker needs to place it in memory and to connect it
+    to the other modules of the program.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void ObjectImage::SetLinkage(const vector<int> &a_relocations, const vector<pair<int, string>> &a_imports, const vector<string> &a_exports)
+{
+     m_relocatable = true;
+     m_relocations = a_relocations;
+     m_imports = a_imports;
+     m_exports = a_exports;
+} /* void ObjectImage::SetLinkage(const vector<int> &a_relocations, const vector<pair<int, string>> &a_imports, const vector<string> &a_exports) */
+
+
+/**/
+/*
+ObjectImage::Write(const string &a_fileName)
+
+NAME
+
+    ObjectImage::Write - save the image to a file.
+
+SYNOPSIS
+
+    bool ObjectImage::Write(const string &a_fileName) const;
+    a_fileName    --> name of the file the image is written to.
+
+DESCRIPTION
+
+    Serializes the segments and the symbol table, computes the checksum of the serialized data and
+    writes the header followed by the data to the file. Errors are recorded with the Errors class.
+
+RETURNS
+
+    'true' if the image was written,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool ObjectImage::Write(const string &a_fileName) const
+{
+     vector<uint32_t> payload;
+
+     for (vector<Segment>::const_iterator it = m_segments.begin(); it != m_segments.end(); ++it) {
+          payload.push_back(it->m_type);
+          payload.push_back(it->m_location);
+          payload.push_back(it->m_count);
+          if (it->m_type == SEG_Words)
+               payload.insert(payload.end(), it->m_words.begin(), it->m_words.end());
+     }
+
+     for (map<string, int>::const_iterator it = m_symbols.begin(); it != m_symbols.end(); ++it) {
+          payload.push_back(it->second);
+          AppendName(payload, it->first);
+     }
+
+     // The linkage section.
+     payload.push_back(m_relocatable ? FLAG_Relocatable : 0);
+     payload.push_back(static_cast<uint32_t>(m_sourceHash));
+     payload.push_back(static_cast<uint32_t>(m_sourceHash >> 32));
+     payload.push_back(static_cast<uint32_t>(m_relocations.size()));
+     payload.insert(payload.end(), m_relocations.begin(), m_relocations.end());
+     payload.push_back(static_cast<uint32_t>(m_imports.size()));
+     for (vector<pair<int, string>>::const_iterator it = m_imports.begin(); it != m_imports.end(); ++it) {
+          payload.push_back(it->first);
+          AppendName(payload, it->second);
+     }
+     payload.push_back(static_cast<uint32_t>(m_exports.size()));
+     for (vector<string>::const_iterator it = m_exports.begin(); it != m_exports.end(); ++it)
+          AppendName(payload, *it);
+
+     // The start state.
+     payload.push_back(m_accumulator);
+     payload.push_back(m_steps);
+
+     ImageHeader header;
+     header.m_magic = MAGIC;
+     header.m_version = VERSION;
+     header.m_origin = m_origin;
+     header.m_end = m_end;
+     header.m_segments = static_cast<uint32_t>(m_segments.size());
+     header.m_symbols = static_cast<uint32_t>(m_symbols.size());
+     header.m_payloadSize = static_cast<uint32_t>(payload.size() * sizeof(uint32_t));
+     header.m_checksum = Hash::Fnv1a32(payload.data(), header.m_payloadSize);
+
+     ofstream file(a_fileName.c_str(), ios::out | ios::binary | ios::trunc);
+     file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+     file.write(reinterpret_cast<const char *>(payload.data()), header.m_payloadSize);
+     file.close();
+     if (!file) {
+          string error = "Could not write the object image " + a_fileName;
+          Errors::RecordError(error);
+          return false;
+     }
+     return true;
+} /* bool ObjectImage::Write(const string &a_fileName) const */
+
+
+/**/
+/*
+ObjectImage::Read(const string &a_fileName)
+
+NAME
+
+    ObjectImage::Read - read an image from a file.
+
+SYNOPSIS
+
+    bool ObjectImage::Read(const string &a_fileName);
+    a_fileName    --> name of the image file.
+
+DESCRIPTION
+
+    Maps the image file, checks it and replaces the contents of this object with the contents of the file.
+    Errors are recorded with the Errors class.
+
+RETURNS
+
+    'true' if the image was read,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool ObjectImage::Read(const string &a_fileName)
+{
+     MappedFile file;
+     if (!file.Open(a_fileName)) {
+          string error = "Object image " + a_fileName + " could not be opened";
+          Errors::RecordError(error);
+          return false;
+     }
+     return Parse(file.Data(), file.Size(), this, NULL);
+} /* bool ObjectImage::Read(const string &a_fileName) */
+
+
+/**/
+/*
+ObjectImage::Load(emulator &a_emul)
+
+NAME
+
+    ObjectImage::Load - copy the image into the emulator.
+
+SYNOPSIS
+
+    bool ObjectImage::Load(emulator &a_emul) const;
+    a_emul    --> the emulator the program is loaded into.
+
+DESCRIPTION
+
+    Copies every word segment into the emulator memory as a block and sets the origin of the program and
+    the accumulator and step count it starts with. Storage segments need no copying since the memory of the emulator starts out cleared.
+    The program is then verified, so it runs on the fast loop if it cannot change its code, and a
+    snapshot is taken so the emulator can be reset to it after each run.
+
+RETURNS
+
+    'true' if the image was loaded,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool ObjectImage::Load(emulator &a_emul) const
+{
+     STATS_TIMER(timer, PH_ImageLoad);
+     for (vector<Segment>::const_iterator it = m_segments.begin(); it != m_segments.end(); ++it) {
+          if (it->m_type == SEG_Words && !a_emul.insertBlock(it->m_location, it->m_words.data(), it->m_count))
+               return false;
+     }
+     a_emul.setStartState(m_accumulator, m_steps);
+     if (!a_emul.setOrigin(m_origin))
+          return false;
+     a_emul.verify();
+     a_emul.snapshot();
+     return true;
+} /* bool ObjectImage::Load(emulator &a_emul) const */
+
+
+/**/
+/*
+ObjectImage::LoadFile(const string &a_fileName, emulator &a_emul)
+
+NAME
+
+    ObjectImage::LoadFile - load an image file into the emulator.
+
+SYNOPSIS
+
+    static bool ObjectImage::LoadFile(const string &a_fileName, emulator &a_emul);
+    a_fileName    --> name of the image file.
+    a_emul        --> the emulator the program is loaded into.
+
+DESCRIPTION
+
+    Maps the image file, checks it and copies the word segments straight from the mapping into the
+    emulator memory. No intermediate copy of the program is made. Errors are recorded with the Errors class.
+    The program is verified, and a snapshot taken, as Load does.
+
+RETURNS
+
+    'true' if the image was loaded,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool ObjectImage::LoadFile(const string &a_fileName, emulator &a_emul)
+{
+     STATS_TIMER(timer, PH_ImageLoad);
+     MappedFile file;
+     if (!file.Open(a_fileName)) {
+          string error = "Object image " + a_fileName + " could not be opened";
+          Errors::RecordError(error);
+          return false;
+     }
+     return Parse(file.Data(), file.Size(), NULL, &a_emul);
+} /* bool ObjectImage::LoadFile(const string &a_fileName, emulator &a_emul) */
+
+
+/**/
+/*
+ObjectImage::Parse(const unsigned char *a_data, size_t a_size, ObjectImage *a_image, emulator *a_emul)
+
+NAME
+
+    ObjectImage::Parse - check an image and pass on its contents.
+
+SYNOPSIS
+
+    static bool ObjectImage::Parse(const unsigned char *a_data, size_t a_size, ObjectImage *a_image, emulator *a_emul);
+    a_data     --> the bytes of the image file. must be aligned to a word boundary.
+    a_size     --> the number of bytes in the image file.
+    a_image    --> if not NULL, receives the contents of the image.
+    a_emul     --> if not NULL, the word segments are copied into its memory.
+
+DESCRIPTION
+
+    Checks the header, the checksum and the bounds of every segment and symbol before anything is handed on,
+    so that a damaged file is never partially loaded. Errors are recorded with the Errors class.
+
+RETURNS
+
+    'true' if the image is valid,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool ObjectImage::Parse(const unsigned char *a_data, size_t a_size, ObjectImage *a_image, emulator *a_emul)
+{
+     const ImageHeader *header = reinterpret_cast<const ImageHeader *>(a_data);
+     if (a_size < sizeof(ImageHeader) || header->m_magic != MAGIC) {
+          string error = "Not a VC3600 object image";
+          Errors::RecordError(error);
+          return false;
+     }
+     if (header->m_version > VERSION) {
+          string error = "Object image version " + to_string(header->m_version) + " is not supported";
+          Errors::RecordError(error);
+          return false;
+     }
+     if (header->m_payloadSize != a_size - sizeof(ImageHeader) || header->m_payloadSize % sizeof(uint32_t) != 0
+          || Hash::Fnv1a32(a_data + sizeof(ImageHeader), header->m_payloadSize) != header->m_checksum) {
+          string error = "Object image is damaged (checksum mismatch)";
+          Errors::RecordError(error);
+          return false;
+     }
+
+     const uint32_t *payload = reinterpret_cast<const uint32_t *>(a_data + sizeof(ImageHeader));
+     size_t size = header->m_payloadSize / sizeof(uint32_t);
+     string error = "Object image is damaged (bad segment or symbol)";
+
+     // First pass: check the bounds of everything in the image.
+     size_t pos = 0;
+     for (uint32_t i = 0; i < header->m_segments; i++) {
+          if (size - pos < 3) {
+               Errors::RecordError(error);
+               return false;
+          }
+          int type = payload[pos], location = payload[pos + 1], count = payload[pos + 2];
+          pos += 3;
+          if ((type != SEG_Words && type != SEG_Storage) || location < 0 || count < 0 || count > emulator::MEMSZ - location) {
+               Errors::RecordError(error);
+               return false;
+          }
+          if (type == SEG_Words) {
+               if (size - pos < (size_t)count) {
+                    Errors::RecordError(error);
+                    return false;
+               }
+               pos += count;
+          }
+     }
+     for (uint32_t i = 0; i < header->m_symbols; i++) {
+          if (size - pos < 1 || !ReadName(payload, size, ++pos, NULL)) {
+               Errors::RecordError(error);
+               return false;
+          }
+     }
+     if (header->m_origin < 0 || header->m_origin >= emulator::MEMSZ || header->m_end < 0
+          || header->m_end > emulator::MEMSZ) {
+          Errors::RecordError(error);
+          return false;
+     }
+
+     // The linkage section is small, so it is checked and extracted at once.
+     uint32_t flags = 0;
+     uint64_t sourceHash = 0;
+     vector<int> relocations;
+     vector<pair<int, string>> imports;
+     vector<string> exports;
+     if (header->m_version >= 2) {
+          bool valid = (size - pos >= 4) && (size - pos - 4 >= payload[pos + 3]);
+          if (valid) {
+               flags = payload[pos];
+               sourceHash = payload[pos + 1] | (uint64_t)payload[pos + 2] << 32;
+               relocations.assign(payload + pos + 4, payload + pos + 4 + payload[pos + 3]);
+               pos += 4 + payload[pos + 3];
+               valid = (size - pos >= 1);
+          }
+          for (uint32_t i = 0, count = valid ? payload[pos++] : 0; valid && i < count; i++) {
+               pair<int, string> import;
+               valid = (size - pos >= 1);
+               if (valid) {
+                    import.first = payload[pos++];
+                    valid = ReadName(payload, size, pos, &import.second);
+                    imports.push_back(import);
+               }
+          }
+          valid = valid && (size - pos >= 1);
+          for (uint32_t i = 0, count = valid ? payload[pos++] : 0; valid && i < count; i++) {
+               exports.push_back("");
+               valid = ReadName(payload, size, pos, &exports.back());
+          }
+          if (!valid) {
+               Errors::RecordError(error);
+               return false;
+          }
+     }
+     int accumulator = 0, steps = 0;
+     if (header->m_version >= 3) {
+          if (size - pos < 2 || (int)payload[pos + 1] < 0 || (int)payload[pos + 1] >= emulator::MEMSZ) {
+               Errors::RecordError(error);
+               return false;
+          }
+          accumulator = payload[pos];
+          steps = payload[pos + 1];
+          pos += 2;
+     }
+     if ((flags & FLAG_Relocatable) && a_emul != NULL) {
+          string error = "Object image is a module, it must be linked before it can be run";
+          Errors::RecordError(error);
+          return false;
+     }
+
+     // Second pass: hand the contents on.
+     if (a_image != NULL) {
+          a_image->m_origin = header->m_origin;
+          a_image->m_end = header->m_end;
+          a_image->m_segments.clear();
+          a_image->m_symbols.clear();
+          a_image->m_relocatable = (flags & FLAG_Relocatable) != 0;
+          a_image->m_sourceHash = sourceHash;
+          a_image->m_relocations = relocations;
+          a_image->m_imports = imports;
+          a_image->m_exports = exports;
+          a_image->m_accumulator = accumulator;
+          a_image->m_steps = steps;
+     }
+     pos = 0;
+     for (uint32_t i = 0; i < header->m_segments; i++) {
+          Segment segment = { SegmentType(payload[pos]), (int)payload[pos + 1], (int)payload[pos + 2], vector<int>() };
+          pos += 3;
+          if (segment.m_type != SEG_Words) {
+               if (a_image != NULL)
+                    a_image->m_segments.push_back(segment);
+               continue;
+          }
+          const int *words = reinterpret_cast<const int *>(payload + pos);
+          if (a_emul != NULL && !a_emul->insertBlock(segment.m_location, words, segment.m_count))
+               return false;
+          if (a_image != NULL) {
+               segment.m_words.assign(words, words + segment.m_count);
+               a_image->m_segments.push_back(segment);
+          }
+          pos += segment.m_count;
+     }
+     if (a_image != NULL) {
+          for (uint32_t i = 0; i < header->m_symbols; i++) {
+               int location = payload[pos++];
+               string name;
+               ReadName(payload, size, pos, &name);
+               a_image->m_symbols[name] = location;
+          }
+     }
+     if (a_emul != NULL) {
+          a_emul->setStartState(accumulator, steps);
+          if (!a_emul->setOrigin(header->m_origin))
+               return false;
+          a_emul->verify();
+          a_emul->snapshot();
+     }
+     return true;
+} /* bool ObjectImage::Parse(const unsigned char *a_data, size_t a_size, ObjectImage *a_image, emulator *a_emul) */
@@ -0,0 +1,170 @@
+#pragma once
+
+/**/
+/*
+ObjectImage Class
+
+NAME
+
+     ObjectImage - binary object image of an assembled VC3600 program.
+
+DESCRIPTION
+
+     ObjectImage class - holds an assembled program in the form that is saved to disk and
+     loaded into the emulator. The image records the origin of the program, the contiguous
+     segments of translated words, the storage (ds) regions as run-length encoded blocks of
+     zeros and the symbol table. The file starts with a versioned header carrying a checksum
+     of the rest of the file.
+
+     File layout, all fields are 32 bit little-endian words:
+
+         header      magic "VC36", version, origin, end, segment count, symbol count,
+                     payload size in bytes, FNV-1a checksum of the payload.
+         segments    type, location, count, followed by count words for SEG_Words.
+         symbols     location, name length, name bytes padded to a multiple of four.
+         linkage     (version 2) flags, 64 bit hash of the source, the relocations, the imports
+                     as location and name, and the names of the exports.
+         start       (version 3) the accumulator and the number of steps already taken when
+                     the program starts, both 0 unless part of the program was run when it was
+                     assembled.
+
+     Modules assembled with -c are relocatable: their locations start at zero and the
+     linkage section tells the Linker which words refer to locations inside the module
+     and which refer to symbols imported from other modules.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+
+class emulator;
+
+class ObjectImage {
+
+public:
+
+    const static uint32_t MAGIC = 0x36334356;   // "VC36" read as a little-endian word.
+    const static uint32_t VERSION = 3;          // Current version of the file format.
+
+    const static uint32_t FLAG_Relocatable = 1; // The image is a module that must be linked before it is run.
+
+    // Kinds of segments in an image.
+    enum SegmentType {
+        SEG_Words = 1,      // Contiguous translated words.
+        SEG_Storage = 2     // Run of words set aside with ds. Only the length is stored.
+    };
+
+    // A segment of the image.
+    struct Segment {
+        SegmentType m_type;     // The kind of segment.
+        int m_location;         // Location of the first word of the segment.
+        int m_count;            // Number of words in the segment.
+        vector<int> m_words;    // The words of a SEG_Words segment.
+    };
+
+    ObjectImage( ) : m_origin( 0 ), m_end( 0 ), m_relocatable( false ), m_sourceHash( 0 ), m_accumulator( 0 ), m_steps( 0 ) { };
+    ~ObjectImage( ) { };
+
+    // Build the image from the translated program.
+    void Build( int a_origin, int a_end, const vector<pair<int, int>> &a_words, const map<string, int> &a_symbols );
+
+    // Make the image a relocatable module with the given linkage information.
+    void SetLinkage( const vector<int> &a_relocations, const vector<pair<int, string>> &a_imports, const vector<string> &a_exports );
+
+    // Record the hash of the source the image was assembled from.
+    void SetSourceHash( uint64_t a_hash ) {
+
+        m_sourceHash = a_hash;
+    };
+
+    // Record the state of the emulator when the program starts, after a_steps steps were run at assembly time.
+    void SetStartState( int a_accumulator, int a_steps ) {
+
+        m_accumulator = a_accumulator;
+        m_steps = a_steps;
+    };
+
+    // Save the image to a file.
+    bool Write( const string &a_fileName ) const;
+
+    // Read an image from a file.
+    bool Read( const string &a_fileName );
+
+    // Copy the image into the emulator memory.
+    bool Load( emulator &a_emul ) const;
+
+    // Map an image file and copy it straight into the emulator memory.
+    static bool LoadFile( const string &a_fileName, emulator &a_emul );
+
+    // To access the parts of the image.
+    inline int GetOrigin( ) const {
+
+        return m_origin;
+    };
+    inline int GetEnd( ) const {
+
+        return m_end;
+    };
+    inline const vector<Segment> &GetSegments( ) const {
+
+        return m_segments;
+    };
+    inline const map<string, int> &GetSymbols( ) const {
+
+        return m_symbols;
+    };
+    inline bool IsRelocatable( ) const {
+
+        return m_relocatable;
+    };
+    inline uint64_t GetSourceHash( ) const {
+
+        return m_sourceHash;
+    };
+    inline const vector<int> &GetRelocations( ) const {
+
+        return m_relocations;
+    };
+    inline const vector<pair<int, string>> &GetImports( ) const {
+
+        return m_imports;
+    };
+    inline const vector<string> &GetExports( ) const {
+
+        return m_exports;
+    };
+    inline int GetAccumulator( ) const {
+
+        return m_accumulator;
+    };
+    inline int GetSteps( ) const {
+
+        return m_steps;
+    };
+
+private:
+
+    // Check a mapped image and hand its contents to an image object and/or an emulator.
+    static bool Parse( const unsigned char *a_data, size_t a_size, ObjectImage *a_image, emulator *a_emul );
+
+    int m_origin;                   // Location of the first instruction to be executed.
+    int m_end;                      // Location following the last word of the program.
+    vector<Segment> m_segments;     // Segments sorted by location.
+    map<string, int> m_symbols;     // The symbol table of the program.
+
+    bool m_relocatable;                     // == true if the image is a module to be linked.
+    uint64_t m_sourceHash;                  // Hash of the source the image was assembled from, 0 if unknown.
+    vector<int> m_relocations;              // Locations of words whose operand is a location in the module.
+    vector<pair<int, string>> m_imports;    // Locations of words whose operand is an imported symbol.
+    vector<string> m_exports;               // Symbols other modules may import.
+
+    int m_accumulator;                      // The accumulator when the program starts.
+    int m_steps;                            // Steps already taken when the program starts.
+};
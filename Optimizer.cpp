@@ -0,0 +1,701 @@
+//
+//      Implementation of the Optimizer class.
+//
+#include "stdafx.h"
+#include "Optimizer.h"
+
+
+/**/
+/*
+Optimizer::Optimizer(const vector<pair<int, int>> &a_machinecode, const vector<bool> &a_instructions, int a_origin, int a_end, const map<string, int> &a_symbols)
+
+NAME
+
+    Optimizer::Optimizer - constructor for the Optimizer class.
+
+SYNOPSIS
+
+    Optimizer::Optimizer(const vector<pair<int, int>> &a_machinecode, const vector<bool> &a_instructions, int a_origin, int a_end, const map<string, int> &a_symbols);
+    a_machinecode    --> (location, contents) pairs translated by Pass II, in source order.
+    a_instructions   --> for each pair, 'true' if it is an instruction and 'false' if it is a constant.
+    a_origin         --> location of the first instruction.
+    a_end            --> location following the program.
+    a_symbols        --> the labels and their locations.
+
+DESCRIPTION
+
+    Places the words in memory as the emulator would. When several words go to the same location the
+    last one is kept.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+Optimizer::Optimizer(const vector<pair<int, int>> &a_machinecode, const vector<bool> &a_instructions, int a_origin, int a_end,
+     const map<string, int> &a_symbols)
+     : m_origin(a_origin), m_end(a_end), m_symbols(a_symbols), m_memory(emulator::MEMSZ, 0), m_kind(emulator::MEMSZ, WK_None),
+     m_source(emulator::MEMSZ), m_removed(emulator::MEMSZ, false), m_removedBefore(emulator::MEMSZ + 1, 0), m_movable(true),
+     m_threaded(0), m_loads(0), m_unreachable(0), m_merged(0)
+{
+     for (size_t i = 0; i < a_machinecode.size(); i++) {
+          int loc = a_machinecode[i].first;
+          if (loc < 0 || loc >= emulator::MEMSZ)
+               continue;
+          m_memory[loc] = a_machinecode[i].second;
+          m_kind[loc] = a_instructions[i] ? WK_Instruction : WK_Constant;
+     }
+     for (int loc = 0; loc < emulator::MEMSZ; loc++)
+          m_source[loc] = loc;
+} /* Optimizer::Optimizer(const vector<pair<int, int>> &a_machinecode, const vector<bool> &a_instructions, int a_origin, int a_end, const map<string, int> &a_symbols) */
+
+
+/**/
+/*
+Optimizer::Run()
+
+NAME
+
+    Optimizer::Run - optimize the program.
+
+SYNOPSIS
+
+    void Optimizer::Run();
+
+DESCRIPTION
+
+    Threads the branches first, since that can leave branches nothing goes to any more, then analyzes
+    the program again and, if words may be removed, removes the loads after stores and the unreachable
+    instructions and merges the constants. Finally the remaining words are moved down.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Optimizer::Run()
+{
+     Analyze();
+     FindReachable();
+     ThreadBranches();
+
+     Analyze();
+     FindReachable();
+     if (m_movable) {
+          RemoveStoredLoads();
+          RemoveUnreachable();
+          MergeConstants();
+     }
+     Compact();
+} /* void Optimizer::Run() */
+
+
+/**/
+/*
+Optimizer::Analyze()
+
+NAME
+
+    Optimizer::Analyze - find the locations that must be kept.
+
+SYNOPSIS
+
+    void Optimizer::Analyze();
+
+DESCRIPTION
+
+    Looks at the operand of every instruction. The locations branches go to, stores and reads write and
+    instructions with labels are pinned, and so is the origin. A program where an instruction other
+    than a branch refers to an instruction, or a branch goes to anything but an instruction, may compute
+    locations, so no words may be removed from it.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Optimizer::Analyze()
+{
+     m_pinned.assign(emulator::MEMSZ, false);
+     m_written.assign(emulator::MEMSZ, false);
+     m_usedAsData.assign(emulator::MEMSZ, false);
+     m_movable = true;
+
+     if (m_origin >= 0 && m_origin < emulator::MEMSZ)
+          m_pinned[m_origin] = true;
+     for (map<string, int>::const_iterator it = m_symbols.begin(); it != m_symbols.end(); ++it) {
+          if (it->second >= 0 && it->second < emulator::MEMSZ && m_kind[it->second] == WK_Instruction)
+               m_pinned[it->second] = true;
+     }
+
+     for (int loc = 0; loc < emulator::MEMSZ; loc++) {
+          if (m_kind[loc] != WK_Instruction || m_removed[loc])
+               continue;
+          int opcode = OpcodeOf(m_memory[loc]);
+          int operand = OperandOf(m_memory[loc]);
+          if (opcode == OP_Halt)
+               continue;
+
+          if (IsBranch(opcode)) {
+               m_pinned[operand] = true;
+               if (m_kind[operand] != WK_Instruction && m_movable) {
+                    m_movable = false;
+                    m_notMovable = "the branch at " + to_string(loc) + " goes to a location that holds no instruction";
+               }
+               continue;
+          }
+
+          m_usedAsData[operand] = true;
+          if (opcode == OP_Store || opcode == OP_Read) {
+               m_written[operand] = true;
+               m_pinned[operand] = true;
+          }
+          if (m_kind[operand] == WK_Instruction && m_movable) {
+               m_movable = false;
+               m_notMovable = "the instruction at " + to_string(loc) + " uses the instruction at " + to_string(operand) + " as data";
+          }
+     }
+} /* void Optimizer::Analyze() */
+
+
+/**/
+/*
+Optimizer::FindReachable()
+
+NAME
+
+    Optimizer::FindReachable - find the words a path from the origin reaches.
+
+SYNOPSIS
+
+    void Optimizer::FindReachable();
+
+DESCRIPTION
+
+    Follows every path from the origin the way the emulator steps: words with opcode 0 and storage are
+    stepped over, branches go to their operand and, unless unconditional, on to the next word, and halt
+    ends the path. A constant that a path reaches and whose opcode is not 0 would be executed, so no
+    words may be removed from such a program.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Optimizer::FindReachable()
+{
+     m_reachable.assign(emulator::MEMSZ, false);
+     vector<int> pending(1, m_origin);
+
+     while (!pending.empty()) {
+          int loc = pending.back();
+          pending.pop_back();
+          if (loc < 0 || loc >= emulator::MEMSZ || m_reachable[loc])
+               continue;
+          m_reachable[loc] = true;
+
+          int opcode = (m_kind[loc] == WK_None || m_removed[loc]) ? 0 : OpcodeOf(m_memory[loc]);
+          if (opcode != 0 && m_kind[loc] == WK_Constant && m_movable) {
+               m_movable = false;
+               m_notMovable = "the constant at " + to_string(loc) + " is executed";
+          }
+
+          if (opcode == OP_Halt || opcode < 0 || opcode > OP_Halt)
+               continue;
+          if (IsBranch(opcode))
+               pending.push_back(OperandOf(m_memory[loc]));
+          if (opcode != OP_Branch)
+               pending.push_back(loc + 1);
+     }
+} /* void Optimizer::FindReachable() */
+
+
+/**/
+/*
+Optimizer::ThreadBranches()
+
+NAME
+
+    Optimizer::ThreadBranches - make branches skip other branches.
+
+SYNOPSIS
+
+    void Optimizer::ThreadBranches();
+
+DESCRIPTION
+
+    A branch that goes to an unconditional branch, or to a branch of its own kind (which goes the same
+    way, as the accumulator has not changed), is made to go where the chain ends. Branches that nothing
+    can store to are the only ones followed, and a branch that is used as data is left as it is.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Optimizer::ThreadBranches()
+{
+     for (int loc = 0; loc < emulator::MEMSZ; loc++) {
+          if (m_kind[loc] != WK_Instruction || !m_reachable[loc] || m_usedAsData[loc] || m_written[loc])
+               continue;
+          int opcode = OpcodeOf(m_memory[loc]);
+          if (!IsBranch(opcode))
+               continue;
+
+          // The number of steps bounds the chain, so a loop of branches ends too.
+          int target = OperandOf(m_memory[loc]);
+          for (int steps = 0; steps < emulator::MEMSZ; steps++) {
+               if (m_kind[target] != WK_Instruction || m_written[target])
+                    break;
+               int next = OpcodeOf(m_memory[target]);
+               if ((next != OP_Branch && next != opcode) || OperandOf(m_memory[target]) == target)
+                    break;
+               target = OperandOf(m_memory[target]);
+          }
+
+          if (target != OperandOf(m_memory[loc])) {
+               m_changes.push_back(to_string(loc) + ": the branch to " + to_string(OperandOf(m_memory[loc])) + " now goes to " + to_string(target));
+               m_memory[loc] = opcode * 10000 + target;
+               m_threaded++;
+          }
+     }
+} /* void Optimizer::ThreadBranches() */
+
+
+/**/
+/*
+Optimizer::RemoveStoredLoads()
+
+NAME
+
+    Optimizer::RemoveStoredLoads - remove loads of what was just stored.
+
+SYNOPSIS
+
+    void Optimizer::RemoveStoredLoads();
+
+DESCRIPTION
+
+    A load right after a store to the same location loads what the accumulator already holds. It is
+    removed unless something else can reach it, which would be a branch to it.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Optimizer::RemoveStoredLoads()
+{
+     for (int loc = 0; loc + 1 < emulator::MEMSZ; loc++) {
+          int next = loc + 1;
+          if (m_kind[loc] != WK_Instruction || m_kind[next] != WK_Instruction || m_removed[loc] || m_pinned[next])
+               continue;
+          if (OpcodeOf(m_memory[loc]) == OP_Store && OpcodeOf(m_memory[next]) == OP_Load
+               && OperandOf(m_memory[loc]) == OperandOf(m_memory[next])) {
+               m_changes.push_back(to_string(next) + ": removed the load of " + to_string(OperandOf(m_memory[next])) + " after the store to it");
+               m_removed[next] = true;
+               m_loads++;
+          }
+     }
+} /* void Optimizer::RemoveStoredLoads() */
+
+
+/**/
+/*
+Optimizer::RemoveUnreachable()
+
+NAME
+
+    Optimizer::RemoveUnreachable - remove instructions that are never executed.
+
+SYNOPSIS
+
+    void Optimizer::RemoveUnreachable();
+
+DESCRIPTION
+
+    Removes the instructions no path from the origin reaches, such as the ones after an unconditional
+    branch or a halt, unless a label or an operand refers to them.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Optimizer::RemoveUnreachable()
+{
+     for (int loc = 0; loc < emulator::MEMSZ; loc++) {
+          if (m_kind[loc] == WK_Instruction && !m_reachable[loc] && !m_pinned[loc] && !m_removed[loc]) {
+               m_changes.push_back(to_string(loc) + ": removed the unreachable instruction " + to_string(m_memory[loc]));
+               m_removed[loc] = true;
+               m_unreachable++;
+          }
+     }
+} /* void Optimizer::RemoveUnreachable() */
+
+
+/**/
+/*
+Optimizer::MergeConstants()
+
+NAME
+
+    Optimizer::MergeConstants - merge constants of the same value.
+
+SYNOPSIS
+
+    void Optimizer::MergeConstants();
+
+DESCRIPTION
+
+    The constants that nothing writes are grouped by value. The instructions that refer to any of a
+    group then refer to its first constant, and the others are removed; their labels go to the first.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Optimizer::MergeConstants()
+{
+     map<int, int> first;    // Location of the first constant of each value.
+     for (int loc = 0; loc < emulator::MEMSZ; loc++) {
+          if (m_kind[loc] != WK_Constant || m_written[loc] || m_removed[loc])
+               continue;
+          map<int, int>::iterator it = first.find(m_memory[loc]);
+          if (it == first.end()) {
+               first[m_memory[loc]] = loc;
+               continue;
+          }
+          m_changes.push_back(to_string(loc) + ": merged the constant " + to_string(m_memory[loc]) + " into the one at " + to_string(it->second));
+          m_removed[loc] = true;
+          m_source[loc] = it->second;
+          m_merged++;
+     }
+
+     for (int loc = 0; loc < emulator::MEMSZ; loc++) {
+          if (m_kind[loc] != WK_Instruction || m_removed[loc] || OpcodeOf(m_memory[loc]) == OP_Halt || IsBranch(OpcodeOf(m_memory[loc])))
+               continue;
+          int operand = OperandOf(m_memory[loc]);
+          if (m_removed[operand] && m_source[operand] != operand)
+               m_memory[loc] = OpcodeOf(m_memory[loc]) * 10000 + m_source[operand];
+     }
+} /* void Optimizer::MergeConstants() */
+
+
+/**/
+/*
+Optimizer::Compact()
+
+NAME
+
+    Optimizer::Compact - move the words after the removed ones down.
+
+SYNOPSIS
+
+    void Optimizer::Compact();
+
+DESCRIPTION
+
+    Counts the removed words before each location, and changes the operands of the remaining
+    instructions to the locations their words move to.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Optimizer::Compact()
+{
+     for (int loc = 0; loc < emulator::MEMSZ; loc++)
+          m_removedBefore[loc + 1] = m_removedBefore[loc] + (m_removed[loc] ? 1 : 0);
+     if (m_removedBefore[emulator::MEMSZ] == 0)
+          return;
+
+     for (int loc = 0; loc < emulator::MEMSZ; loc++) {
+          if (m_kind[loc] != WK_Instruction || m_removed[loc] || OpcodeOf(m_memory[loc]) == OP_Halt)
+               continue;
+          m_memory[loc] = OpcodeOf(m_memory[loc]) * 10000 + NewLocation(OperandOf(m_memory[loc]));
+     }
+} /* void Optimizer::Compact() */
+
+
+/**/
+/*
+Optimizer::NewLocation(int a_loc)
+
+NAME
+
+    Optimizer::NewLocation - the location a location moves to.
+
+SYNOPSIS
+
+    int Optimizer::NewLocation(int a_loc) const;
+    a_loc    --> the location before the words were removed.
+
+DESCRIPTION
+
+    Subtracts the number of words removed before a_loc.
+
+RETURNS
+
+    The new location.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+int Optimizer::NewLocation(int a_loc) const
+{
+     if (a_loc < 0 || a_loc > emulator::MEMSZ)
+          return a_loc;
+     return a_loc - m_removedBefore[a_loc];
+} /* int Optimizer::NewLocation(int a_loc) const */
+
+
+/**/
+/*
+Optimizer::Remap(int a_loc)
+
+NAME
+
+    Optimizer::Remap - the new location of a word.
+
+SYNOPSIS
+
+    int Optimizer::Remap(int a_loc) const;
+    a_loc    --> the location of the word before optimization.
+
+DESCRIPTION
+
+    Gives where a word, or the label on it, is after optimization.
+
+RETURNS
+
+    The new location. For a merged constant, the new location of the constant it was merged into;
+    for another removed word, -1.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+int Optimizer::Remap(int a_loc) const
+{
+     if (a_loc < 0 || a_loc >= emulator::MEMSZ)
+          return a_loc;
+     if (m_removed[a_loc])
+          return m_source[a_loc] != a_loc ? NewLocation(m_source[a_loc]) : -1;
+     return NewLocation(a_loc);
+} /* int Optimizer::Remap(int a_loc) const */
+
+
+/**/
+/*
+Optimizer::GetMachineCode()
+
+NAME
+
+    Optimizer::GetMachineCode - the optimized words.
+
+SYNOPSIS
+
+    vector<pair<int, int>> Optimizer::GetMachineCode() const;
+
+DESCRIPTION
+
+    Gives the words that were kept, at their new locations.
+
+RETURNS
+
+    The (location, contents) pairs, in order of location.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+vector<pair<int, int>> Optimizer::GetMachineCode() const
+{
+     vector<pair<int, int>> machinecode;
+     for (int loc = 0; loc < emulator::MEMSZ; loc++) {
+          if (m_kind[loc] != WK_None && !m_removed[loc])
+               machinecode.push_back(pair<int, int>(NewLocation(loc), m_memory[loc]));
+     }
+     return machinecode;
+} /* vector<pair<int, int>> Optimizer::GetMachineCode() const */
+
+
+/**/
+/*
+Optimizer::GetSymbols()
+
+NAME
+
+    Optimizer::GetSymbols - the labels at their new locations.
+
+SYNOPSIS
+
+    map<string, int> Optimizer::GetSymbols() const;
+
+DESCRIPTION
+
+    Moves each label with its word. The label of a merged constant goes to the constant it was merged
+    into. Removed instructions have no labels, as labels keep their instructions.
+
+RETURNS
+
+    The labels and their new locations.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+map<string, int> Optimizer::GetSymbols() const
+{
+     map<string, int> symbols;
+     for (map<string, int>::const_iterator it = m_symbols.begin(); it != m_symbols.end(); ++it) {
+          int loc = Remap(it->second);
+          symbols[it->first] = loc == -1 ? NewLocation(it->second) : loc;
+     }
+     return symbols;
+} /* map<string, int> Optimizer::GetSymbols() const */
+
+
+/**/
+/*
+Optimizer::Report(ostream &a_out)
+
+NAME
+
+    Optimizer::Report - print what was changed.
+
+SYNOPSIS
+
+    void Optimizer::Report(ostream &a_out) const;
+    a_out    --> where the report is printed.
+
+DESCRIPTION
+
+    Prints each change, at the locations from before optimization, followed by a summary. If no words
+    could be removed, says why.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Optimizer::Report(ostream &a_out) const
+{
+     a_out << endl << "Optimization:" << endl;
+     for (vector<string>::const_iterator it = m_changes.begin(); it != m_changes.end(); ++it)
+          a_out << "    " << *it << endl;
+     if (!m_movable)
+          a_out << "    No words were removed, since " << m_notMovable << endl;
+
+     a_out << "Threaded " << m_threaded << " branches, removed " << m_loads << " loads after stores and "
+          << m_unreachable << " unreachable instructions, merged " << m_merged << " constants; the program is "
+          << m_removedBefore[emulator::MEMSZ] << " words shorter" << endl << endl;
+} /* void Optimizer::Report(ostream &a_out) const */
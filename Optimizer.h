@@ -0,0 +1,154 @@
+#pragma once
+
+/**/
+/*
+Optimizer Class
+
+NAME
+
+     Optimizer - peephole optimization of an assembled program.
+
+DESCRIPTION
+
+     Optimizer class - rewrites the machine code translated by Pass II so the program executes
+     fewer instructions and takes less memory, without changing what it does:
+
+         - a load of the location the previous instruction stored to is removed,
+         - a branch to an unconditional branch, or to a branch of its own kind, is made to go
+           straight to the end of the chain,
+         - instructions that no path from the origin reaches are removed,
+         - constants of the same value that are only read are merged into one.
+
+     Removing words moves the words after them, so every operand and label is moved with them.
+     That is only safe because the VC-3600 has no indirect addressing: locations only appear in
+     the operands of instructions. A program that uses instructions as data, or executes its
+     data, could compute locations the optimizer cannot see, so for such a program nothing is
+     removed and only branches that no store can change are threaded.
+
+     Locations that labels of instructions or the operands of branches, stores and reads refer
+     to are kept, as is the origin.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+
+#include "Emulator.h"
+
+class Optimizer {
+
+public:
+
+    // a_machinecode are the (location, contents) pairs of Pass II, and a_instructions tells which of them are instructions.
+    Optimizer( const vector<pair<int, int>> &a_machinecode, const vector<bool> &a_instructions, int a_origin, int a_end,
+        const map<string, int> &a_symbols );
+    ~Optimizer( ) { };
+
+    // Optimize the program.
+    void Run( );
+
+    // Print what was changed.
+    void Report( ostream &a_out ) const;
+
+    // The new location of a word. A merged constant goes to the one it was merged into, other removed words to -1.
+    int Remap( int a_loc ) const;
+
+    // Check if the word at a location was removed.
+    inline bool IsRemoved( int a_loc ) const {
+
+        return a_loc >= 0 && a_loc < emulator::MEMSZ && m_removed[a_loc];
+    };
+
+    // The optimized program.
+    vector<pair<int, int>> GetMachineCode( ) const;
+    map<string, int> GetSymbols( ) const;
+    inline int GetOrigin( ) const {
+
+        return NewLocation( m_origin );
+    };
+    inline int GetEnd( ) const {
+
+        return NewLocation( m_end );
+    };
+
+private:
+
+    // What a location of memory holds.
+    enum WordKind {
+        WK_None,            // Nothing was placed there: storage or unused memory.
+        WK_Instruction,     // An instruction.
+        WK_Constant         // A constant.
+    };
+
+    // Opcodes the optimizer looks at.
+    enum Opcode {
+        OP_Load = 5,
+        OP_Store = 6,
+        OP_Read = 7,
+        OP_Branch = 9,
+        OP_BranchMinus = 10,
+        OP_BranchPositive = 12,
+        OP_Halt = 13
+    };
+
+    // Find the locations that must be kept and whether words may be removed.
+    void Analyze( );
+
+    // Mark the words that a path from the origin reaches.
+    void FindReachable( );
+
+    // The rewrites.
+    void ThreadBranches( );
+    void RemoveStoredLoads( );
+    void RemoveUnreachable( );
+    void MergeConstants( );
+
+    // Move the words after the removed ones down, changing the operands to match.
+    void Compact( );
+
+    // Location a_loc moves to when the removed words are taken out.
+    int NewLocation( int a_loc ) const;
+
+    // Parts of a word.
+    static inline int OpcodeOf( int a_word ) {
+
+        return a_word / 10000;
+    };
+    static inline int OperandOf( int a_word ) {
+
+        return a_word % 10000;
+    };
+    static inline bool IsBranch( int a_opcode ) {
+
+        return a_opcode >= OP_Branch && a_opcode <= OP_BranchPositive;
+    };
+
+    int m_origin;                   // Location of the first instruction.
+    int m_end;                      // Location following the program.
+    map<string, int> m_symbols;     // The labels and their locations.
+
+    vector<int> m_memory;           // The program as it is placed in memory.
+    vector<WordKind> m_kind;        // What each location holds.
+    vector<int> m_source;           // Location each word was merged into, or the location itself.
+    vector<bool> m_pinned;          // == true if the location must be kept.
+    vector<bool> m_written;         // == true if a store or read writes the location.
+    vector<bool> m_usedAsData;      // == true if an instruction other than a branch refers to the location.
+    vector<bool> m_reachable;       // == true if a path from the origin reaches the location.
+    vector<bool> m_removed;         // == true if the word is removed.
+    vector<int> m_removedBefore;    // Number of removed words before each location, once compacted.
+
+    bool m_movable;                 // == true if words may be removed.
+    string m_notMovable;            // Why words may not be removed.
+    vector<string> m_changes;       // Description of each change made.
+    int m_threaded;                 // Number of branches threaded.
+    int m_loads;                    // Number of loads removed.
+    int m_unreachable;              // Number of unreachable instructions removed.
+    int m_merged;                   // Number of constants merged.
+};
@@ -0,0 +1,1396 @@
+//
+//      Implementation of the Options class.
+//
+#include "stdafx.h"
+#include "Options.h"
+
+// The options selected on the command line.
+static string m_sourceFile;
+static string m_imageFile;
+static string m_debugFile;
+static bool m_runImage = false;
+static bool m_incremental = false;
+static bool m_optimize = false;
+static bool m_evaluate = false;
+static int m_evaluateSteps = 10000;
+static double m_evaluateSeconds = 1.0;
+static string m_cacheFile;
+static bool m_compile = false;
+static bool m_link = false;
+static bool m_batch = false;
+static bool m_shards = false;
+static bool m_pipelined = false;
+static vector<string> m_inputFiles;
+static bool m_stats = false;
+static string m_statsFile;
+static string m_coverageFile;
+static bool m_report = false;
+static string m_inputLogFile;
+static bool m_replay = false;
+static string m_translateFile;
+static string m_imageCacheDirectory;
+static size_t m_imageCacheBytes = 64 * (size_t)1048576;
+static string m_resultCacheDirectory;
+static size_t m_resultCacheBytes = 64 * (size_t)1048576;
+
+// Read the bounds of --evaluate=<MaxSteps>[:<MaxSeconds>].
+static bool ParseBounds(const string &a_bounds)
+{
+     size_t colon = a_bounds.find(':');
+     char *end;
+     long steps = strtol(a_bounds.substr(0, colon).c_str(), &end, 10);
+     if (*end != '\0' || colon == 0 || steps <= 0 || steps > INT_MAX)
+          return false;
+     m_evaluateSteps = (int)steps;
+     if (colon == string::npos)
+          return true;
+     m_evaluateSeconds = strtod(a_bounds.c_str() + colon + 1, &end);
+     return *end == '\0' && colon + 1 < a_bounds.size() && m_evaluateSeconds > 0;
+}
+
+// Read <Directory>[:<MaxMegabytes>] of --image-cache and --result-cache. A colon not followed by a number is part of the directory.
+static bool ParseCache(const string &a_cache, string &a_directory, size_t &a_bytes)
+{
+     a_directory = a_cache;
+     size_t colon = a_cache.find_last_of(':');
+     if (colon == string::npos || colon + 1 == a_cache.size() || a_cache.find_first_not_of("0123456789", colon + 1) != string::npos)
+          return !a_cache.empty();
+     long megabytes = strtol(a_cache.c_str() + colon + 1, NULL, 10);
+     a_directory = a_cache.substr(0, colon);
+     a_bytes = (size_t)megabytes * 1048576;
+     return colon > 0 && megabytes > 0 && megabytes <= INT_MAX / 2;
+}
+
+// Strip the extension from a file name.
+static string BaseName(const string &a_fileName)
+{
+     string base = a_fileName;
+     size_t dot = base.find_last_of('.');
+     if (dot != string::npos && base.find_first_of("/\\", dot) == string::npos)
+          base.erase(dot);
+     return base;
+}
+
+
+/**/
+/*
+Options::ParseCommandLine(int argc, char *argv[])
+
+NAME
+
+    Options::ParseCommandLine - parse the command line.
+
+SYNOPSIS
+
+    void Options::ParseCommandLine(int argc, char *argv[]);
+    argc       --> total number of arguments received in the command line.
+    *argv[]    --> the array of arguments passed through the command line.
+
+DESCRIPTION
+
+    Parse the command line. The accepted forms are:
+
+        Assem <FileName>                        assemble, save the image as <FileName> with a .vco extension and run it.
+        Assem -o <ImageFile> <FileName>         assemble, save the image as <ImageFile> and run it.
+        Assem -x <ImageFile>                    run a previously assembled image.
+        Assem -c <FileName>...                  assemble each file as a module, saved with a .vco extension.
+        Assem -l <ImageFile> <ObjectFile>...    link the modules into an image that can be run with -x.
+        Assem -r <CoverageFile> <FileName>      print the source with the coverage recorded in <CoverageFile>.
+        Assem -t <CppFile> <ImageFile>          translate a previously assembled image into a C++ program.
+        Assem -b <ImageFile>...                 run previously assembled images at once on a pool of threads.
+        Assem -s <ImageFile> <InputFile>...     run a previously assembled image on each input file in worker processes.
+        Assem -p <FileName>...                  assemble and run each file, with the stages of many files at once.
+
+    Any form may be followed by --stats to print the time spent in each phase and the counters of the work
+    done when the program finishes, or by --stats=<JsonFile> to write them to a file as JSON instead.
+
+    With -b each image reads its input from a file named after it with a .in extension, if there is
+    one, and the output of the images is printed in the order they were given once all of them are done.
+    Runs of the same image under different names share one copy of it, and each keeps only the
+    memory it writes.
+    With -s the image is loaded once and run on each input file by as many worker processes as there
+    are cores, and the output of each input file is likewise printed in order. A worker that crashes,
+    or takes more than 10 seconds over one input file, is replaced and the batch goes on without it.
+    With -b and -s a run of the same image on the same input as an earlier run of the batch is not
+    done again; it is given the result of the earlier one. --result-cache=<Directory>[:<MaxMegabytes>]
+    also keeps the result of each run that halted or ran out of steps in the directory, under a hash
+    of the image and the input, so no later batch does that run again either. The results used least
+    recently are deleted when the directory takes more than the given megabytes (64 by default).
+    With -p the files go through a pipeline whose stages (reading, Pass I, Pass II, loading and
+    running) each have their own threads. Nothing is saved and there is no listing: each program
+    reads its input from a file named after the source with a .in extension, if there is one, and
+    its output and errors are printed in the order the files were given.
+
+    When a program is assembled, the table from its locations to its source lines and labels is saved
+    next to the image, with a .vcd extension.
+
+    When assembling a program, -O optimizes the translation before it is saved and run: loads of what
+    was just stored and unreachable instructions are removed, branches to branches are threaded and
+    equal constants are merged. What was changed is printed after the listing.
+
+    --evaluate[=<MaxSteps>[:<MaxSeconds>]] runs the program when it is assembled, up to the first
+    instruction that reads, writes, halts or would overflow, but for no more than the given steps
+    (10000 by default) and seconds (1 by default). The image then starts from where that run stopped.
+
+    When assembling, or with -p, --image-cache=<Directory>[:<MaxMegabytes>] keeps the image, debug
+    information and listing of each program in the directory, under a hash of its source and the
+    options that change the translation. A program assembled before is loaded from there without
+    being assembled again and its listing is printed as it was. The entries used least recently are
+    deleted when the directory takes more than the given megabytes (64 by default). Any number of
+    runs may share the directory at once.
+
+    When assembling, -i keeps the results of each block of lines in a cache file next to the source file
+    (with a .vcc extension) so that the next run only redoes the work for blocks that changed or moved.
+
+    When a program is run, --coverage=<CoverageFile> records which instructions and branch directions it
+    executed and merges them into the file, so the file collects the coverage of any number of runs.
+    --record=<InputLog> saves the values the program reads, and the steps at which it reads them, and
+    --replay=<InputLog> gives the program the saved values instead of reading the console, without
+    waiting for Enter, so the run is repeated exactly.
+
+    Terminates the program with a usage message if the command line is not valid.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Options::ParseCommandLine(int argc, char *argv[])
+{
+     for (int i = 1; i < argc; i++) {
+          string arg = argv[i];
+
+          if ((arg == "-o" || arg == "-x" || arg == "-l" || arg == "-s") && i + 1 < argc && m_imageFile.empty()) {
+               m_imageFile = argv[++i];
+               m_runImage = (arg == "-x");
+               m_link = (arg == "-l");
+               m_shards = (arg == "-s");
+          }
+          else if (arg == "-i") {
+               m_incremental = true;
+          }
+          else if (arg == "-O") {
+               m_optimize = true;
+          }
+          else if (arg == "--evaluate" || arg.compare(0, 11, "--evaluate=") == 0) {
+               m_evaluate = true;
+               if (arg.size() > 11 && !ParseBounds(arg.substr(11)))
+                    Usage();
+          }
+          else if (arg == "--stats" || arg.compare(0, 8, "--stats=") == 0) {
+               m_stats = true;
+               m_statsFile = arg.size() > 8 ? arg.substr(8) : "";
+          }
+          else if (arg.compare(0, 11, "--coverage=") == 0 && arg.size() > 11 && m_coverageFile.empty()) {
+               m_coverageFile = arg.substr(11);
+          }
+          else if ((arg.compare(0, 9, "--record=") == 0 || arg.compare(0, 9, "--replay=") == 0) && arg.size() > 9 && m_inputLogFile.empty()) {
+               m_inputLogFile = arg.substr(9);
+               m_replay = (arg[4] == 'p');
+          }
+          else if (arg.compare(0, 14, "--image-cache=") == 0 && m_imageCacheDirectory.empty()) {
+               if (!ParseCache(arg.substr(14), m_imageCacheDirectory, m_imageCacheBytes))
+                    Usage();
+          }
+          else if (arg.compare(0, 15, "--result-cache=") == 0 && m_resultCacheDirectory.empty()) {
+               if (!ParseCache(arg.substr(15), m_resultCacheDirectory, m_resultCacheBytes))
+                    Usage();
+          }
+          else if (arg == "-r" && i + 1 < argc && m_coverageFile.empty()) {
+               m_coverageFile = argv[++i];
+               m_report = true;
+          }
+          else if (arg == "-t" && i + 1 < argc && m_translateFile.empty()) {
+               m_translateFile = argv[++i];
+          }
+          else if (arg == "-c") {
+               m_compile = true;
+          }
+          else if (arg == "-b") {
+               m_batch = true;
+          }
+          else if (arg == "-p") {
+               m_pipelined = true;
+          }
+          else if (arg[0] != '-' && (m_compile || m_link || m_batch || m_shards || m_pipelined || m_inputFiles.empty())) {
+               m_inputFiles.push_back(arg);
+          }
+          else {
+               Usage();
+          }
+     }
+
+     // Modules are assembled and linked in separate runs, without running anything.
+     if (m_compile && (m_link || m_batch || m_shards || m_pipelined || m_runImage || !m_imageFile.empty() || m_inputFiles.empty()))
+          Usage();
+     if (m_link && (m_batch || m_shards || m_pipelined || m_incremental || m_inputFiles.empty()))
+          Usage();
+     if ((m_compile || m_link) && (m_optimize || m_evaluate || !m_coverageFile.empty() || !m_inputLogFile.empty() || !m_imageCacheDirectory.empty()))
+          Usage();
+     if (m_compile || m_link)
+          return;
+
+     // Only the runs of a batch, or of one image on many input files, are kept in the result cache.
+     if (!m_resultCacheDirectory.empty() && !m_batch && !m_shards)
+          Usage();
+
+     // Images run as a batch, or on many input files, are only run, and a pipeline has no options of its own but the image cache.
+     if (m_batch || m_shards || m_pipelined) {
+          if (m_batch + m_shards + m_pipelined != 1 || m_shards == m_imageFile.empty() || m_runImage || m_incremental || m_optimize || m_evaluate || m_report
+               || !m_coverageFile.empty() || !m_inputLogFile.empty() || !m_translateFile.empty() || m_inputFiles.empty()
+               || (!m_pipelined && !m_imageCacheDirectory.empty()))
+               Usage();
+          return;
+     }
+
+     // An image is translated without assembling or running anything.
+     if (!m_translateFile.empty()) {
+          if (m_runImage || !m_imageFile.empty() || m_incremental || m_optimize || m_evaluate || !m_coverageFile.empty()
+               || !m_inputLogFile.empty() || !m_imageCacheDirectory.empty() || m_inputFiles.size() != 1)
+               Usage();
+          m_imageFile = m_inputFiles[0];
+          return;
+     }
+
+     // The coverage is reported against the source without writing or running anything.
+     if (m_report && (m_runImage || !m_imageFile.empty() || m_incremental || m_optimize || m_evaluate || !m_inputLogFile.empty()
+          || !m_imageCacheDirectory.empty()))
+          Usage();
+
+     // Only a program being assembled can be optimized, evaluated or cached.
+     if (m_runImage && (m_optimize || m_evaluate || !m_imageCacheDirectory.empty()))
+          Usage();
+
+     // Exactly one of a source file or an image to run is required.
+     if (m_runImage != m_inputFiles.empty())
+          Usage();
+     if (!m_inputFiles.empty())
+          m_sourceFile = m_inputFiles[0];
+
+     // The image and the cache are named after the source file unless a name was given.
+     string base = BaseName(m_sourceFile);
+     if (m_imageFile.empty())
+          m_imageFile = base + ".vco";
+     m_debugFile = BaseName(m_imageFile) + ".vcd";
+     m_cacheFile = base + ".vcc";
+} /* void Options::ParseCommandLine(int argc, char *argv[]) */
+
+
+/**/
+/*
+Options::SourceFile()
+
+NAME
+
+    Options::SourceFile - the source file to be assembled.
+
+SYNOPSIS
+
+    const string &Options::SourceFile();
+
+DESCRIPTION
+
+    Get the name of the source file given on the command line.
+
+RETURNS
+
+    The name of the source file. Empty if an image is to be run or modules are assembled or linked.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+const string &Options::SourceFile()
+{
+     return m_sourceFile;
+} /* const string &Options::SourceFile() */
+
+
+/**/
+/*
+Options::ImageFile()
+
+NAME
+
+    Options::ImageFile - the object image file.
+
+SYNOPSIS
+
+    const string &Options::ImageFile();
+
+DESCRIPTION
+
+    Get the name of the object image the assembler writes, the image to be run with -x, or the image
+    the linker writes with -l.
+
+RETURNS
+
+    The name of the object image file.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+const string &Options::ImageFile()
+{
+     return m_imageFile;
+} /* const string &Options::ImageFile() */
+
+
+/**/
+/*
+Options::DebugFile()
+
+NAME
+
+    Options::DebugFile - the file the debug information is written to.
+
+SYNOPSIS
+
+    const string &Options::DebugFile();
+
+DESCRIPTION
+
+    Get the name of the debug information file, which is the image file with a .vcd extension.
+
+RETURNS
+
+    The name of the debug information file. Empty if modules are assembled or linked.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+const string &Options::DebugFile()
+{
+     return m_debugFile;
+} /* const string &Options::DebugFile() */
+
+
+/**/
+/*
+Options::RunImage()
+
+NAME
+
+    Options::RunImage - check if an image is to be run.
+
+SYNOPSIS
+
+    bool Options::RunImage();
+
+DESCRIPTION
+
+    Check if the -x option was given to run a previously assembled image without assembling anything.
+
+RETURNS
+
+    'true' if an image is to be run,
+    'false' if a source file is to be assembled.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Options::RunImage()
+{
+     return m_runImage;
+} /* bool Options::RunImage() */
+
+
+/**/
+/*
+Options::Incremental()
+
+NAME
+
+    Options::Incremental - check if the translation cache is to be used.
+
+SYNOPSIS
+
+    bool Options::Incremental();
+
+DESCRIPTION
+
+    Check if the -i option was given to assemble incrementally using the translation cache.
+
+RETURNS
+
+    'true' if the translation cache is to be used,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Options::Incremental()
+{
+     return m_incremental;
+} /* bool Options::Incremental() */
+
+
+/**/
+/*
+Options::Optimize()
+
+NAME
+
+    Options::Optimize - check if the translation is to be optimized.
+
+SYNOPSIS
+
+    bool Options::Optimize();
+
+DESCRIPTION
+
+    Check if -O was given, to optimize the translation of the program before it is saved and run.
+
+RETURNS
+
+    'true' if the translation is to be optimized,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Options::Optimize()
+{
+     return m_optimize;
+} /* bool Options::Optimize() */
+
+
+/**/
+/*
+Options::Evaluate()
+
+NAME
+
+    Options::Evaluate - check if the start of the program is to be run at assembly time.
+
+SYNOPSIS
+
+    bool Options::Evaluate();
+
+DESCRIPTION
+
+    Check if --evaluate was given, to run the program up to its first input when it is assembled.
+
+RETURNS
+
+    'true' if the start of the program is to be run,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Options::Evaluate()
+{
+     return m_evaluate;
+} /* bool Options::Evaluate() */
+
+
+/**/
+/*
+Options::EvaluateSteps()
+
+NAME
+
+    Options::EvaluateSteps - the most steps run at assembly time.
+
+SYNOPSIS
+
+    int Options::EvaluateSteps();
+
+DESCRIPTION
+
+    Get the number of steps given with --evaluate=<MaxSteps>.
+
+RETURNS
+
+    The most steps to run, 10000 if no number was given.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+int Options::EvaluateSteps()
+{
+     return m_evaluateSteps;
+} /* int Options::EvaluateSteps() */
+
+
+/**/
+/*
+Options::EvaluateSeconds()
+
+NAME
+
+    Options::EvaluateSeconds - the most time spent running at assembly time.
+
+SYNOPSIS
+
+    double Options::EvaluateSeconds();
+
+DESCRIPTION
+
+    Get the number of seconds given with --evaluate=<MaxSteps>:<MaxSeconds>.
+
+RETURNS
+
+    The most seconds to run for, 1 if no number was given.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+double Options::EvaluateSeconds()
+{
+     return m_evaluateSeconds;
+} /* double Options::EvaluateSeconds() */
+
+
+/**/
+/*
+Options::CacheFile()
+
+NAME
+
+    Options::CacheFile - the translation cache file.
+
+SYNOPSIS
+
+    const string &Options::CacheFile();
+
+DESCRIPTION
+
+    Get the name of the file the translation cache is kept in. This is the source file name with a .vcc extension.
+
+RETURNS
+
+    The name of the translation cache file.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+const string &Options::CacheFile()
+{
+     return m_cacheFile;
+} /* const string &Options::CacheFile() */
+
+
+/**/
+/*
+Options::Compile()
+
+NAME
+
+    Options::Compile - check if modules are to be assembled.
+
+SYNOPSIS
+
+    bool Options::Compile();
+
+DESCRIPTION
+
+    Check if the -c option was given to assemble each input file as a relocatable module.
+
+RETURNS
+
+    'true' if modules are to be assembled,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Options::Compile()
+{
+     return m_compile;
+} /* bool Options::Compile() */
+
+
+/**/
+/*
+Options::Link()
+
+NAME
+
+    Options::Link - check if modules are to be linked.
+
+SYNOPSIS
+
+    bool Options::Link();
+
+DESCRIPTION
+
+    Check if the -l option was given to link the input files into the image named after it.
+
+RETURNS
+
+    'true' if modules are to be linked,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Options::Link()
+{
+     return m_link;
+} /* bool Options::Link() */
+
+
+/**/
+/*
+Options::InputFiles()
+
+NAME
+
+    Options::InputFiles - the files given on the command line.
+
+SYNOPSIS
+
+    const vector<string> &Options::InputFiles();
+
+DESCRIPTION
+
+    Get the source files to be assembled as modules with -c, or the object files to be linked with -l.
+
+RETURNS
+
+    The names of the input files in the order they were given.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+const vector<string> &Options::InputFiles()
+{
+     return m_inputFiles;
+} /* const vector<string> &Options::InputFiles() */
+
+
+/**/
+/*
+Options::ObjectFileFor(const string &a_sourceFile)
+
+NAME
+
+    Options::ObjectFileFor - the object file of a module.
+
+SYNOPSIS
+
+    string Options::ObjectFileFor(const string &a_sourceFile);
+    a_sourceFile    --> name of the source file of the module.
+
+DESCRIPTION
+
+    Get the name the module assembled from a source file is saved as. This is the source file name
+    with a .vco extension.
+
+RETURNS
+
+    The name of the object file.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+string Options::ObjectFileFor(const string &a_sourceFile)
+{
+     return BaseName(a_sourceFile) + ".vco";
+} /* string Options::ObjectFileFor(const string &a_sourceFile) */
+
+
+/**/
+/*
+Options::Batch()
+
+NAME
+
+    Options::Batch - check if images are to be run as a batch.
+
+SYNOPSIS
+
+    bool Options::Batch();
+
+DESCRIPTION
+
+    Check if the -b option was given to run the input files, which are images, at once on a pool of
+    threads.
+
+RETURNS
+
+    'true' if the images are to be run as a batch,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Options::Batch()
+{
+     return m_batch;
+} /* bool Options::Batch() */
+
+
+/**/
+/*
+Options::Shards()
+
+NAME
+
+    Options::Shards - check if an image is to be run on many input files.
+
+SYNOPSIS
+
+    bool Options::Shards();
+
+DESCRIPTION
+
+    Check if the -s option was given to run the image on each of the input files in worker
+    processes.
+
+RETURNS
+
+    'true' if the image is to be run on the input files,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Options::Shards()
+{
+     return m_shards;
+} /* bool Options::Shards() */
+
+
+/**/
+/*
+Options::Pipelined()
+
+NAME
+
+    Options::Pipelined - check if source files are to be assembled and run in a pipeline.
+
+SYNOPSIS
+
+    bool Options::Pipelined();
+
+DESCRIPTION
+
+    Check if the -p option was given to assemble and run each of the input files, which are source
+    files, with a pool of threads for each stage.
+
+RETURNS
+
+    'true' if the source files are to be run in a pipeline,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Options::Pipelined()
+{
+     return m_pipelined;
+} /* bool Options::Pipelined() */
+
+
+/**/
+/*
+Options::InputFileFor(const string &a_imageFile)
+
+NAME
+
+    Options::InputFileFor - the input file of an image run in a batch.
+
+SYNOPSIS
+
+    string Options::InputFileFor(const string &a_imageFile);
+    a_imageFile    --> name of the image.
+
+DESCRIPTION
+
+    Get the name of the file an image run with -b, or a source file run with -p, reads its input
+    from. This is the file name with a .in extension.
+
+RETURNS
+
+    The name of the input file.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+string Options::InputFileFor(const string &a_imageFile)
+{
+     return BaseName(a_imageFile) + ".in";
+} /* string Options::InputFileFor(const string &a_imageFile) */
+
+
+/**/
+/*
+Options::Stats()
+
+NAME
+
+    Options::Stats - check if statistics are to be reported.
+
+SYNOPSIS
+
+    bool Options::Stats();
+
+DESCRIPTION
+
+    Check if the --stats option was given to report the time spent in each phase and the counters of the
+    work done.
+
+RETURNS
+
+    'true' if statistics are to be reported,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Options::Stats()
+{
+     return m_stats;
+} /* bool Options::Stats() */
+
+
+/**/
+/*
+Options::StatsFile()
+
+NAME
+
+    Options::StatsFile - the file statistics are written to.
+
+SYNOPSIS
+
+    const string &Options::StatsFile();
+
+DESCRIPTION
+
+    Get the file given with --stats=<JsonFile>, which the statistics are written to as JSON.
+
+RETURNS
+
+    The name of the file, or an empty string if the statistics are to be printed as a table.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+const string &Options::StatsFile()
+{
+     return m_statsFile;
+} /* const string &Options::StatsFile() */
+
+
+/**/
+/*
+Options::CoverageFile()
+
+NAME
+
+    Options::CoverageFile - the file holding the coverage.
+
+SYNOPSIS
+
+    const string &Options::CoverageFile();
+
+DESCRIPTION
+
+    Get the file given with --coverage=<CoverageFile>, which the coverage of the run is merged into, or
+    the one given with -r, which the coverage is reported from.
+
+RETURNS
+
+    The name of the file, or an empty string if the coverage is not recorded.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+const string &Options::CoverageFile()
+{
+     return m_coverageFile;
+} /* const string &Options::CoverageFile() */
+
+
+/**/
+/*
+Options::Report()
+
+NAME
+
+    Options::Report - check if the coverage is to be reported.
+
+SYNOPSIS
+
+    bool Options::Report();
+
+DESCRIPTION
+
+    Check if -r was given, to print the source with the coverage instead of assembling and running it.
+
+RETURNS
+
+    'true' if the coverage is to be reported,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Options::Report()
+{
+     return m_report;
+} /* bool Options::Report() */
+
+
+/**/
+/*
+Options::InputLogFile()
+
+NAME
+
+    Options::InputLogFile - the file of the values read by the program.
+
+SYNOPSIS
+
+    const string &Options::InputLogFile();
+
+DESCRIPTION
+
+    Get the file given with --record=<InputLog> or --replay=<InputLog>.
+
+RETURNS
+
+    The name of the file, or an empty string if the values read are neither recorded nor replayed.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+const string &Options::InputLogFile()
+{
+     return m_inputLogFile;
+} /* const string &Options::InputLogFile() */
+
+
+/**/
+/*
+Options::Replay()
+
+NAME
+
+    Options::Replay - check if the values read are replayed.
+
+SYNOPSIS
+
+    bool Options::Replay();
+
+DESCRIPTION
+
+    Check if --replay was given, to give the program the values of the input log instead of reading
+    the console.
+
+RETURNS
+
+    'true' if the values are replayed,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Options::Replay()
+{
+     return m_replay;
+} /* bool Options::Replay() */
+
+
+/**/
+/*
+Options::TranslateFile()
+
+NAME
+
+    Options::TranslateFile - the file an image is translated into.
+
+SYNOPSIS
+
+    const string &Options::TranslateFile();
+
+DESCRIPTION
+
+    Get the file given with -t, which the C++ translation of the image is written to.
+
+RETURNS
+
+    The name of the file, or an empty string if nothing is to be translated.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+const string &Options::TranslateFile()
+{
+     return m_translateFile;
+} /* const string &Options::TranslateFile() */
+
+
+/**/
+/*
+Options::ImageCacheDirectory()
+
+NAME
+
+    Options::ImageCacheDirectory - the directory of the image cache.
+
+SYNOPSIS
+
+    const string &Options::ImageCacheDirectory();
+
+DESCRIPTION
+
+    Get the directory given with --image-cache, which assembled programs are kept in.
+
+RETURNS
+
+    The name of the directory, or an empty string if the image cache is not in use.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+const string &Options::ImageCacheDirectory()
+{
+     return m_imageCacheDirectory;
+} /* const string &Options::ImageCacheDirectory() */
+
+
+/**/
+/*
+Options::ImageCacheBytes()
+
+NAME
+
+    Options::ImageCacheBytes - the size the image cache may take.
+
+SYNOPSIS
+
+    size_t Options::ImageCacheBytes();
+
+DESCRIPTION
+
+    Get the size given with --image-cache, 64 megabytes if none was given.
+
+RETURNS
+
+    The size in bytes.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+size_t Options::ImageCacheBytes()
+{
+     return m_imageCacheBytes;
+} /* size_t Options::ImageCacheBytes() */
+
+
+/**/
+/*
+Options::ResultCacheDirectory()
+
+NAME
+
+    Options::ResultCacheDirectory - the directory of the result cache.
+
+SYNOPSIS
+
+    const string &Options::ResultCacheDirectory();
+
+DESCRIPTION
+
+    Get the directory given with --result-cache, which the results of runs are kept in.
+
+RETURNS
+
+    The name of the directory, or an empty string if the result cache is not in use.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+const string &Options::ResultCacheDirectory()
+{
+     return m_resultCacheDirectory;
+} /* const string &Options::ResultCacheDirectory() */
+
+
+/**/
+/*
+Options::ResultCacheBytes()
+
+NAME
+
+    Options::ResultCacheBytes - the size the result cache may take.
+
+SYNOPSIS
+
+    size_t Options::ResultCacheBytes();
+
+DESCRIPTION
+
+    Get the size given with --result-cache, 64 megabytes if none was given.
+
+RETURNS
+
+    The size in bytes.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+size_t Options::ResultCacheBytes()
+{
+     return m_resultCacheBytes;
+} /* size_t Options::ResultCacheBytes() */
+
+
+/**/
+/*
+Options::Usage()
+
+NAME
+
+    Options::Usage - print the usage message.
+
+SYNOPSIS
+
+    void Options::Usage();
+
+DESCRIPTION
+
+    Print how the program is to be invoked and terminate.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Options::Usage()
+{
+     cerr << "Usage: Assem [-i] [-O] [--evaluate[=<MaxSteps>[:<MaxSeconds>]]] [--image-cache=<Directory>[:<MaxMegabytes>]] [-o <ImageFile>] [<RunOptions>] <FileName> [--stats[=<JsonFile>]]" << endl;
+     cerr << "       Assem -x <ImageFile> [<RunOptions>] [--stats[=<JsonFile>]]" << endl;
+     cerr << "       Assem -c <FileName>... [--stats[=<JsonFile>]]" << endl;
+     cerr << "       Assem -l <ImageFile> <ObjectFile>... [--stats[=<JsonFile>]]" << endl;
+     cerr << "       Assem -r <CoverageFile> <FileName> [--stats[=<JsonFile>]]" << endl;
+     cerr << "       Assem -t <CppFile> <ImageFile> [--stats[=<JsonFile>]]" << endl;
+     cerr << "       Assem -b <ImageFile>... [--result-cache=<Directory>[:<MaxMegabytes>]] [--stats[=<JsonFile>]]" << endl;
+     cerr << "       Assem -s <ImageFile> <InputFile>... [--result-cache=<Directory>[:<MaxMegabytes>]] [--stats[=<JsonFile>]]" << endl;
+     cerr << "       Assem -p <FileName>... [--image-cache=<Directory>[:<MaxMegabytes>]] [--stats[=<JsonFile>]]" << endl;
+     cerr << "RunOptions: [--coverage=<CoverageFile>] [--record=<InputLog> | --replay=<InputLog>]" << endl;
+     exit(1);
+} /* void Options::Usage() */
@@ -0,0 +1,118 @@
+#pragma once
+
+/**/
+/*
+Options Class
+
+NAME
+
+     Options - the command line options of the program.
+
+DESCRIPTION
+
+     Options class - parses the command line and holds the options it selects.
+     Note: all members are static so we can access them anywhere.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+
+class Options {
+
+public:
+
+    // Parse the command line. Terminates the program with a usage message if it is not valid.
+    static void ParseCommandLine( int argc, char *argv[] );
+
+    // The source file to be assembled.
+    static const string &SourceFile( );
+
+    // The object image to be written by the assembler or run by the emulator.
+    static const string &ImageFile( );
+
+    // The file the debug information of the image is written to.
+    static const string &DebugFile( );
+
+    // Check if a previously assembled image is to be run without assembling anything.
+    static bool RunImage( );
+
+    // Check if the source is to be assembled incrementally using the translation cache.
+    static bool Incremental( );
+
+    // Check if the translation is to be optimized.
+    static bool Optimize( );
+
+    // Check if the start of the program is to be run at assembly time, and the bounds for doing so.
+    static bool Evaluate( );
+    static int EvaluateSteps( );
+    static double EvaluateSeconds( );
+
+    // The file the translation cache is kept in.
+    static const string &CacheFile( );
+
+    // Check if each input file is to be assembled as a module.
+    static bool Compile( );
+
+    // Check if the input files are modules to be linked into the image.
+    static bool Link( );
+
+    // The source files of the modules, the modules to be linked, the images to be run as a batch, the inputs to run the image on, or the sources to run in a pipeline.
+    static const vector<string> &InputFiles( );
+
+    // The object file a module is saved as.
+    static string ObjectFileFor( const string &a_sourceFile );
+
+    // Check if the input files are images to be run at once on a pool of threads.
+    static bool Batch( );
+
+    // Check if the image is to be run on each input file in worker processes.
+    static bool Shards( );
+
+    // Check if the input files are source files to be assembled and run in a pipeline.
+    static bool Pipelined( );
+
+    // The file an image run in a batch, or a source run in a pipeline, reads its input from.
+    static string InputFileFor( const string &a_imageFile );
+
+    // Check if statistics are to be reported when the program finishes.
+    static bool Stats( );
+
+    // The file the statistics are written to as JSON. Empty to print them as a table.
+    static const string &StatsFile( );
+
+    // The file the coverage of the run is merged into, or reported from with -r. Empty if there is none.
+    static const string &CoverageFile( );
+
+    // Check if the coverage is to be reported against the source instead of running the program.
+    static bool Report( );
+
+    // The file the values read by the program are recorded in or replayed from. Empty if there is none.
+    static const string &InputLogFile( );
+
+    // Check if the values read are replayed from the input log instead of read from the console.
+    static bool Replay( );
+
+    // The file the C++ translation of the image is written to. Empty if nothing is to be translated.
+    static const string &TranslateFile( );
+
+    // The directory assembled programs are kept in, and the size it may take. Empty if the image cache is not in use.
+    static const string &ImageCacheDirectory( );
+    static size_t ImageCacheBytes( );
+
+    // The directory the results of runs are kept in, and the size it may take. Empty if the result cache is not in use.
+    static const string &ResultCacheDirectory( );
+    static size_t ResultCacheBytes( );
+
+private:
+
+    // Print the usage message and terminate.
+    static void Usage( );
+};
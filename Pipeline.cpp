@@ -0,0 +1,524 @@
+//
+//      Implementation of the Pipeline class.
+//
+#include "stdafx.h"
+#include "Pipeline.h"
+#include "Assembler.h"
+#include "Emulator.h"
+#include "Errors.h"
+#include "Options.h"
+
+
+/**/
+/*
+Pipeline::Pipeline(int a_threads, int a_depth)
+
+NAME
+
+    Pipeline::Pipeline - make a pipeline.
+
+SYNOPSIS
+
+    Pipeline::Pipeline(int a_threads, int a_depth);
+    a_threads    --> number of threads of each stage, 0 for one per core.
+    a_depth      --> the most jobs a queue between two stages holds.
+
+DESCRIPTION
+
+    Makes a pipeline that has not been run.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+Pipeline::Pipeline(int a_threads, int a_depth)
+     : m_depth(max(1, a_depth)), m_imageCache(NULL), m_written(0)
+{
+     for (int i = 0; i < PS_Stages; i++)
+          m_threads[i] = a_threads > 0 ? a_threads : max(1, (int)thread::hardware_concurrency());
+} /* Pipeline::Pipeline(int a_threads, int a_depth) */
+
+
+/**/
+/*
+Pipeline::SetThreads(Stage a_stage, int a_threads)
+
+NAME
+
+    Pipeline::SetThreads - change the number of threads of a stage.
+
+SYNOPSIS
+
+    void Pipeline::SetThreads(Stage a_stage, int a_threads);
+    a_stage      --> the stage.
+    a_threads    --> its number of threads, 0 for one per core.
+
+DESCRIPTION
+
+    Sets the size of the thread pool of the stage for the next call to Run.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Pipeline::SetThreads(Stage a_stage, int a_threads)
+{
+     m_threads[a_stage] = a_threads > 0 ? a_threads : max(1, (int)thread::hardware_concurrency());
+} /* void Pipeline::SetThreads(Stage a_stage, int a_threads) */
+
+
+/**/
+/*
+Pipeline::UseImageCache(ImageCache *a_cache)
+
+NAME
+
+    Pipeline::UseImageCache - assemble through an image cache.
+
+SYNOPSIS
+
+    void Pipeline::UseImageCache(ImageCache *a_cache);
+    a_cache    --> the image cache, which must outlive the runs.
+
+DESCRIPTION
+
+    The assembler of each file looks it up in the cache, and saves it there if it was not found. The
+    cache is shared by the threads of the stages, and it may be shared with other processes as well.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Pipeline::UseImageCache(ImageCache *a_cache)
+{
+     m_imageCache = a_cache;
+} /* void Pipeline::UseImageCache(ImageCache *a_cache) */
+
+
+/**/
+/*
+Pipeline::Run(const vector<string> &a_sourceFiles, ostream &a_out)
+
+NAME
+
+    Pipeline::Run - assemble and run the source files.
+
+SYNOPSIS
+
+    bool Pipeline::Run(const vector<string> &a_sourceFiles, ostream &a_out);
+    a_sourceFiles    --> the source files.
+    a_out            --> the stream the results are written to.
+
+DESCRIPTION
+
+    Starts the threads of every stage and a thread that feeds the files into the first stage, then
+    writes the result of each file in turn as soon as it is done: its name, the output of its
+    program and its errors. Each program reads its input from the file Options::InputFileFor names,
+    if there is one. Returns once every file has been written and the threads have finished.
+
+RETURNS
+
+    'true' if every file was assembled and run without errors,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Pipeline::Run(const vector<string> &a_sourceFiles, ostream &a_out)
+{
+     m_queues.clear();
+     for (int i = 0; i < PS_Stages; i++) {
+          m_queues.push_back(unique_ptr<Queue>(new Queue(m_depth)));
+          m_live[i] = m_threads[i];
+     }
+     m_done.clear();
+     m_done.resize(a_sourceFiles.size());
+     m_written = 0;
+
+     vector<thread> threads;
+     for (int i = 0; i < PS_Stages; i++) {
+          for (int j = 0; j < m_threads[i]; j++)
+               threads.push_back(thread(&Pipeline::Work, this, i));
+     }
+     threads.push_back(thread(&Pipeline::Feed, this, cref(a_sourceFiles)));
+
+     bool success = true;
+     for (size_t i = 0; i < a_sourceFiles.size(); i++) {
+          unique_ptr<Job> job;
+          {
+               unique_lock<mutex> lock(m_doneLock);
+               m_doneChanged.wait(lock, [this, i]() { return m_done[i] != NULL; });
+               job = move(m_done[i]);
+               m_written++;
+          }
+          m_doneChanged.notify_all();
+
+          a_out << job->m_sourceFile << ":" << endl << job->m_output.str();
+          vector<string> *previous = Errors::CaptureErrors(&job->m_errors);
+          Errors::DisplayErrors(a_out);
+          Errors::CaptureErrors(previous);
+          success = success && job->m_errors.empty();
+     }
+
+     for (size_t i = 0; i < threads.size(); i++)
+          threads[i].join();
+     return success;
+} /* bool Pipeline::Run(const vector<string> &a_sourceFiles, ostream &a_out) */
+
+
+/**/
+/*
+Pipeline::Feed(const vector<string> &a_sourceFiles)
+
+NAME
+
+    Pipeline::Feed - start the jobs.
+
+SYNOPSIS
+
+    void Pipeline::Feed(const vector<string> &a_sourceFiles);
+    a_sourceFiles    --> the source files.
+
+DESCRIPTION
+
+    Makes a job for each file in order and puts it in the queue of the first stage, waiting while
+    the job would be further ahead of the oldest one not written than the window allows. The window
+    is what the queues and the threads can hold, so the stages are never kept waiting by it. Closes
+    the queue once every job has been started.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Pipeline::Feed(const vector<string> &a_sourceFiles)
+{
+     size_t window = 0;
+     for (int i = 0; i < PS_Stages; i++)
+          window += m_depth + m_threads[i];
+
+     for (size_t i = 0; i < a_sourceFiles.size(); i++) {
+          {
+               unique_lock<mutex> lock(m_doneLock);
+               m_doneChanged.wait(lock, [this, i, window]() { return i < m_written + window; });
+          }
+          Job *job = new Job;
+          job->m_index = i;
+          job->m_sourceFile = a_sourceFiles[i];
+          job->m_failed = false;
+          m_queues[PS_Read]->Push(job);
+     }
+     m_queues[PS_Read]->Close();
+} /* void Pipeline::Feed(const vector<string> &a_sourceFiles) */
+
+
+/**/
+/*
+Pipeline::Work(int a_stage)
+
+NAME
+
+    Pipeline::Work - the work of a thread of a stage.
+
+SYNOPSIS
+
+    void Pipeline::Work(int a_stage);
+    a_stage    --> the stage.
+
+DESCRIPTION
+
+    Takes the jobs from the queue in front of the stage, does the stage on each one that has not
+    failed and passes it on to the next queue. The jobs of the last stage are done. The last thread
+    of a stage to find its queue closed and empty closes the queue of the next stage.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Pipeline::Work(int a_stage)
+{
+     Job *job;
+     while ((job = m_queues[a_stage]->Pop()) != NULL) {
+          if (!job->m_failed) {
+               vector<string> *previous = Errors::CaptureErrors(&job->m_errors);
+               Process(a_stage, *job);
+               Errors::CaptureErrors(previous);
+               job->m_failed = !job->m_errors.empty();
+          }
+
+          if (a_stage + 1 < PS_Stages) {
+               m_queues[a_stage + 1]->Push(job);
+               continue;
+          }
+          {
+               lock_guard<mutex> lock(m_doneLock);
+               m_done[job->m_index].reset(job);
+          }
+          m_doneChanged.notify_all();
+     }
+     if (--m_live[a_stage] == 0 && a_stage + 1 < PS_Stages)
+          m_queues[a_stage + 1]->Close();
+} /* void Pipeline::Work(int a_stage) */
+
+
+/**/
+/*
+Pipeline::Process(int a_stage, Job &a_job)
+
+NAME
+
+    Pipeline::Process - do one stage on a job.
+
+SYNOPSIS
+
+    void Pipeline::Process(int a_stage, Job &a_job);
+    a_stage    --> the stage.
+    a_job      --> the job.
+
+DESCRIPTION
+
+    Reads the source, unless the image cache may have the program, does Pass I or Pass II with the
+    listing kept apart and no waiting for Enter, loads the image and the input into an emulator of
+    the job's own, freeing the assembler, or runs the program and frees the emulator. The errors found are recorded as usual, and are collected
+    with the job by Work.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Pipeline::Process(int a_stage, Job &a_job)
+{
+     switch (a_stage) {
+          case PS_Read:
+          {
+               // The assembler gives up on the whole program if the file does not open.
+               if (!ifstream(a_job.m_sourceFile.c_str())) {
+                    string error = "Source file " + a_job.m_sourceFile + " could not be opened";
+                    Errors::RecordError(error);
+                    break;
+               }
+               a_job.m_assembler.reset(new Assembler(a_job.m_sourceFile));
+               a_job.m_assembler->SetOutput(a_job.m_listing);
+               if (m_imageCache != NULL)
+                    a_job.m_assembler->UseImageCache(m_imageCache, "");
+               else
+                    a_job.m_assembler->ReadSource();
+               break;
+          }
+          case PS_PassI:
+               a_job.m_assembler->PassI();
+               break;
+          case PS_PassII:
+               a_job.m_assembler->PassII();
+               a_job.m_assembler->CacheImage();
+               break;
+          case PS_Load:
+          {
+               a_job.m_emulator.reset(new emulator);
+               if (!a_job.m_assembler->GetImage().Load(*a_job.m_emulator)) {
+                    string error = "Error inserting the object image into the emulator memory";
+                    Errors::RecordError(error);
+               }
+               a_job.m_assembler.reset();
+
+               ifstream file(Options::InputFileFor(a_job.m_sourceFile).c_str());
+               a_job.m_input.str(string(istreambuf_iterator<char>(file), istreambuf_iterator<char>()));
+               a_job.m_emulator->setStreams(&a_job.m_input, &a_job.m_output);
+               break;
+          }
+          case PS_Run:
+               if (!a_job.m_emulator->runProgram()) {
+                    string error = "Error running the emulator";
+                    Errors::RecordError(error);
+               }
+               a_job.m_emulator.reset();
+               break;
+     }
+} /* void Pipeline::Process(int a_stage, Job &a_job) */
+
+
+/**/
+/*
+Pipeline::Queue::Push(Job *a_job)
+
+NAME
+
+    Pipeline::Queue::Push - add a job to a queue.
+
+SYNOPSIS
+
+    void Pipeline::Queue::Push(Job *a_job);
+    a_job    --> the job.
+
+DESCRIPTION
+
+    Waits while the queue is full, then adds the job at the end.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Pipeline::Queue::Push(Job *a_job)
+{
+     {
+          unique_lock<mutex> lock(m_lock);
+          m_notFull.wait(lock, [this]() { return m_jobs.size() < m_capacity; });
+          m_jobs.push_back(a_job);
+     }
+     m_notEmpty.notify_one();
+} /* void Pipeline::Queue::Push(Job *a_job) */
+
+
+/**/
+/*
+Pipeline::Queue::Pop()
+
+NAME
+
+    Pipeline::Queue::Pop - take a job from a queue.
+
+SYNOPSIS
+
+    Job *Pipeline::Queue::Pop();
+
+DESCRIPTION
+
+    Waits while the queue is empty and not closed, then takes the oldest job.
+
+RETURNS
+
+    The job, or NULL if the queue is closed and empty.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+Pipeline::Job *Pipeline::Queue::Pop()
+{
+     Job *job;
+     {
+          unique_lock<mutex> lock(m_lock);
+          m_notEmpty.wait(lock, [this]() { return !m_jobs.empty() || m_closed; });
+          if (m_jobs.empty())
+               return NULL;
+          job = m_jobs.front();
+          m_jobs.pop_front();
+     }
+     m_notFull.notify_one();
+     return job;
+} /* Job *Pipeline::Queue::Pop() */
+
+
+/**/
+/*
+Pipeline::Queue::Close()
+
+NAME
+
+    Pipeline::Queue::Close - close a queue.
+
+SYNOPSIS
+
+    void Pipeline::Queue::Close();
+
+DESCRIPTION
+
+    Marks the queue as closed and wakes every thread waiting for a job, so those that find it empty
+    return.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Pipeline::Queue::Close()
+{
+     {
+          lock_guard<mutex> lock(m_lock);
+          m_closed = true;
+     }
+     m_notEmpty.notify_all();
+} /* void Pipeline::Queue::Close() */
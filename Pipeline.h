@@ -0,0 +1,134 @@
+#pragma once
+
+/**/
+/*
+Pipeline Class
+
+NAME
+
+     Pipeline - assemble and run many source files at once, a stage on each thread pool.
+
+DESCRIPTION
+
+     Pipeline class - takes each source file through five stages: reading the source, Pass I,
+     Pass II, loading the image into an emulator, and running it. Each stage has a pool of threads
+     of its own, and the stages are joined by queues that hold at most a given number of files. A
+     stage that gets ahead of the next one waits for room in the queue, so files at every stage are
+     worked on at once, and the memory in use stays bounded however many files there are.
+
+     The results are written in the order the files were given, each as soon as it and every file
+     before it are done. Only a bounded window of files may be started ahead of the oldest one not
+     written yet, so a slow file holds up how far the others get, not how much is kept.
+
+     With an image cache, a file assembled before is loaded from it in the Pass I stage, and Pass II
+     has nothing to do for it. The others are saved in it once Pass II is done.
+
+     A file that fails a stage, by not opening or by having errors, is passed through the rest of
+     the stages without being worked on, so that its errors are written in its turn.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+class Assembler;
+class emulator;
+class ImageCache;
+
+class Pipeline {
+
+public:
+
+    // The stages, in order.
+    enum Stage {
+        PS_Read,        // Read the source.
+        PS_PassI,       // Establish the locations of the labels.
+        PS_PassII,      // Translate.
+        PS_Load,        // Load the image and the input into an emulator.
+        PS_Run,         // Run the program.
+        PS_Stages       // Number of stages.
+    };
+
+    const static int DEFAULT_DEPTH = 16;        // Files a queue holds unless asked otherwise.
+
+    // A_threads of 0 gives each stage a thread per core.
+    Pipeline( int a_threads = 0, int a_depth = DEFAULT_DEPTH );
+    ~Pipeline( ) { };
+
+    // Change the number of threads of one stage.
+    void SetThreads( Stage a_stage, int a_threads );
+
+    // Load the programs assembled before from a_cache, and save the others in it.
+    void UseImageCache( ImageCache *a_cache );
+
+    // Take each source file through the stages and write the results in order. Returns true if every file ran without errors.
+    bool Run( const vector<string> &a_sourceFiles, ostream &a_out );
+
+private:
+
+    // A source file on its way through the pipeline.
+    struct Job {
+        size_t m_index;                         // Its place among the files given.
+        string m_sourceFile;                    // The source file.
+        unique_ptr<Assembler> m_assembler;      // Its assembler, until the image is loaded.
+        unique_ptr<emulator> m_emulator;        // The emulator it runs in, once loaded.
+        ostringstream m_listing;                // The translation listing, which is not written.
+        istringstream m_input;                  // What the program reads.
+        ostringstream m_output;                 // What it writes.
+        vector<string> m_errors;                // The errors of every stage.
+        bool m_failed;                          // == true once a stage has failed.
+    };
+
+    // A queue between two stages, that holds at most a given number of jobs.
+    class Queue {
+
+    public:
+
+        Queue( int a_capacity ) : m_capacity( a_capacity ), m_closed( false ) { };
+
+        // Add a job, waiting while the queue is full.
+        void Push( Job *a_job );
+
+        // Take the oldest job, waiting while the queue is empty. Returns NULL once it is closed and empty.
+        Job *Pop( );
+
+        // No more jobs will be added.
+        void Close( );
+
+    private:
+
+        mutex m_lock;
+        condition_variable m_notFull;
+        condition_variable m_notEmpty;
+        deque<Job *> m_jobs;
+        size_t m_capacity;
+        bool m_closed;
+    };
+
+    // The work of a thread of a stage.
+    void Work( int a_stage );
+
+    // Do one stage on a job.
+    void Process( int a_stage, Job &a_job );
+
+    // Start the jobs in order, as long as the window allows.
+    void Feed( const vector<string> &a_sourceFiles );
+
+    int m_threads[PS_Stages];                   // Number of threads of each stage.
+    int m_depth;                                // Jobs a queue holds.
+    ImageCache *m_imageCache;                   // The image cache, NULL if it is not in use.
+
+    vector<unique_ptr<Queue>> m_queues;         // The queue in front of each stage.
+    atomic<int> m_live[PS_Stages];              // Threads of each stage still working.
+
+    mutex m_doneLock;                           // Held to finish a job, start one or write one.
+    condition_variable m_doneChanged;           // Signalled when a job is done or written.
+    vector<unique_ptr<Job>> m_done;             // The jobs that are done, by index, until they are written.
+    size_t m_written;                           // Jobs written so far.
+};
@@ -0,0 +1,617 @@
+//
+//      Implementation of the ProgramGenerator class.
+//
+#include "stdafx.h"
+#include "ProgramGenerator.h"
+#include "Emulator.h"
+
+
+/**/
+/*
+ProgramGenerator::DefaultShape()
+
+NAME
+
+    ProgramGenerator::DefaultShape - the default shape of the programs.
+
+SYNOPSIS
+
+    static ProgramGenerator::Shape ProgramGenerator::DefaultShape();
+
+DESCRIPTION
+
+    A program of a thousand instructions, a hundred extra labels, loops nested three deep, half the
+    data after the code, one data word for every four instructions and few reads and writes.
+
+RETURNS
+
+    The default shape.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+ProgramGenerator::Shape ProgramGenerator::DefaultShape()
+{
+     Shape shape = { 1000, 100, 0.5, 3, 0.25, 0.02, false };
+     return shape;
+} /* ProgramGenerator::Shape ProgramGenerator::DefaultShape() */
+
+
+/**/
+/*
+ProgramGenerator::Generate(const Shape &a_shape, ostream &a_out)
+
+NAME
+
+    ProgramGenerator::Generate - write a program.
+
+SYNOPSIS
+
+    void ProgramGenerator::Generate(const Shape &a_shape, ostream &a_out);
+    a_shape    --> the size and shape of the program.
+    a_out      --> the stream the source code is written to.
+
+DESCRIPTION
+
+    Writes sections until the requested number of instructions were written, followed by the end
+    statement. Nothing follows the end statement, not even a new line, since the assembler reports
+    any line after it.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void ProgramGenerator::Generate(const Shape &a_shape, ostream &a_out)
+{
+     m_nextLabel = 0;
+     m_labelsLeft = a_shape.m_labels;
+     m_linesLeft = a_shape.m_lines;
+
+     a_out << "; generated program: " << a_shape.m_lines << " instructions, " << a_shape.m_labels << " labels, forward ratio "
+           << a_shape.m_forwardRatio << ", loop depth " << a_shape.m_loopDepth << ", data density " << a_shape.m_dataDensity
+           << ", i/o frequency " << a_shape.m_ioFrequency << (a_shape.m_fillMemory ? ", memory filled" : "") << "\n";
+
+     bool first = true;
+     while (first || m_linesLeft > 0) {
+          GenerateSection(a_shape, first, a_out);
+          first = false;
+     }
+     a_out << "         end";
+} /* void ProgramGenerator::Generate(const Shape &a_shape, ostream &a_out) */
+
+
+/**/
+/*
+ProgramGenerator::GenerateSection(const Shape &a_shape, bool a_first, ostream &a_out)
+
+NAME
+
+    ProgramGenerator::GenerateSection - write a section of the program.
+
+SYNOPSIS
+
+    void ProgramGenerator::GenerateSection(const Shape &a_shape, bool a_first, ostream &a_out);
+    a_shape    --> the size and shape of the program.
+    a_first    --> == true for the first section, which needs no org statement.
+    a_out      --> the stream the source code is written to.
+
+DESCRIPTION
+
+    Writes statements until the program has all its instructions or the section is full, then a halt,
+    the data placed after the code and, if asked for, storage up to the last word of memory.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void ProgramGenerator::GenerateSection(const Shape &a_shape, bool a_first, ostream &a_out)
+{
+     if (!a_first)
+          a_out << "         org     0\n";
+     m_loc = 0;
+     m_dataWords = 0;
+     m_one.clear();
+     m_pendingLabel.clear();
+     m_inline.clear();
+     m_tail.clear();
+
+     GenerateBlock(a_shape, 0, INT_MAX, a_out);
+
+     // A label followed only by halt would be read as an op code, so a pending label goes on a load.
+     if (!m_pendingLabel.empty())
+          Emit("load", m_one.empty() ? NewOne() : m_one, a_out);
+     Emit("halt", "", a_out);
+
+     for (size_t i = 0; i < m_tail.size(); i++)
+          EmitData(m_tail[i], a_out);
+
+     if (a_shape.m_fillMemory && m_loc < emulator::MEMSZ) {
+          a_out << left << setw(9) << NewLabel('m') << setw(8) << "ds" << emulator::MEMSZ - m_loc << "\n";
+          m_loc = emulator::MEMSZ;
+     }
+} /* void ProgramGenerator::GenerateSection(const Shape &a_shape, bool a_first, ostream &a_out) */
+
+
+/**/
+/*
+ProgramGenerator::GenerateBlock(const Shape &a_shape, int a_depth, int a_statements, ostream &a_out)
+
+NAME
+
+    ProgramGenerator::GenerateBlock - write a run of statements.
+
+SYNOPSIS
+
+    void ProgramGenerator::GenerateBlock(const Shape &a_shape, int a_depth, int a_statements, ostream &a_out);
+    a_shape         --> the size and shape of the program.
+    a_depth         --> the number of loops the statements are nested in.
+    a_statements    --> the number of statements to write.
+    a_out           --> the stream the source code is written to.
+
+DESCRIPTION
+
+    Writes statements until a_statements were written, the program has all its instructions or the
+    section is full. A statement is one of:
+
+        a counted loop, running its body two or three times, while a_depth is below the loop depth;
+        a read into storage or a write of any data word;
+        a conditional branch skipping forward over up to three statements;
+        a load of a constant, up to three arithmetic operations on constants and a store.
+
+    The loops and the skipped statements are themselves written with GenerateBlock.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void ProgramGenerator::GenerateBlock(const Shape &a_shape, int a_depth, int a_statements, ostream &a_out)
+{
+     // Room left for closing the enclosing loops, the halt and the data after the code.
+     while (a_statements-- > 0 && m_linesLeft > 0
+          && m_loc + (int)m_tail.size() + 4 * (a_depth + 1) + SECTION_SLACK < emulator::MEMSZ) {
+          double choice = Fraction();
+
+          if (a_depth < a_shape.m_loopDepth && choice < 0.1) {
+               // A counted loop with its own counter, which no other statement uses.
+               DataWord counter = { NewLabel('c'), false, 0, false };
+               DataWord count = { NewLabel('n'), true, 2 + (int)Random(2), false };
+               m_tail.push_back(counter);
+               m_tail.push_back(count);
+               if (m_one.empty())
+                    NewOne();
+               string top = NewLabel('t');
+
+               Emit("load", count.m_label, a_out);
+               Emit("store", counter.m_label, a_out);
+               SetPendingLabel(top, a_out);
+               GenerateBlock(a_shape, a_depth + 1, 2 + Random(6), a_out);
+               Emit("load", counter.m_label, a_out);
+               Emit("sub", m_one, a_out);
+               Emit("store", counter.m_label, a_out);
+               Emit("bp", top, a_out);
+          }
+          else if ((choice = Fraction()) < a_shape.m_ioFrequency) {
+               if (Random(2) == 0) {
+                    string storage = PickData(a_shape, false, a_out);
+                    Emit("read", storage, a_out);
+               }
+               else {
+                    string data = PickData(a_shape, Random(2) == 0, a_out);
+                    Emit("write", data, a_out);
+               }
+          }
+          else if (choice < a_shape.m_ioFrequency + 0.1) {
+               // Skip forward over a few statements, depending on the last value computed.
+               static const char *branches[] = { "bz", "bp", "bm" };
+               string skip = NewLabel('f');
+               Emit(branches[Random(3)], skip, a_out);
+               GenerateBlock(a_shape, a_depth, 1 + Random(3), a_out);
+               SetPendingLabel(skip, a_out);
+          }
+          else {
+               // At most one multiplication, so the accumulator stays far from overflowing.
+               static const char *operations[] = { "add", "sub", "mult", "div" };
+               string constant = PickData(a_shape, true, a_out);
+               Emit("load", constant, a_out);
+               bool multiplied = false;
+               for (uint32_t i = 1 + Random(3); i > 0; i--) {
+                    uint32_t operation = Random(multiplied ? 2 : 4);
+                    multiplied = multiplied || operation == 2;
+                    constant = PickData(a_shape, true, a_out);
+                    Emit(operations[operation], constant, a_out);
+               }
+               string storage = PickData(a_shape, false, a_out);
+               Emit("store", storage, a_out);
+          }
+     }
+} /* void ProgramGenerator::GenerateBlock(const Shape &a_shape, int a_depth, int a_statements, ostream &a_out) */
+
+
+/**/
+/*
+ProgramGenerator::Emit(const string &a_opcode, const string &a_operand, ostream &a_out)
+
+NAME
+
+    ProgramGenerator::Emit - write an instruction.
+
+SYNOPSIS
+
+    void ProgramGenerator::Emit(const string &a_opcode, const string &a_operand, ostream &a_out);
+    a_opcode     --> the symbolic op code.
+    a_operand    --> the operand, empty for halt.
+    a_out        --> the stream the source code is written to.
+
+DESCRIPTION
+
+    Writes the instruction with the pending label, if any. Otherwise the instruction may be given one
+    of the extra labels, so that they are spread evenly over the instructions of the program. Halt is
+    never labelled, since a label and halt alone would be taken for an op code and an operand.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void ProgramGenerator::Emit(const string &a_opcode, const string &a_operand, ostream &a_out)
+{
+     string label = m_pendingLabel;
+     m_pendingLabel.clear();
+     if (label.empty() && !a_operand.empty() && m_labelsLeft > 0 && Fraction() * max(m_linesLeft, 1) < m_labelsLeft) {
+          label = NewLabel('l');
+          m_labelsLeft--;
+     }
+
+     a_out << left << setw(9) << label;
+     if (a_operand.empty())
+          a_out << a_opcode << "\n";
+     else
+          a_out << setw(8) << a_opcode << a_operand << "\n";
+     m_loc++;
+     m_linesLeft--;
+} /* void ProgramGenerator::Emit(const string &a_opcode, const string &a_operand, ostream &a_out) */
+
+
+/**/
+/*
+ProgramGenerator::EmitData(const DataWord &a_word, ostream &a_out)
+
+NAME
+
+    ProgramGenerator::EmitData - write a data word.
+
+SYNOPSIS
+
+    void ProgramGenerator::EmitData(const DataWord &a_word, ostream &a_out);
+    a_word    --> the data word.
+    a_out     --> the stream the source code is written to.
+
+DESCRIPTION
+
+    Writes a dc statement for a constant or a ds statement setting aside one word of storage.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void ProgramGenerator::EmitData(const DataWord &a_word, ostream &a_out)
+{
+     a_out << left << setw(9) << a_word.m_label << setw(8) << (a_word.m_constant ? "dc" : "ds")
+           << (a_word.m_constant ? a_word.m_value : 1) << "\n";
+     m_loc++;
+} /* void ProgramGenerator::EmitData(const DataWord &a_word, ostream &a_out) */
+
+
+/**/
+/*
+ProgramGenerator::SetPendingLabel(const string &a_label, ostream &a_out)
+
+NAME
+
+    ProgramGenerator::SetPendingLabel - label the next instruction.
+
+SYNOPSIS
+
+    void ProgramGenerator::SetPendingLabel(const string &a_label, ostream &a_out);
+    a_label    --> the label.
+    a_out      --> the stream the source code is written to.
+
+DESCRIPTION
+
+    Makes a_label the label of the next instruction. An instruction has only one label, so if another
+    label is already waiting, it is given to a load of a constant first.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void ProgramGenerator::SetPendingLabel(const string &a_label, ostream &a_out)
+{
+     if (!m_pendingLabel.empty()) {
+          string one = m_one.empty() ? NewOne() : m_one;
+          Emit("load", one, a_out);
+     }
+     m_pendingLabel = a_label;
+} /* void ProgramGenerator::SetPendingLabel(const string &a_label, ostream &a_out) */
+
+
+/**/
+/*
+ProgramGenerator::NewOne()
+
+NAME
+
+    ProgramGenerator::NewOne - make the constant 1 of the section.
+
+SYNOPSIS
+
+    string ProgramGenerator::NewOne();
+
+DESCRIPTION
+
+    Adds the constant 1 to the data after the code of the section. Loops count down with it.
+
+RETURNS
+
+    The label of the constant.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+string ProgramGenerator::NewOne()
+{
+     DataWord one = { NewLabel('k'), true, 1, false };
+     m_one = one.m_label;
+     m_tail.push_back(one);
+     return m_one;
+} /* string ProgramGenerator::NewOne() */
+
+
+/**/
+/*
+ProgramGenerator::PickData(const Shape &a_shape, bool a_constant, ostream &a_out)
+
+NAME
+
+    ProgramGenerator::PickData - choose a data word to refer to.
+
+SYNOPSIS
+
+    string ProgramGenerator::PickData(const Shape &a_shape, bool a_constant, ostream &a_out);
+    a_shape       --> the size and shape of the program.
+    a_constant    --> == true for a constant, false for storage.
+    a_out         --> the stream the source code is written to.
+
+DESCRIPTION
+
+    Makes a new data word while the section has fewer than the data density asks for, or none of the
+    kind needed. A new word goes after the code with the forward ratio as its chance; otherwise it is
+    written right away behind a branch over it, so the instruction referring to it refers back to it.
+    When no new word is needed, an existing word is chosen after the code with the forward ratio as its
+    chance, and among the code otherwise.
+
+RETURNS
+
+    The label of the data word.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+string ProgramGenerator::PickData(const Shape &a_shape, bool a_constant, ostream &a_out)
+{
+     vector<const DataWord *> forward, backward;
+     for (size_t i = 0; i < m_tail.size(); i++) {
+          if (m_tail[i].m_shared && m_tail[i].m_constant == a_constant)
+               forward.push_back(&m_tail[i]);
+     }
+     for (size_t i = 0; i < m_inline.size(); i++) {
+          if (m_inline[i].m_constant == a_constant)
+               backward.push_back(&m_inline[i]);
+     }
+
+     bool wantForward = Fraction() < a_shape.m_forwardRatio;
+     if ((forward.empty() && backward.empty()) || m_dataWords < a_shape.m_dataDensity * m_loc) {
+          DataWord word = { NewLabel(a_constant ? 'k' : 's'), a_constant, 1 + (int)Random(99), true };
+          m_dataWords++;
+          if (wantForward) {
+               m_tail.push_back(word);
+          }
+          else {
+               string over = NewLabel('j');
+               Emit("b", over, a_out);
+               EmitData(word, a_out);
+               m_inline.push_back(word);
+               SetPendingLabel(over, a_out);
+          }
+          return word.m_label;
+     }
+
+     vector<const DataWord *> &pool = (wantForward && !forward.empty()) || backward.empty() ? forward : backward;
+     return pool[Random((uint32_t)pool.size())]->m_label;
+} /* string ProgramGenerator::PickData(const Shape &a_shape, bool a_constant, ostream &a_out) */
+
+
+/**/
+/*
+ProgramGenerator::NewLabel(char a_prefix)
+
+NAME
+
+    ProgramGenerator::NewLabel - make a new label.
+
+SYNOPSIS
+
+    string ProgramGenerator::NewLabel(char a_prefix);
+    a_prefix    --> the letter the label starts with, telling what it labels.
+
+DESCRIPTION
+
+    Labels are numbered through the whole program, so they are unique even across sections. They are
+    in lower case because the assembler folds the case of labels but not of operands.
+
+RETURNS
+
+    The new label.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+string ProgramGenerator::NewLabel(char a_prefix)
+{
+     return a_prefix + to_string(m_nextLabel++);
+} /* string ProgramGenerator::NewLabel(char a_prefix) */
+
+
+/**/
+/*
+ProgramGenerator::Random(uint32_t a_range)
+
+NAME
+
+    ProgramGenerator::Random - a random number.
+
+SYNOPSIS
+
+    uint32_t ProgramGenerator::Random(uint32_t a_range);
+    a_range    --> the number of values to choose from.
+
+DESCRIPTION
+
+    Takes the raw output of the generator rather than a standard distribution, whose results differ
+    between libraries, so a seed gives the same program everywhere.
+
+RETURNS
+
+    A number from 0 to a_range - 1.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+uint32_t ProgramGenerator::Random(uint32_t a_range)
+{
+     return (uint32_t)(m_random() % a_range);
+} /* uint32_t ProgramGenerator::Random(uint32_t a_range) */
+
+
+/**/
+/*
+ProgramGenerator::Fraction()
+
+NAME
+
+    ProgramGenerator::Fraction - a random fraction.
+
+SYNOPSIS
+
+    double ProgramGenerator::Fraction();
+
+DESCRIPTION
+
+    Like Random, uses the raw output of the generator so a seed gives the same program everywhere.
+
+RETURNS
+
+    A number from 0 up to, but not including, 1.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+double ProgramGenerator::Fraction()
+{
+     return (uint32_t)m_random() / 4294967296.0;
+} /* double ProgramGenerator::Fraction() */
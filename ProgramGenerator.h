@@ -0,0 +1,116 @@
+#pragma once
+
+/**/
+/*
+ProgramGenerator Class
+
+NAME
+
+     ProgramGenerator - write synthetic VC-3600 programs.
+
+DESCRIPTION
+
+     ProgramGenerator class - writes valid VC-3600 source code of a given size and shape, for
+     measuring and stress testing the assembler and the emulator. The same seed and shape always
+     give the same program, on every platform.
+
+     A program is made of straight runs of arithmetic on constants, counted loops nested up to a
+     given depth, conditional branches skipping forward over a few statements, reads and writes,
+     and data words (dc constants and ds storage). Data is placed either at the end of the program,
+     so referring to it is a forward reference, or among the code behind a branch, so later code
+     refers back to it. Every arithmetic run starts by loading a constant between 1 and 99, so the
+     accumulator never overflows.
+
+     A program larger than the memory is split into sections that each start with "org 0" and
+     end with a halt and their own data. Such a program assembles, but only its last section is
+     left in memory, so only programs that fit are meant to be run. Nested loops can also make
+     a program run longer than the emulator's limit of one step per word of memory.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+
+class ProgramGenerator {
+
+public:
+
+    // The size and shape of the programs.
+    struct Shape {
+        int m_lines;            // Number of instructions, not counting data, comments and the end statement.
+        int m_labels;           // Number of labels on instructions besides the ones branches and loops need.
+        double m_forwardRatio;  // Fraction of the data, and so of the data references, placed after the code.
+        int m_loopDepth;        // Deepest nesting of counted loops.
+        double m_dataDensity;   // Data words per instruction.
+        double m_ioFrequency;   // Fraction of the statements that read or write.
+        bool m_fillMemory;      // == true to set aside storage up to the last word of memory after each section.
+    };
+
+    // The shape used when nothing else is asked for.
+    static Shape DefaultShape( );
+
+    ProgramGenerator( uint32_t a_seed ) : m_random( a_seed ), m_nextLabel( 0 ) { };
+    ~ProgramGenerator( ) { };
+
+    // Write a program of the given shape.
+    void Generate( const Shape &a_shape, ostream &a_out );
+
+private:
+
+    // Instructions of a section stop this many words before the end of memory, leaving room for its data.
+    const static int SECTION_SLACK = 64;
+
+    // A data word of the section being written.
+    struct DataWord {
+        string m_label;         // Its label.
+        bool m_constant;        // == true for a dc constant, false for ds storage.
+        int m_value;            // The value of a constant.
+        bool m_shared;          // == true if any statement may refer to it, false if it belongs to a loop.
+    };
+
+    // Write one section of the program.
+    void GenerateSection( const Shape &a_shape, bool a_first, ostream &a_out );
+
+    // Write a_statements statements, or fewer if the program has all its instructions or the section is full.
+    void GenerateBlock( const Shape &a_shape, int a_depth, int a_statements, ostream &a_out );
+
+    // Write an instruction, giving it the pending label if there is one.
+    void Emit( const string &a_opcode, const string &a_operand, ostream &a_out );
+
+    // Write a data word.
+    void EmitData( const DataWord &a_word, ostream &a_out );
+
+    // Give a label to the next instruction.
+    void SetPendingLabel( const string &a_label, ostream &a_out );
+
+    // Make the constant 1 of the section.
+    string NewOne( );
+
+    // Choose a constant or a storage word to refer to, making a new one if needed.
+    string PickData( const Shape &a_shape, bool a_constant, ostream &a_out );
+
+    // Make a new label with the given prefix.
+    string NewLabel( char a_prefix );
+
+    // A random number from 0 to a_range - 1, or a random fraction from 0 to 1.
+    uint32_t Random( uint32_t a_range );
+    double Fraction( );
+
+    mt19937 m_random;               // The random numbers. mt19937 gives the same sequence everywhere.
+    int m_nextLabel;                // Number of the next label made.
+    int m_loc;                      // Location of the next word of the section.
+    int m_dataWords;                // Shared data words made in the section.
+    int m_labelsLeft;               // Labels still to be placed on instructions.
+    int m_linesLeft;                // Instructions still to be written in the whole program.
+    string m_pendingLabel;          // Label to be put on the next instruction.
+    string m_one;                   // Label of the constant 1 of the section, empty until it is needed.
+    vector<DataWord> m_inline;      // Data already placed among the code of the section.
+    vector<DataWord> m_tail;        // Data to be placed after the code of the section.
+};
@@ -0,0 +1,253 @@
+//
+//      Implementation of the ResultCache class.
+//
+#include "stdafx.h"
+#include "ResultCache.h"
+#include "Hash.h"
+#include "MappedFile.h"
+#include "Stats.h"
+
+
+/**/
+/*
+ResultCache::ResultCache(const string &a_directory, size_t a_maxBytes)
+
+NAME
+
+    ResultCache::ResultCache - open a result cache.
+
+SYNOPSIS
+
+    ResultCache::ResultCache(const string &a_directory, size_t a_maxBytes);
+    a_directory    --> the directory the entries are kept in. It is made when the first one is saved.
+    a_maxBytes     --> the size the files of the cache may take.
+
+DESCRIPTION
+
+    Nothing is read until an entry is looked up.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+ResultCache::ResultCache(const string &a_directory, size_t a_maxBytes)
+     : m_files(a_directory, a_maxBytes, ".vcr", Stats::CT_ResultCacheEvictions)
+{
+} /* ResultCache::ResultCache(const string &a_directory, size_t a_maxBytes) */
+
+
+/**/
+/*
+ResultCache::HashImage(const string &a_imageFile)
+
+NAME
+
+    ResultCache::HashImage - the hash of an image file.
+
+SYNOPSIS
+
+    static string ResultCache::HashImage(const string &a_imageFile);
+    a_imageFile    --> the object image file.
+
+DESCRIPTION
+
+    Hashes the bytes of the file with SHA-256. The file holds everything a run of the program starts
+    from: the words, the origin and the state left by partial evaluation.
+
+RETURNS
+
+    The hash, as 64 hexadecimal digits, or an empty string if the file could not be read.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+string ResultCache::HashImage(const string &a_imageFile)
+{
+     MappedFile file;
+     if (!file.Open(a_imageFile))
+          return "";
+     return Hash::Sha256(file.Data(), file.Size());
+} /* string ResultCache::HashImage(const string &a_imageFile) */
+
+
+/**/
+/*
+ResultCache::KeyFor(const string &a_imageHash, const string &a_input)
+
+NAME
+
+    ResultCache::KeyFor - the key of a run.
+
+SYNOPSIS
+
+    static string ResultCache::KeyFor(const string &a_imageHash, const string &a_input);
+    a_imageHash    --> the hash of the image, from HashImage.
+    a_input        --> everything the program may read.
+
+DESCRIPTION
+
+    Hashes the version of the cache, the hash of the image and the input with SHA-256. Any change to
+    the emulator that changes how a program runs must change the version.
+
+RETURNS
+
+    The key, as 64 hexadecimal digits, or an empty string if the image could not be hashed.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+string ResultCache::KeyFor(const string &a_imageHash, const string &a_input)
+{
+     if (a_imageHash.empty())
+          return "";
+     string text = "VC3600 result cache " + to_string(VERSION) + " " + a_imageHash + "\n" + a_input;
+     return Hash::Sha256(text.data(), text.size());
+} /* string ResultCache::KeyFor(const string &a_imageHash, const string &a_input) */
+
+
+/**/
+/*
+ResultCache::Find(const string &a_key, Result &a_result)
+
+NAME
+
+    ResultCache::Find - look up the result of a run.
+
+SYNOPSIS
+
+    bool ResultCache::Find(const string &a_key, Result &a_result);
+    a_key       --> the key from KeyFor.
+    a_result    --> the result is put in this.
+
+DESCRIPTION
+
+    Reads the entry: a line with whether the run halted, its steps, its accumulator, the number of
+    its errors and the size of its output, then each error on a line of its own, then the output.
+    An entry that is missing or does not check out is not found. The entry found is touched so it
+    is the last to be evicted.
+
+RETURNS
+
+    'true' if the result was found,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool ResultCache::Find(const string &a_key, Result &a_result)
+{
+     if (a_key.empty())
+          return false;
+
+     ifstream file(m_files.PathFor(a_key, ".vcr").c_str(), ios::in | ios::binary);
+     int halted = 0;
+     size_t errors = 0;
+     size_t outputSize = 0;
+     bool found = file >> halted >> a_result.m_steps >> a_result.m_accumulator >> errors >> outputSize
+          && file.get() == '\n' && (halted == 0 || halted == 1);
+
+     a_result.m_halted = halted == 1;
+     a_result.m_errors.clear();
+     string error;
+     for (size_t i = 0; found && i < errors; i++) {
+          found = (bool)getline(file, error);
+          a_result.m_errors.push_back(error);
+     }
+     a_result.m_output.assign(found ? outputSize : 0, '\0');
+     found = found && (outputSize == 0 || file.read(&a_result.m_output[0], outputSize)) && file.peek() == EOF;
+     if (!found) {
+          STATS_ADD(CT_ResultCacheMisses, 1);
+          return false;
+     }
+
+     m_files.Touch(a_key);
+     STATS_ADD(CT_ResultCacheHits, 1);
+     return true;
+} /* bool ResultCache::Find(const string &a_key, Result &a_result) */
+
+
+/**/
+/*
+ResultCache::Save(const string &a_key, const Result &a_result)
+
+NAME
+
+    ResultCache::Save - save the result of a run.
+
+SYNOPSIS
+
+    bool ResultCache::Save(const string &a_key, const Result &a_result);
+    a_key       --> the key from KeyFor.
+    a_result    --> the result.
+
+DESCRIPTION
+
+    Writes the entry under a name of its own and renames it over any entry for the same run saved
+    by another process, then evicts entries if the cache is too big. The cache only saves work, so
+    failing to save is not an error.
+
+RETURNS
+
+    'true' if the result was saved,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool ResultCache::Save(const string &a_key, const Result &a_result)
+{
+     if (a_key.empty())
+          return false;
+
+     bool saved = m_files.WriteAtomically(m_files.PathFor(a_key, ".vcr"), [&a_result](const string &a_path) {
+          ofstream file(a_path.c_str(), ios::out | ios::binary | ios::trunc);
+          file << (a_result.m_halted ? 1 : 0) << ' ' << a_result.m_steps << ' ' << a_result.m_accumulator << ' '
+               << a_result.m_errors.size() << ' ' << a_result.m_output.size() << '\n';
+          for (size_t i = 0; i < a_result.m_errors.size(); i++)
+               file << a_result.m_errors[i] << '\n';
+          file << a_result.m_output;
+          file.close();
+          return !file.fail();
+     });
+
+     if (saved)
+          m_files.Evict();
+     return saved;
+} /* bool ResultCache::Save(const string &a_key, const Result &a_result) */
@@ -0,0 +1,71 @@
+#pragma once
+
+/**/
+/*
+ResultCache Class
+
+NAME
+
+     ResultCache - a directory of the results of runs, kept by the hash of the image and the input.
+
+DESCRIPTION
+
+     ResultCache class - a run of a VC3600 program depends on nothing but its image and the values
+     it reads, so its result is kept under the SHA-256 of the version of the cache, the image file
+     and the input: whether it halted, the steps it took, the accumulator it ended with, what it
+     wrote and the errors recorded. A run of the same image on the same input is then not done
+     again, in this process or any other sharing the directory.
+
+     The entries are kept by a DiskCache, each in a single file that is renamed into place, so any
+     number of processes may share the directory. When the files of the cache take more than the
+     size allowed, the entries used least recently are deleted until they fit. An entry is used
+     when it is saved or found.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+#include "DiskCache.h"
+
+class ResultCache {
+
+public:
+
+    // The result of a run.
+    struct Result {
+        bool m_halted;              // == true if it halted, or was stopped by an error, rather than running out of steps.
+        int m_steps;                // Steps it took.
+        int m_accumulator;          // The accumulator when it ended.
+        string m_output;            // What it wrote.
+        vector<string> m_errors;    // The errors recorded while it ran.
+    };
+
+    const static uint32_t VERSION = 1;              // Changes whenever a program may run differently, or an entry is kept differently.
+    const static int DEFAULT_MEGABYTES = 64;        // Size allowed unless asked otherwise.
+
+    ResultCache( const string &a_directory, size_t a_maxBytes = DEFAULT_MEGABYTES * (size_t)1048576 );
+    ~ResultCache( ) { };
+
+    // The hash of an image file, which the keys of its runs are made from. Empty if the file cannot be read.
+    static string HashImage( const string &a_imageFile );
+
+    // The key of a run of an image on an input.
+    static string KeyFor( const string &a_imageHash, const string &a_input );
+
+    // Find the result of a run.
+    bool Find( const string &a_key, Result &a_result );
+
+    // Save the result of a run, then delete the entries used least recently if the cache is too big.
+    bool Save( const string &a_key, const Result &a_result );
+
+private:
+
+    DiskCache m_files;          // The files of the entries, one for each.
+};
@@ -0,0 +1,647 @@
+//
+//      Implementation of the Scheduler class.
+//
+#include "stdafx.h"
+#include "Scheduler.h"
+#include "Emulator.h"
+#include "Errors.h"
+#include "SharedImage.h"
+#include "Stats.h"
+
+
+/**/
+/*
+Scheduler::Scheduler(int a_threads, int a_slice)
+
+NAME
+
+    Scheduler::Scheduler - make a scheduler.
+
+SYNOPSIS
+
+    Scheduler::Scheduler(int a_threads, int a_slice);
+    a_threads    --> number of threads to run the jobs on, 0 for one per core.
+    a_slice      --> number of steps in a time slice.
+
+DESCRIPTION
+
+    Makes a scheduler without any jobs.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+Scheduler::Scheduler(int a_threads, int a_slice)
+     : m_threads(a_threads > 0 ? a_threads : max(1, (int)thread::hardware_concurrency())),
+     m_slice(max(1, a_slice)), m_remaining(0), m_tick(0)
+{
+} /* Scheduler::Scheduler(int a_threads, int a_slice) */
+
+
+/**/
+/*
+Scheduler::Submit(emulator &a_emulator, int a_priority, int a_budget, double a_deadline)
+
+NAME
+
+    Scheduler::Submit - add a program to be run.
+
+SYNOPSIS
+
+    int Scheduler::Submit(emulator &a_emulator, int a_priority, int a_budget, double a_deadline);
+    a_emulator    --> the emulator the program is loaded into. It must outlive the scheduler.
+    a_priority    --> from 0 to PRIORITIES - 1. Higher priorities are run first.
+    a_budget      --> most steps the program may take, 0 for as many as the emulator allows.
+    a_deadline    --> seconds from the start of Run by which the program must be done, 0 for none.
+
+DESCRIPTION
+
+    Adds a job for the program, to be run by the next call to Run. A priority outside the range
+    is taken as the nearest one inside it.
+
+RETURNS
+
+    The number of the job, for GetJob.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+int Scheduler::Submit(emulator &a_emulator, int a_priority, int a_budget, double a_deadline)
+{
+     Job job;
+     job.m_emulator = &a_emulator;
+     job.m_instance = NULL;
+     job.m_in = NULL;
+     job.m_out = NULL;
+     job.m_priority = min(max(a_priority, 0), PRIORITIES - 1);
+     job.m_budget = max(a_budget, 0);
+     job.m_deadline = max(a_deadline, 0.0);
+     job.m_outcome = JO_Waiting;
+     job.m_steps = 0;
+     job.m_slices = 0;
+     m_jobs.push_back(job);
+     return (int)m_jobs.size() - 1;
+} /* int Scheduler::Submit(emulator &a_emulator, int a_priority, int a_budget, double a_deadline) */
+
+
+/**/
+/*
+Scheduler::Submit(SharedInstance &a_instance, istream *a_in, ostream *a_out, int a_priority, int a_budget, double a_deadline)
+
+NAME
+
+    Scheduler::Submit - add a run of a shared image.
+
+SYNOPSIS
+
+    int Scheduler::Submit(SharedInstance &a_instance, istream *a_in, ostream *a_out, int a_priority, int a_budget, double a_deadline);
+    a_instance    --> the run. It and its image must outlive the scheduler.
+    a_in          --> where the run reads its values from.
+    a_out         --> where the run writes its output.
+    a_priority    --> from 0 to PRIORITIES - 1. Higher priorities are run first.
+    a_budget      --> most steps the program may take, 0 for as many as the emulator allows.
+    a_deadline    --> seconds from the start of Run by which the program must be done, 0 for none.
+
+DESCRIPTION
+
+    Adds a job for the run, like the job of an emulator. Its slices are run on a worker the thread
+    loaded the image into, given the streams of the run for each slice.
+
+RETURNS
+
+    The number of the job, for GetJob.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+int Scheduler::Submit(SharedInstance &a_instance, istream *a_in, ostream *a_out, int a_priority, int a_budget, double a_deadline)
+{
+     Job job;
+     job.m_emulator = NULL;
+     job.m_instance = &a_instance;
+     job.m_in = a_in;
+     job.m_out = a_out;
+     job.m_priority = min(max(a_priority, 0), PRIORITIES - 1);
+     job.m_budget = max(a_budget, 0);
+     job.m_deadline = max(a_deadline, 0.0);
+     job.m_outcome = JO_Waiting;
+     job.m_steps = 0;
+     job.m_slices = 0;
+     m_jobs.push_back(job);
+     return (int)m_jobs.size() - 1;
+} /* int Scheduler::Submit(SharedInstance &a_instance, istream *a_in, ostream *a_out, int a_priority, int a_budget, double a_deadline) */
+
+
+/**/
+/*
+Scheduler::Run()
+
+NAME
+
+    Scheduler::Run - run the jobs.
+
+SYNOPSIS
+
+    void Scheduler::Run();
+
+DESCRIPTION
+
+    Deals the jobs that are still waiting out to the run queues of the threads in turn, puts their
+    deadlines on the timing wheel and runs them on the threads, the calling thread being one of them.
+    Returns once every job is done or blocked. A job blocked on its channel by an earlier call is
+    dealt out again only if the channel now has what it waits for; the others stay blocked.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Scheduler::Run()
+{
+     m_queues.clear();
+     for (int i = 0; i < m_threads; i++)
+          m_queues.push_back(unique_ptr<RunQueue>(new RunQueue));
+     for (int i = 0; i < WHEEL_SLOTS; i++)
+          m_wheel[i].clear();
+     m_expired.reset(new atomic<bool>[m_jobs.size()]);
+     m_tick = 0;
+     m_start = chrono::steady_clock::now();
+
+     int remaining = 0;
+     for (size_t i = 0; i < m_jobs.size(); i++) {
+          m_expired[i] = false;
+          if (m_jobs[i].m_outcome == JO_Blocked && m_jobs[i].m_emulator->channelReady())
+               m_jobs[i].m_outcome = JO_Waiting;
+          if (m_jobs[i].m_outcome != JO_Waiting)
+               continue;
+          if (m_jobs[i].m_deadline > 0)
+               AddDeadline((int)i);
+          m_queues[remaining % m_threads]->m_jobs[m_jobs[i].m_priority].push_back((int)i);
+          remaining++;
+     }
+     m_remaining = remaining;
+     m_waiting = remaining;
+     m_parked = 0;
+
+     vector<thread> threads;
+     for (int i = 1; i < m_threads; i++)
+          threads.push_back(thread(&Scheduler::Work, this, i));
+     Work(0);
+     for (size_t i = 0; i < threads.size(); i++)
+          threads[i].join();
+} /* void Scheduler::Run() */
+
+
+/**/
+/*
+Scheduler::Work(int a_thread)
+
+NAME
+
+    Scheduler::Work - the work of a thread.
+
+SYNOPSIS
+
+    void Scheduler::Work(int a_thread);
+    a_thread    --> the number of the thread.
+
+DESCRIPTION
+
+    Runs a slice of the next job at a time, putting a job that is not done back at the end of the
+    thread's own run queue, until every job is done or blocked. A thread with nothing to take while
+    other threads are still running their last jobs parks until a job is queued that the thread
+    queuing it will not take itself, or until every job is done or blocked. A parked thread need not wake for the
+    deadlines: the jobs are all being run, and the threads running them turn the timing wheel after
+    every slice.
+
+    The runs of shared images are run on workers of the thread's own, one for each image, which are
+    deleted when the thread is done.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Scheduler::Work(int a_thread)
+{
+     Workers workers;       // Workers for the runs of shared images, made when first needed.
+     while (m_remaining > 0) {
+          int job = Take(a_thread);
+          if (job < 0) {
+               Park();
+               continue;
+          }
+
+          if (RunSlice(job, workers)) {
+               // The last job done lets the parked threads return.
+               if (--m_remaining == 0)
+                    Wake(true);
+          }
+          else {
+               // This thread takes the job back itself unless others are waiting too, and then a
+               // parked thread is woken to run one of them.
+               RunQueue &queue = *m_queues[a_thread];
+               lock_guard<mutex> lock(queue.m_lock);
+               queue.m_jobs[m_jobs[job].m_priority].push_back(job);
+               if (++m_waiting > 1)
+                    Wake(false);
+          }
+          AdvanceWheel();
+     }
+} /* void Scheduler::Work(int a_thread) */
+
+
+/**/
+/*
+Scheduler::Take(int a_thread)
+
+NAME
+
+    Scheduler::Take - take the next job for a thread.
+
+SYNOPSIS
+
+    int Scheduler::Take(int a_thread);
+    a_thread    --> the number of the thread.
+
+DESCRIPTION
+
+    Takes the oldest job of the highest priority waiting in the thread's own run queues. If they
+    are empty, the queues of the other threads are tried in turn and the job is stolen from the
+    first one that has any.
+
+RETURNS
+
+    The number of the job, or -1 if no job is waiting.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+int Scheduler::Take(int a_thread)
+{
+     for (int i = 0; i < m_threads; i++) {
+          int owner = (a_thread + i) % m_threads;
+          RunQueue &queue = *m_queues[owner];
+          lock_guard<mutex> lock(queue.m_lock);
+          for (int priority = PRIORITIES - 1; priority >= 0; priority--) {
+               if (queue.m_jobs[priority].empty())
+                    continue;
+               int job = queue.m_jobs[priority].front();
+               queue.m_jobs[priority].pop_front();
+               m_waiting--;
+               if (owner != a_thread)
+                    STATS_ADD(CT_Steals, 1);
+               return job;
+          }
+     }
+     return -1;
+} /* int Scheduler::Take(int a_thread) */
+
+
+/**/
+/*
+Scheduler::Park()
+
+NAME
+
+    Scheduler::Park - wait for a job to take.
+
+SYNOPSIS
+
+    void Scheduler::Park();
+
+DESCRIPTION
+
+    Waits on the condition variable until a job is waiting in some run queue or every job is done,
+    so an idle thread takes no time on the core and no queue locks while the others run. The thread
+    counts itself as parked before it looks at the queues, and a thread queuing a job looks at the
+    count after queuing it, so one of them always sees the other and no wakeup is lost.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Scheduler::Park()
+{
+     unique_lock<mutex> lock(m_idleLock);
+     m_parked++;
+     m_idle.wait(lock, [this]() { return m_waiting > 0 || m_remaining == 0; });
+     m_parked--;
+} /* void Scheduler::Park() */
+
+
+/**/
+/*
+Scheduler::Wake(bool a_all)
+
+NAME
+
+    Scheduler::Wake - wake parked threads.
+
+SYNOPSIS
+
+    void Scheduler::Wake(bool a_all);
+    a_all    --> == true to wake every parked thread, as when every job is done.
+
+DESCRIPTION
+
+    Wakes one parked thread, or all of them. Nothing is done if none is parked, so a thread that
+    queues its jobs while every thread is busy does not take the lock.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Scheduler::Wake(bool a_all)
+{
+     if (m_parked == 0)
+          return;
+     lock_guard<mutex> lock(m_idleLock);
+     if (a_all)
+          m_idle.notify_all();
+     else
+          m_idle.notify_one();
+} /* void Scheduler::Wake(bool a_all) */
+
+
+/**/
+/*
+Scheduler::RunSlice(int a_job, Workers &a_workers)
+
+NAME
+
+    Scheduler::RunSlice - run a job for a time slice.
+
+SYNOPSIS
+
+    bool Scheduler::RunSlice(int a_job, Workers &a_workers);
+    a_job        --> the number of the job.
+    a_workers    --> the workers of the thread, for a run of a shared image.
+
+DESCRIPTION
+
+    Runs the program of the job for a slice, or for what is left of its budget if that is less.
+    The errors it records are collected with the job. The job is done if the program is, if its
+    budget is used up or if its deadline has passed, and its outcome is set. A program that waits
+    for its channel is blocked, and is done with for this Run. A run of a shared image
+    is run on the worker its image was loaded into, which is made the first time it is needed.
+
+RETURNS
+
+    'true' if the job is done or blocked,
+    'false' if it is to be run again.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Scheduler::RunSlice(int a_job, Workers &a_workers)
+{
+     Job &job = m_jobs[a_job];
+     if (m_expired[a_job]) {
+          job.m_outcome = JO_Deadline;
+          return true;
+     }
+
+     int steps = m_slice;
+     if (job.m_budget > 0)
+          steps = min(steps, job.m_budget - job.m_steps);
+
+     vector<string> *previous = Errors::CaptureErrors(&job.m_errors);
+     bool done;
+     bool halted;
+     if (job.m_instance != NULL) {
+          const SharedImage *image = &job.m_instance->GetImage();
+          unique_ptr<emulator> &worker = a_workers[image];
+          if (!worker) {
+               worker.reset(new emulator);
+               image->Load(*worker);
+          }
+          worker->setStreams(job.m_in, job.m_out);
+          int start = job.m_instance->GetSteps();
+          done = job.m_instance->Run(*worker, steps);
+          halted = job.m_instance->IsHalted();
+          job.m_steps += job.m_instance->GetSteps() - start;
+     }
+     else {
+          int start = job.m_emulator->startSteps();
+          done = job.m_emulator->runSlice(steps);
+          halted = job.m_emulator->halted();
+          job.m_steps += job.m_emulator->stepCount() - start;
+     }
+     Errors::CaptureErrors(previous);
+     job.m_slices++;
+     STATS_ADD(CT_Slices, 1);
+
+     if (done)
+          job.m_outcome = halted ? JO_Halted : JO_OutOfSteps;
+     else if (job.m_budget > 0 && job.m_steps >= job.m_budget)
+          job.m_outcome = JO_OverBudget;
+     else if (m_expired[a_job])
+          job.m_outcome = JO_Deadline;
+     else if (job.m_emulator != NULL && job.m_emulator->waitingFor() != emulator::W_Nothing)
+          job.m_outcome = JO_Blocked;
+     return job.m_outcome != JO_Waiting;
+} /* bool Scheduler::RunSlice(int a_job, Workers &a_workers) */
+
+
+/**/
+/*
+Scheduler::AddDeadline(int a_job)
+
+NAME
+
+    Scheduler::AddDeadline - put the deadline of a job on the timing wheel.
+
+SYNOPSIS
+
+    void Scheduler::AddDeadline(int a_job);
+    a_job    --> the number of the job.
+
+DESCRIPTION
+
+    The deadline is rounded up to a tick and kept in the slot of that tick. A deadline more than a
+    turn of the wheel away shares its slot with nearer ones and stays there until its own tick.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Scheduler::AddDeadline(int a_job)
+{
+     int64_t tick = (int64_t)ceil(m_jobs[a_job].m_deadline * 1e6 / TICK_MICROSECONDS);
+     tick = max<int64_t>(tick, 1);
+     m_wheel[tick % WHEEL_SLOTS].push_back(make_pair(a_job, tick));
+} /* void Scheduler::AddDeadline(int a_job) */
+
+
+/**/
+/*
+Scheduler::AdvanceWheel()
+
+NAME
+
+    Scheduler::AdvanceWheel - mark the jobs whose deadlines have passed.
+
+SYNOPSIS
+
+    void Scheduler::AdvanceWheel();
+
+DESCRIPTION
+
+    Turns the timing wheel to the current tick, going through the slots of the ticks that passed
+    since it was last turned, or through every slot once if a whole turn passed. The jobs found there
+    whose deadlines have passed are marked, and are stopped by the thread running them at the end
+    of their slice. Only one thread turns the wheel at a time; the others go on with their jobs.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Scheduler::AdvanceWheel()
+{
+     unique_lock<mutex> lock(m_wheelLock, try_to_lock);
+     if (!lock.owns_lock())
+          return;
+
+     int64_t now = Ticks();
+     int64_t last = min(now, m_tick + WHEEL_SLOTS);
+     for (int64_t tick = m_tick + 1; tick <= last; tick++) {
+          vector<pair<int, int64_t>> &slot = m_wheel[tick % WHEEL_SLOTS];
+          for (size_t i = 0; i < slot.size(); ) {
+               if (slot[i].second <= now) {
+                    m_expired[slot[i].first] = true;
+                    slot[i] = slot.back();
+                    slot.pop_back();
+               }
+               else {
+                    i++;
+               }
+          }
+     }
+     m_tick = max(m_tick, now);
+} /* void Scheduler::AdvanceWheel() */
+
+
+/**/
+/*
+Scheduler::Ticks()
+
+NAME
+
+    Scheduler::Ticks - the current tick of the timing wheel.
+
+SYNOPSIS
+
+    int64_t Scheduler::Ticks() const;
+
+DESCRIPTION
+
+    Counts the ticks since Run started.
+
+RETURNS
+
+    The number of ticks.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+int64_t Scheduler::Ticks() const
+{
+     return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - m_start).count() / TICK_MICROSECONDS;
+} /* int64_t Scheduler::Ticks() const */
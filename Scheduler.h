@@ -0,0 +1,161 @@
+#pragma once
+
+/**/
+/*
+Scheduler Class
+
+NAME
+
+     Scheduler - run many programs at once on a fixed pool of threads.
+
+DESCRIPTION
+
+     Scheduler class - runs the programs loaded into a number of emulators, each as a job, on as
+     many threads as there are cores. A job runs for a time slice of a given number of steps and is
+     then put back at the end of the run queue of the thread that ran it, so short programs are not
+     held up behind long ones. Each thread has a run queue of its own for every priority, and a
+     thread whose queues are empty steals the oldest waiting job of another thread. A job is taken
+     from the highest priority that has one waiting.
+
+     A job may be given a budget, the most steps it may take, and a deadline, the seconds from the
+     start of Run by which it must be done. Deadlines are kept on a timing wheel that the threads
+     advance between slices, so a job that misses its deadline is stopped at the end of its slice
+     without every job being looked at.
+
+     Each emulator should have streams of its own, set with setStreams, since the jobs run at the
+     same time. The errors of a job are collected with the job instead of being displayed.
+
+     A job may also be a run of a SharedImage, so that many runs of one program keep only the pages
+     they write. Each thread then loads the image into a worker emulator of its own the first time
+     it runs one of them, and runs every slice of the runs of that image on it.
+
+     A program fed through a Channel that waits for a value, or for its output to be taken, is
+     parked: it is taken out of the run queues and left blocked when Run returns, so it takes no
+     slices until the caller has fed its channel. The next call to Run then runs the blocked jobs
+     whose channels have what they wait for, and leaves the others blocked. The channels may only be
+     fed between calls to Run, so with one thread any number of programs can be driven from their
+     channels by a loop of Run and feeding.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+class emulator;
+class SharedImage;
+class SharedInstance;
+
+class Scheduler {
+
+public:
+
+    // How a job ended.
+    enum Outcome {
+        JO_Waiting,     // It has not been run to the end yet.
+        JO_Blocked,     // It waits for its channel, and is run again by the next Run once the channel has what it waits for.
+        JO_Halted,      // It halted, or was stopped by an error.
+        JO_OutOfSteps,  // It took as many steps as the emulator allows without halting.
+        JO_OverBudget,  // It used up its budget.
+        JO_Deadline     // It was not done by its deadline.
+    };
+
+    // A program to be run.
+    struct Job {
+        emulator *m_emulator;       // The emulator the program is loaded into, NULL for a run of a shared image.
+        SharedInstance *m_instance; // The run of a shared image, NULL if the program is loaded into m_emulator.
+        istream *m_in;              // Where m_instance reads its values from.
+        ostream *m_out;             // Where m_instance writes its output.
+        int m_priority;             // From 0 to PRIORITIES - 1. Higher priorities are run first.
+        int m_budget;               // Most steps the job may take, 0 for as many as the emulator allows.
+        double m_deadline;          // Seconds from the start of Run by which it must be done, 0 for none.
+        Outcome m_outcome;          // How it ended.
+        int m_steps;                // Steps it took.
+        int m_slices;               // Time slices it was run for.
+        vector<string> m_errors;    // The errors recorded while it ran.
+    };
+
+    const static int PRIORITIES = 4;            // Number of priorities.
+    const static int DEFAULT_SLICE = 1000;      // Steps in a time slice unless asked otherwise.
+
+    // A_threads of 0 uses a thread per core.
+    Scheduler( int a_threads = 0, int a_slice = DEFAULT_SLICE );
+    ~Scheduler( ) { };
+
+    // Add a program to be run by Run. Returns the number of the job.
+    int Submit( emulator &a_emulator, int a_priority = 0, int a_budget = 0, double a_deadline = 0 );
+
+    // Add a run of a shared image, reading from a_in and writing to a_out. Returns the number of the job.
+    int Submit( SharedInstance &a_instance, istream *a_in, ostream *a_out, int a_priority = 0, int a_budget = 0, double a_deadline = 0 );
+
+    // Run all the jobs submitted to the end, or until they wait for their channels, and wait for them.
+    void Run( );
+
+    // Access the jobs.
+    inline const Job &GetJob( int a_job ) const {
+
+        return m_jobs[a_job];
+    };
+    inline int JobCount( ) const {
+
+        return (int)m_jobs.size();
+    };
+
+private:
+
+    // The run queues of a thread, one for each priority.
+    struct RunQueue {
+        mutex m_lock;
+        deque<int> m_jobs[PRIORITIES];
+    };
+
+    // The worker emulators of a thread, by the shared image loaded into them.
+    typedef map<const SharedImage *, unique_ptr<emulator>> Workers;
+
+    // The timing wheel has this many slots of a tick each.
+    const static int WHEEL_SLOTS = 256;
+    const static int TICK_MICROSECONDS = 1000;
+
+    // The work of each thread.
+    void Work( int a_thread );
+
+    // Take the next job for a thread from its own queues or another thread's. Returns -1 if there is none.
+    int Take( int a_thread );
+
+    // Wait until a job is waiting in some queue or every job is done, and wake a thread that waits.
+    void Park( );
+    void Wake( bool a_all );
+
+    // Run a slice of a job, a run of a shared image on a worker of a_workers. Returns true if the job is done.
+    bool RunSlice( int a_job, Workers &a_workers );
+
+    // Put a deadline on the timing wheel, and stop the jobs whose deadlines have passed.
+    void AddDeadline( int a_job );
+    void AdvanceWheel( );
+
+    // The ticks of the timing wheel since Run started.
+    int64_t Ticks( ) const;
+
+    int m_threads;                              // Number of threads.
+    int m_slice;                                // Steps in a time slice.
+    vector<Job> m_jobs;                         // The jobs, in the order they were submitted.
+
+    vector<unique_ptr<RunQueue>> m_queues;      // The run queues of each thread.
+    atomic<int> m_remaining;                    // Jobs that are not done yet.
+    atomic<int> m_waiting;                      // Jobs waiting in the run queues.
+
+    mutex m_idleLock;                           // Held to park a thread, or to wake one.
+    condition_variable m_idle;                  // Signalled when a job is queued for a parked thread, or every job is done.
+    atomic<int> m_parked;                       // Threads parked, or about to be.
+
+    mutex m_wheelLock;                          // Held by the thread advancing the timing wheel.
+    vector<pair<int, int64_t>> m_wheel[WHEEL_SLOTS];    // Jobs and the ticks of their deadlines, by tick.
+    int64_t m_tick;                             // The tick the wheel has been advanced to.
+    chrono::steady_clock::time_point m_start;   // When Run started.
+    unique_ptr<atomic<bool>[]> m_expired;       // == true for the jobs whose deadlines have passed.
+};
@@ -0,0 +1,643 @@
+//
+//      Implementation of the ShardRunner class.
+//
+#include "stdafx.h"
+#include "ShardRunner.h"
+#include "Emulator.h"
+#include "Errors.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+
+/**/
+/*
+ShardRunner::ShardRunner(const emulator &a_loaded, int a_workers, double a_timeout)
+
+NAME
+
+    ShardRunner::ShardRunner - make a runner for a loaded program.
+
+SYNOPSIS
+
+    ShardRunner::ShardRunner(const emulator &a_loaded, int a_workers, double a_timeout);
+    a_loaded     --> an emulator the program was loaded into and has not run. It must outlive the runner.
+    a_workers    --> number of workers, 0 for one per core.
+    a_timeout    --> seconds a worker may take over one shard before it is killed.
+
+DESCRIPTION
+
+    Makes a runner that has not run anything.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+ShardRunner::ShardRunner(const emulator &a_loaded, int a_workers, double a_timeout)
+     : m_loaded(&a_loaded), m_workers(a_workers > 0 ? a_workers : max(1, (int)thread::hardware_concurrency())),
+     m_timeout(max<int64_t>(1, (int64_t)(a_timeout * 1000))), m_inputFiles(NULL),
+     m_arena(NULL), m_arenaSize(0), m_header(NULL), m_workerStates(NULL), m_slots(NULL), m_restarts(0)
+{
+} /* ShardRunner::ShardRunner(const emulator &a_loaded, int a_workers, double a_timeout) */
+
+
+/**/
+/*
+ShardRunner::~ShardRunner()
+
+NAME
+
+    ShardRunner::~ShardRunner - destroyer for the ShardRunner class.
+
+SYNOPSIS
+
+    ShardRunner::~ShardRunner();
+
+DESCRIPTION
+
+    Frees the arena if a batch left it behind.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+ShardRunner::~ShardRunner()
+{
+     FreeArena();
+} /* ShardRunner::~ShardRunner() */
+
+
+/**/
+/*
+ShardRunner::Run(const vector<string> &a_inputFiles)
+
+NAME
+
+    ShardRunner::Run - run the program on each input file.
+
+SYNOPSIS
+
+    bool ShardRunner::Run(const vector<string> &a_inputFiles);
+    a_inputFiles    --> the input files, one for each shard.
+
+DESCRIPTION
+
+    Makes the arena and forks the workers, then waits for them. A worker that dies before the
+    shards run out is replaced by a new one. Between waits, a worker that has been running the
+    same shard for longer than the timeout is killed and replaced, and the shard is recorded as
+    timed out. Once every worker has exited, the results are collected from the arena.
+
+    Where workers are threads, they are started and joined, and nothing is killed.
+
+RETURNS
+
+    'true' if the batch was run,
+    'false' if the arena could not be made or not a single worker could be started.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool ShardRunner::Run(const vector<string> &a_inputFiles)
+{
+     m_results.clear();
+     m_restarts = 0;
+     m_inputFiles = &a_inputFiles;
+     int shards = (int)a_inputFiles.size();
+     if (!MakeArena(shards))
+          return false;
+
+#ifdef _WIN32
+     vector<thread> threads;
+     for (int i = 1; i < m_workers; i++)
+          threads.push_back(thread(&ShardRunner::Work, this, i));
+     Work(0);
+     for (size_t i = 0; i < threads.size(); i++)
+          threads[i].join();
+#else
+     // What is still buffered would otherwise be written again by each worker.
+     cout.flush();
+     cerr.flush();
+     fflush(NULL);
+
+     m_pids.assign(m_workers, 0);
+     int live = 0;
+     for (int i = 0; i < m_workers; i++) {
+          if (Fork(i))
+               live++;
+     }
+     if (live == 0) {
+          FreeArena();
+          return false;
+     }
+
+     while (live > 0) {
+          int status;
+          pid_t pid = waitpid(-1, &status, WNOHANG);
+          if (pid > 0) {
+               int worker = (int)(find(m_pids.begin(), m_pids.end(), (int)pid) - m_pids.begin());
+               if (worker == m_workers)
+                    continue;
+               m_pids[worker] = 0;
+               live--;
+               Abandon(worker, SO_Crashed);
+               if (m_header->m_next < shards && Fork(worker)) {
+                    live++;
+                    m_restarts++;
+               }
+               continue;
+          }
+          if (pid < 0 && errno != EINTR)
+               break;
+
+          // Kill the workers that have spent too long on one shard.
+          int64_t now = Now();
+          for (int i = 0; i < m_workers; i++) {
+               if (m_pids[i] == 0 || m_workerStates[i].m_shard < 0 || now - m_workerStates[i].m_started <= m_timeout)
+                    continue;
+               kill(m_pids[i], SIGKILL);
+               waitpid(m_pids[i], &status, 0);
+               m_pids[i] = 0;
+               live--;
+               Abandon(i, SO_TimedOut);
+               if (m_header->m_next < shards && Fork(i)) {
+                    live++;
+                    m_restarts++;
+               }
+          }
+          this_thread::sleep_for(chrono::milliseconds(1));
+     }
+#endif
+
+     Collect();
+     FreeArena();
+     return true;
+} /* bool ShardRunner::Run(const vector<string> &a_inputFiles) */
+
+
+/**/
+/*
+ShardRunner::MakeArena(int a_shards)
+
+NAME
+
+    ShardRunner::MakeArena - make the arena for a batch.
+
+SYNOPSIS
+
+    bool ShardRunner::MakeArena(int a_shards);
+    a_shards    --> the number of shards.
+
+DESCRIPTION
+
+    Maps memory that is shared with the processes forked from this one, enough for the header, the
+    state of each worker and a slot for each shard, and sets it all up with no shard taken. Where
+    workers are threads, the arena is ordinary memory. The pages of the slots are only backed once
+    they are written.
+
+RETURNS
+
+    'true' if the arena was made,
+    'false' if the memory could not be mapped.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool ShardRunner::MakeArena(int a_shards)
+{
+     FreeArena();
+     size_t size = sizeof(Header) + m_workers * sizeof(WorkerState) + a_shards * sizeof(Slot);
+
+#ifdef _WIN32
+     m_arena = new char[size];
+#else
+     void *arena = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+     if (arena == MAP_FAILED)
+          return false;
+     m_arena = static_cast<char *>(arena);
+#endif
+     m_arenaSize = size;
+
+     m_header = new (m_arena) Header;
+     m_header->m_next = 0;
+     m_workerStates = reinterpret_cast<WorkerState *>(m_arena + sizeof(Header));
+     for (int i = 0; i < m_workers; i++) {
+          new (&m_workerStates[i]) WorkerState;
+          m_workerStates[i].m_shard = -1;
+          m_workerStates[i].m_started = 0;
+     }
+     m_slots = reinterpret_cast<Slot *>(m_arena + sizeof(Header) + m_workers * sizeof(WorkerState));
+     for (int i = 0; i < a_shards; i++) {
+          new (&m_slots[i].m_state) atomic<int>;
+          m_slots[i].m_state = SS_Waiting;
+     }
+     return true;
+} /* bool ShardRunner::MakeArena(int a_shards) */
+
+
+/**/
+/*
+ShardRunner::FreeArena()
+
+NAME
+
+    ShardRunner::FreeArena - free the arena.
+
+SYNOPSIS
+
+    void ShardRunner::FreeArena();
+
+DESCRIPTION
+
+    Unmaps the arena, if there is one.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void ShardRunner::FreeArena()
+{
+     if (m_arena == NULL)
+          return;
+#ifdef _WIN32
+     delete[] m_arena;
+#else
+     munmap(m_arena, m_arenaSize);
+#endif
+     m_arena = NULL;
+     m_arenaSize = 0;
+     m_header = NULL;
+     m_workerStates = NULL;
+     m_slots = NULL;
+} /* void ShardRunner::FreeArena() */
+
+
+/**/
+/*
+ShardRunner::Work(int a_worker)
+
+NAME
+
+    ShardRunner::Work - the work of a worker.
+
+SYNOPSIS
+
+    void ShardRunner::Work(int a_worker);
+    a_worker    --> the number of the worker.
+
+DESCRIPTION
+
+    Copies the loaded program into an emulator of its own, then takes the next shard from the
+    counter in the arena and runs it, until the counter passes the last shard. The shard being run
+    and when it was started are kept in the state of the worker, for the parent to watch.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void ShardRunner::Work(int a_worker)
+{
+     unique_ptr<emulator> work(new emulator(*m_loaded));
+     int shards = (int)m_inputFiles->size();
+     WorkerState &state = m_workerStates[a_worker];
+
+     for (int shard = m_header->m_next++; shard < shards; shard = m_header->m_next++) {
+          state.m_started = Now();
+          state.m_shard = shard;
+          RunShard(*work, shard);
+          state.m_shard = -1;
+     }
+} /* void ShardRunner::Work(int a_worker) */
+
+
+/**/
+/*
+ShardRunner::RunShard(emulator &a_work, int a_shard)
+
+NAME
+
+    ShardRunner::RunShard - run the program on one input file.
+
+SYNOPSIS
+
+    void ShardRunner::RunShard(emulator &a_work, int a_shard);
+    a_work     --> the emulator of the worker, with the program loaded.
+    a_shard    --> the number of the shard.
+
+DESCRIPTION
+
+    Resets the emulator to the loaded program and runs it with the input file as its input, keeping
+    its output and the errors it records. These are written into the slot of the shard, as much of
+    them as fits, and the slot is then marked as done.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void ShardRunner::RunShard(emulator &a_work, int a_shard)
+{
+     Slot &slot = m_slots[a_shard];
+     const string &inputFile = (*m_inputFiles)[a_shard];
+     vector<string> errors;
+     ostringstream output;
+     Outcome outcome = SO_NoInput;
+
+     vector<string> *previous = Errors::CaptureErrors(&errors);
+     ifstream file(inputFile.c_str());
+     if (file) {
+          istringstream input;
+          input.str(string(istreambuf_iterator<char>(file), istreambuf_iterator<char>()));
+          a_work.reset();
+          a_work.setStreams(&input, &output);
+          a_work.runProgram();
+          a_work.setStreams(&cin, &cout);
+          outcome = a_work.halted() ? SO_Halted : SO_OutOfSteps;
+     }
+     else {
+          string error = "Could not open the input file " + inputFile;
+          Errors::RecordError(error);
+     }
+     Errors::CaptureErrors(previous);
+
+     string text = output.str();
+     slot.m_outcome = outcome;
+     slot.m_steps = a_work.stepCount();
+     slot.m_accumulator = a_work.accumulator();
+     slot.m_outputSize = (int)min<size_t>(text.size(), OUTPUT_BYTES);
+     slot.m_truncated = text.size() > OUTPUT_BYTES;
+     memcpy(slot.m_output, text.data(), slot.m_outputSize);
+
+     slot.m_errorSize = 0;
+     for (size_t i = 0; i < errors.size(); i++) {
+          if (slot.m_errorSize + errors[i].size() + 1 > ERROR_BYTES) {
+               slot.m_truncated = true;
+               break;
+          }
+          memcpy(slot.m_errors + slot.m_errorSize, errors[i].data(), errors[i].size());
+          slot.m_errorSize += (int)errors[i].size();
+          slot.m_errors[slot.m_errorSize++] = '\n';
+     }
+     slot.m_state = SS_Done;
+} /* void ShardRunner::RunShard(emulator &a_work, int a_shard) */
+
+
+/**/
+/*
+ShardRunner::Fork(int a_worker)
+
+NAME
+
+    ShardRunner::Fork - start a worker process.
+
+SYNOPSIS
+
+    bool ShardRunner::Fork(int a_worker);
+    a_worker    --> the number of the worker.
+
+DESCRIPTION
+
+    Forks a process that does the work of the worker and exits, without running the exit handlers
+    of this process or writing out its buffers.
+
+RETURNS
+
+    'true' if the worker was started,
+    'false' if the process could not be forked.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool ShardRunner::Fork(int a_worker)
+{
+#ifdef _WIN32
+     return false;
+#else
+     m_workerStates[a_worker].m_shard = -1;
+     pid_t pid = fork();
+     if (pid < 0)
+          return false;
+     if (pid == 0) {
+          Work(a_worker);
+          _exit(0);
+     }
+     m_pids[a_worker] = (int)pid;
+     return true;
+#endif
+} /* bool ShardRunner::Fork(int a_worker) */
+
+
+/**/
+/*
+ShardRunner::Abandon(int a_worker, Outcome a_outcome)
+
+NAME
+
+    ShardRunner::Abandon - record the shard of a worker that has died.
+
+SYNOPSIS
+
+    void ShardRunner::Abandon(int a_worker, Outcome a_outcome);
+    a_worker     --> the number of the worker, which must no longer be running.
+    a_outcome    --> how the shard ended.
+
+DESCRIPTION
+
+    If the worker died while running a shard whose slot it had not written, the slot is written
+    with the outcome and no output. A worker that died after taking a shard from the counter but
+    before saying so leaves the slot waiting, and Collect records it as crashed.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void ShardRunner::Abandon(int a_worker, Outcome a_outcome)
+{
+     int shard = m_workerStates[a_worker].m_shard;
+     m_workerStates[a_worker].m_shard = -1;
+     if (shard < 0 || m_slots[shard].m_state == SS_Done)
+          return;
+
+     Slot &slot = m_slots[shard];
+     slot.m_outcome = a_outcome;
+     slot.m_steps = 0;
+     slot.m_accumulator = 0;
+     slot.m_outputSize = 0;
+     slot.m_errorSize = 0;
+     slot.m_truncated = false;
+     slot.m_state = SS_Done;
+} /* void ShardRunner::Abandon(int a_worker, Outcome a_outcome) */
+
+
+/**/
+/*
+ShardRunner::Collect()
+
+NAME
+
+    ShardRunner::Collect - collect the results from the arena.
+
+SYNOPSIS
+
+    void ShardRunner::Collect();
+
+DESCRIPTION
+
+    Copies the slot of each shard into its result. A slot still waiting belongs to a shard whose
+    worker died before it could say it had taken it, and is recorded as crashed.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void ShardRunner::Collect()
+{
+     m_results.resize(m_inputFiles->size());
+     for (size_t i = 0; i < m_results.size(); i++) {
+          const Slot &slot = m_slots[i];
+          Result &result = m_results[i];
+          if (slot.m_state != SS_Done) {
+               result.m_outcome = SO_Crashed;
+               result.m_steps = 0;
+               result.m_accumulator = 0;
+               result.m_truncated = false;
+               continue;
+          }
+          result.m_outcome = static_cast<Outcome>(slot.m_outcome);
+          result.m_steps = slot.m_steps;
+          result.m_accumulator = slot.m_accumulator;
+          result.m_truncated = slot.m_truncated;
+          result.m_output.assign(slot.m_output, slot.m_outputSize);
+
+          const char *start = slot.m_errors;
+          const char *end = slot.m_errors + slot.m_errorSize;
+          while (start < end) {
+               const char *line = find(start, end, '\n');
+               result.m_errors.push_back(string(start, line));
+               start = line + 1;
+          }
+     }
+} /* void ShardRunner::Collect() */
+
+
+/**/
+/*
+ShardRunner::Now()
+
+NAME
+
+    ShardRunner::Now - the time, for the timeout.
+
+SYNOPSIS
+
+    static int64_t ShardRunner::Now();
+
+DESCRIPTION
+
+    Reads the steady clock, which is the same in every process.
+
+RETURNS
+
+    The milliseconds of the steady clock.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+int64_t ShardRunner::Now()
+{
+     return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+} /* int64_t ShardRunner::Now() */
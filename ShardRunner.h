@@ -0,0 +1,160 @@
+#pragma once
+
+/**/
+/*
+ShardRunner Class
+
+NAME
+
+     ShardRunner - run one program on many inputs in worker processes.
+
+DESCRIPTION
+
+     ShardRunner class - runs a program that has been loaded once on every one of a list of input
+     files, each input being a shard of the batch. The work is done by worker processes forked
+     from the one that loaded the program, so they share its memory, the image included, and only
+     copy what they write. The workers take the next shard from a counter in memory shared with
+     them, which needs no lock, and write how it went into a slot of its own in a results arena in
+     the same memory: the outcome, steps, accumulator, output and errors.
+
+     A worker runs a program in its own address space, so if it crashes or runs longer than the
+     time allowed for one shard, it is killed without harming the others. The shard it had is
+     recorded as failed and another worker is forked in its place to go on with the rest of the
+     batch. The output and errors a shard can keep are limited to the size of its slot; what goes
+     over is cut off.
+
+     On Windows, which has no fork, the workers are threads of the same process instead, and a
+     worker that crashes takes the batch down with it.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+class emulator;
+
+class ShardRunner {
+
+public:
+
+    // How a shard ended.
+    enum Outcome {
+        SO_Halted,      // It halted, or was stopped by an error.
+        SO_OutOfSteps,  // It took as many steps as the emulator allows without halting.
+        SO_NoInput,     // Its input file could not be read.
+        SO_Crashed,     // The worker running it died.
+        SO_TimedOut     // The worker running it was killed for taking too long.
+    };
+
+    // How a shard went, as collected from the results arena.
+    struct Result {
+        Outcome m_outcome;          // How it ended.
+        int m_steps;                // Steps it took.
+        int m_accumulator;          // The accumulator when it ended.
+        string m_output;            // What it wrote.
+        vector<string> m_errors;    // The errors recorded while it ran.
+        bool m_truncated;           // == true if its output or errors did not fit in its slot.
+    };
+
+    const static int OUTPUT_BYTES = 4096;           // Characters of output kept for a shard.
+    const static int ERROR_BYTES = 1024;            // Characters of errors kept for a shard.
+    const static int DEFAULT_TIMEOUT = 10;          // Seconds a shard may take unless asked otherwise.
+
+    // A_workers of 0 forks a worker per core.
+    ShardRunner( const emulator &a_loaded, int a_workers = 0, double a_timeout = DEFAULT_TIMEOUT );
+    ~ShardRunner( );
+
+    // Run the program on each input file, and wait for all of them. Returns false if the workers could not be started.
+    bool Run( const vector<string> &a_inputFiles );
+
+    // Access the results, in the order of the input files, and the number of workers forked in place of ones that died.
+    inline const Result &GetResult( int a_shard ) const {
+
+        return m_results[a_shard];
+    };
+    inline int ShardCount( ) const {
+
+        return (int)m_results.size();
+    };
+    inline int Restarts( ) const {
+
+        return m_restarts;
+    };
+
+private:
+
+    // The states of a slot in the arena.
+    enum SlotState {
+        SS_Waiting,     // No result has been written.
+        SS_Done         // The result was written, by the worker or by the parent when the worker died.
+    };
+
+    // What each worker is doing, after the header.
+    struct WorkerState {
+        atomic<int> m_shard;        // The shard it is running, -1 for none.
+        atomic<int64_t> m_started;  // When it started the shard, in milliseconds of the steady clock.
+    };
+
+    // The counter shards are taken from, at the start of the arena. Aligned as the worker states after it must be.
+    struct alignas( WorkerState ) Header {
+        atomic<int> m_next;         // The next shard to be taken.
+    };
+
+    // The result of a shard, as it is written into the arena, after the workers.
+    struct Slot {
+        atomic<int> m_state;        // A SlotState.
+        int m_outcome;              // An Outcome.
+        int m_steps;
+        int m_accumulator;
+        int m_outputSize;
+        int m_errorSize;
+        bool m_truncated;
+        char m_output[OUTPUT_BYTES];
+        char m_errors[ERROR_BYTES];     // The errors, each ending with a new line.
+    };
+
+    // The arena is shared so it may not be copied.
+    ShardRunner( const ShardRunner & );
+    ShardRunner &operator=( const ShardRunner & );
+
+    // Make and free the arena.
+    bool MakeArena( int a_shards );
+    void FreeArena( );
+
+    // The work of each worker: run shards until none are left.
+    void Work( int a_worker );
+
+    // Run a shard on a worker emulator and write its slot.
+    void RunShard( emulator &a_work, int a_shard );
+
+    // Start a worker, and deal with one that has died. Only used where workers are processes.
+    bool Fork( int a_worker );
+    void Abandon( int a_worker, Outcome a_outcome );
+
+    // Collect the results from the arena.
+    void Collect( );
+
+    // Milliseconds of the steady clock.
+    static int64_t Now( );
+
+    const emulator *m_loaded;                   // The program, loaded.
+    int m_workers;                              // Number of workers.
+    int64_t m_timeout;                          // Milliseconds a shard may take.
+    const vector<string> *m_inputFiles;         // The input files of the batch being run.
+
+    char *m_arena;                              // The arena, shared with the workers.
+    size_t m_arenaSize;                         // Its size in bytes.
+    Header *m_header;                           // The parts of the arena.
+    WorkerState *m_workerStates;
+    Slot *m_slots;
+    vector<int> m_pids;                         // The process of each worker, 0 for none.
+
+    vector<Result> m_results;                   // The results of the last batch.
+    int m_restarts;                             // Workers forked in place of ones that died.
+};
@@ -0,0 +1,321 @@
+//
+//      Implementation of the SharedImage and SharedInstance classes.
+//
+#include "stdafx.h"
+#include "SharedImage.h"
+
+
+/**/
+/*
+SharedImage::SharedImage(const emulator &a_loaded)
+
+NAME
+
+    SharedImage::SharedImage - share a loaded program.
+
+SYNOPSIS
+
+    SharedImage::SharedImage(const emulator &a_loaded);
+    a_loaded    --> an emulator the program was loaded into and has not run.
+
+DESCRIPTION
+
+    Copies the pages of the memory that are not all zero, and the state the program starts with.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+SharedImage::SharedImage(const emulator &a_loaded)
+     : m_origin(a_loaded.origin()), m_accumulator(a_loaded.accumulator()), m_steps(a_loaded.startSteps())
+{
+     const int *memory = a_loaded.memory();
+     for (int page = 0; page < PAGES; page++) {
+          int start = page * PAGE_WORDS;
+          int count = min(emulator::MEMSZ - start, (int)PAGE_WORDS);
+          if (all_of(memory + start, memory + start + count, [](int a_word) { return a_word == 0; }))
+               continue;
+          m_pages[page].reset(new int[PAGE_WORDS]());
+          copy(memory + start, memory + start + count, m_pages[page].get());
+     }
+} /* SharedImage::SharedImage(const emulator &a_loaded) */
+
+
+/**/
+/*
+SharedImage::Load(emulator &a_work) const
+
+NAME
+
+    SharedImage::Load - load the image into a worker.
+
+SYNOPSIS
+
+    void SharedImage::Load(emulator &a_work) const;
+    a_work    --> an emulator that has nothing loaded.
+
+DESCRIPTION
+
+    Copies the pages that are not all zero into the worker, verifies the program and takes a
+    snapshot, so the worker can run instances and be reset after each.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void SharedImage::Load(emulator &a_work) const
+{
+     for (int page = 0; page < PAGES; page++) {
+          int start = page * PAGE_WORDS;
+          if (m_pages[page])
+               a_work.insertBlock(start, m_pages[page].get(), min(emulator::MEMSZ - start, (int)PAGE_WORDS));
+     }
+     a_work.setStartState(m_accumulator, m_steps);
+     a_work.setOrigin(m_origin);
+     a_work.verify();
+     a_work.snapshot();
+} /* void SharedImage::Load(emulator &a_work) const */
+
+
+/**/
+/*
+SharedInstance::SharedInstance(const SharedImage &a_image)
+
+NAME
+
+    SharedInstance::SharedInstance - start a run of a shared image.
+
+SYNOPSIS
+
+    SharedInstance::SharedInstance(const SharedImage &a_image);
+    a_image    --> the image. It must outlive the instance.
+
+DESCRIPTION
+
+    Makes a run that has not started, with no pages of its own.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+SharedInstance::SharedInstance(const SharedImage &a_image)
+     : m_image(&a_image), m_loc(a_image.GetOrigin()), m_accumulator(a_image.GetAccumulator()),
+     m_steps(a_image.GetSteps()), m_done(false), m_halted(false)
+{
+} /* SharedInstance::SharedInstance(const SharedImage &a_image) */
+
+
+/**/
+/*
+SharedInstance::Run(emulator &a_work, int a_steps)
+
+NAME
+
+    SharedInstance::Run - run a slice of the program.
+
+SYNOPSIS
+
+    bool SharedInstance::Run(emulator &a_work, int a_steps);
+    a_work     --> a worker the image was loaded into with SharedImage::Load.
+    a_steps    --> the most steps to take.
+
+DESCRIPTION
+
+    Writes the private pages over the image in the worker, resumes the program where it left off
+    with runSlice and copies the words it wrote into the private pages, then resets the worker.
+    The input and output of the program are whatever the worker has been given.
+
+RETURNS
+
+    'true' if the run is done,
+    'false' if it is to be resumed.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool SharedInstance::Run(emulator &a_work, int a_steps)
+{
+     if (m_done)
+          return true;
+
+     for (int page = 0; page < SharedImage::PAGES; page++) {
+          int start = page * SharedImage::PAGE_WORDS;
+          if (m_pages[page])
+               a_work.restoreWords(start, m_pages[page].get(), min(emulator::MEMSZ - start, (int)SharedImage::PAGE_WORDS));
+     }
+     a_work.setResumeState(m_loc, m_accumulator, m_steps);
+     m_done = a_work.runSlice(a_steps);
+
+     for (int i = 0; i < a_work.dirtyCount(); i++) {
+          int loc = a_work.dirtyLocation(i);
+          Write(loc, a_work.memory()[loc]);
+     }
+     m_loc = a_work.origin();
+     m_accumulator = a_work.accumulator();
+     m_steps = a_work.stepCount();
+     m_halted = a_work.halted();
+     a_work.reset();
+     return m_done;
+} /* bool SharedInstance::Run(emulator &a_work, int a_steps) */
+
+
+/**/
+/*
+SharedInstance::Read(int a_loc) const
+
+NAME
+
+    SharedInstance::Read - read a word.
+
+SYNOPSIS
+
+    int SharedInstance::Read(int a_loc) const;
+    a_loc    --> the location, from 0 to MEMSZ - 1.
+
+DESCRIPTION
+
+    Reads the word from the private page if there is one, otherwise from the image.
+
+RETURNS
+
+    The contents of the word.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+int SharedInstance::Read(int a_loc) const
+{
+     int page = a_loc / SharedImage::PAGE_WORDS;
+     const int *words = m_pages[page] ? m_pages[page].get() : m_image->GetPage(page);
+     return words != NULL ? words[a_loc % SharedImage::PAGE_WORDS] : 0;
+} /* int SharedInstance::Read(int a_loc) const */
+
+
+/**/
+/*
+SharedInstance::Write(int a_loc, int a_word)
+
+NAME
+
+    SharedInstance::Write - write a word.
+
+SYNOPSIS
+
+    void SharedInstance::Write(int a_loc, int a_word);
+    a_loc     --> the location.
+    a_word    --> the new contents.
+
+DESCRIPTION
+
+    Makes the private copy of the page the first time it is written, from the image, or as zeros if
+    the image does not keep the page, and writes the word into it. A word written with the value the
+    image already has does not need a page of its own.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void SharedInstance::Write(int a_loc, int a_word)
+{
+     int page = a_loc / SharedImage::PAGE_WORDS;
+     if (!m_pages[page]) {
+          const int *shared = m_image->GetPage(page);
+          if ((shared != NULL ? shared[a_loc % SharedImage::PAGE_WORDS] : 0) == a_word)
+               return;
+          m_pages[page].reset(new int[SharedImage::PAGE_WORDS]());
+          if (shared != NULL)
+               copy(shared, shared + SharedImage::PAGE_WORDS, m_pages[page].get());
+     }
+     m_pages[page][a_loc % SharedImage::PAGE_WORDS] = a_word;
+} /* void SharedInstance::Write(int a_loc, int a_word) */
+
+
+/**/
+/*
+SharedInstance::PrivatePages() const
+
+NAME
+
+    SharedInstance::PrivatePages - count the pages of the run.
+
+SYNOPSIS
+
+    int SharedInstance::PrivatePages() const;
+
+DESCRIPTION
+
+    Counts the pages the run has its own copy of.
+
+RETURNS
+
+    The number of pages.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+int SharedInstance::PrivatePages() const
+{
+     int count = 0;
+     for (int page = 0; page < SharedImage::PAGES; page++) {
+          if (m_pages[page])
+               count++;
+     }
+     return count;
+} /* int SharedInstance::PrivatePages() const */
@@ -0,0 +1,156 @@
+#pragma once
+
+/**/
+/*
+SharedImage Class
+
+NAME
+
+     SharedImage - a loaded program shared by many instances that keep only what they write.
+
+DESCRIPTION
+
+     SharedImage class - holds the memory of a loaded program once, read only, in pages of
+     PAGE_WORDS words. Pages that are all zero are not kept at all. Any number of SharedInstance
+     objects then run the program, each keeping a private copy of only the pages it has written,
+     made the first time it writes one, so a parameter sweep can keep hundreds of thousands of
+     runs resident where a whole emulator each would not fit.
+
+     An instance does not carry an emulator. It is run a slice at a time on a worker emulator the
+     image was loaded into, one per thread: its private pages are written over the image, it runs
+     from where it left off, the words it wrote are copied into its pages, and the worker is reset
+     to the image for the next instance. This costs what the instance has written, and keeps the
+     fast loops of the emulator, which index one flat memory, as they are.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+#include "Emulator.h"
+
+class SharedImage {
+
+public:
+
+    const static int PAGE_WORDS = 256;                                                  // Words in a page.
+    const static int PAGES = (emulator::MEMSZ + PAGE_WORDS - 1) / PAGE_WORDS;           // Pages in the memory.
+
+    // Share the program loaded into an emulator.
+    SharedImage( const emulator &a_loaded );
+    ~SharedImage( ) { };
+
+    // Load the image into a worker emulator that has nothing loaded.
+    void Load( emulator &a_work ) const;
+
+    // Access the image.
+    inline const int *GetPage( int a_page ) const {
+
+        return m_pages[a_page].get();
+    };
+    inline int GetOrigin( ) const {
+
+        return m_origin;
+    };
+    inline int GetAccumulator( ) const {
+
+        return m_accumulator;
+    };
+    inline int GetSteps( ) const {
+
+        return m_steps;
+    };
+
+private:
+
+    unique_ptr<int[]> m_pages[PAGES];   // The pages of the memory, NULL for pages that are all zero.
+    int m_origin;                       // Location of the first instruction to be executed.
+    int m_accumulator;                  // The accumulator when the program starts.
+    int m_steps;                        // Steps already taken when the program starts.
+};
+
+
+/**/
+/*
+SharedInstance Class
+
+NAME
+
+     SharedInstance - a run of a shared image.
+
+DESCRIPTION
+
+     SharedInstance class - the pages a run of a SharedImage has written, where it left off and
+     how it ended. The pages are copied from the image, or made as zeros, when they are first
+     written.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+class SharedInstance {
+
+public:
+
+    SharedInstance( const SharedImage &a_image );
+    ~SharedInstance( ) { };
+
+    // Run the program for at most a_steps steps on a worker the image was loaded into. Returns true once it is done.
+    bool Run( emulator &a_work, int a_steps );
+
+    // The image this is a run of.
+    inline const SharedImage &GetImage( ) const {
+
+        return *m_image;
+    };
+
+    // The contents of a word as this run sees it.
+    int Read( int a_loc ) const;
+
+    // Access how the run went.
+    inline bool IsDone( ) const {
+
+        return m_done;
+    };
+    inline bool IsHalted( ) const {
+
+        return m_halted;
+    };
+    inline int GetSteps( ) const {
+
+        return m_steps;
+    };
+    inline int GetAccumulator( ) const {
+
+        return m_accumulator;
+    };
+
+    // The number of pages this run has its own copy of.
+    int PrivatePages( ) const;
+
+private:
+
+    // Write a word, copying its page first if this run does not have its own yet.
+    void Write( int a_loc, int a_word );
+
+    const SharedImage *m_image;                         // The image this is a run of.
+    unique_ptr<int[]> m_pages[SharedImage::PAGES];      // The pages written, NULL for the ones read from the image.
+    int m_loc;                                          // Where the run goes on from.
+    int m_accumulator;                                  // The accumulator.
+    int m_steps;                                        // Steps taken.
+    bool m_done;                                        // == true once the run is done.
+    bool m_halted;                                      // == true if it halted or was stopped by an error.
+};
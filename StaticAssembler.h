@@ -0,0 +1,981 @@
+#pragma once
+
+/**/
+/*
+StaticAssembler Class
+
+NAME
+
+     StaticAssembler - assemble and run VC-3600 programs at compile time.
+
+DESCRIPTION
+
+     StaticAssembler class - the translation rules of Instruction and the execution rules of
+     emulator as constexpr functions, so a program written into C++ source as a string literal
+     can be assembled, and run if it reads no input, while the host program is being compiled:
+
+         constexpr StaticAssembler::Image image = StaticAssembler::Assemble( "..." );
+         static_assert( image.m_error == NULL, "the program does not assemble" );
+         constexpr StaticAssembler::Result result = StaticAssembler::Run( image );
+
+     Instruction and emulator use Opcode, ParseConstant and Arithmetic themselves, so the rules
+     cannot drift apart. Assemble stops at the first error, which it leaves in the image with its
+     line instead of printing a listing, and programs that import or export symbols are refused.
+     Run keeps what the program writes instead of printing it and counts the overflows.
+     Everything is C++14, and is in this header since constexpr functions must be.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+
+class StaticAssembler {
+
+public:
+
+    const static int MEMSZ = 10000;         // The size of the memory of the VC3600.
+    const static int MAX_SYMBOLS = 1000;    // Most labels a program assembled at compile time may have.
+    const static int MAX_OUTPUT = 1000;     // Most values a run at compile time may write.
+
+    // A piece of text, which need not end with a null character.
+    struct Text {
+        const char *m_data;
+        int m_size;
+    };
+
+    // An assembled program.
+    struct Image {
+        int m_memory[MEMSZ];        // The memory the program starts with.
+        int m_origin;               // Location of the first instruction.
+        int m_end;                  // Location following the last word of the program.
+        const char *m_error;        // The first error found, NULL if the program assembled.
+        int m_errorLine;            // The line of the error, counting from 1.
+    };
+
+    // The end of a run of a program.
+    struct Result {
+        int m_memory[MEMSZ];        // The memory when the program stopped.
+        int m_accumulator;          // The accumulator when the program stopped.
+        int m_steps;                // Steps taken, as counted by the emulator.
+        bool m_halted;              // == true if the program halted within the step limit of the emulator.
+        int m_output[MAX_OUTPUT];   // The values written, in order.
+        int m_outputs;              // Number of values written.
+        int m_overflows;            // Number of times an instruction would have overflowed the accumulator.
+        const char *m_error;        // Why the program could not be run at compile time, NULL if it was.
+    };
+
+    // The opcode of an operation, or -1 if there is none. With a_anyCase the name may be in upper case.
+    static constexpr int Opcode( Text a_name, bool a_anyCase );
+
+    // Read the constant of a dc statement: an optional sign and one to six digits.
+    static constexpr bool ParseConstant( Text a_constant, int &a_value );
+
+    // Apply add, sub, mult or div to the accumulator. Returns false instead if the accumulator would overflow.
+    static constexpr bool Arithmetic( int a_opcode, int a_accumulator, int a_value, int &a_result );
+
+    // Assemble a program. The first error found, if any, is left in the image.
+    static constexpr Image Assemble( const char *a_source );
+
+    // Run an assembled program that reads no input.
+    static constexpr Result Run( const Image &a_image );
+
+private:
+
+    // Codes to indicate the type of a line, as Instruction::InstructionType.
+    enum LineType {
+        LT_MachineLanguage,     // A machine language instruction.
+        LT_AssemblerInstr,      // Assembler language instruction.
+        LT_Comment,             // Comment or blank line.
+        LT_End                  // end instruction.
+    };
+
+    // A line split into its fields, without its comment.
+    struct Statement {
+        Text m_field[4];            // The first four fields. A line with more is an error.
+        int m_count;                // Number of fields.
+        LineType m_type;            // The type of the line.
+        bool m_label;               // == true if the first field is a label.
+    };
+
+    // A label and its location.
+    struct Symbol {
+        Text m_name;                // The label, before it is converted to lower case.
+        int m_loc;                  // Its location, or -1 if it is multiply defined.
+    };
+
+    // Get the next line of the source. Returns false at the end of the source.
+    static constexpr bool NextLine( const char *a_source, int a_size, int &a_pos, Text &a_line );
+
+    // Split a line into its fields and find its type, as Instruction::ParseInstruction does.
+    static constexpr Statement Parse( Text a_line );
+
+    // Compute the location of the next line, as Instruction::LocationNextInstruction does. Returns false if the number is bad.
+    static constexpr bool NextLocation( const Statement &a_statement, int &a_loc );
+
+    // Compare a field with a lower case word.
+    static constexpr bool Equals( Text a_text, const char *a_word, bool a_anyCase );
+
+    // Compare a label, which the Assembler converts to lower case, with a field.
+    static constexpr bool SameLabel( Text a_label, Text a_text, bool a_anyCase );
+
+    // Read the number at the start of a field, as stoi does.
+    static constexpr bool ParseNumber( Text a_text, int &a_value );
+
+    // Convert a character to lower case.
+    static constexpr char Lower( char a_char );
+
+    // Record the first error of the program and return the image.
+    static constexpr Image Fail( Image &a_image, const char *a_error, int a_line );
+};
+
+
+/**/
+/*
+StaticAssembler::Opcode(Text a_name, bool a_anyCase)
+
+NAME
+
+    StaticAssembler::Opcode - get the opcode of an operation.
+
+SYNOPSIS
+
+    static constexpr int StaticAssembler::Opcode(Text a_name, bool a_anyCase);
+    a_name       --> the name of the operation.
+    a_anyCase    --> true to accept the name in any case, false to accept only lower case.
+
+DESCRIPTION
+
+    Looks up the operation in the table of operations, in the order of their opcodes.
+
+RETURNS
+
+    an integer between 1 and 13 representing the corresponding opcode,
+    -1 if the operation is not defined.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+constexpr int StaticAssembler::Opcode(Text a_name, bool a_anyCase)
+{
+     const char *const names[] = {
+          "add", "sub", "mult", "div", "load", "store", "read", "write", "b", "bm", "bz", "bp", "halt"
+     };
+     for (int i = 0; i < 13; i++) {
+          if (Equals(a_name, names[i], a_anyCase))
+               return i + 1;
+     }
+     return -1;
+} /* constexpr int StaticAssembler::Opcode(Text a_name, bool a_anyCase) */
+
+
+/**/
+/*
+StaticAssembler::ParseConstant(Text a_constant, int &a_value)
+
+NAME
+
+    StaticAssembler::ParseConstant - read the constant of a dc statement.
+
+SYNOPSIS
+
+    static constexpr bool StaticAssembler::ParseConstant(Text a_constant, int &a_value);
+    a_constant    --> the operand of the dc statement.
+    a_value       --> the value of the constant.
+
+DESCRIPTION
+
+    A constant is an optional sign followed by one to six digits, and nothing else.
+
+RETURNS
+
+    'true' if the constant is valid,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+constexpr bool StaticAssembler::ParseConstant(Text a_constant, int &a_value)
+{
+     int first = (a_constant.m_size > 0 && (a_constant.m_data[0] == '-' || a_constant.m_data[0] == '+')) ? 1 : 0;
+     if (first == a_constant.m_size || a_constant.m_size - first > 6)
+          return false;
+
+     int value = 0;
+     for (int i = first; i < a_constant.m_size; i++) {
+          if (a_constant.m_data[i] < '0' || a_constant.m_data[i] > '9')
+               return false;
+          value = value * 10 + (a_constant.m_data[i] - '0');
+     }
+     a_value = a_constant.m_data[0] == '-' ? -value : value;
+     return true;
+} /* constexpr bool StaticAssembler::ParseConstant(Text a_constant, int &a_value) */
+
+
+/**/
+/*
+StaticAssembler::Arithmetic(int a_opcode, int a_accumulator, int a_value, int &a_result)
+
+NAME
+
+    StaticAssembler::Arithmetic - apply an arithmetic instruction.
+
+SYNOPSIS
+
+    static constexpr bool StaticAssembler::Arithmetic(int a_opcode, int a_accumulator, int a_value, int &a_result);
+    a_opcode         --> 1 to 4 for add, sub, mult and div.
+    a_accumulator    --> the accumulator.
+    a_value          --> the word the instruction refers to.
+    a_result         --> the new value of the accumulator.
+
+DESCRIPTION
+
+    The accumulator overflows when add goes above 999999, when sub goes below -999999, when mult or div
+    go outside either bound, and when div divides by zero. The product is computed in 64 bits, so it
+    cannot wrap around before it is checked.
+
+RETURNS
+
+    'true' if the instruction can be applied,
+    'false' if the accumulator would overflow.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+constexpr bool StaticAssembler::Arithmetic(int a_opcode, int a_accumulator, int a_value, int &a_result)
+{
+     long long result = 0;
+     switch (a_opcode) {
+     case 1:
+          result = (long long)a_accumulator + a_value;
+          if (result > 999999)
+               return false;
+          break;
+     case 2:
+          result = (long long)a_accumulator - a_value;
+          if (result < -999999)
+               return false;
+          break;
+     case 3:
+          result = (long long)a_accumulator * a_value;
+          if (result > 999999 || result < -999999)
+               return false;
+          break;
+     case 4:
+          if (a_value == 0)
+               return false;
+          result = (long long)a_accumulator / a_value;
+          if (result > 999999 || result < -999999)
+               return false;
+          break;
+     default:
+          return false;
+     }
+     a_result = (int)result;
+     return true;
+} /* constexpr bool StaticAssembler::Arithmetic(int a_opcode, int a_accumulator, int a_value, int &a_result) */
+
+
+/**/
+/*
+StaticAssembler::Assemble(const char *a_source)
+
+NAME
+
+    StaticAssembler::Assemble - assemble a program.
+
+SYNOPSIS
+
+    static constexpr StaticAssembler::Image StaticAssembler::Assemble(const char *a_source);
+    a_source    --> the source code, with its lines separated by new lines.
+
+DESCRIPTION
+
+    Makes the same two passes as the Assembler: the first records the location of every label, and
+    the second translates the instructions and constants and places them in memory. Execution starts
+    at the first instruction. The errors are the ones the Assembler reports, with the same messages,
+    and a bad number in an org or ds statement, which the Assembler does not check.
+
+RETURNS
+
+    The assembled program, or an image holding the first error and its line.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+constexpr StaticAssembler::Image StaticAssembler::Assemble(const char *a_source)
+{
+     Image image = {};
+     Symbol symbols[MAX_SYMBOLS] = {};
+     int symbolCount = 0;
+     int size = 0;
+     while (a_source[size] != '\0')
+          size++;
+
+     // Pass I: record the location of every label, up to the end statement.
+     Text line = { a_source, 0 };
+     int pos = 0;
+     int lineNumber = 0;
+     int loc = 0;
+     bool ended = false;
+     while (!ended && NextLine(a_source, size, pos, line)) {
+          lineNumber++;
+          Statement statement = Parse(line);
+          if (statement.m_type == LT_End) {
+               ended = true;
+               continue;
+          }
+          if (statement.m_type == LT_Comment)
+               continue;
+          if (Equals(statement.m_field[0], "import", true) || Equals(statement.m_field[0], "export", true))
+               return Fail(image, "Import and export statements are only allowed in modules (assemble with -c)", lineNumber);
+
+          if (statement.m_label) {
+               int i = 0;
+               while (i < symbolCount && !SameLabel(symbols[i].m_name, statement.m_field[0], true))
+                    i++;
+               if (i < symbolCount) {
+                    symbols[i].m_loc = -1;
+               }
+               else if (symbolCount == MAX_SYMBOLS) {
+                    return Fail(image, "Too many labels to assemble at compile time", lineNumber);
+               }
+               else {
+                    symbols[symbolCount].m_name = statement.m_field[0];
+                    symbols[symbolCount].m_loc = loc;
+                    symbolCount++;
+               }
+          }
+          if (!NextLocation(statement, loc))
+               return Fail(image, "Bad number in org or ds statement", lineNumber);
+     }
+     int lastLine = lineNumber;
+     bool linesAfterEnd = ended && NextLine(a_source, size, pos, line);
+
+     // Pass II: translate the lines and place the words in memory.
+     image.m_origin = -1;
+     pos = 0;
+     lineNumber = 0;
+     loc = 0;
+     while (NextLine(a_source, size, pos, line)) {
+          lineNumber++;
+          Statement statement = Parse(line);
+          if (statement.m_type == LT_End)
+               break;
+          if (statement.m_count > 3)
+               return Fail(image, "More than three field", lineNumber);
+
+          int word = 0;
+          bool placed = true;
+          if (statement.m_type == LT_MachineLanguage) {
+               // The operation is the first field unless there is a label. Only the first field is converted to lower case.
+               Text operation = statement.m_field[statement.m_count == 3 ? 1 : 0];
+               int opcode = Opcode(operation, statement.m_count != 3);
+               if (opcode == -1)
+                    return Fail(image, "Bad Operation Command", lineNumber);
+               if (statement.m_count == 1) {
+                    if (opcode != 13)
+                         return Fail(image, "Missing operand", lineNumber);
+                    word = 130000;
+               }
+               else {
+                    Text operand = statement.m_field[statement.m_count - 1];
+                    int i = 0;
+                    while (i < symbolCount && !SameLabel(symbols[i].m_name, operand, false))
+                         i++;
+                    if (i == symbolCount)
+                         return Fail(image, "Undefined Operand/Label", lineNumber);
+                    if (symbols[i].m_loc < 0)
+                         return Fail(image, "Multiply defined Operand/Label", lineNumber);
+                    word = opcode * 10000 + symbols[i].m_loc;
+               }
+               if (image.m_origin == -1)
+                    image.m_origin = loc;
+          }
+          else if (statement.m_type == LT_AssemblerInstr && statement.m_count == 3
+               && (Equals(statement.m_field[1], "dc", false) || Equals(statement.m_field[1], "DC", false))) {
+               if (!ParseConstant(statement.m_field[2], word))
+                    return Fail(image, "Constant is not a number of at most six digits", lineNumber);
+          }
+          else {
+               placed = false;
+          }
+
+          if (placed) {
+               if (loc < 0 || loc >= MEMSZ)
+                    return Fail(image, "Location out of bounds error", lineNumber);
+               image.m_memory[loc] = word;
+          }
+          NextLocation(statement, loc);
+     }
+     if (!ended)
+          return Fail(image, "Missing end statement", lastLine);
+     if (linesAfterEnd)
+          return Fail(image, "Lines after end statement", lastLine + 1);
+     if (image.m_origin == -1)
+          image.m_origin = 0;
+     image.m_end = loc;
+     return image;
+} /* constexpr StaticAssembler::Image StaticAssembler::Assemble(const char *a_source) */
+
+
+/**/
+/*
+StaticAssembler::Run(const Image &a_image)
+
+NAME
+
+    StaticAssembler::Run - run an assembled program.
+
+SYNOPSIS
+
+    static constexpr StaticAssembler::Result StaticAssembler::Run(const Image &a_image);
+    a_image    --> the program to be run.
+
+DESCRIPTION
+
+    Executes the program from the origin as emulator::runProgram does, taking a step for every word
+    it passes, until it halts or has taken a step for every word of memory. An instruction that would
+    overflow the accumulator is counted and tried again, as the emulator prints a message and tries
+    it again. A program that reads cannot be run, since there is no input at compile time, and a word
+    with an invalid opcode stops the program with an error, as in the emulator.
+
+RETURNS
+
+    The state the program stopped in, with the values it wrote, or the reason it could not be run.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+constexpr StaticAssembler::Result StaticAssembler::Run(const Image &a_image)
+{
+     Result result = {};
+     result.m_error = a_image.m_error;
+     if (result.m_error != NULL)
+          return result;
+     for (int i = 0; i < MEMSZ; i++)
+          result.m_memory[i] = a_image.m_memory[i];
+
+     int loc = a_image.m_origin;
+     for (int i = 0; i < MEMSZ; i++) {
+          if (loc < 0 || loc >= MEMSZ) {
+               result.m_error = "The program ran past the end of memory";
+               result.m_steps = i;
+               return result;
+          }
+          int opcode = result.m_memory[loc] / 10000;
+          int operand = result.m_memory[loc] % 10000;
+          int value = 0;
+
+          switch (opcode) {
+          case 0:
+               loc++;
+               break;
+          case 1:
+          case 2:
+          case 3:
+          case 4:
+               if (Arithmetic(opcode, result.m_accumulator, result.m_memory[operand], value)) {
+                    result.m_accumulator = value;
+                    loc++;
+               }
+               else {
+                    result.m_overflows++;
+               }
+               break;
+          case 5:
+               result.m_accumulator = result.m_memory[operand];
+               loc++;
+               break;
+          case 6:
+               result.m_memory[operand] = result.m_accumulator;
+               loc++;
+               break;
+          case 7:
+               result.m_error = "The program reads input, it cannot be run at compile time";
+               result.m_steps = i;
+               return result;
+          case 8:
+               if (result.m_outputs == MAX_OUTPUT) {
+                    result.m_error = "The program writes more than can be kept at compile time";
+                    result.m_steps = i;
+                    return result;
+               }
+               result.m_output[result.m_outputs++] = result.m_memory[operand];
+               loc++;
+               break;
+          case 9:
+               loc = operand;
+               break;
+          case 10:
+               loc = result.m_accumulator < 0 ? operand : loc + 1;
+               break;
+          case 11:
+               loc = result.m_accumulator == 0 ? operand : loc + 1;
+               break;
+          case 12:
+               loc = result.m_accumulator > 0 ? operand : loc + 1;
+               break;
+          case 13:
+               result.m_halted = true;
+               result.m_steps = i + 1;
+               return result;
+          default:
+               result.m_error = "Invalid opcode";
+               result.m_steps = i + 1;
+               return result;
+          }
+     }
+     result.m_steps = MEMSZ;
+     return result;
+} /* constexpr StaticAssembler::Result StaticAssembler::Run(const Image &a_image) */
+
+
+/**/
+/*
+StaticAssembler::NextLine(const char *a_source, int a_size, int &a_pos, Text &a_line)
+
+NAME
+
+    StaticAssembler::NextLine - get the next line of the source.
+
+SYNOPSIS
+
+    static constexpr bool StaticAssembler::NextLine(const char *a_source, int a_size, int &a_pos, Text &a_line);
+    a_source    --> the source code.
+    a_size      --> the length of the source code.
+    a_pos       --> where the next line starts. Moved past the line and its new line.
+    a_line      --> the line, without its new line.
+
+DESCRIPTION
+
+    Lines are separated by new lines, so a new line at the very end starts an empty last line, as it does
+    when the Assembler reads a file. An empty source has no lines.
+
+RETURNS
+
+    'true' if there was a line,
+    'false' at the end of the source.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+constexpr bool StaticAssembler::NextLine(const char *a_source, int a_size, int &a_pos, Text &a_line)
+{
+     if (a_pos > a_size || a_size == 0)
+          return false;
+     int end = a_pos;
+     while (end < a_size && a_source[end] != '\n')
+          end++;
+     a_line.m_data = a_source + a_pos;
+     a_line.m_size = end - a_pos;
+     a_pos = end + 1;
+     return true;
+} /* constexpr bool StaticAssembler::NextLine(const char *a_source, int a_size, int &a_pos, Text &a_line) */
+
+
+/**/
+/*
+StaticAssembler::Parse(Text a_line)
+
+NAME
+
+    StaticAssembler::Parse - split a line into its fields.
+
+SYNOPSIS
+
+    static constexpr StaticAssembler::Statement StaticAssembler::Parse(Text a_line);
+    a_line    --> the line of source code.
+
+DESCRIPTION
+
+    Drops the comment, splits the rest at white space and finds the type of the line the way
+    Instruction::ParseInstruction does: halt, org, end, import and export in the first field in any case,
+    then two fields for an instruction without a label, then a label followed by dc, ds or an operation.
+
+RETURNS
+
+    The fields and the type of the line.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+constexpr StaticAssembler::Statement StaticAssembler::Parse(Text a_line)
+{
+     Statement statement = {};
+     int end = 0;
+     while (end < a_line.m_size && a_line.m_data[end] != ';')
+          end++;
+
+     int i = 0;
+     while (i < end) {
+          char c = a_line.m_data[i];
+          if (c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f') {
+               i++;
+               continue;
+          }
+          int start = i;
+          while (i < end && a_line.m_data[i] != ' ' && a_line.m_data[i] != '\t' && a_line.m_data[i] != '\r'
+               && a_line.m_data[i] != '\v' && a_line.m_data[i] != '\f')
+               i++;
+          if (statement.m_count < 4) {
+               statement.m_field[statement.m_count].m_data = a_line.m_data + start;
+               statement.m_field[statement.m_count].m_size = i - start;
+          }
+          statement.m_count++;
+     }
+
+     const Text &first = statement.m_field[0];
+     if (statement.m_count == 0)
+          statement.m_type = LT_Comment;
+     else if (Equals(first, "halt", true))
+          statement.m_type = LT_MachineLanguage;
+     else if (Equals(first, "org", true) || Equals(first, "import", true) || Equals(first, "export", true))
+          statement.m_type = LT_AssemblerInstr;
+     else if (Equals(first, "end", true))
+          statement.m_type = LT_End;
+     else if (statement.m_count == 2)
+          statement.m_type = LT_MachineLanguage;
+     else if (statement.m_count == 1)
+          statement.m_type = LT_MachineLanguage;
+     else {
+          const Text &second = statement.m_field[1];
+          statement.m_label = true;
+          statement.m_type = (Equals(second, "dc", false) || Equals(second, "DC", false)
+               || Equals(second, "ds", false) || Equals(second, "DS", false)) ? LT_AssemblerInstr : LT_MachineLanguage;
+     }
+     return statement;
+} /* constexpr StaticAssembler::Statement StaticAssembler::Parse(Text a_line) */
+
+
+/**/
+/*
+StaticAssembler::NextLocation(const Statement &a_statement, int &a_loc)
+
+NAME
+
+    StaticAssembler::NextLocation - get the location of the next line.
+
+SYNOPSIS
+
+    static constexpr bool StaticAssembler::NextLocation(const Statement &a_statement, int &a_loc);
+    a_statement    --> the line.
+    a_loc          --> the location of the line, replaced by the location of the next line.
+
+DESCRIPTION
+
+    Comments, end, import and export take no room, org sets the location, ds sets aside the words it asks
+    for and anything else takes one word.
+
+RETURNS
+
+    'true' if the location was computed,
+    'false' if an org or ds statement does not start its number with a digit.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+constexpr bool StaticAssembler::NextLocation(const Statement &a_statement, int &a_loc)
+{
+     if (a_statement.m_type == LT_Comment || a_statement.m_type == LT_End)
+          return true;
+     if (a_statement.m_type == LT_AssemblerInstr) {
+          int value = 0;
+          if (Equals(a_statement.m_field[0], "import", true) || Equals(a_statement.m_field[0], "export", true))
+               return true;
+          if (Equals(a_statement.m_field[0], "org", true)) {
+               if (a_statement.m_count < 2 || !ParseNumber(a_statement.m_field[1], value))
+                    return false;
+               a_loc = value;
+               return true;
+          }
+          if (Equals(a_statement.m_field[1], "ds", false) || Equals(a_statement.m_field[1], "DS", false)) {
+               if (!ParseNumber(a_statement.m_field[2], value))
+                    return false;
+               a_loc += value;
+               return true;
+          }
+     }
+     a_loc++;
+     return true;
+} /* constexpr bool StaticAssembler::NextLocation(const Statement &a_statement, int &a_loc) */
+
+
+/**/
+/*
+StaticAssembler::Equals(Text a_text, const char *a_word, bool a_anyCase)
+
+NAME
+
+    StaticAssembler::Equals - compare a field with a word.
+
+SYNOPSIS
+
+    static constexpr bool StaticAssembler::Equals(Text a_text, const char *a_word, bool a_anyCase);
+    a_text       --> the field.
+    a_word       --> the word, in lower case unless a_anyCase is false.
+    a_anyCase    --> true to convert the field to lower case before comparing it.
+
+DESCRIPTION
+
+    Compares the field with the word character by character.
+
+RETURNS
+
+    'true' if they are the same,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+constexpr bool StaticAssembler::Equals(Text a_text, const char *a_word, bool a_anyCase)
+{
+     int i = 0;
+     for (; i < a_text.m_size; i++) {
+          char c = a_anyCase ? Lower(a_text.m_data[i]) : a_text.m_data[i];
+          if (a_word[i] == '\0' || a_word[i] != c)
+               return false;
+     }
+     return a_word[i] == '\0';
+} /* constexpr bool StaticAssembler::Equals(Text a_text, const char *a_word, bool a_anyCase) */
+
+
+/**/
+/*
+StaticAssembler::SameLabel(Text a_label, Text a_text, bool a_anyCase)
+
+NAME
+
+    StaticAssembler::SameLabel - compare a label with a field.
+
+SYNOPSIS
+
+    static constexpr bool StaticAssembler::SameLabel(Text a_label, Text a_text, bool a_anyCase);
+    a_label      --> the label, as written in the source.
+    a_text       --> the field.
+    a_anyCase    --> true if the field is a label too, false if it is an operand.
+
+DESCRIPTION
+
+    The Assembler converts labels to lower case, but not operands, so an operand only refers to a label
+    if it is written in lower case.
+
+RETURNS
+
+    'true' if they name the same symbol,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+constexpr bool StaticAssembler::SameLabel(Text a_label, Text a_text, bool a_anyCase)
+{
+     if (a_label.m_size != a_text.m_size)
+          return false;
+     for (int i = 0; i < a_label.m_size; i++) {
+          if (Lower(a_label.m_data[i]) != (a_anyCase ? Lower(a_text.m_data[i]) : a_text.m_data[i]))
+               return false;
+     }
+     return true;
+} /* constexpr bool StaticAssembler::SameLabel(Text a_label, Text a_text, bool a_anyCase) */
+
+
+/**/
+/*
+StaticAssembler::ParseNumber(Text a_text, int &a_value)
+
+NAME
+
+    StaticAssembler::ParseNumber - read the number at the start of a field.
+
+SYNOPSIS
+
+    static constexpr bool StaticAssembler::ParseNumber(Text a_text, int &a_value);
+    a_text     --> the field.
+    a_value    --> the number.
+
+DESCRIPTION
+
+    Reads an optional sign and the digits after it, ignoring the rest of the field, as stoi does.
+
+RETURNS
+
+    'true' if the field starts with a number,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+constexpr bool StaticAssembler::ParseNumber(Text a_text, int &a_value)
+{
+     int i = (a_text.m_size > 0 && (a_text.m_data[0] == '-' || a_text.m_data[0] == '+')) ? 1 : 0;
+     int first = i;
+     int value = 0;
+     for (; i < a_text.m_size && a_text.m_data[i] >= '0' && a_text.m_data[i] <= '9' && value < 100000000; i++)
+          value = value * 10 + (a_text.m_data[i] - '0');
+     if (i == first)
+          return false;
+     a_value = a_text.m_data[0] == '-' ? -value : value;
+     return true;
+} /* constexpr bool StaticAssembler::ParseNumber(Text a_text, int &a_value) */
+
+
+/**/
+/*
+StaticAssembler::Lower(char a_char)
+
+NAME
+
+    StaticAssembler::Lower - convert a character to lower case.
+
+SYNOPSIS
+
+    static constexpr char StaticAssembler::Lower(char a_char);
+    a_char    --> the character.
+
+DESCRIPTION
+
+    tolower for the letters of the source code, which is not constexpr.
+
+RETURNS
+
+    The character in lower case.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+constexpr char StaticAssembler::Lower(char a_char)
+{
+     return (a_char >= 'A' && a_char <= 'Z') ? char(a_char - 'A' + 'a') : a_char;
+} /* constexpr char StaticAssembler::Lower(char a_char) */
+
+
+/**/
+/*
+StaticAssembler::Fail(Image &a_image, const char *a_error, int a_line)
+
+NAME
+
+    StaticAssembler::Fail - record the error of a program.
+
+SYNOPSIS
+
+    static constexpr StaticAssembler::Image StaticAssembler::Fail(Image &a_image, const char *a_error, int a_line);
+    a_image    --> the image being assembled.
+    a_error    --> the error message.
+    a_line     --> the line of the error, counting from 1.
+
+DESCRIPTION
+
+    Records the error in the image, which Assemble then returns.
+
+RETURNS
+
+    The image.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+constexpr StaticAssembler::Image StaticAssembler::Fail(Image &a_image, const char *a_error, int a_line)
+{
+     a_image.m_error = a_error;
+     a_image.m_errorLine = a_line;
+     return a_image;
+} /* constexpr StaticAssembler::Image StaticAssembler::Fail(Image &a_image, const char *a_error, int a_line) */
@@ -0,0 +1,396 @@
+//
+//      Implementation of the Stats class.
+//
+#include "stdafx.h"
+#include "Stats.h"
+
+#ifdef _WIN32
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+// The counters, and the time and number of runs of each phase. Atomic since several threads update them.
+static atomic<int64_t> m_counters[Stats::CT_Count];
+static atomic<int64_t> m_phaseNanoseconds[Stats::PH_Count];
+static atomic<int64_t> m_phaseRuns[Stats::PH_Count];
+
+// == true once the statistics are to be collected. Only read in the hot paths, so its cache line stays shared.
+static atomic<bool> m_enabled(false);
+
+// Names used when the statistics are reported.
+static const char *PHASE_NAMES[Stats::PH_Count] = { "read_file", "pass1", "pass2", "listing", "image_load", "emulation" };
+static const char *COUNTER_NAMES[Stats::CT_Count] = {
+     "lines_read", "lines_pass1", "lines_pass2", "cached_blocks", "symbol_lookups", "instructions", "reads", "writes", "verified_steps",
+     "operand_patches", "redecodes", "slices", "steals", "reset_words",
+     "image_cache_hits", "image_cache_misses", "image_cache_evictions",
+     "result_cache_hits", "result_cache_misses", "result_cache_evictions", "duplicate_runs", "allocations"
+};
+
+// The current time in nanoseconds.
+static int64_t Now()
+{
+     return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#if VC_STATS
+// Count every allocation of the program once the statistics are enabled. The array forms and the sized forms call these.
+void *operator new(size_t a_size)
+{
+     if (m_enabled.load(memory_order_relaxed))
+          m_counters[Stats::CT_Allocations].fetch_add(1, memory_order_relaxed);
+     void *memory = malloc(a_size != 0 ? a_size : 1);
+     if (memory == NULL)
+          throw bad_alloc();
+     return memory;
+}
+void operator delete(void *a_memory) noexcept
+{
+     free(a_memory);
+}
+void operator delete(void *a_memory, size_t) noexcept
+{
+     free(a_memory);
+}
+#endif
+
+
+/**/
+/*
+Stats::Timer::Timer(Phase a_phase)
+
+NAME
+
+    Stats::Timer::Timer - start timing a phase.
+
+SYNOPSIS
+
+    Stats::Timer::Timer(Phase a_phase);
+    a_phase    --> the phase being timed.
+
+DESCRIPTION
+
+    Notes the time the phase started. The time is added to the phase when the timer is stopped. A
+    timer started before the statistics are enabled does nothing.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+Stats::Timer::Timer(Phase a_phase)
+: m_phase( a_phase ), m_start( m_enabled.load(memory_order_relaxed) ? Now() : -1 )
+{
+} /* Stats::Timer::Timer(Phase a_phase) */
+
+
+/**/
+/*
+Stats::Timer::Stop()
+
+NAME
+
+    Stats::Timer::Stop - stop timing a phase.
+
+SYNOPSIS
+
+    void Stats::Timer::Stop();
+
+DESCRIPTION
+
+    Adds the time since the timer was started to its phase. Stopping a timer again does nothing.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Stats::Timer::Stop()
+{
+     if (m_start < 0)
+          return;
+     m_phaseNanoseconds[m_phase] += Now() - m_start;
+     m_phaseRuns[m_phase]++;
+     m_start = -1;
+} /* void Stats::Timer::Stop() */
+
+
+/**/
+/*
+Stats::Enable()
+
+NAME
+
+    Stats::Enable - start collecting the statistics.
+
+SYNOPSIS
+
+    static void Stats::Enable();
+
+DESCRIPTION
+
+    From now on the counters are added to and the phases are timed. Before this they cost no more
+    than a test of a flag that is never written, so runs that do not report them are not slowed
+    down by threads writing to the same counters.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Stats::Enable()
+{
+     m_enabled = true;
+} /* void Stats::Enable() */
+
+
+/**/
+/*
+Stats::Add(Counter a_counter, int64_t a_amount)
+
+NAME
+
+    Stats::Add - add to a counter.
+
+SYNOPSIS
+
+    static void Stats::Add(Counter a_counter, int64_t a_amount);
+    a_counter    --> the counter.
+    a_amount     --> the amount added to it.
+
+DESCRIPTION
+
+    Adds to the counter without ordering it with other memory operations, which is all a counter needs
+    and is the cheapest atomic update. Nothing is done until the statistics are enabled.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Stats::Add(Counter a_counter, int64_t a_amount)
+{
+     if (a_amount == 0 || !m_enabled.load(memory_order_relaxed))
+          return;
+     m_counters[a_counter].fetch_add(a_amount, memory_order_relaxed);
+} /* void Stats::Add(Counter a_counter, int64_t a_amount) */
+
+
+/**/
+/*
+Stats::Get(Counter a_counter)
+
+NAME
+
+    Stats::Get - get the value of a counter.
+
+SYNOPSIS
+
+    static int64_t Stats::Get(Counter a_counter);
+    a_counter    --> the counter.
+
+DESCRIPTION
+
+    Reads the counter.
+
+RETURNS
+
+    The value of the counter.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+int64_t Stats::Get(Counter a_counter)
+{
+     return m_counters[a_counter].load(memory_order_relaxed);
+} /* int64_t Stats::Get(Counter a_counter) */
+
+
+/**/
+/*
+Stats::Print(ostream &a_out)
+
+NAME
+
+    Stats::Print - print the statistics.
+
+SYNOPSIS
+
+    static void Stats::Print(ostream &a_out);
+    a_out    --> the stream the statistics are printed on.
+
+DESCRIPTION
+
+    Prints the time and number of runs of every phase, the counters and the peak memory as a table.
+    The column of names is as wide as the longest name, so no name runs into its value.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Stats::Print(ostream &a_out)
+{
+     if (!VC_STATS)
+          a_out << "Statistics were left out when the program was compiled." << endl;
+
+     // The names are padded to the longest of them, with room to spare, so the values line up.
+     size_t width = strlen("peak_memory_bytes");
+     for (int i = 0; i < PH_Count; i++)
+          width = max(width, strlen(PHASE_NAMES[i]));
+     for (int i = 0; i < CT_Count; i++)
+          width = max(width, strlen(COUNTER_NAMES[i]));
+     width += 3;
+
+     a_out << setw(width) << left << "Phase" << setw(16) << right << "Seconds" << setw(10) << "Runs" << endl;
+     for (int i = 0; i < PH_Count; i++) {
+          a_out << setw(width) << left << PHASE_NAMES[i] << setw(16) << right << fixed << setprecision(6)
+                << m_phaseNanoseconds[i] / 1e9 << setw(10) << m_phaseRuns[i] << endl;
+     }
+     a_out << endl << setw(width) << left << "Counter" << setw(16) << right << "Value" << endl;
+     for (int i = 0; i < CT_Count; i++)
+          a_out << setw(width) << left << COUNTER_NAMES[i] << setw(16) << right << m_counters[i] << endl;
+     a_out << setw(width) << left << "peak_memory_bytes" << setw(16) << right << PeakMemory() << endl;
+} /* void Stats::Print(ostream &a_out) */
+
+
+/**/
+/*
+Stats::WriteJson(ostream &a_out)
+
+NAME
+
+    Stats::WriteJson - write the statistics as JSON.
+
+SYNOPSIS
+
+    static void Stats::WriteJson(ostream &a_out);
+    a_out    --> the stream the statistics are written to.
+
+DESCRIPTION
+
+    Writes an object with the phases, each with its seconds and runs, the counters and the peak memory.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Stats::WriteJson(ostream &a_out)
+{
+     a_out << "{\n  \"enabled\": " << (VC_STATS ? "true" : "false") << ",\n  \"phases\": {\n";
+     for (int i = 0; i < PH_Count; i++) {
+          a_out << "    \"" << PHASE_NAMES[i] << "\": {\"seconds\": " << fixed << setprecision(9) << m_phaseNanoseconds[i] / 1e9
+                << ", \"runs\": " << m_phaseRuns[i] << "}" << (i + 1 < PH_Count ? ",\n" : "\n");
+     }
+     a_out << "  },\n  \"counters\": {\n";
+     for (int i = 0; i < CT_Count; i++)
+          a_out << "    \"" << COUNTER_NAMES[i] << "\": " << m_counters[i] << ",\n";
+     a_out << "    \"peak_memory_bytes\": " << PeakMemory() << "\n  }\n}\n";
+} /* void Stats::WriteJson(ostream &a_out) */
+
+
+/**/
+/*
+Stats::PeakMemory()
+
+NAME
+
+    Stats::PeakMemory - the peak memory of the process.
+
+SYNOPSIS
+
+    static int64_t Stats::PeakMemory();
+
+DESCRIPTION
+
+    Asks the operating system for the largest amount of physical memory the process has used.
+
+RETURNS
+
+    The peak memory in bytes, or 0 if it is not known.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+int64_t Stats::PeakMemory()
+{
+#ifdef _WIN32
+     PROCESS_MEMORY_COUNTERS counters;
+     if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+          return (int64_t)counters.PeakWorkingSetSize;
+     return 0;
+#else
+     struct rusage usage;
+     if (getrusage(RUSAGE_SELF, &usage) != 0)
+          return 0;
+#ifdef __APPLE__
+     return (int64_t)usage.ru_maxrss;
+#else
+     return (int64_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+} /* int64_t Stats::PeakMemory() */
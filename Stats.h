@@ -0,0 +1,127 @@
+#pragma once
+
+/**/
+/*
+Stats Class
+
+NAME
+
+     Stats - counters and timers for the phases of the assembler and the emulator.
+
+DESCRIPTION
+
+     Stats class - keeps the time spent in each phase (reading the source, Pass I, Pass II,
+     writing the listing, loading an image and emulating) and counters of the work done in
+     them: lines, symbol lookups, instructions executed, reads and writes, and memory
+     allocations. The peak memory of the process is read from the operating system when the
+     statistics are reported. Phases may be nested: reading the source is part of Pass I and
+     writing the listing is part of Pass II. The emulation time includes any time spent waiting
+     for the user to type input.
+
+     The counters are updated from several threads, so they are atomic. They are only touched
+     through the STATS_ macros below, and nothing is counted or timed until Enable is called, so a
+     run that does not report them only tests a flag. Counts made in hot loops from many threads
+     are kept per thread or per chunk and added once. Compiling with VC_STATS defined as 0 removes
+     them and the counting of allocations entirely.
+     Note: all members are static so we can access them anywhere.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+
+// Compile with VC_STATS defined as 0 to leave the counters and timers out.
+#ifndef VC_STATS
+#define VC_STATS 1
+#endif
+
+class Stats {
+
+public:
+
+    // The phases that are timed.
+    enum Phase {
+        PH_ReadFile,        // Reading the source file.
+        PH_PassI,           // Pass I, including reading the source.
+        PH_PassII,          // Pass II, including writing the listing.
+        PH_Listing,         // Writing the translation listing.
+        PH_ImageLoad,       // Loading an object image into the emulator.
+        PH_Emulation,       // Running the program.
+        PH_Count
+    };
+
+    // The counters.
+    enum Counter {
+        CT_LinesRead,       // Lines read from the source file.
+        CT_LinesPassI,      // Lines scanned by Pass I.
+        CT_LinesPassII,     // Lines translated by Pass II.
+        CT_CachedBlocks,    // Blocks whose translation was taken from the translation cache.
+        CT_SymbolLookups,   // Lookups in the symbol table.
+        CT_Instructions,    // Steps taken by the emulator.
+        CT_Reads,           // Values read by the emulator.
+        CT_Writes,          // Values written by the emulator.
+        CT_VerifiedInstructions, // Steps taken on the fast loop of verified programs.
+        CT_OperandPatches,  // Stores that changed only the operand of a decoded instruction.
+        CT_Redecodes,       // Stores that changed the opcode of a decoded word.
+        CT_Slices,          // Time slices run by the scheduler.
+        CT_Steals,          // Jobs a scheduler thread took from the queue of another.
+        CT_ResetWords,      // Words restored by resetting the emulator.
+        CT_ImageCacheHits,  // Programs loaded from the image cache.
+        CT_ImageCacheMisses, // Programs looked up in the image cache and not found.
+        CT_ImageCacheEvictions, // Entries deleted from the image cache to make it fit.
+        CT_ResultCacheHits, // Runs whose result was found in the result cache.
+        CT_ResultCacheMisses, // Runs looked up in the result cache and not found.
+        CT_ResultCacheEvictions, // Entries deleted from the result cache to make it fit.
+        CT_DuplicateRuns,   // Runs of a batch not done because an earlier run had the same image and input.
+        CT_Allocations,     // Calls to operator new.
+        CT_Count
+    };
+
+    // Times a phase from its construction until Stop is called or it goes out of scope.
+    class Timer {
+    public:
+        Timer( Phase a_phase );
+        ~Timer( ) { Stop(); }
+        void Stop( );
+    private:
+        Phase m_phase;
+        int64_t m_start;    // Time the phase started in nanoseconds, negative once stopped.
+    };
+
+    // Start counting and timing. Until then the counters and timers do nothing.
+    static void Enable( );
+
+    // Add to a counter.
+    static void Add( Counter a_counter, int64_t a_amount );
+
+    // Get the value of a counter.
+    static int64_t Get( Counter a_counter );
+
+    // Print the statistics as a table.
+    static void Print( ostream &a_out );
+
+    // Write the statistics as JSON.
+    static void WriteJson( ostream &a_out );
+
+private:
+
+    // The peak memory used by the process, in bytes, or 0 if it is not known.
+    static int64_t PeakMemory( );
+};
+
+#if VC_STATS
+#define STATS_ADD( a_counter, a_amount ) Stats::Add( Stats::a_counter, a_amount )
+#define STATS_TIMER( a_name, a_phase ) Stats::Timer a_name( Stats::a_phase )
+#define STATS_STOP( a_name ) a_name.Stop()
+#else
+#define STATS_ADD( a_counter, a_amount )
+#define STATS_TIMER( a_name, a_phase )
+#define STATS_STOP( a_name )
+#endif
@@ -3,9 +3,12 @@
 //
 #include "stdafx.h"
 #include "SymTab.h"
+#include "Stats.h"
 
-// This is the actual symbol table.  The symbol is the key to the map.
-static map<string, int> m_symbolTable;
+#if VC_STATS
+// Lookups made by this thread that have not been added to the statistics yet.
+static thread_local int64_t m_lookups = 0;
+#endif
 
 
 /**/
@@ -56,7 +59,49 @@ void SymbolTable::AddSymbol(string &a_symbol, int a_loc)
 
 /**/
 /*
-SymbolTable::DisplaySymbolTable()
+SymbolTable::Merge(const SymbolTable &a_other)
+
+NAME
+
+    SymbolTable::Merge - add the symbols of another table.
+
+SYNOPSIS
+
+    void SymbolTable::Merge(const SymbolTable &a_other);
+    a_other    --> the table whose symbols are added to this table.
+
+DESCRIPTION
+
+    This function adds every symbol of "a_other" to this table. A symbol defined in both tables is recorded
+    as multiply defined, so merging the tables built for parts of the source code gives the same table as
+    adding all the symbols to a single table, whatever order the parts are merged in.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void SymbolTable::Merge(const SymbolTable &a_other)
+{
+     for (map<string, int>::const_iterator it = a_other.m_symbolTable.begin(); it != a_other.m_symbolTable.end(); ++it) {
+          pair<map<string, int>::iterator, bool> st = m_symbolTable.insert(*it);
+          if (!st.second)
+               st.first->second = multiplyDefinedSymbol;
+     }
+} /* void SymbolTable::Merge(const SymbolTable &a_other) */
+
+
+/**/
+/*
+SymbolTable::DisplaySymbolTable(ostream &a_out)
 
 NAME
 
@@ -64,7 +109,8 @@ NAME
 
 SYNOPSIS
 
-    void SymbolTable::DisplaySymbolTable();
+    void SymbolTable::DisplaySymbolTable(ostream &a_out);
+    a_out    --> the stream the table is printed to.
 
 DESCRIPTION
 
@@ -83,17 +129,15 @@ DATE
 
 */
 /**/
-void SymbolTable::DisplaySymbolTable()
+void SymbolTable::DisplaySymbolTable(ostream &a_out)
 {
-     cout << setw(12) << left << "Symbol #" << setw(12) << left << "Symbol" << setw(12) << left << "Location" << endl;
+     a_out << setw(12) << left << "Symbol #" << setw(12) << left << "Symbol" << setw(12) << left << "Location" << endl;
      int count = 0;
      for (map<string, int>::iterator it = m_symbolTable.begin(); it != m_symbolTable.end(); ++it) {
-          cout << setw(12) << left << count++ << setw(12) << left << it->first << setw(12) << left << it->second << endl;
+          a_out << setw(12) << left << count++ << setw(12) << left << it->first << setw(12) << left << it->second << endl;
      }
-     cout << "_______________________________________________________________________________________________________\n\n";
-     cout << "Press Enter to continue...";
-     cin.ignore();
-} /* void SymbolTable::DisplaySymbolTable() */
+     a_out << "_______________________________________________________________________________________________________\n\n";
+} /* void SymbolTable::DisplaySymbolTable(ostream &a_out) */
 
 
 /**/
@@ -106,13 +150,14 @@ NAME
 
 SYNOPSIS
 
-    bool SymbolTable::LookupSymbol(const string & a_symbol, int & a_loc);
+    bool SymbolTable::LookupSymbol(const string & a_symbol, int & a_loc) const;
     a_symbol    --> the symbol to be searched for. const before the argument indicates the function is not going to change the value at the address of a_symbol.
     a_loc       --> if the symbol is found, the location is stored in a_loc. if not, a_loc is unchanged.
 
 DESCRIPTION
 
     This function will lookup a symbol in the symbol table and if found, store the location of the symbol in a_loc.
+    The lookup is counted for this thread only, and added to the statistics by TakeLookups.
 
 RETURNS
 
@@ -129,12 +174,90 @@ DATE
 
 */
 /**/
-bool SymbolTable::LookupSymbol(const string & a_symbol, int & a_loc)
+bool SymbolTable::LookupSymbol(const string & a_symbol, int & a_loc) const
 {
-     map<string, int>::iterator it = m_symbolTable.find(a_symbol);
+#if VC_STATS
+     m_lookups++;
+#endif
+     map<string, int>::const_iterator it = m_symbolTable.find(a_symbol);
      if (it != m_symbolTable.end()) {
           a_loc = it->second;
           return true;
      }
      return false;
-} /* bool SymbolTable::LookupSymbol(const string & a_symbol, int & a_loc) */
+} /* bool SymbolTable::LookupSymbol(const string & a_symbol, int & a_loc) const */
+
+
+/**/
+/*
+SymbolTable::GetSymbols()
+
+NAME
+
+    SymbolTable::GetSymbols - access all the symbols.
+
+SYNOPSIS
+
+    const map<string, int> &SymbolTable::GetSymbols() const;
+
+DESCRIPTION
+
+    This function gives read access to the whole symbol table so it can be saved with the object image.
+
+RETURNS
+
+    The map from each symbol to its location.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+const map<string, int> &SymbolTable::GetSymbols() const
+{
+     return m_symbolTable;
+} /* const map<string, int> &SymbolTable::GetSymbols() const */
+
+
+/**/
+/*
+SymbolTable::TakeLookups()
+
+NAME
+
+    SymbolTable::TakeLookups - add the lookups of this thread to the statistics.
+
+SYNOPSIS
+
+    static void SymbolTable::TakeLookups();
+
+DESCRIPTION
+
+    Lookups are counted per thread so that the threads translating the chunks do not all write to
+    the same counter. Each thread adds them here once it is done with a batch of work.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void SymbolTable::TakeLookups()
+{
+#if VC_STATS
+     STATS_ADD(CT_SymbolLookups, m_lookups);
+     m_lookups = 0;
+#endif
+} /* void SymbolTable::TakeLookups() */
@@ -13,7 +13,8 @@ DESCRIPTION
      SymbolTable class - this class holds the symbol table for the source code.
      The symbol table is made in the first pass and used in the second pass to 
      determine value for labels and for looking up symbols.
-     Note: LookupSymbol method is static so we can access it anywhere.
+     Note: each object holds its own table so that parts of the source code can
+     build tables of their own on separate threads and merge them afterwards.
 
 AUTHOR
 
@@ -34,18 +35,30 @@ public:
     SymbolTable( ) {};
     ~SymbolTable( ) {};
     
-    const int multiplyDefinedSymbol = -999;
+    const static int multiplyDefinedSymbol = -999;
+    const static int importedSymbol = -998;     // The symbol is defined in another module.
 
     // Add a new symbol to the symbol table.
     void AddSymbol( string &a_symbol, int a_loc );
 
+    // Add the symbols of another table to this table.
+    void Merge( const SymbolTable &a_other );
+
     // Display the symbol table.
-    void DisplaySymbolTable( );
+    void DisplaySymbolTable( ostream &a_out );
 
     // Lookup a symbol in the symbol table.
-    static bool LookupSymbol( const string &a_symbol, int &a_loc );
+    bool LookupSymbol( const string &a_symbol, int &a_loc ) const;
+
+    // Add the lookups made by this thread to the statistics.
+    static void TakeLookups( );
+
+    // Access all the symbols in the symbol table.
+    const map<string, int> &GetSymbols( ) const;
 
 private:
 
+    // This is the actual symbol table.  The symbol is the key to the map.
+    map<string, int> m_symbolTable;
 
 };
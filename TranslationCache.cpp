@@ -0,0 +1,779 @@
+//
+//      Implementation of the TranslationCache class.
+//
+#include "stdafx.h"
+#include "TranslationCache.h"
+
+// Where GetBytes reads the values the Put functions wrote. Once a read runs past the end, every read fails.
+struct Reader {
+     const char *m_data;
+     size_t m_size;
+     size_t m_pos;
+};
+
+
+/**/
+/*
+PutInt(string &a_out, int64_t a_value)
+
+NAME
+
+    PutInt - append a number to the text of a cache file.
+
+SYNOPSIS
+
+    static void PutInt(string &a_out, int64_t a_value);
+    a_out      --> the text the number is appended to.
+    a_value    --> the number.
+
+DESCRIPTION
+
+    Appends the 8 bytes of the number as they are in memory. The cache is only read by the
+    assembler that wrote it.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+static void PutInt(string &a_out, int64_t a_value)
+{
+     a_out.append(reinterpret_cast<const char *>(&a_value), sizeof(a_value));
+} /* static void PutInt(string &a_out, int64_t a_value) */
+
+
+/**/
+/*
+PutString(string &a_out, const string &a_text)
+
+NAME
+
+    PutString - append a string to the text of a cache file.
+
+SYNOPSIS
+
+    static void PutString(string &a_out, const string &a_text);
+    a_out     --> the text the string is appended to.
+    a_text    --> the string.
+
+DESCRIPTION
+
+    Appends the size of the string, then its bytes.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+static void PutString(string &a_out, const string &a_text)
+{
+     PutInt(a_out, a_text.size());
+     a_out += a_text;
+} /* static void PutString(string &a_out, const string &a_text) */
+
+
+/**/
+/*
+GetBytes(Reader &a_in, void *a_bytes, size_t a_size)
+
+NAME
+
+    GetBytes - read bytes from the text of a cache file.
+
+SYNOPSIS
+
+    static bool GetBytes(Reader &a_in, void *a_bytes, size_t a_size);
+    a_in       --> where the bytes are read from.
+    a_bytes    --> the bytes are copied here.
+    a_size     --> number of bytes.
+
+DESCRIPTION
+
+    Copies the next bytes and moves past them. If there are not that many left, nothing is copied and
+    the reader is moved to the end, so every read after it fails too.
+
+RETURNS
+
+    'true' if the bytes were read,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+static bool GetBytes(Reader &a_in, void *a_bytes, size_t a_size)
+{
+     if (a_in.m_pos > a_in.m_size || a_size > a_in.m_size - a_in.m_pos) {
+          a_in.m_pos = a_in.m_size + 1;
+          return false;
+     }
+     if (a_size > 0)
+          memcpy(a_bytes, a_in.m_data + a_in.m_pos, a_size);
+     a_in.m_pos += a_size;
+     return true;
+} /* static bool GetBytes(Reader &a_in, void *a_bytes, size_t a_size) */
+
+
+/**/
+/*
+GetInt(Reader &a_in)
+
+NAME
+
+    GetInt - read a number from the text of a cache file.
+
+SYNOPSIS
+
+    static int64_t GetInt(Reader &a_in);
+    a_in    --> where the number is read from.
+
+DESCRIPTION
+
+    Reads a number written by PutInt.
+
+RETURNS
+
+    The number, or 0 if it could not be read.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+static int64_t GetInt(Reader &a_in)
+{
+     int64_t value = 0;
+     GetBytes(a_in, &value, sizeof(value));
+     return value;
+} /* static int64_t GetInt(Reader &a_in) */
+
+
+/**/
+/*
+GetCount(Reader &a_in, size_t a_itemSize)
+
+NAME
+
+    GetCount - read the number of items that follow in the text of a cache file.
+
+SYNOPSIS
+
+    static size_t GetCount(Reader &a_in, size_t a_itemSize);
+    a_in          --> where the number is read from.
+    a_itemSize    --> the fewest bytes each item takes.
+
+DESCRIPTION
+
+    Reads a number written by PutInt. A number of items that could not fit in the bytes left is taken
+    to be damage, so a damaged file never makes the assembler allocate more than its size.
+
+RETURNS
+
+    The number of items, or 0 if it could not be read or was too big.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+static size_t GetCount(Reader &a_in, size_t a_itemSize)
+{
+     int64_t count = GetInt(a_in);
+     if (a_in.m_pos > a_in.m_size || count < 0 || (uint64_t)count > (a_in.m_size - a_in.m_pos) / max<size_t>(1, a_itemSize)) {
+          a_in.m_pos = a_in.m_size + 1;
+          return 0;
+     }
+     return (size_t)count;
+} /* static size_t GetCount(Reader &a_in, size_t a_itemSize) */
+
+
+/**/
+/*
+GetString(Reader &a_in, string &a_text)
+
+NAME
+
+    GetString - read a string from the text of a cache file.
+
+SYNOPSIS
+
+    static bool GetString(Reader &a_in, string &a_text);
+    a_in      --> where the string is read from.
+    a_text    --> the string is put here.
+
+DESCRIPTION
+
+    Reads a string written by PutString.
+
+RETURNS
+
+    'true' if the string was read,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+static bool GetString(Reader &a_in, string &a_text)
+{
+     size_t size = GetCount(a_in, 1);
+     a_text.resize(size);
+     return GetBytes(a_in, size > 0 ? &a_text[0] : NULL, size);
+} /* static bool GetString(Reader &a_in, string &a_text) */
+
+
+/**/
+/*
+TranslationCache::Load(const string &a_fileName)
+
+NAME
+
+    TranslationCache::Load - read the cache from a file.
+
+SYNOPSIS
+
+    bool TranslationCache::Load(const string &a_fileName);
+    a_fileName    --> name of the cache file.
+
+DESCRIPTION
+
+    Replaces the source and the blocks with the ones saved in the file. If the file does not exist,
+    was written by a different version of the assembler or is damaged, the cache is left empty and
+    every block is assembled as if the cache were not there. The results of the lines of each block
+    are only checked when they are decoded.
+
+RETURNS
+
+    'true' if the cache was read from the file,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool TranslationCache::Load(const string &a_fileName)
+{
+     m_source.clear();
+     m_blocks.clear();
+
+     ifstream file(a_fileName.c_str(), ios::in | ios::binary);
+     if (!file)
+          return false;
+     file.seekg(0, ios::end);
+     streamoff size = file.tellg();
+     file.seekg(0, ios::beg);
+     if (size <= 0)
+          return false;
+     string text((size_t)size, '\0');
+     if (!file.read(&text[0], size))
+          return false;
+
+     Reader in = { text.data(), text.size(), 0 };
+     uint32_t header[2];
+     if (!GetBytes(in, header, sizeof(header)) || header[0] != MAGIC || header[1] != VERSION || !GetString(in, m_source))
+          return false;
+
+     m_blocks.resize(GetCount(in, 8));
+     size_t next = 0;    // The first byte no block before has taken.
+     for (size_t i = 0; i < m_blocks.size() && in.m_pos <= in.m_size; i++) {
+          Block &block = m_blocks[i];
+          block.m_offset = (size_t)GetInt(in);
+          block.m_size = (size_t)GetInt(in);
+          block.m_lines = (size_t)GetInt(in);
+          if (block.m_offset < next || block.m_offset > m_source.size() || block.m_size > m_source.size() - block.m_offset) {
+               in.m_pos = in.m_size + 1;
+               break;
+          }
+          next = block.m_offset + block.m_size;
+
+          block.m_loc = (int)GetInt(in);
+          block.m_absolute = GetInt(in) != 0;
+          block.m_endLine = (size_t)GetInt(in);
+          block.m_labels.resize(GetCount(in, 24));
+          for (size_t j = 0; j < block.m_labels.size(); j++) {
+               GetString(in, block.m_labels[j].m_label);
+               block.m_labels[j].m_loc = (int)GetInt(in);
+               block.m_labels[j].m_relative = GetInt(in) != 0;
+          }
+          block.m_exports.resize(GetCount(in, 8));
+          for (size_t j = 0; j < block.m_exports.size(); j++)
+               GetString(in, block.m_exports[j]);
+
+          block.m_start = (int)GetInt(in);
+          size_t symbols = GetCount(in, 16);
+          for (size_t j = 0; j < symbols; j++) {
+               string symbol;
+               GetString(in, symbol);
+               block.m_symbols[symbol] = (int)GetInt(in);
+          }
+          GetString(in, block.m_listing);
+          block.m_machinecode.resize(GetCount(in, sizeof(pair<int, int>)));
+          GetBytes(in, block.m_machinecode.data(), block.m_machinecode.size() * sizeof(pair<int, int>));
+          block.m_sourceLines.resize(GetCount(in, sizeof(int)));
+          GetBytes(in, block.m_sourceLines.data(), block.m_sourceLines.size() * sizeof(int));
+          string instructions;
+          GetString(in, instructions);
+          block.m_instructions.assign(instructions.size(), false);
+          for (size_t j = 0; j < instructions.size(); j++)
+               block.m_instructions[j] = instructions[j] != 0;
+          block.m_origin = (int)GetInt(in);
+          block.m_relocations.resize(GetCount(in, sizeof(int)));
+          GetBytes(in, block.m_relocations.data(), block.m_relocations.size() * sizeof(int));
+          block.m_imports.resize(GetCount(in, 16));
+          for (size_t j = 0; j < block.m_imports.size(); j++) {
+               block.m_imports[j].first = (int)GetInt(in);
+               GetString(in, block.m_imports[j].second);
+          }
+          GetString(in, block.m_entries);
+     }
+     if (in.m_pos != in.m_size) {
+          m_source.clear();
+          m_blocks.clear();
+          return false;
+     }
+     return true;
+} /* bool TranslationCache::Load(const string &a_fileName) */
+
+
+/**/
+/*
+TranslationCache::Save(const string &a_fileName)
+
+NAME
+
+    TranslationCache::Save - save the cache to a file.
+
+SYNOPSIS
+
+    bool TranslationCache::Save(const string &a_fileName) const;
+    a_fileName    --> name of the cache file.
+
+DESCRIPTION
+
+    Writes the source and the blocks to the file, replacing its previous contents. The results of the
+    lines of a block are written as they were kept, so a block that was taken from the cache is only
+    copied.
+
+RETURNS
+
+    'true' if the cache was saved,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool TranslationCache::Save(const string &a_fileName) const
+{
+     string text;
+     uint32_t header[2] = { MAGIC, VERSION };
+     text.append(reinterpret_cast<const char *>(header), sizeof(header));
+     PutString(text, m_source);
+
+     PutInt(text, m_blocks.size());
+     for (vector<Block>::const_iterator block = m_blocks.begin(); block != m_blocks.end(); ++block) {
+          PutInt(text, block->m_offset);
+          PutInt(text, block->m_size);
+          PutInt(text, block->m_lines);
+
+          PutInt(text, block->m_loc);
+          PutInt(text, block->m_absolute);
+          PutInt(text, block->m_endLine);
+          PutInt(text, block->m_labels.size());
+          for (vector<Label>::const_iterator it = block->m_labels.begin(); it != block->m_labels.end(); ++it) {
+               PutString(text, it->m_label);
+               PutInt(text, it->m_loc);
+               PutInt(text, it->m_relative);
+          }
+          PutInt(text, block->m_exports.size());
+          for (vector<string>::const_iterator it = block->m_exports.begin(); it != block->m_exports.end(); ++it)
+               PutString(text, *it);
+
+          PutInt(text, block->m_start);
+          PutInt(text, block->m_symbols.size());
+          for (map<string, int>::const_iterator it = block->m_symbols.begin(); it != block->m_symbols.end(); ++it) {
+               PutString(text, it->first);
+               PutInt(text, it->second);
+          }
+          PutString(text, block->m_listing);
+          PutInt(text, block->m_machinecode.size());
+          text.append(reinterpret_cast<const char *>(block->m_machinecode.data()), block->m_machinecode.size() * sizeof(pair<int, int>));
+          PutInt(text, block->m_sourceLines.size());
+          text.append(reinterpret_cast<const char *>(block->m_sourceLines.data()), block->m_sourceLines.size() * sizeof(int));
+          string instructions(block->m_instructions.begin(), block->m_instructions.end());
+          PutString(text, instructions);
+          PutInt(text, block->m_origin);
+          PutInt(text, block->m_relocations.size());
+          text.append(reinterpret_cast<const char *>(block->m_relocations.data()), block->m_relocations.size() * sizeof(int));
+          PutInt(text, block->m_imports.size());
+          for (vector<pair<int, string>>::const_iterator it = block->m_imports.begin(); it != block->m_imports.end(); ++it) {
+               PutInt(text, it->first);
+               PutString(text, it->second);
+          }
+          PutString(text, block->m_entries);
+     }
+
+     ofstream file(a_fileName.c_str(), ios::out | ios::binary | ios::trunc);
+     file.write(text.data(), text.size());
+     file.close();
+     return !file.fail();
+} /* bool TranslationCache::Save(const string &a_fileName) const */
+
+
+/**/
+/*
+TranslationCache::Match(const string &a_source, vector<Span> &a_spans)
+
+NAME
+
+    TranslationCache::Match - find the blocks of the previous run in a source.
+
+SYNOPSIS
+
+    void TranslationCache::Match(const string &a_source, vector<Span> &a_spans) const;
+    a_source    --> the text of the source being assembled.
+    a_spans     --> the blocks of the source are put here, in order.
+
+DESCRIPTION
+
+    Compares the source with the source of the previous run a page at a time, from the start until
+    the first byte that differs and from the end until the last. A block of the previous run that
+    lies wholly before the first difference is in the same place in the source, and one that lies
+    wholly after the last difference has moved by the change in size. The line before such a block
+    is unchanged too, so the block still starts a line. The text between these blocks is split into
+    new blocks. An edit therefore costs the blocks it touches; the rest of the source is only compared.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void TranslationCache::Match(const string &a_source, vector<Span> &a_spans) const
+{
+     const size_t PAGE = 4096;
+     const string &old = m_source;
+     size_t common = min(old.size(), a_source.size());
+
+     size_t prefix = 0;      // Bytes the same at the start.
+     while (prefix < common) {
+          size_t step = min(PAGE, common - prefix);
+          if (memcmp(old.data() + prefix, a_source.data() + prefix, step) != 0) {
+               while (old[prefix] == a_source[prefix])
+                    prefix++;
+               break;
+          }
+          prefix += step;
+     }
+     size_t suffix = 0;      // Bytes the same at the end, not counting those at the start.
+     while (suffix < common - prefix) {
+          size_t step = min(PAGE, common - prefix - suffix);
+          if (memcmp(old.data() + old.size() - suffix - step, a_source.data() + a_source.size() - suffix - step, step) != 0) {
+               while (old[old.size() - 1 - suffix] == a_source[a_source.size() - 1 - suffix])
+                    suffix++;
+               break;
+          }
+          suffix += step;
+     }
+     bool same = prefix == old.size() && old.size() == a_source.size();
+
+     a_spans.clear();
+     size_t pos = 0;         // The first byte not yet in a block.
+     bool closed = false;    // == true once the last line of the source is in a block.
+     for (vector<Block>::const_iterator block = m_blocks.begin(); block != m_blocks.end(); ++block) {
+          // Only the last block of the old source does not end with a new line.
+          size_t end = block->m_offset + block->m_size;
+          size_t offset;
+          if (end <= prefix && (end < old.size() || same))
+               offset = block->m_offset;
+          else if (block->m_offset > old.size() - suffix)
+               offset = block->m_offset + a_source.size() - old.size();
+          else
+               continue;
+          if (offset < pos)
+               continue;
+
+          if (offset > pos)
+               Split(a_source, pos, offset, a_spans);
+          Span span = { offset, block->m_size, block->m_lines, &*block };
+          a_spans.push_back(span);
+          pos = offset + block->m_size;
+          closed = end == old.size();
+     }
+     if (!closed)
+          Split(a_source, pos, a_source.size(), a_spans);
+} /* void TranslationCache::Match(const string &a_source, vector<Span> &a_spans) const */
+
+
+/**/
+/*
+TranslationCache::Split(const string &a_source, size_t a_begin, size_t a_end, vector<Span> &a_spans)
+
+NAME
+
+    TranslationCache::Split - split text into new blocks.
+
+SYNOPSIS
+
+    static void TranslationCache::Split(const string &a_source, size_t a_begin, size_t a_end, vector<Span> &a_spans);
+    a_source    --> the text of the source.
+    a_begin     --> offset of the first byte to split, at the start of a line.
+    a_end       --> offset following the last byte to split, following a new line or at the end of the source.
+    a_spans     --> the blocks are added here.
+
+DESCRIPTION
+
+    Adds blocks of BLOCK_LINES lines, the last one shorter. The lines are those FileAccess reads: the
+    text up to each new line, and at the end of the source the text after the last new line, which is
+    a line even if it is empty.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void TranslationCache::Split(const string &a_source, size_t a_begin, size_t a_end, vector<Span> &a_spans)
+{
+     bool open = a_end == a_source.size();  // == true until the last line of the source is in a block.
+     size_t pos = a_begin;
+     while (pos < a_end || open) {
+          Span span = { pos, 0, 0, NULL };
+          while (span.m_lines < BLOCK_LINES) {
+               const char *newline = static_cast<const char *>(memchr(a_source.data() + pos, '\n', a_end - pos));
+               if (newline == NULL) {
+                    if (open || pos < a_end)
+                         span.m_lines++;
+                    pos = a_end;
+                    open = false;
+                    break;
+               }
+               pos = newline - a_source.data() + 1;
+               span.m_lines++;
+          }
+          span.m_size = pos - span.m_offset;
+          a_spans.push_back(span);
+     }
+} /* static void TranslationCache::Split(const string &a_source, size_t a_begin, size_t a_end, vector<Span> &a_spans) */
+
+
+/**/
+/*
+TranslationCache::Replace(const string &a_source, vector<Block> &a_blocks)
+
+NAME
+
+    TranslationCache::Replace - replace the source and the blocks.
+
+SYNOPSIS
+
+    void TranslationCache::Replace(const string &a_source, vector<Block> &a_blocks);
+    a_source    --> the text of the source.
+    a_blocks    --> the blocks of this run, in source order. They are moved into the cache.
+
+DESCRIPTION
+
+    Makes the cache hold the results of this run, to be saved for the next. The blocks found by Match
+    are no longer valid.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void TranslationCache::Replace(const string &a_source, vector<Block> &a_blocks)
+{
+     m_source = a_source;
+     m_blocks.swap(a_blocks);
+     a_blocks.clear();
+} /* void TranslationCache::Replace(const string &a_source, vector<Block> &a_blocks) */
+
+
+/**/
+/*
+TranslationCache::EncodeEntries(const vector<Entry> &a_entries, string &a_text)
+
+NAME
+
+    TranslationCache::EncodeEntries - keep the results of the lines of a block.
+
+SYNOPSIS
+
+    static void TranslationCache::EncodeEntries(const vector<Entry> &a_entries, string &a_text);
+    a_entries    --> the results of the lines.
+    a_text       --> they are written here.
+
+DESCRIPTION
+
+    Writes the number of entries, then for each its fixed size fields, followed by the label, the
+    operand and the linkage symbol.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void TranslationCache::EncodeEntries(const vector<Entry> &a_entries, string &a_text)
+{
+     a_text.clear();
+     PutInt(a_text, a_entries.size());
+     for (vector<Entry>::const_iterator entry = a_entries.begin(); entry != a_entries.end(); ++entry) {
+          int32_t fields[13] = {
+               entry->m_type, entry->m_origin, entry->m_size, entry->m_translated, entry->m_operandLoc,
+               entry->m_status, entry->m_word, entry->m_unknown,
+               static_cast<int32_t>(entry->m_label.size()), static_cast<int32_t>(entry->m_operand.size()),
+               entry->m_import, entry->m_export, static_cast<int32_t>(entry->m_linkSymbol.size())
+          };
+          a_text.append(reinterpret_cast<const char *>(fields), sizeof(fields));
+          a_text += entry->m_label;
+          a_text += entry->m_operand;
+          a_text += entry->m_linkSymbol;
+     }
+} /* static void TranslationCache::EncodeEntries(const vector<Entry> &a_entries, string &a_text) */
+
+
+/**/
+/*
+TranslationCache::DecodeEntries(const string &a_text, vector<Entry> &a_entries)
+
+NAME
+
+    TranslationCache::DecodeEntries - get back the results of the lines of a block.
+
+SYNOPSIS
+
+    static bool TranslationCache::DecodeEntries(const string &a_text, vector<Entry> &a_entries);
+    a_text       --> the results, as EncodeEntries wrote them.
+    a_entries    --> the results of the lines are put here.
+
+DESCRIPTION
+
+    Reads the entries EncodeEntries wrote. Damaged text gives no entries.
+
+RETURNS
+
+    'true' if the entries were read,
+    'false' otherwise.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool TranslationCache::DecodeEntries(const string &a_text, vector<Entry> &a_entries)
+{
+     Reader in = { a_text.data(), a_text.size(), 0 };
+     a_entries.resize(GetCount(in, 13 * sizeof(int32_t)));
+     for (size_t i = 0; i < a_entries.size(); i++) {
+          Entry &entry = a_entries[i];
+          int32_t fields[13];
+          if (!GetBytes(in, fields, sizeof(fields)) || fields[8] < 0 || fields[9] < 0 || fields[12] < 0)
+               break;
+          entry.m_type = Instruction::InstructionType(fields[0]);
+          entry.m_origin = fields[1] != 0;
+          entry.m_size = fields[2];
+          entry.m_translated = fields[3] != 0;
+          entry.m_operandLoc = fields[4];
+          entry.m_status = Instruction::TranslationStatus(fields[5]);
+          entry.m_word = fields[6];
+          entry.m_unknown = fields[7];
+          entry.m_label.resize(fields[8]);
+          entry.m_operand.resize(fields[9]);
+          entry.m_import = fields[10] != 0;
+          entry.m_export = fields[11] != 0;
+          entry.m_linkSymbol.resize(fields[12]);
+          if (!GetBytes(in, &entry.m_label[0], fields[8]) || !GetBytes(in, &entry.m_operand[0], fields[9])
+               || !GetBytes(in, &entry.m_linkSymbol[0], fields[12]))
+               break;
+     }
+     if (in.m_pos != in.m_size) {
+          a_entries.clear();
+          return false;
+     }
+     return true;
+} /* static bool TranslationCache::DecodeEntries(const string &a_text, vector<Entry> &a_entries) */
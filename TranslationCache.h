@@ -0,0 +1,138 @@
+#pragma once
+
+/**/
+/*
+TranslationCache Class
+
+NAME
+
+     TranslationCache - the results of blocks of source code kept between runs of the assembler.
+
+DESCRIPTION
+
+     TranslationCache class - remembers what Pass I and Pass II made of each block of lines of
+     a source file, along with the text of the file. When the file is assembled again, its text is
+     compared with the text kept, from the start and from the end, and the blocks that lie wholly in
+     the parts that did not change are not split into lines, parsed, translated or listed again:
+     their labels, machine code and listing are taken from the cache, as long as the block starts at
+     the same location and the symbols it refers to did not move. Only the text in between is split
+     into new blocks and assembled, so the work done follows the size of the edit rather than the
+     size of the file. A block that did not change but moved is translated again from the results of
+     its lines, which are kept too, without parsing them.
+
+     Blocks that produced errors are never kept, so their error messages are always reported. The
+     cache is saved in a file next to the source file.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+
+#include "Instruction.h"
+
+class TranslationCache {
+
+public:
+
+    const static uint32_t MAGIC = 0x43544356;   // "VCTC" read as a little-endian word.
+    const static uint32_t VERSION = 3;          // Changes whenever the translation of a line, or the file, may change.
+    const static size_t BLOCK_LINES = 256;      // Lines in each new block.
+    const static int NOT_A_SYMBOL = INT_MIN;    // Kept as the location of an operand that is not a symbol.
+
+    // What the assembler made of a line.
+    struct Entry {
+        // Results of Pass I. These depend only on the text of the line.
+        Instruction::InstructionType m_type;    // The type of instruction.
+        bool m_origin;                          // == true if the line is an org statement.
+        int m_size;                             // The new location for org, otherwise the number of words taken up.
+        string m_label;                         // The label, if any.
+        bool m_import;                          // == true if the line imports m_linkSymbol.
+        bool m_export;                          // == true if the line exports m_linkSymbol.
+        string m_linkSymbol;                    // The symbol named by an import or export statement.
+
+        // Results of Pass II. These also depend on the location of the operand.
+        bool m_translated;                      // == true if the fields below are valid.
+        string m_operand;                       // The symbol the line refers to, if any.
+        int m_operandLoc;                       // The location of m_operand when the line was translated.
+        Instruction::TranslationStatus m_status;    // The status of the translation.
+        int m_word;                             // The machine word or constant.
+        int m_unknown;                          // Always 0, since lines with errors are not cached.
+    };
+
+    // A label found in Pass I. Its location is relative to the start of its block until an org is seen.
+    struct Label {
+        string m_label;             // The label.
+        int m_loc;                  // Its location.
+        bool m_relative;            // == true if m_loc is relative to the start of the block.
+    };
+
+    // What the assembler made of a block of lines.
+    struct Block {
+        size_t m_offset;            // Offset of the first byte of the block in the source.
+        size_t m_size;              // Size of the block in bytes.
+        size_t m_lines;             // Number of lines in the block.
+
+        // Results of Pass I. These depend only on the text of the block.
+        int m_loc;                  // Location following the block. Relative to its start unless m_absolute.
+        bool m_absolute;            // == true if an org statement in the block made m_loc absolute.
+        size_t m_endLine;           // Index of the end statement in the block, or m_lines if it has none.
+        vector<Label> m_labels;     // Labels in the order they were found. Imports are included.
+        vector<string> m_exports;   // Symbols exported by the block.
+
+        // Results of Pass II. These are good while the block starts at m_start and the symbols keep their locations.
+        int m_start;                          // Location of the first line of the block.
+        map<string, int> m_symbols;           // The operands of the block and their locations, NOT_A_SYMBOL for those that are not symbols.
+        string m_listing;                     // Translation listing of the block.
+        vector<pair<int, int>> m_machinecode; // (location, contents) pairs translated in the block.
+        vector<int> m_sourceLines;            // Index in the block of the line of each word of m_machinecode.
+        vector<bool> m_instructions;          // == true for the words of m_machinecode that are instructions.
+        int m_origin;                         // Location of the first instruction in the block, -1 if none.
+        vector<int> m_relocations;            // Locations of the instructions referring to a label of the module.
+        vector<pair<int, string>> m_imports;  // Locations of the instructions referring to an imported symbol.
+
+        string m_entries;           // The results of each line, as EncodeEntries keeps them. Only read if the block moved.
+    };
+
+    // A block of the source being assembled, and the block of the previous run with the same text, if any.
+    struct Span {
+        size_t m_offset;            // Offset of the first byte of the block in the source.
+        size_t m_size;              // Size of the block in bytes.
+        size_t m_lines;             // Number of lines in the block.
+        const Block *m_block;       // The block of the previous run, NULL if the text is new.
+    };
+
+    TranslationCache( ) { };
+    ~TranslationCache( ) { };
+
+    // Read the cache from a file. A missing or out of date file gives an empty cache.
+    bool Load( const string &a_fileName );
+
+    // Save the cache to a file.
+    bool Save( const string &a_fileName ) const;
+
+    // Split a source into blocks, matching them with the blocks of the previous run whose text did not change.
+    void Match( const string &a_source, vector<Span> &a_spans ) const;
+
+    // Replace the source and the blocks with those of this run. a_blocks is left empty.
+    void Replace( const string &a_source, vector<Block> &a_blocks );
+
+    // Keep the results of the lines of a block, and get them back.
+    static void EncodeEntries( const vector<Entry> &a_entries, string &a_text );
+    static bool DecodeEntries( const string &a_text, vector<Entry> &a_entries );
+
+private:
+
+    // Split a part of the source into new blocks of BLOCK_LINES lines. The last line of the source
+    // is the text after its last new line, which is a line even if it is empty.
+    static void Split( const string &a_source, size_t a_begin, size_t a_end, vector<Span> &a_spans );
+
+    string m_source;            // The text of the source the blocks were made from.
+    vector<Block> m_blocks;     // The blocks, in source order. Blocks with errors are left out.
+};
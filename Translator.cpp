@@ -0,0 +1,402 @@
+//
+//      Implementation of the Translator class.
+//
+#include "stdafx.h"
+#include "Translator.h"
+#include "Emulator.h"
+
+// The end of Run(), with the general step, and the entry points of the translated program. Run()
+// returns 1 if the program halted, 0 if it used up its steps and -1 if it stopped with an error.
+static const char *GENERAL_STEP =
+     "     // A location that held no word, or a word that changed: one step like emulator::runProgram.\n"
+     "general:\n"
+     "     if (loc < 0 || loc >= MEMSZ) {\n"
+     "          a_error = \"The program ran past the end of memory\";\n"
+     "          return -1;\n"
+     "     }\n"
+     "     if (i >= MEMSZ)\n"
+     "          return 0;\n"
+     "     i++;\n"
+     "     x = m[loc] % 10000;\n"
+     "     switch (m[loc] / 10000) {\n"
+     "     case 0: loc++; break;\n"
+     "     case 1: if (acc + m[x] > 999999) Overflow(); else { acc += m[x]; loc++; } break;\n"
+     "     case 2: if (acc - m[x] < -999999) Overflow(); else { acc -= m[x]; loc++; } break;\n"
+     "     case 3: if (1LL * acc * m[x] > 999999 || 1LL * acc * m[x] < -999999) Overflow(); else { acc *= m[x]; loc++; } break;\n"
+     "     case 4: if (m[x] == 0 || acc / m[x] > 999999 || acc / m[x] < -999999) Overflow(); else { acc /= m[x]; loc++; } break;\n"
+     "     case 5: acc = m[x]; loc++; break;\n"
+     "     case 6: m[x] = acc; loc++; changed = true; break;\n"
+     "     case 7: switch (Read(x, i - 1, a_error)) { case 1: loc++; break; case -1: return -1; } changed = true; break;\n"
+     "     case 8: std::cout << m[x] << std::endl; loc++; break;\n"
+     "     case 9: loc = x; break;\n"
+     "     case 10: loc = acc < 0 ? x : loc + 1; break;\n"
+     "     case 11: loc = acc == 0 ? x : loc + 1; break;\n"
+     "     case 12: loc = acc > 0 ? x : loc + 1; break;\n"
+     "     case 13: return 1;\n"
+     "     default: a_error = InvalidOpcode(loc, i - 1); return -1;\n"
+     "     }\n"
+     "     if (changed)\n"
+     "          goto general;\n"
+     "     goto dispatch;\n"
+     "}\n"
+     "\n"
+     "} // namespace\n"
+     "\n"
+     "// Run the program once, like Assem -x: returns 0, or 1 after printing the error that stopped it.\n"
+     "extern \"C\" int vc3600_run()\n"
+     "{\n"
+     "     Init();\n"
+     "     std::string error;\n"
+     "     if (Run(error) == 0)\n"
+     "          error = \"Error running the emulator\";\n"
+     "     if (error.empty())\n"
+     "          return 0;\n"
+     "     std::cout << \"!ERROR \" << std::setw(2) << 0 << \"! \" << error << std::endl;\n"
+     "     return 1;\n"
+     "}\n"
+     "\n"
+     "#ifndef VC3600_NO_MAIN\n"
+     "int main()\n"
+     "{\n"
+     "     return vc3600_run();\n"
+     "}\n"
+     "#endif\n";
+
+// The memory and the operations shared by the translations and the general step.
+static const char *SUPPORT =
+     "namespace {\n"
+     "\n"
+     "const int MEMSZ = 10000;     // The size of the memory of the VC3600.\n"
+     "int m[MEMSZ];               // The memory.\n"
+     "int acc;                    // The accumulator.\n"
+     "\n"
+     "void Overflow()\n"
+     "{\n"
+     "     std::cout << \"Overflow in the accumulator when executing command\\n\";\n"
+     "}\n"
+     "\n"
+     "std::string InvalidOpcode(int a_loc, int a_step)\n"
+     "{\n"
+     "     return \"Invalid opcode at location \" + std::to_string(a_loc) + \" (step \" + std::to_string(a_step) + \")\";\n"
+     "}\n"
+     "\n"
+     "// emulator::read: 1 if a number was read into m[a_loc], 0 if the input was not a number, -1 at the end of the input.\n"
+     "int Read(int a_loc, int a_step, std::string &a_error)\n"
+     "{\n"
+     "     std::string input;\n"
+     "     std::cout << \"? \";\n"
+     "     if (!(std::cin >> input)) {\n"
+     "          a_error = \"No input left to read (step \" + std::to_string(a_step) + \")\";\n"
+     "          return -1;\n"
+     "     }\n"
+     "     char sign = 'z';\n"
+     "     if (input[0] == '-' || input[0] == '+') {\n"
+     "          sign = input[0];\n"
+     "          input.erase(0, 1);\n"
+     "     }\n"
+     "     if (input.size() > 6)\n"
+     "          input = input.substr(0, 6);\n"
+     "     bool digits = !input.empty();\n"
+     "     for (size_t i = 0; i < input.size(); i++) {\n"
+     "          if (!isdigit(input[i]))\n"
+     "               digits = false;\n"
+     "     }\n"
+     "     if (!digits) {\n"
+     "          std::cout << \"Input is not all digits\\n\";\n"
+     "          return 0;\n"
+     "     }\n"
+     "     m[a_loc] = std::stoi(input);\n"
+     "     if (sign == '-')\n"
+     "          m[a_loc] *= -1;\n"
+     "     return 1;\n"
+     "}\n"
+     "\n";
+
+
+/**/
+/*
+Translator::Translator(const ObjectImage &a_image)
+
+NAME
+
+    Translator::Translator - constructor for the Translator class.
+
+SYNOPSIS
+
+    Translator::Translator(const ObjectImage &a_image);
+    a_image    --> the program to be translated.
+
+DESCRIPTION
+
+    Lays out the memory the program starts with and finds the locations that stores and reads can write.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+Translator::Translator(const ObjectImage &a_image)
+     : m_origin(a_image.GetOrigin()), m_accumulator(a_image.GetAccumulator()), m_steps(a_image.GetSteps()),
+     m_memory(emulator::MEMSZ, 0), m_placed(emulator::MEMSZ, false), m_written(emulator::MEMSZ, false)
+{
+     for (vector<ObjectImage::Segment>::const_iterator it = a_image.GetSegments().begin(); it != a_image.GetSegments().end(); ++it) {
+          if (it->m_type != ObjectImage::SEG_Words)
+               continue;
+          for (int i = 0; i < it->m_count; i++) {
+               m_memory[it->m_location + i] = it->m_words[i];
+               m_placed[it->m_location + i] = true;
+          }
+     }
+
+     // Any word that would store or read if executed counts, whether it is code or not.
+     for (int loc = 0; loc < emulator::MEMSZ; loc++) {
+          int opcode = m_memory[loc] / 10000;
+          if (opcode == 6 || opcode == 7)
+               m_written[m_memory[loc] % 10000] = true;
+     }
+
+     for (map<string, int>::const_iterator it = a_image.GetSymbols().begin(); it != a_image.GetSymbols().end(); ++it) {
+          if (it->second >= 0 && it->second < emulator::MEMSZ)
+               m_labels[it->second] += (m_labels[it->second].empty() ? "" : " ") + it->first;
+     }
+} /* Translator::Translator(const ObjectImage &a_image) */
+
+
+/**/
+/*
+Translator::Translate(const string &a_name, ostream &a_out)
+
+NAME
+
+    Translator::Translate - write the C++ program.
+
+SYNOPSIS
+
+    void Translator::Translate(const string &a_name, ostream &a_out) const;
+    a_name    --> name of the image, for the comments.
+    a_out     --> where the program is written.
+
+DESCRIPTION
+
+    Writes the memory the program starts with, the runtime support, the translation of every word and
+    the entry points: vc3600_run(), and main() unless VC3600_NO_MAIN is defined.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Translator::Translate(const string &a_name, ostream &a_out) const
+{
+     a_out << "// The VC-3600 program " << a_name << ", translated to C++ by Assem -t." << endl
+          << "//" << endl
+          << "// Build it as a program with:    c++ -O2 -o <Program> <ThisFile>" << endl
+          << "// or as a shared library with:   c++ -O2 -shared -fPIC -DVC3600_NO_MAIN -o <Library> <ThisFile>" << endl
+          << "// and call vc3600_run(), which runs the program once like Assem -x. A program of thousands of" << endl
+          << "// words compiles several times faster with -O1." << endl
+          << "#include <cctype>" << endl << "#include <cstring>" << endl << "#include <iomanip>" << endl
+          << "#include <iostream>" << endl << "#include <string>" << endl << endl;
+     a_out << SUPPORT;
+
+     // The words of the program, one array per run of consecutive words.
+     vector<pair<int, int>> runs;
+     for (int loc = 0; loc < emulator::MEMSZ; loc++) {
+          if (!m_placed[loc])
+               continue;
+          if (runs.empty() || runs.back().first + runs.back().second != loc)
+               runs.push_back(pair<int, int>(loc, 0));
+          runs.back().second++;
+     }
+     for (size_t i = 0; i < runs.size(); i++) {
+          a_out << "const int words" << i << "[] = {";
+          for (int j = 0; j < runs[i].second; j++)
+               a_out << (j % 10 == 0 ? "\n     " : " ") << m_memory[runs[i].first + j] << ",";
+          a_out << "\n};" << endl;
+     }
+     a_out << endl << "// Set up the memory and the accumulator the program starts with." << endl
+          << "void Init()" << endl << "{" << endl
+          << "     memset(m, 0, sizeof(m));" << endl;
+     for (size_t i = 0; i < runs.size(); i++)
+          a_out << "     memcpy(m + " << runs[i].first << ", words" << i << ", sizeof(words" << i << "));" << endl;
+     a_out << "     acc = " << m_accumulator << ";" << endl << "}" << endl << endl;
+
+     // The translation of each word falls through to the next location or goes to its case.
+     a_out << "int Run(std::string &a_error)" << endl << "{" << endl
+          << "     int loc = " << m_origin << ";" << endl
+          << "     int i = " << m_steps << ";" << endl
+          << "     int x;" << endl
+          << "     bool changed = false;   // == true once a general step stored or read: the rest is run by general steps." << endl
+          << "dispatch:" << endl
+          << "     switch (loc) {" << endl;
+     for (int loc = 0; loc < emulator::MEMSZ; loc++) {
+          if (m_placed[loc])
+               TranslateWord(loc, a_out);
+     }
+     a_out << "     }" << endl << endl << GENERAL_STEP;
+} /* void Translator::Translate(const string &a_name, ostream &a_out) const */
+
+
+/**/
+/*
+Translator::TranslateWord(int a_loc, ostream &a_out)
+
+NAME
+
+    Translator::TranslateWord - write the translation of a word.
+
+SYNOPSIS
+
+    void Translator::TranslateWord(int a_loc, ostream &a_out) const;
+    a_loc    --> the location of the word.
+    a_out    --> where the translation is written.
+
+DESCRIPTION
+
+    Writes the case of the location: the step, the check that the word has not changed, and the
+    operation of the word as in Emulator.cpp. A word with opcode 0 only takes its step, and a word
+    with no valid opcode stops the program with an error, as in the emulator.
+
+RETURNS
+
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+void Translator::TranslateWord(int a_loc, ostream &a_out) const
+{
+     int word = m_memory[a_loc];
+     int opcode = word / 10000;
+     int operand = word % 10000;
+     string here = "L" + to_string(a_loc);
+     string next = (a_loc + 1 < emulator::MEMSZ && m_placed[a_loc + 1]) ? "" : GoTo(a_loc + 1);
+
+     map<int, string>::const_iterator label = m_labels.find(a_loc);
+     a_out << "     case " << a_loc << ": " << here << ":";
+     if (label != m_labels.end())
+          a_out << "     // " << label->second;
+     a_out << endl;
+
+     // The step is taken by the general step if the word changed.
+     if (m_written[a_loc])
+          a_out << "          if (m[" << a_loc << "] != " << word << ") { loc = " << a_loc << "; goto general; }" << endl;
+     a_out << "          if (i >= MEMSZ) return 0;" << endl
+          << "          i++;" << endl;
+
+     string m = "m[" + to_string(operand) + "]";
+     switch (opcode) {
+     case 0:
+          break;
+     case 1:
+          a_out << "          if (acc + " << m << " > 999999) { Overflow(); goto " << here << "; }" << endl
+               << "          acc += " << m << ";" << endl;
+          break;
+     case 2:
+          a_out << "          if (acc - " << m << " < -999999) { Overflow(); goto " << here << "; }" << endl
+               << "          acc -= " << m << ";" << endl;
+          break;
+     case 3:
+          a_out << "          if (1LL * acc * " << m << " > 999999 || 1LL * acc * " << m << " < -999999) { Overflow(); goto " << here << "; }" << endl
+               << "          acc *= " << m << ";" << endl;
+          break;
+     case 4:
+          a_out << "          if (" << m << " == 0 || acc / " << m << " > 999999 || acc / " << m << " < -999999) { Overflow(); goto " << here << "; }" << endl
+               << "          acc /= " << m << ";" << endl;
+          break;
+     case 5:
+          a_out << "          acc = " << m << ";" << endl;
+          break;
+     case 6:
+          a_out << "          " << m << " = acc;" << endl;
+          break;
+     case 7:
+          a_out << "          switch (Read(" << operand << ", i - 1, a_error)) { case 0: goto " << here << "; case -1: return -1; }" << endl;
+          break;
+     case 8:
+          a_out << "          std::cout << " << m << " << std::endl;" << endl;
+          break;
+     case 9:
+          a_out << "          " << GoTo(operand) << endl;
+          return;
+     case 10:
+          a_out << "          if (acc < 0) " << GoTo(operand) << endl;
+          break;
+     case 11:
+          a_out << "          if (acc == 0) " << GoTo(operand) << endl;
+          break;
+     case 12:
+          a_out << "          if (acc > 0) " << GoTo(operand) << endl;
+          break;
+     case 13:
+          a_out << "          return 1;" << endl;
+          return;
+     default:
+          a_out << "          a_error = InvalidOpcode(" << a_loc << ", i - 1);" << endl
+               << "          return -1;" << endl;
+          return;
+     }
+     if (!next.empty())
+          a_out << "          " << next << endl;
+} /* void Translator::TranslateWord(int a_loc, ostream &a_out) const */
+
+
+/**/
+/*
+Translator::GoTo(int a_loc)
+
+NAME
+
+    Translator::GoTo - continue at a location.
+
+SYNOPSIS
+
+    string Translator::GoTo(int a_loc) const;
+    a_loc    --> the location to continue at.
+
+DESCRIPTION
+
+    A location that holds a word of the image has a case to go to. Any other goes through the switch,
+    which sends it to the general step.
+
+RETURNS
+
+    The statement that continues at a_loc.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+string Translator::GoTo(int a_loc) const
+{
+     if (a_loc >= 0 && a_loc < emulator::MEMSZ && m_placed[a_loc])
+          return "goto L" + to_string(a_loc) + ";";
+     return "{ loc = " + to_string(a_loc) + "; goto dispatch; }";
+} /* string Translator::GoTo(int a_loc) const */
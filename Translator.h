@@ -0,0 +1,68 @@
+#pragma once
+
+/**/
+/*
+Translator Class
+
+NAME
+
+     Translator - translate an object image into a C++ program.
+
+DESCRIPTION
+
+     Translator class - writes an assembled program as C++ source that does what the emulator
+     does when it runs the image, so a program that is run very often can be compiled with
+     full optimization by the host compiler, as an executable or a shared library.
+
+     Every word of the image becomes a case of one switch on the location, in the order of
+     the locations, so the code of consecutive instructions falls through from one to the
+     next and a branch is a goto to the case it goes to; the labels of the image name the
+     cases. The operations follow Emulator.cpp: every word costs a step of the same budget,
+     an overflow prints the same message and leaves the instruction to be tried again, and
+     read prompts, checks and fails the same way.
+
+     A word that a store or a read of the image can reach is checked before its translation
+     is used; a changed word, or a location that held no word, is executed by a general step
+     like the one of emulator::runProgram. Once a general step has stored or read, it may
+     have changed any word, so general steps run the rest of the program.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+
+#include "ObjectImage.h"
+
+class Translator {
+
+public:
+
+    Translator( const ObjectImage &a_image );
+    ~Translator( ) { };
+
+    // Write the C++ program. a_name is the name of the image, for the comments.
+    void Translate( const string &a_name, ostream &a_out ) const;
+
+private:
+
+    // Write the translation of the word at a location.
+    void TranslateWord( int a_loc, ostream &a_out ) const;
+
+    // The statement that continues at a location.
+    string GoTo( int a_loc ) const;
+
+    int m_origin;                   // Location of the first instruction.
+    int m_accumulator;              // The accumulator when the program starts.
+    int m_steps;                    // Steps already taken when the program starts.
+    vector<int> m_memory;           // The memory when the program starts.
+    vector<bool> m_placed;          // == true for the locations that hold a word of the image.
+    vector<bool> m_written;         // == true for the locations a store or a read in the image writes.
+    map<int, string> m_labels;      // Labels of the locations, for the comments.
+};
@@ -0,0 +1,125 @@
+//
+//      Implementation of the Verifier class.
+//
+#include "stdafx.h"
+#include "Verifier.h"
+#include "Emulator.h"
+
+
+/**/
+/*
+Verifier::Run()
+
+NAME
+
+    Verifier::Run - check the program.
+
+SYNOPSIS
+
+    bool Verifier::Run();
+
+DESCRIPTION
+
+    Walks the control flow graph from the origin. An arithmetic instruction that overflows is tried
+    again, which does not lead anywhere new, so every instruction but a branch or a halt goes on to the
+    next word. The stores and reads found on the way are checked once every reachable word is known.
+
+RETURNS
+
+    'true' if the program passed,
+    'false' otherwise, with the reason in GetReason.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Verifier::Run()
+{
+     m_reachable.assign(emulator::MEMSZ, false);
+     m_reason.clear();
+     if (m_origin < 0 || m_origin >= emulator::MEMSZ)
+          return Fail("The origin " + to_string(m_origin) + " is outside memory");
+
+     vector<int> work(1, m_origin);
+     vector<int> writers;             // Locations of the stores and reads that can be executed.
+     bool halts = false;
+     while (!work.empty()) {
+          int loc = work.back();
+          work.pop_back();
+          if (m_reachable[loc])
+               continue;
+          m_reachable[loc] = true;
+
+          int opcode = m_memory[loc] / 10000;
+          int operand = m_memory[loc] % 10000;
+          if (opcode < 0 || opcode > 13)
+               return Fail("Invalid opcode at location " + to_string(loc));
+          if (opcode == 6 || opcode == 7)
+               writers.push_back(loc);
+
+          if (opcode == 13) {
+               halts = true;
+               continue;
+          }
+          if (opcode >= 9 && opcode <= 12)
+               work.push_back(operand);
+          if (opcode != 9) {
+               if (loc + 1 >= emulator::MEMSZ)
+                    return Fail("The program can run past the end of memory at location " + to_string(loc));
+               work.push_back(loc + 1);
+          }
+     }
+
+     for (size_t i = 0; i < writers.size(); i++) {
+          int target = m_memory[writers[i]] % 10000;
+          if (m_reachable[target])
+               return Fail("The word at location " + to_string(target) + " can be executed and changed by location " + to_string(writers[i]));
+     }
+     if (!halts)
+          return Fail("No halt can be reached");
+     return true;
+} /* bool Verifier::Run() */
+
+
+/**/
+/*
+Verifier::Fail(const string &a_reason)
+
+NAME
+
+    Verifier::Fail - record why the program did not pass.
+
+SYNOPSIS
+
+    bool Verifier::Fail(const string &a_reason);
+    a_reason    --> what was found.
+
+DESCRIPTION
+
+    Keeps the reason for GetReason.
+
+RETURNS
+
+    'false', so Run can return it.
+
+AUTHOR
+
+    Abish Jha
+
+DATE
+
+    12/05/2017
+
+*/
+/**/
+bool Verifier::Fail(const string &a_reason)
+{
+     m_reason = a_reason;
+     return false;
+} /* bool Verifier::Fail(const string &a_reason) */
@@ -0,0 +1,67 @@
+#pragma once
+
+/**/
+/*
+Verifier Class
+
+NAME
+
+     Verifier - check that a loaded program cannot change its own code.
+
+DESCRIPTION
+
+     Verifier class - follows every path of a program from its origin, through the words it
+     steps over and both ways of every conditional branch, and proves that
+
+         - every word that can be executed has a valid opcode, or opcode 0, which is skipped,
+         - no store or read that can be executed has a word that can be executed as its operand,
+         - no path runs past the end of memory,
+         - a halt can be reached.
+
+     Since there is no indirect addressing, the words that can be executed then never change,
+     so the emulator can decode them once and run them on a loop without the checks that
+     self-modifying code and invalid opcodes need.
+
+AUTHOR
+
+     Abish Jha
+
+DATE
+
+     12/05/2017
+
+*/
+/**/
+
+
+class Verifier {
+
+public:
+
+    Verifier( const int *a_memory, int a_origin ) : m_memory( a_memory ), m_origin( a_origin ) { };
+    ~Verifier( ) { };
+
+    // Check the program. Returns true if it passed.
+    bool Run( );
+
+    // Why the program did not pass, empty if it did.
+    inline const string &GetReason( ) const {
+
+        return m_reason;
+    };
+    // Check if the word at a location can be executed. Valid after Run.
+    inline bool IsReachable( int a_loc ) const {
+
+        return m_reachable[a_loc];
+    };
+
+private:
+
+    // Record why the program did not pass.
+    bool Fail( const string &a_reason );
+
+    const int *m_memory;            // The memory of the program.
+    int m_origin;                   // Location of the first instruction to be executed.
+    vector<bool> m_reachable;       // == true for the words that can be executed.
+    string m_reason;                // Why the program did not pass.
+};
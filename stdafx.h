@@ -43,8 +43,24 @@ DATE
 #include <string>
 #include <windows.h>
 #include <map>
+#include <unordered_map>
 #include <iomanip>
 #include <sstream>
 #include <vector>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <random>
+#include <climits>
+#include <mutex>
+#include <deque>
+#include <memory>
+#include <condition_variable>
 
 using namespace std;